@@ -20,6 +20,7 @@
 
 #include "common/IInterface.h"
 #include "common/stdstring.h"
+#include "common/stdvector.h"
 
 class ArchThreadImpl;
 typedef ArchThreadImpl* ArchThread;
@@ -64,6 +65,8 @@ public:
 	enum EAddressFamily {
 		kUNKNOWN,
 		kINET,
+		kUNIX,
+		kINET6
 	};
 
 	//! Supported socket types
@@ -236,18 +239,56 @@ public:
 	*/
 	virtual bool		setReuseAddrOnSocket(ArchSocket, bool reuse) = 0;
 
+	//! Limit unsent data on socket
+	/*!
+	Asks the kernel to keep no more than about \c bytes of data that
+	hasn't been sent yet queued on the TCP socket, so data written
+	later isn't stuck behind a deep send buffer.  The socket reports
+	itself writable only once the unsent data drops below the limit.
+	Returns false if the platform doesn't support this.
+	*/
+	virtual bool		setUnsentLowWaterOnSocket(ArchSocket, int bytes) = 0;
+
+	//! Get the user on the other end of a local socket
+	/*!
+	Returns the user id of the process connected to the other end of
+	the local (\c kUNIX) socket \c s, or -1 if the platform can't tell.
+	*/
+	virtual int			getPeerUserOnSocket(ArchSocket s) = 0;
+
 	//! Return local host's name
 	virtual std::string		getHostName() = 0;
 
 	//! Create an "any" network address
 	virtual ArchNetAddress	newAnyAddr(EAddressFamily) = 0;
 
+	//! Create a local network address
+	/*!
+	Returns a \c kUNIX address for the socket file at \c path.  Throws
+	\c XArchNetworkSupport if local sockets aren't supported.
+	*/
+	virtual ArchNetAddress	newLocalAddr(const std::string& path) = 0;
+
 	//! Copy a network address
 	virtual ArchNetAddress	copyAddr(ArchNetAddress) = 0;
 
 	//! Convert a name to a network address
+	/*!
+	Returns the name's first IPv4 address or, if it has none, its first
+	IPv6 address.
+	*/
 	virtual ArchNetAddress	nameToAddr(const std::string&) = 0;
 
+	//! Convert a name to all of its network addresses
+	/*!
+	Appends every IPv4 and IPv6 address of \c name to \c addrs, in the
+	order the resolver prefers them.  The caller must close each one.
+	This doesn't lock out other lookups, so it may be called from any
+	thread, but it blocks for as long as the lookup takes.
+	*/
+	virtual void			nameToAddrs(const std::string& name,
+								std::vector<ArchNetAddress>& addrs) = 0;
+
 	//! Destroy a network address
 	virtual void			closeAddr(ArchNetAddress) = 0;
 
@@ -37,5 +37,13 @@ public:
 	*/
 	virtual double		time() = 0;
 
+	//! Get the current monotonic time
+	/*!
+	Returns the number of seconds since some arbitrary starting time
+	using a clock that never jumps when the wall clock is changed.  Use
+	this to measure intervals.
+	*/
+	virtual double		monotonicTime() = 0;
+
 	//@}
 };
@@ -25,6 +25,7 @@
 #if HAVE_UNISTD_H
 #	include <unistd.h>
 #endif
+#include <sys/un.h>
 #include <netinet/in.h>
 #include <netdb.h>
 #if !defined(TCP_NODELAY)
@@ -33,6 +34,7 @@
 #include <arpa/inet.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <stddef.h>
 #include <string.h>
 
 #if HAVE_POLL
@@ -46,42 +48,17 @@
 #	endif
 #endif
 
-#if !HAVE_INET_ATON
-#	include <stdio.h>
-#endif
-
 static const int s_family[] = {
 	PF_UNSPEC,
-	PF_INET
+	PF_INET,
+	PF_UNIX,
+	PF_INET6
 };
 static const int s_type[] = {
 	SOCK_DGRAM,
 	SOCK_STREAM
 };
 
-#if !HAVE_INET_ATON
-// parse dotted quad addresses.  we don't bother with the weird BSD'ism
-// of handling octal and hex and partial forms.
-static
-in_addr_t
-inet_aton(const char* cp, struct in_addr* inp)
-{
-	unsigned int a, b, c, d;
-	if (sscanf(cp, "%u.%u.%u.%u", &a, &b, &c, &d) != 4) {
-		return 0;
-	}
-	if (a >= 256 || b >= 256 || c >= 256 || d >= 256) {
-		return 0;
-	}
-	unsigned char* incp = (unsigned char*)inp;
-	incp[0] = (unsigned char)(a & 0xffu);
-	incp[1] = (unsigned char)(b & 0xffu);
-	incp[2] = (unsigned char)(c & 0xffu);
-	incp[3] = (unsigned char)(d & 0xffu);
-	return inp->s_addr;
-}
-#endif
-
 //
 // ArchNetworkBSD
 //
@@ -623,6 +600,48 @@ ArchNetworkBSD::setReuseAddrOnSocket(ArchSocket s, bool reuse)
 	return (oflag != 0);
 }
 
+bool
+ArchNetworkBSD::setUnsentLowWaterOnSocket(ArchSocket s, int bytes)
+{
+	assert(s != NULL);
+
+#if defined(TCP_NOTSENT_LOWAT)
+	// older kernels reject the option, which leaves the socket as it was
+	if (setsockopt(s->m_fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT,
+							(optval_t*)&bytes, (socklen_t)sizeof(bytes)) == -1) {
+		return false;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+int
+ArchNetworkBSD::getPeerUserOnSocket(ArchSocket s)
+{
+	assert(s != NULL);
+
+#if defined(SO_PEERCRED)
+	struct ucred cred;
+	socklen_t size = (socklen_t)sizeof(cred);
+	if (getsockopt(s->m_fd, SOL_SOCKET, SO_PEERCRED,
+							(optval_t*)&cred, &size) == -1) {
+		throwError(errno);
+	}
+	return (int)cred.uid;
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__)
+	uid_t uid;
+	gid_t gid;
+	if (getpeereid(s->m_fd, &uid, &gid) == -1) {
+		throwError(errno);
+	}
+	return (int)uid;
+#else
+	return -1;
+#endif
+}
+
 std::string
 ArchNetworkBSD::getHostName()
 {
@@ -654,6 +673,16 @@ ArchNetworkBSD::newAnyAddr(EAddressFamily family)
 		break;
 	}
 
+	case kINET6: {
+		struct sockaddr_in6* ipAddr =
+			reinterpret_cast<struct sockaddr_in6*>(&addr->m_addr);
+		memset(ipAddr, 0, sizeof(struct sockaddr_in6));
+		ipAddr->sin6_family        = AF_INET6;
+		ipAddr->sin6_addr          = in6addr_any;
+		addr->m_len                = (socklen_t)sizeof(struct sockaddr_in6);
+		break;
+	}
+
 	default:
 		delete addr;
 		assert(0 && "invalid family");
@@ -662,6 +691,26 @@ ArchNetworkBSD::newAnyAddr(EAddressFamily family)
 	return addr;
 }
 
+ArchNetAddress
+ArchNetworkBSD::newLocalAddr(const std::string& path)
+{
+	ArchNetAddressImpl* addr = new ArchNetAddressImpl;
+	struct sockaddr_un* localAddr =
+		reinterpret_cast<struct sockaddr_un*>(&addr->m_addr);
+	if (path.size() >= sizeof(localAddr->sun_path)) {
+		delete addr;
+		throw XArchNetworkNameUnsupported(
+				"The local socket path is too long");
+	}
+
+	memset(localAddr, 0, sizeof(struct sockaddr_un));
+	localAddr->sun_family = AF_UNIX;
+	memcpy(localAddr->sun_path, path.c_str(), path.size());
+	addr->m_len = (socklen_t)(offsetof(struct sockaddr_un, sun_path) +
+								path.size() + 1);
+	return addr;
+}
+
 ArchNetAddress
 ArchNetworkBSD::copyAddr(ArchNetAddress addr)
 {
@@ -674,52 +723,59 @@ ArchNetworkBSD::copyAddr(ArchNetAddress addr)
 ArchNetAddress
 ArchNetworkBSD::nameToAddr(const std::string& name)
 {
-	// allocate address
-	ArchNetAddressImpl* addr = new ArchNetAddressImpl;
-
-	// try to convert assuming an IPv4 dot notation address
-	struct sockaddr_in inaddr;
-	memset(&inaddr, 0, sizeof(inaddr));
-	if (inet_aton(name.c_str(), &inaddr.sin_addr) != 0) {
-		// it's a dot notation address
-		addr->m_len       = (socklen_t)sizeof(struct sockaddr_in);
-		inaddr.sin_family = AF_INET;
-		inaddr.sin_port   = 0;
-		memcpy(&addr->m_addr, &inaddr, addr->m_len);
+	std::vector<ArchNetAddress> addrs;
+	nameToAddrs(name, addrs);
+
+	// prefer IPv4, which is all we used to support
+	ArchNetAddress addr = addrs[0];
+	for (size_t i = 0; i < addrs.size(); ++i) {
+		if (getAddrFamily(addrs[i]) == kINET) {
+			addr = addrs[i];
+			break;
+		}
 	}
-
-	else {
-		// mutexed address lookup (ugh)
-		ARCH->lockMutex(m_mutex);
-		struct hostent* info = gethostbyname(name.c_str());
-		if (info == NULL) {
-			ARCH->unlockMutex(m_mutex);
-			delete addr;
-			throwNameError(h_errno);
+	for (size_t i = 0; i < addrs.size(); ++i) {
+		if (addrs[i] != addr) {
+			closeAddr(addrs[i]);
 		}
+	}
+	return addr;
+}
 
-		// copy over address (only IPv4 currently supported)
-		if (info->h_addrtype == AF_INET) {
-			addr->m_len       = (socklen_t)sizeof(struct sockaddr_in);
-			inaddr.sin_family = info->h_addrtype;
-			inaddr.sin_port   = 0;
-			memcpy(&inaddr.sin_addr, info->h_addr_list[0],
-								sizeof(inaddr.sin_addr));
-			memcpy(&addr->m_addr, &inaddr, addr->m_len);
-		}
-		else {
-			ARCH->unlockMutex(m_mutex);
-			delete addr;
-			throw XArchNetworkNameUnsupported(
-					"The requested name is valid but "
-					"does not have a supported address family");
-		}
+void
+ArchNetworkBSD::nameToAddrs(const std::string& name,
+				std::vector<ArchNetAddress>& addrs)
+{
+	// getaddrinfo() is thread safe so, unlike gethostbyname(), needs
+	// no mutex
+	struct addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family   = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	struct addrinfo* info = NULL;
+	int err = getaddrinfo(name.c_str(), NULL, &hints, &info);
+	if (err != 0) {
+		throwAddrInfoError(err);
+	}
 
-		// done with static buffer
-		ARCH->unlockMutex(m_mutex);
+	size_t n = addrs.size();
+	for (struct addrinfo* i = info; i != NULL; i = i->ai_next) {
+		if ((i->ai_family != AF_INET && i->ai_family != AF_INET6) ||
+			i->ai_addrlen > sizeof(struct sockaddr_storage)) {
+			continue;
+		}
+		ArchNetAddressImpl* addr = new ArchNetAddressImpl;
+		memcpy(&addr->m_addr, i->ai_addr, i->ai_addrlen);
+		addr->m_len = (socklen_t)i->ai_addrlen;
+		addrs.push_back(addr);
 	}
+	freeaddrinfo(info);
 
-	return addr;
+	if (addrs.size() == n) {
+		throw XArchNetworkNameUnsupported(
+				"The requested name is valid but "
+				"does not have a supported address family");
+	}
 }
 
 void
@@ -763,10 +819,21 @@ ArchNetworkBSD::addrToString(ArchNetAddress addr)
 	case kINET: {
 		struct sockaddr_in* ipAddr =
 			reinterpret_cast<struct sockaddr_in*>(&addr->m_addr);
-		ARCH->lockMutex(m_mutex);
-		std::string s = inet_ntoa(ipAddr->sin_addr);
-		ARCH->unlockMutex(m_mutex);
-		return s;
+		char s[INET_ADDRSTRLEN];
+		return inet_ntop(AF_INET, &ipAddr->sin_addr, s, sizeof(s));
+	}
+
+	case kINET6: {
+		struct sockaddr_in6* ipAddr =
+			reinterpret_cast<struct sockaddr_in6*>(&addr->m_addr);
+		char s[INET6_ADDRSTRLEN];
+		return inet_ntop(AF_INET6, &ipAddr->sin6_addr, s, sizeof(s));
+	}
+
+	case kUNIX: {
+		struct sockaddr_un* localAddr =
+			reinterpret_cast<struct sockaddr_un*>(&addr->m_addr);
+		return localAddr->sun_path;
 	}
 
 	default:
@@ -784,6 +851,12 @@ ArchNetworkBSD::getAddrFamily(ArchNetAddress addr)
 	case AF_INET:
 		return kINET;
 
+	case AF_INET6:
+		return kINET6;
+
+	case AF_UNIX:
+		return kUNIX;
+
 	default:
 		return kUNKNOWN;
 	}
@@ -802,6 +875,17 @@ ArchNetworkBSD::setAddrPort(ArchNetAddress addr, int port)
 		break;
 	}
 
+	case kINET6: {
+		struct sockaddr_in6* ipAddr =
+			reinterpret_cast<struct sockaddr_in6*>(&addr->m_addr);
+		ipAddr->sin6_port = htons(port);
+		break;
+	}
+
+	case kUNIX:
+		// local sockets have no port
+		break;
+
 	default:
 		assert(0 && "unknown address family");
 		break;
@@ -820,6 +904,16 @@ ArchNetworkBSD::getAddrPort(ArchNetAddress addr)
 		return ntohs(ipAddr->sin_port);
 	}
 
+	case kINET6: {
+		struct sockaddr_in6* ipAddr =
+			reinterpret_cast<struct sockaddr_in6*>(&addr->m_addr);
+		return ntohs(ipAddr->sin6_port);
+	}
+
+	case kUNIX:
+		// local sockets have no port
+		return 0;
+
 	default:
 		assert(0 && "unknown address family");
 		return 0;
@@ -839,6 +933,16 @@ ArchNetworkBSD::isAnyAddr(ArchNetAddress addr)
 				addr->m_len == (socklen_t)sizeof(struct sockaddr_in));
 	}
 
+	case kINET6: {
+		struct sockaddr_in6* ipAddr =
+			reinterpret_cast<struct sockaddr_in6*>(&addr->m_addr);
+		return (IN6_IS_ADDR_UNSPECIFIED(&ipAddr->sin6_addr) &&
+				addr->m_len == (socklen_t)sizeof(struct sockaddr_in6));
+	}
+
+	case kUNIX:
+		return false;
+
 	default:
 		assert(0 && "unknown address family");
 		return true;
@@ -987,3 +1091,35 @@ ArchNetworkBSD::throwNameError(int err)
 		throw XArchNetworkName(s_msg[4]);
 	}
 }
+
+void
+ArchNetworkBSD::throwAddrInfoError(int err)
+{
+	switch (err) {
+	case EAI_NONAME:
+		throw XArchNetworkNameUnknown(gai_strerror(err));
+
+#if defined(EAI_NODATA) && EAI_NODATA != EAI_NONAME
+	case EAI_NODATA:
+#endif
+#if defined(EAI_ADDRFAMILY)
+	case EAI_ADDRFAMILY:
+#endif
+		throw XArchNetworkNameNoAddress(gai_strerror(err));
+
+	case EAI_FAIL:
+		throw XArchNetworkNameFailure(gai_strerror(err));
+
+	case EAI_AGAIN:
+		throw XArchNetworkNameUnavailable(gai_strerror(err));
+
+	case EAI_FAMILY:
+		throw XArchNetworkNameUnsupported(gai_strerror(err));
+
+	case EAI_SYSTEM:
+		throwError(errno);
+
+	default:
+		throw XArchNetworkName(gai_strerror(err));
+	}
+}
@@ -47,10 +47,14 @@ public:
 
 class ArchNetAddressImpl {
 public:
-	ArchNetAddressImpl() : m_len(sizeof(m_addr)) { }
+	ArchNetAddressImpl() : m_len(sizeof(m_storage)) { }
 
 public:
-	struct sockaddr		m_addr;
+	// large enough for a unix domain socket path
+	union {
+		struct sockaddr			m_addr;
+		struct sockaddr_storage	m_storage;
+	};
 	socklen_t			m_len;
 };
 
@@ -79,10 +83,15 @@ public:
 	virtual void		throwErrorOnSocket(ArchSocket);
 	virtual bool		setNoDelayOnSocket(ArchSocket, bool noDelay);
 	virtual bool		setReuseAddrOnSocket(ArchSocket, bool reuse);
+	virtual bool		setUnsentLowWaterOnSocket(ArchSocket, int bytes);
+	virtual int			getPeerUserOnSocket(ArchSocket);
 	virtual std::string		getHostName();
 	virtual ArchNetAddress	newAnyAddr(EAddressFamily);
+	virtual ArchNetAddress	newLocalAddr(const std::string& path);
 	virtual ArchNetAddress	copyAddr(ArchNetAddress);
 	virtual ArchNetAddress	nameToAddr(const std::string&);
+	virtual void			nameToAddrs(const std::string&,
+								std::vector<ArchNetAddress>&);
 	virtual void			closeAddr(ArchNetAddress);
 	virtual std::string		addrToName(ArchNetAddress);
 	virtual std::string		addrToString(ArchNetAddress);
@@ -98,6 +107,7 @@ private:
 	void				setBlockingOnSocket(int fd, bool blocking);
 	void				throwError(int);
 	void				throwNameError(int);
+	void				throwAddrInfoError(int);
 
 private:
 	ArchMutex			m_mutex;
@@ -50,3 +50,15 @@ ArchTimeUnix::time()
 	gettimeofday(&t, NULL);
 	return (double)t.tv_sec + 1.0e-6 * (double)t.tv_usec;
 }
+
+double
+ArchTimeUnix::monotonicTime()
+{
+#if defined(CLOCK_MONOTONIC)
+	struct timespec t;
+	if (clock_gettime(CLOCK_MONOTONIC, &t) == 0) {
+		return (double)t.tv_sec + 1.0e-9 * (double)t.tv_nsec;
+	}
+#endif
+	return time();
+}
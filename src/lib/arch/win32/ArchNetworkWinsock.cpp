@@ -26,7 +26,9 @@
 
 static const int s_family[] = {
 	PF_UNSPEC,
-	PF_INET
+	PF_INET,
+	PF_UNSPEC,	// no local sockets
+	PF_INET6
 };
 static const int s_type[] = {
 	SOCK_DGRAM,
@@ -54,6 +56,9 @@ static int (PASCAL FAR *shutdown_winsock)(SOCKET s, int how);
 static SOCKET (PASCAL FAR *socket_winsock)(int af, int type, int protocol);
 static struct hostent FAR * (PASCAL FAR *gethostbyaddr_winsock)(const char FAR * addr, int len, int type);
 static struct hostent FAR * (PASCAL FAR *gethostbyname_winsock)(const char FAR * name);
+static int (PASCAL FAR *getaddrinfo_winsock)(const char FAR * node, const char FAR * service, const struct addrinfo FAR * hints, struct addrinfo FAR * FAR * res);
+static void (PASCAL FAR *freeaddrinfo_winsock)(struct addrinfo FAR * info);
+static int (PASCAL FAR *WSAAddressToStringA_winsock)(LPSOCKADDR, DWORD, LPWSAPROTOCOL_INFOA, LPSTR, LPDWORD);
 static int (PASCAL FAR *WSACleanup_winsock)(void);
 static int (PASCAL FAR *WSAFDIsSet_winsock)(SOCKET, fd_set FAR * fdset);
 static WSAEVENT (PASCAL FAR *WSACreateEvent_winsock)(void);
@@ -189,6 +194,9 @@ ArchNetworkWinsock::initModule(HMODULE module)
 	setfunc(socket_winsock, socket, SOCKET (PASCAL FAR *)(int af, int type, int protocol));
 	setfunc(gethostbyaddr_winsock, gethostbyaddr, struct hostent FAR * (PASCAL FAR *)(const char FAR * addr, int len, int type));
 	setfunc(gethostbyname_winsock, gethostbyname, struct hostent FAR * (PASCAL FAR *)(const char FAR * name));
+	setfunc(getaddrinfo_winsock, getaddrinfo, int (PASCAL FAR *)(const char FAR *, const char FAR *, const struct addrinfo FAR *, struct addrinfo FAR * FAR *));
+	setfunc(freeaddrinfo_winsock, freeaddrinfo, void (PASCAL FAR *)(struct addrinfo FAR *));
+	setfunc(WSAAddressToStringA_winsock, WSAAddressToStringA, int (PASCAL FAR *)(LPSOCKADDR, DWORD, LPWSAPROTOCOL_INFOA, LPSTR, LPDWORD));
 	setfunc(WSACleanup_winsock, WSACleanup, int (PASCAL FAR *)(void));
 	setfunc(WSAFDIsSet_winsock, __WSAFDIsSet, int (PASCAL FAR *)(SOCKET, fd_set FAR *));
 	setfunc(WSACreateEvent_winsock, WSACreateEvent, WSAEVENT (PASCAL FAR *)(void));
@@ -654,6 +662,20 @@ ArchNetworkWinsock::setReuseAddrOnSocket(ArchSocket s, bool reuse)
 	return (oflag != 0);
 }
 
+bool
+ArchNetworkWinsock::setUnsentLowWaterOnSocket(ArchSocket, int)
+{
+	// winsock has no equivalent of TCP_NOTSENT_LOWAT
+	return false;
+}
+
+int
+ArchNetworkWinsock::getPeerUserOnSocket(ArchSocket)
+{
+	// local sockets aren't supported
+	return -1;
+}
+
 std::string
 ArchNetworkWinsock::getHostName()
 {
@@ -681,12 +703,26 @@ ArchNetworkWinsock::newAnyAddr(EAddressFamily family)
 		break;
 	}
 
+	case kINET6: {
+		addr = ArchNetAddressImpl::alloc(sizeof(struct sockaddr_in6));
+		struct sockaddr_in6* ipAddr = TYPED_ADDR(struct sockaddr_in6, addr);
+		memset(ipAddr, 0, sizeof(struct sockaddr_in6));
+		ipAddr->sin6_family        = AF_INET6;
+		break;
+	}
+
 	default:
 		assert(0 && "invalid family");
 	}
 	return addr;
 }
 
+ArchNetAddress
+ArchNetworkWinsock::newLocalAddr(const std::string&)
+{
+	throw XArchNetworkSupport("Local sockets are not supported");
+}
+
 ArchNetAddress
 ArchNetworkWinsock::copyAddr(ArchNetAddress addr)
 {
@@ -700,43 +736,55 @@ ArchNetworkWinsock::copyAddr(ArchNetAddress addr)
 ArchNetAddress
 ArchNetworkWinsock::nameToAddr(const std::string& name)
 {
-	// allocate address
-	ArchNetAddressImpl* addr = NULL;
-
-	// try to convert assuming an IPv4 dot notation address
-	struct sockaddr_in inaddr;
-	memset(&inaddr, 0, sizeof(inaddr));
-	inaddr.sin_family      = AF_INET;
-	inaddr.sin_port        = 0;
-	inaddr.sin_addr.s_addr = inet_addr_winsock(name.c_str());
-	if (inaddr.sin_addr.s_addr != INADDR_NONE) {
-		// it's a dot notation address
-		addr = ArchNetAddressImpl::alloc(sizeof(struct sockaddr_in));
-		memcpy(TYPED_ADDR(void, addr), &inaddr, addr->m_len);
+	std::vector<ArchNetAddress> addrs;
+	nameToAddrs(name, addrs);
+
+	// prefer IPv4, which is all we used to support
+	ArchNetAddress addr = addrs[0];
+	for (size_t i = 0; i < addrs.size(); ++i) {
+		if (getAddrFamily(addrs[i]) == kINET) {
+			addr = addrs[i];
+			break;
+		}
 	}
-
-	else {
-		// address lookup
-		struct hostent* info = gethostbyname_winsock(name.c_str());
-		if (info == NULL) {
-			throwNameError(getsockerror_winsock());
+	for (size_t i = 0; i < addrs.size(); ++i) {
+		if (addrs[i] != addr) {
+			closeAddr(addrs[i]);
 		}
+	}
+	return addr;
+}
 
-		// copy over address (only IPv4 currently supported)
-		if (info->h_addrtype == AF_INET) {
-			addr = ArchNetAddressImpl::alloc(sizeof(struct sockaddr_in));
-			memcpy(&inaddr.sin_addr, info->h_addr_list[0],
-								sizeof(inaddr.sin_addr));
-			memcpy(TYPED_ADDR(void, addr), &inaddr, addr->m_len);
-		}
-		else {
-			throw XArchNetworkNameUnsupported(
-					"The requested name is valid but "
-					"does not have a supported address family");
+void
+ArchNetworkWinsock::nameToAddrs(const std::string& name,
+				std::vector<ArchNetAddress>& addrs)
+{
+	struct addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family   = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	struct addrinfo* info = NULL;
+	int err = getaddrinfo_winsock(name.c_str(), NULL, &hints, &info);
+	if (err != 0) {
+		throwNameError(err);
+	}
+
+	size_t n = addrs.size();
+	for (struct addrinfo* i = info; i != NULL; i = i->ai_next) {
+		if (i->ai_family != AF_INET && i->ai_family != AF_INET6) {
+			continue;
 		}
+		ArchNetAddressImpl* addr = ArchNetAddressImpl::alloc(i->ai_addrlen);
+		memcpy(TYPED_ADDR(void, addr), i->ai_addr, i->ai_addrlen);
+		addrs.push_back(addr);
 	}
+	freeaddrinfo_winsock(info);
 
-	return addr;
+	if (addrs.size() == n) {
+		throw XArchNetworkNameUnsupported(
+				"The requested name is valid but "
+				"does not have a supported address family");
+	}
 }
 
 void
@@ -776,6 +824,21 @@ ArchNetworkWinsock::addrToString(ArchNetAddress addr)
 		return inet_ntoa_winsock(ipAddr->sin_addr);
 	}
 
+	case kINET6: {
+		// without the port, which would add brackets
+		struct sockaddr_in6 ipAddr =
+			*reinterpret_cast<struct sockaddr_in6*>(&addr->m_addr);
+		ipAddr.sin6_port = 0;
+		char s[64];
+		DWORD size = sizeof(s);
+		if (WSAAddressToStringA_winsock(
+							reinterpret_cast<LPSOCKADDR>(&ipAddr),
+							sizeof(ipAddr), NULL, s, &size) != 0) {
+			return "";
+		}
+		return s;
+	}
+
 	default:
 		assert(0 && "unknown address family");
 		return "";
@@ -791,6 +854,9 @@ ArchNetworkWinsock::getAddrFamily(ArchNetAddress addr)
 	case AF_INET:
 		return kINET;
 
+	case AF_INET6:
+		return kINET6;
+
 	default:
 		return kUNKNOWN;
 	}
@@ -809,6 +875,13 @@ ArchNetworkWinsock::setAddrPort(ArchNetAddress addr, int port)
 		break;
 	}
 
+	case kINET6: {
+		struct sockaddr_in6* ipAddr =
+			reinterpret_cast<struct sockaddr_in6*>(&addr->m_addr);
+		ipAddr->sin6_port = htons_winsock(static_cast<u_short>(port));
+		break;
+	}
+
 	default:
 		assert(0 && "unknown address family");
 		break;
@@ -827,6 +900,12 @@ ArchNetworkWinsock::getAddrPort(ArchNetAddress addr)
 		return ntohs_winsock(ipAddr->sin_port);
 	}
 
+	case kINET6: {
+		struct sockaddr_in6* ipAddr =
+			reinterpret_cast<struct sockaddr_in6*>(&addr->m_addr);
+		return ntohs_winsock(ipAddr->sin6_port);
+	}
+
 	default:
 		assert(0 && "unknown address family");
 		return 0;
@@ -846,6 +925,14 @@ ArchNetworkWinsock::isAnyAddr(ArchNetAddress addr)
 				ipAddr->sin_addr.s_addr == INADDR_ANY);
 	}
 
+	case kINET6: {
+		static const struct in6_addr s_any = { 0 };
+		struct sockaddr_in6* ipAddr =
+			reinterpret_cast<struct sockaddr_in6*>(&addr->m_addr);
+		return (addr->m_len == sizeof(struct sockaddr_in6) &&
+				memcmp(&ipAddr->sin6_addr, &s_any, sizeof(s_any)) == 0);
+	}
+
 	default:
 		assert(0 && "unknown address family");
 		return true;
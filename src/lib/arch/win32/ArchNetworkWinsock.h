@@ -26,6 +26,7 @@
 #include "arch/IArchMultithread.h"
 
 #include <WinSock2.h>
+#include <WS2tcpip.h>
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
 #include <list>
@@ -77,10 +78,15 @@ public:
 	virtual void		throwErrorOnSocket(ArchSocket);
 	virtual bool		setNoDelayOnSocket(ArchSocket, bool noDelay);
 	virtual bool		setReuseAddrOnSocket(ArchSocket, bool reuse);
+	virtual bool		setUnsentLowWaterOnSocket(ArchSocket, int bytes);
+	virtual int			getPeerUserOnSocket(ArchSocket);
 	virtual std::string		getHostName();
 	virtual ArchNetAddress	newAnyAddr(EAddressFamily);
+	virtual ArchNetAddress	newLocalAddr(const std::string& path);
 	virtual ArchNetAddress	copyAddr(ArchNetAddress);
 	virtual ArchNetAddress	nameToAddr(const std::string&);
+	virtual void			nameToAddrs(const std::string&,
+								std::vector<ArchNetAddress>&);
 	virtual void			closeAddr(ArchNetAddress);
 	virtual std::string		addrToName(ArchNetAddress);
 	virtual std::string		addrToString(ArchNetAddress);
@@ -87,3 +87,10 @@ ArchTimeWindows::time()
 		return 0.001 * static_cast<double>(GetTickCount());
 	}
 }
+
+double
+ArchTimeWindows::monotonicTime()
+{
+	// all of the counters time() uses only ever move forward
+	return time();
+}
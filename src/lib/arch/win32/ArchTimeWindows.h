@@ -30,4 +30,5 @@ public:
 
 	// IArchTime overrides
 	virtual double		time();
+	virtual double		monotonicTime();
 };
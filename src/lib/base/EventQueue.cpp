@@ -37,6 +37,7 @@ EVENT_TYPE_ACCESSOR(IpcServerProxy)
 EVENT_TYPE_ACCESSOR(IDataSocket)
 EVENT_TYPE_ACCESSOR(IListenSocket)
 EVENT_TYPE_ACCESSOR(ISocket)
+EVENT_TYPE_ACCESSOR(NameResolver)
 EVENT_TYPE_ACCESSOR(OSXScreen)
 EVENT_TYPE_ACCESSOR(ClientListener)
 EVENT_TYPE_ACCESSOR(ClientProxy)
@@ -75,6 +76,7 @@ EventQueue::EventQueue() :
 	m_typesForIDataSocket(NULL),
 	m_typesForIListenSocket(NULL),
 	m_typesForISocket(NULL),
+	m_typesForNameResolver(NULL),
 	m_typesForOSXScreen(NULL),
 	m_typesForClientListener(NULL),
 	m_typesForClientProxy(NULL),
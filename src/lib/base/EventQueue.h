@@ -148,6 +148,7 @@ public:
 	IDataSocketEvents&			forIDataSocket();
 	IListenSocketEvents&		forIListenSocket();
 	ISocketEvents&				forISocket();
+	NameResolverEvents&			forNameResolver();
 	OSXScreenEvents&			forOSXScreen();
 	ClientListenerEvents&		forClientListener();
 	ClientProxyEvents&			forClientProxy();
@@ -170,6 +171,7 @@ private:
 	IDataSocketEvents*			m_typesForIDataSocket;
 	IListenSocketEvents*		m_typesForIListenSocket;
 	ISocketEvents*				m_typesForISocket;
+	NameResolverEvents*			m_typesForNameResolver;
 	OSXScreenEvents*			m_typesForOSXScreen;
 	ClientListenerEvents*		m_typesForClientListener;
 	ClientProxyEvents*			m_typesForClientProxy;
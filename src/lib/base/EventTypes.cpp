@@ -46,6 +46,7 @@ EventTypes::setEvents(IEventQueue* events)
 REGISTER_EVENT(Client, connected)
 REGISTER_EVENT(Client, connectionFailed)
 REGISTER_EVENT(Client, disconnected)
+REGISTER_EVENT(Client, logStats)
 
 //
 // IStream
@@ -82,6 +83,7 @@ REGISTER_EVENT(IpcServerProxy, messageReceived)
 //
 
 REGISTER_EVENT(IDataSocket, connected)
+REGISTER_EVENT(IDataSocket, secureConnected)
 REGISTER_EVENT(IDataSocket, connectionFailed)
 
 //
@@ -97,6 +99,12 @@ REGISTER_EVENT(IListenSocket, connecting)
 REGISTER_EVENT(ISocket, disconnected)
 REGISTER_EVENT(ISocket, stopRetry)
 
+//
+// NameResolver
+//
+
+REGISTER_EVENT(NameResolver, resolved)
+
 //
 // OSXScreen
 //
@@ -115,6 +123,7 @@ REGISTER_EVENT(ClientListener, connected)
 
 REGISTER_EVENT(ClientProxy, ready)
 REGISTER_EVENT(ClientProxy, disconnected)
+REGISTER_EVENT(ClientProxy, motionQueued)
 
 //
 // ClientProxyUnknown
@@ -143,6 +152,7 @@ REGISTER_EVENT(Server, screenSwitched)
 REGISTER_EVENT(ServerApp, reloadConfig)
 REGISTER_EVENT(ServerApp, forceReconnect)
 REGISTER_EVENT(ServerApp, resetServer)
+REGISTER_EVENT(ServerApp, logStats)
 
 //
 // IKeyState
@@ -191,6 +201,8 @@ REGISTER_EVENT(IpcServer, messageReceived)
 REGISTER_EVENT(Clipboard, clipboardGrabbed)
 REGISTER_EVENT(Clipboard, clipboardChanged)
 REGISTER_EVENT(Clipboard, clipboardSending)
+REGISTER_EVENT(Clipboard, clipboardFormatsRequested)
+REGISTER_EVENT(Clipboard, clipboardReceived)
 
 //
 // File
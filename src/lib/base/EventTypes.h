@@ -45,7 +45,8 @@ public:
 	ClientEvents() :
 		m_connected(Event::kUnknown),
 		m_connectionFailed(Event::kUnknown),
-		m_disconnected(Event::kUnknown) { }
+		m_disconnected(Event::kUnknown),
+		m_logStats(Event::kUnknown) { }
 
 	//! @name accessors
 	//@{
@@ -72,12 +73,20 @@ public:
 	*/
 	Event::Type		disconnected();
 
+	//! Get log statistics event type
+	/*!
+	Returns the log statistics event type.  This is sent to the system
+	target when the client app is asked to log the client's statistics.
+	*/
+	Event::Type		logStats();
+
 	//@}
 
 private:
 	Event::Type		m_connected;
 	Event::Type		m_connectionFailed;
 	Event::Type		m_disconnected;
+	Event::Type		m_logStats;
 };
 
 class IStreamEvents : public EventTypes {
@@ -230,6 +239,7 @@ class IDataSocketEvents : public EventTypes {
 public:
 	IDataSocketEvents() :
 		m_connected(Event::kUnknown),
+		m_secureConnected(Event::kUnknown),
 		m_connectionFailed(Event::kUnknown) { }
 
 	//! @name accessors
@@ -242,6 +252,14 @@ public:
 	*/
 	Event::Type		connected();
 
+	//! Get secure connected event type
+	/*!
+	Returns the secure socket connected event type.  A secure socket
+	sends this event when the SSL handshake has completed and the
+	socket is ready to carry data.
+	*/
+	Event::Type		secureConnected();
+
 	//! Get connection failed event type
 	/*!
 	Returns the socket connection failed event type.  A socket sends
@@ -254,6 +272,7 @@ public:
 
 private:
 	Event::Type		m_connected;
+	Event::Type		m_secureConnected;
 	Event::Type		m_connectionFailed;
 };
 
@@ -309,6 +328,29 @@ private:
 	Event::Type		m_stopRetry;
 };
 
+class NameResolverEvents : public EventTypes {
+public:
+	NameResolverEvents() :
+		m_resolved(Event::kUnknown) { }
+
+	//! @name accessors
+	//@{
+
+	//! Get resolved event type
+	/*!
+	Returns the name resolved event type.  A NameResolver sends this
+	to the requester when a lookup has finished, whether or not it
+	succeeded.  The data is a pointer to a NameResolver::Result which
+	the handler must delete.
+	*/
+	Event::Type		resolved();
+
+	//@}
+
+private:
+	Event::Type		m_resolved;
+};
+
 class OSXScreenEvents : public EventTypes {
 public:
 	OSXScreenEvents() :
@@ -350,7 +392,8 @@ class ClientProxyEvents : public EventTypes {
 public:
 	ClientProxyEvents() :
 		m_ready(Event::kUnknown),
-		m_disconnected(Event::kUnknown) { }
+		m_disconnected(Event::kUnknown),
+		m_motionQueued(Event::kUnknown) { }
 
 	//! @name accessors
 	//@{
@@ -370,11 +413,20 @@ public:
 	*/
 	Event::Type		disconnected();
 
+	//! Get motion queued event type
+	/*!
+	Returns the motion queued event type.  A proxy that batches mouse
+	motion sends this to itself when it starts a batch, so the batch is
+	sent once the events already in the queue have been handled.
+	*/
+	Event::Type		motionQueued();
+
 	//@}
 
 private:
 	Event::Type		m_ready;
 	Event::Type		m_disconnected;
+	Event::Type		m_motionQueued;
 };
 
 class ClientProxyUnknownEvents : public EventTypes {
@@ -501,7 +553,8 @@ public:
 	ServerAppEvents() :
 		m_reloadConfig(Event::kUnknown),
 		m_forceReconnect(Event::kUnknown),
-		m_resetServer(Event::kUnknown) { }
+		m_resetServer(Event::kUnknown),
+		m_logStats(Event::kUnknown) { }
 		
 	//! @name accessors
 	//@{
@@ -509,6 +562,7 @@ public:
 	Event::Type		reloadConfig();
 	Event::Type		forceReconnect();
 	Event::Type		resetServer();
+	Event::Type		logStats();
 
 	//@}
 		
@@ -516,6 +570,7 @@ private:
 	Event::Type		m_reloadConfig;
 	Event::Type		m_forceReconnect;
 	Event::Type		m_resetServer;
+	Event::Type		m_logStats;
 };
 
 class IKeyStateEvents : public EventTypes {
@@ -672,7 +727,9 @@ public:
 	ClipboardEvents() :
 		m_clipboardGrabbed(Event::kUnknown),
 		m_clipboardChanged(Event::kUnknown),
-		m_clipboardSending(Event::kUnknown) { }
+		m_clipboardSending(Event::kUnknown),
+		m_clipboardFormatsRequested(Event::kUnknown),
+		m_clipboardReceived(Event::kUnknown) { }
 
 	//! @name accessors
 	//@{
@@ -700,12 +757,31 @@ public:
 	*/
 	Event::Type		clipboardSending();
 
+	//! Get clipboard formats requested event type
+	/*!
+	Returns the clipboard formats requested event type.  This is sent
+	when an application asks for clipboard formats that were promised
+	but not yet supplied.  The data is a pointer to a
+	IScreen::ClipboardFormatsInfo.
+	*/
+	Event::Type		clipboardFormatsRequested();
+
+	//! Get clipboard received event type
+	/*!
+	Returns the clipboard received event type.  This is sent by a
+	ProtocolWorker when it has decoded a whole clipboard from its
+	stream.  The data is a pointer to a ProtocolWorker::ClipboardInfo.
+	*/
+	Event::Type		clipboardReceived();
+
 	//@}
 
 private:
 	Event::Type		m_clipboardGrabbed;
 	Event::Type		m_clipboardChanged;
 	Event::Type		m_clipboardSending;
+	Event::Type		m_clipboardFormatsRequested;
+	Event::Type		m_clipboardReceived;
 };
 
 class FileEvents : public EventTypes {
@@ -39,6 +39,7 @@ class IpcServerProxyEvents;
 class IDataSocketEvents;
 class IListenSocketEvents;
 class ISocketEvents;
+class NameResolverEvents;
 class OSXScreenEvents;
 class ClientListenerEvents;
 class ClientProxyEvents;
@@ -237,6 +238,7 @@ public:
 	virtual IDataSocketEvents&			forIDataSocket() = 0;
 	virtual IListenSocketEvents&		forIListenSocket() = 0;
 	virtual ISocketEvents&				forISocket() = 0;
+	virtual NameResolverEvents&			forNameResolver() = 0;
 	virtual OSXScreenEvents&			forOSXScreen() = 0;
 	virtual ClientListenerEvents&		forClientListener() = 0;
 	virtual ClientProxyEvents&			forClientProxy() = 0;
@@ -0,0 +1,130 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "base/LatencyHistogram.h"
+
+#include <cstring>
+
+//
+// LatencyHistogram
+//
+
+LatencyHistogram::LatencyHistogram()
+{
+	reset();
+}
+
+void
+LatencyHistogram::record(UInt32 usec)
+{
+	++m_counts[getBucket(usec)];
+	++m_count;
+	m_sum += usec;
+	if (usec > m_max) {
+		m_max = usec;
+	}
+}
+
+void
+LatencyHistogram::reset()
+{
+	memset(m_counts, 0, sizeof(m_counts));
+	m_count = 0;
+	m_max   = 0;
+	m_sum   = 0.0;
+}
+
+UInt32
+LatencyHistogram::getCount() const
+{
+	return m_count;
+}
+
+UInt32
+LatencyHistogram::getMax() const
+{
+	return m_max;
+}
+
+double
+LatencyHistogram::getMean() const
+{
+	return (m_count == 0) ? 0.0 : m_sum / m_count;
+}
+
+UInt32
+LatencyHistogram::getPercentile(double percent) const
+{
+	if (m_count == 0) {
+		return 0;
+	}
+
+	// find the bucket holding the sample with the wanted rank
+	double rank = 0.01 * percent * m_count;
+	UInt32 seen = 0;
+	for (UInt32 i = 0; i < kBuckets; ++i) {
+		seen += m_counts[i];
+		if (seen != 0 && seen >= rank) {
+			UInt32 end = getBucketEnd(i);
+			return (end < m_max) ? end : m_max;
+		}
+	}
+	return m_max;
+}
+
+String
+LatencyHistogram::getSummary() const
+{
+	return synergy::string::sprintf(
+		"n=%u mean=%.2f p50=%.2f p90=%.2f p99=%.2f p99.9=%.2f max=%.2f ms",
+		m_count, 1.0e-3 * getMean(),
+		1.0e-3 * getPercentile(50.0), 1.0e-3 * getPercentile(90.0),
+		1.0e-3 * getPercentile(99.0), 1.0e-3 * getPercentile(99.9),
+		1.0e-3 * m_max);
+}
+
+UInt32
+LatencyHistogram::getBucket(UInt32 usec)
+{
+	if (usec < kExact) {
+		return usec;
+	}
+
+	// the top bit picks the power of two and the kSubBucketBits below
+	// it pick the bucket within it
+	UInt32 top = 0;
+	for (UInt32 v = usec; v > 1; v >>= 1) {
+		++top;
+	}
+	UInt32 shift = top - kSubBucketBits;
+	return kExact + (shift - 1) * kSubBuckets +
+			((usec >> shift) & (kSubBuckets - 1));
+}
+
+UInt32
+LatencyHistogram::getBucketEnd(UInt32 bucket)
+{
+	if (bucket < kExact) {
+		return bucket;
+	}
+
+	UInt32 shift = (bucket - kExact) / kSubBuckets + 1;
+	UInt32 sub   = (bucket - kExact) % kSubBuckets;
+	UInt32 start = (kSubBuckets + sub) << shift;
+	return start + ((1u << shift) - 1);
+}
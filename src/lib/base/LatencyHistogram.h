@@ -0,0 +1,94 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "base/String.h"
+#include "common/basic_types.h"
+
+//! Latency histogram
+/*!
+Counts latency samples, in microseconds, in log-linear buckets like an
+HDR histogram:  values below 64 are exact and larger values land in one
+of 32 buckets per power of two, so any percentile is within about 3% of
+the true value.  Recording is a few shifts and an increment, and the
+memory used is fixed no matter how many samples are recorded.
+*/
+class LatencyHistogram {
+public:
+	LatencyHistogram();
+
+	//! @name manipulators
+	//@{
+
+	//! Record a sample
+	/*!
+	Counts one sample of \p usec microseconds.
+	*/
+	void				record(UInt32 usec);
+
+	//! Forget all samples
+	void				reset();
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get the number of samples
+	UInt32				getCount() const;
+
+	//! Get the largest sample
+	UInt32				getMax() const;
+
+	//! Get the mean of the samples
+	double				getMean() const;
+
+	//! Get a percentile
+	/*!
+	Returns the sample value below which \p percent percent of the samples
+	fall, rounded up to the end of its bucket.  Returns 0 if there are no
+	samples.
+	*/
+	UInt32				getPercentile(double percent) const;
+
+	//! Get a summary
+	/*!
+	Returns the count, mean, median, 90th, 99th and 99.9th percentiles and
+	maximum on one line, in milliseconds.
+	*/
+	String				getSummary() const;
+
+	//@}
+
+private:
+	static UInt32		getBucket(UInt32 usec);
+	static UInt32		getBucketEnd(UInt32 bucket);
+
+private:
+	enum {
+		kSubBucketBits = 5,
+		kSubBuckets = 1 << kSubBucketBits,
+		kExact = 2 * kSubBuckets,
+		kBuckets = kExact + (32 - kSubBucketBits - 1) * kSubBuckets
+	};
+
+	UInt32				m_counts[kBuckets];
+	UInt32				m_count;
+	UInt32				m_max;
+	double				m_sum;
+};
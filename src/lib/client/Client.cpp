@@ -29,11 +29,13 @@
 #include "synergy/protocol_types.h"
 #include "synergy/XSynergy.h"
 #include "synergy/StreamChunker.h"
+#include "synergy/LatencyStats.h"
 #include "synergy/IPlatformScreen.h"
 #include "mt/Thread.h"
 #include "net/TCPSocket.h"
 #include "net/IDataSocket.h"
 #include "net/ISocketFactory.h"
+#include "net/SocketConnector.h"
 #include "arch/Arch.h"
 #include "base/Log.h"
 #include "base/IEventQueue.h"
@@ -73,13 +75,25 @@ Client::Client(
 	m_sendFileThread(NULL),
 	m_writeToDropDirThread(NULL),
 	m_socket(NULL),
+	m_resolver(NULL),
+	m_resolving(false),
+	m_connector(NULL),
 	m_useSecureNetwork(false),
 	m_args(args),
-	m_sendClipboardThread(NULL)
+	m_sendClipboardThread(NULL),
+	m_latencyStats(NULL)
 {
 	assert(m_socketFactory != NULL);
 	assert(m_screen        != NULL);
 
+	m_latencyStats = new LatencyStats(m_events);
+	m_resolver     = new NameResolver(m_events);
+
+	m_events->adoptHandler(m_events->forNameResolver().resolved(),
+							getEventTarget(),
+							new TMethodEventJob<Client>(this,
+								&Client::handleResolved));
+
 	// register suspend/resume event handlers
 	m_events->adoptHandler(m_events->forIScreen().suspend(),
 							getEventTarget(),
@@ -119,18 +133,22 @@ Client::~Client()
 							  getEventTarget());
 	m_events->removeHandler(m_events->forIScreen().resume(),
 							  getEventTarget());
+	m_events->removeHandler(m_events->forNameResolver().resolved(),
+							  getEventTarget());
 
 	cleanupTimer();
 	cleanupScreen();
 	cleanupConnecting();
 	cleanupConnection();
+	delete m_resolver;
 	delete m_socketFactory;
+	delete m_latencyStats;
 }
 
 void
 Client::connect()
 {
-	if (m_stream != NULL) {
+	if (m_stream != NULL || m_resolving || m_connector != NULL) {
 		return;
 	}
 	if (m_suspended) {
@@ -138,45 +156,22 @@ Client::connect()
 		return;
 	}
 
-	try {
-		// resolve the server hostname.  do this every time we connect
-		// in case we couldn't resolve the address earlier or the address
-		// has changed (which can happen frequently if this is a laptop
-		// being shuttled between various networks).  patch by Brent
-		// Priddy.
-		m_serverAddress.resolve();
-		
-		// m_serverAddress will be null if the hostname address is not reolved
-		if (m_serverAddress.getAddress() != NULL) {
-		  // to help users troubleshoot, show server host name (issue: 60)
-		  LOG((CLOG_NOTE "connecting to '%s': %s:%i", 
-		  m_serverAddress.getHostname().c_str(),
-		  ARCH->addrToString(m_serverAddress.getAddress()).c_str(),
-		  m_serverAddress.getPort()));
-		}
-
-		// create the socket
-		IDataSocket* socket = m_socketFactory->create(m_useSecureNetwork);
-		m_socket = dynamic_cast<TCPSocket*>(socket);
-
-		// filter socket messages, including a packetizing filter
-		m_stream = socket;
-		bool adopt = !m_useSecureNetwork;
-		m_stream = new PacketStreamFilter(m_events, m_stream, adopt);
-
-		// connect
-		LOG((CLOG_DEBUG1 "connecting to server"));
-		setupConnecting();
-		setupTimer();
-		socket->connect(m_serverAddress);
+	// the timeout covers both looking up the server and connecting
+	setupTimer();
+
+	// look up the server hostname every time we connect in case the
+	// address has changed (which can happen frequently if this is a
+	// laptop being shuttled between various networks), unless we
+	// looked it up very recently.  the lookup is done on a thread so
+	// a slow DNS server doesn't stall us.
+	NameResolver::AddressList addresses;
+	if (m_resolver->getCached(m_serverAddress, addresses)) {
+		LOG((CLOG_DEBUG1 "using cached addresses of '%s'", m_serverAddress.getHostname().c_str()));
+		connectTo(addresses);
 	}
-	catch (XBase& e) {
-		cleanupTimer();
-		cleanupConnecting();
-		cleanupStream();
-		LOG((CLOG_DEBUG1 "connection failed"));
-		sendConnectionFailedEvent(e.what());
-		return;
+	else {
+		m_resolving = true;
+		m_resolver->resolve(m_serverAddress, getEventTarget());
 	}
 }
 
@@ -292,6 +287,7 @@ Client::setClipboard(ClipboardID id, const IClipboard* clipboard)
  	m_screen->setClipboard(id, clipboard);
 	m_ownClipboard[id]  = false;
 	m_sentClipboard[id] = false;
+	m_lazyClipboard[id].m_formats = 0;
 }
 
 void
@@ -300,6 +296,97 @@ Client::grabClipboard(ClipboardID id)
 	m_screen->grabClipboard(id);
 	m_ownClipboard[id]  = false;
 	m_sentClipboard[id] = false;
+	m_lazyClipboard[id].m_formats = 0;
+}
+
+void
+Client::offerClipboard(ClipboardID id, UInt32 serial,
+				const std::vector<UInt32>& formats)
+{
+	LazyClipboard& lazy = m_lazyClipboard[id];
+
+	// keep data we already have if its size and hash haven't changed
+	Clipboard data;
+	UInt32 offered = 0;
+	data.open(0);
+	lazy.m_clipboard.open(0);
+	for (size_t i = 0; i + 2 < formats.size(); i += 3) {
+		const UInt32 format = formats[i];
+		if (format >= IClipboard::kNumFormats) {
+			continue;
+		}
+		offered |= (1u << format);
+
+		IClipboard::EFormat eFormat = (IClipboard::EFormat)format;
+		if (formats[i + 1] != 0xffffffffu && lazy.m_clipboard.has(eFormat)) {
+			const String old = lazy.m_clipboard.get(eFormat);
+			if (old.size() == formats[i + 1] &&
+				Clipboard::getDataHash(old) == formats[i + 2]) {
+				LOG((CLOG_DEBUG1 "reusing clipboard %d format %d", id, format));
+				data.add(eFormat, old);
+			}
+		}
+	}
+	lazy.m_clipboard.close();
+	data.close();
+	Clipboard::copy(&lazy.m_clipboard, &data);
+
+	lazy.m_serial    = serial;
+	lazy.m_formats   = offered;
+	lazy.m_requested = 0;
+
+	// the server owns the clipboard now
+	m_ownClipboard[id]  = false;
+	m_sentClipboard[id] = false;
+
+	// promise the formats we don't have.  if the screen can't do that
+	// then it gets the clipboard once all the data is here.
+	UInt32 missing = 0;
+	lazy.m_clipboard.open(0);
+	for (SInt32 format = 0; format != IClipboard::kNumFormats; ++format) {
+		if ((offered & (1u << format)) != 0 &&
+			!lazy.m_clipboard.has((IClipboard::EFormat)format)) {
+			missing |= (1u << format);
+		}
+	}
+	lazy.m_clipboard.close();
+	LOG((CLOG_DEBUG "offered clipboard %d serial=%d formats=0x%x missing=0x%x", id, serial, offered, missing));
+
+	lazy.m_offered = m_screen->offerClipboard(id, &lazy.m_clipboard, missing);
+	if (!lazy.m_offered) {
+		if (missing == 0) {
+			m_screen->setClipboard(id, &lazy.m_clipboard);
+		}
+		else {
+			requestClipboardFormats(id, missing);
+		}
+	}
+}
+
+void
+Client::setClipboardFormat(ClipboardID id, UInt32 serial,
+				IClipboard::EFormat format, const String& data)
+{
+	// ignore data for an old offer
+	LazyClipboard& lazy = m_lazyClipboard[id];
+	if (serial != lazy.m_serial || (lazy.m_formats & (1u << format)) == 0) {
+		LOG((CLOG_DEBUG "ignored clipboard %d format %d (stale)", id, format));
+		return;
+	}
+
+	lazy.m_requested &= ~(1u << format);
+	lazy.m_clipboard.open(0);
+	lazy.m_clipboard.add(format, data);
+	lazy.m_clipboard.close();
+
+	// pass the data on if the screen is waiting for it, otherwise set
+	// the clipboard when all the data is here.
+	if (lazy.m_offered) {
+		m_screen->setClipboardFormat(id, format, data);
+	}
+	else if (lazy.m_requested == 0) {
+		m_screen->setClipboard(id, &lazy.m_clipboard);
+	}
 }
 
 void
@@ -396,7 +483,11 @@ Client::sendClipboard(ClipboardID id)
 	if (clipboard.open(m_timeClipboard[id])) {
 		clipboard.close();
 	}
-	m_screen->getClipboard(id, &clipboard);
+	if (!m_screen->getClipboard(id, &clipboard)) {
+		// nothing to send yet.  the screen sends clipboardChanged
+		// when it has the data.
+		return;
+	}
 
 	// check time
 	if (m_timeClipboard[id] == 0 ||
@@ -445,14 +536,14 @@ Client::sendFileChunk(const void* data)
 void
 Client::setupConnecting()
 {
-	assert(m_stream != NULL);
+	assert(m_connector != NULL);
 
 	m_events->adoptHandler(m_events->forIDataSocket().connected(),
-							m_stream->getEventTarget(),
+							m_connector->getEventTarget(),
 							new TMethodEventJob<Client>(this,
 								&Client::handleConnected));
 	m_events->adoptHandler(m_events->forIDataSocket().connectionFailed(),
-							m_stream->getEventTarget(),
+							m_connector->getEventTarget(),
 							new TMethodEventJob<Client>(this,
 								&Client::handleConnectionFailed));
 }
@@ -503,6 +594,14 @@ Client::setupScreen()
 							getEventTarget(),
 							new TMethodEventJob<Client>(this,
 								&Client::handleClipboardGrabbed));
+	m_events->adoptHandler(m_events->forClipboard().clipboardChanged(),
+							getEventTarget(),
+							new TMethodEventJob<Client>(this,
+								&Client::handleClipboardChanged));
+	m_events->adoptHandler(m_events->forClipboard().clipboardFormatsRequested(),
+							getEventTarget(),
+							new TMethodEventJob<Client>(this,
+								&Client::handleClipboardFormatsRequested));
 }
 
 void
@@ -519,11 +618,17 @@ Client::setupTimer()
 void
 Client::cleanupConnecting()
 {
-	if (m_stream != NULL) {
+	if (m_resolving) {
+		m_resolver->cancel(getEventTarget());
+		m_resolving = false;
+	}
+	if (m_connector != NULL) {
 		m_events->removeHandler(m_events->forIDataSocket().connected(),
-							m_stream->getEventTarget());
+							m_connector->getEventTarget());
 		m_events->removeHandler(m_events->forIDataSocket().connectionFailed(),
-							m_stream->getEventTarget());
+							m_connector->getEventTarget());
+		delete m_connector;
+		m_connector = NULL;
 	}
 }
 
@@ -559,6 +664,10 @@ Client::cleanupScreen()
 							getEventTarget());
 		m_events->removeHandler(m_events->forClipboard().clipboardGrabbed(),
 							getEventTarget());
+		m_events->removeHandler(m_events->forClipboard().clipboardChanged(),
+							getEventTarget());
+		m_events->removeHandler(m_events->forClipboard().clipboardFormatsRequested(),
+							getEventTarget());
 		delete m_server;
 		m_server = NULL;
 	}
@@ -577,6 +686,10 @@ Client::cleanupTimer()
 void
 Client::cleanupStream()
 {
+	if (m_stream == NULL) {
+		return;
+	}
+
 	delete m_stream;
 	m_stream = NULL;
 
@@ -588,18 +701,64 @@ Client::cleanupStream()
 	}
 }
 
+void
+Client::connectTo(const NameResolver::AddressList& addresses)
+{
+	// to help users troubleshoot, show server host name (issue: 60)
+	LOG((CLOG_NOTE "connecting to '%s': %s:%i",
+		m_serverAddress.getHostname().c_str(),
+		ARCH->addrToString(addresses[0].getAddress()).c_str(),
+		m_serverAddress.getPort()));
+
+	// race the addresses
+	m_connector = new SocketConnector(m_events,
+							m_socketFactory, m_useSecureNetwork);
+	setupConnecting();
+	m_connector->connect(addresses);
+}
+
+void
+Client::handleResolved(const Event& event, void*)
+{
+	NameResolver::Result* result =
+		reinterpret_cast<NameResolver::Result*>(event.getData());
+	m_resolving = false;
+
+	if (result->m_addresses.empty()) {
+		cleanupTimer();
+		LOG((CLOG_DEBUG1 "connection failed"));
+		sendConnectionFailedEvent(result->m_error.c_str());
+	}
+	else {
+		connectTo(result->m_addresses);
+	}
+	delete result;
+}
+
 void
 Client::handleConnected(const Event&, void*)
 {
 	LOG((CLOG_DEBUG1 "connected;  wait for hello"));
+
+	// take the winning socket and filter socket messages, including
+	// a packetizing filter
+	IDataSocket* socket = m_connector->orphanSocket();
+	m_serverAddress     = m_connector->getAddress();
 	cleanupConnecting();
+	m_socket = dynamic_cast<TCPSocket*>(socket);
+	m_stream = new PacketStreamFilter(m_events, socket, !m_useSecureNetwork);
 	setupConnection();
 
+	// the server may have sent its hello before the filter existed
+	m_events->addEvent(Event(m_events->forIStream().inputReady(),
+							socket->getEventTarget()));
+
 	// reset clipboard state
 	for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
 		m_ownClipboard[id]  = false;
 		m_sentClipboard[id] = false;
 		m_timeClipboard[id] = 0;
+		m_lazyClipboard[id].m_formats = 0;
 	}
 
 	m_socket->secureConnect();
@@ -611,9 +770,11 @@ Client::handleConnectionFailed(const Event& event, void*)
 	IDataSocket::ConnectionFailedInfo* info =
 		reinterpret_cast<IDataSocket::ConnectionFailedInfo*>(event.getData());
 
+	// the server may have moved so look it up again next time
+	m_resolver->forget(m_serverAddress);
+
 	cleanupTimer();
 	cleanupConnecting();
-	cleanupStream();
 	LOG((CLOG_DEBUG1 "connection failed"));
 	sendConnectionFailedEvent(info->m_what.c_str());
 	delete info;
@@ -670,6 +831,7 @@ Client::handleClipboardGrabbed(const Event& event, void*)
 	m_ownClipboard[info->m_id]  = true;
 	m_sentClipboard[info->m_id] = false;
 	m_timeClipboard[info->m_id] = 0;
+	m_lazyClipboard[info->m_id].m_formats = 0;
 
 	// if we're not the active screen then send the clipboard now,
 	// otherwise we'll wait until we leave.
@@ -678,6 +840,40 @@ Client::handleClipboardGrabbed(const Event& event, void*)
 	}
 }
 
+void
+Client::handleClipboardChanged(const Event& event, void*)
+{
+	const IScreen::ClipboardInfo* info =
+		reinterpret_cast<const IScreen::ClipboardInfo*>(event.getData());
+
+	// the screen has new data for a clipboard we own.  send it if
+	// we're not the active screen, otherwise we'll send it when we
+	// leave.
+	if (m_ownClipboard[info->m_id] && !m_active) {
+		sendClipboard(info->m_id);
+	}
+}
+
+void
+Client::handleClipboardFormatsRequested(const Event& event, void*)
+{
+	const IScreen::ClipboardFormatsInfo* info =
+		reinterpret_cast<const IScreen::ClipboardFormatsInfo*>(event.getData());
+	requestClipboardFormats(info->m_id, info->m_formats);
+}
+
+void
+Client::requestClipboardFormats(ClipboardID id, UInt32 formats)
+{
+	// only ask for offered formats once
+	LazyClipboard& lazy = m_lazyClipboard[id];
+	formats &= lazy.m_formats & ~lazy.m_requested;
+	if (formats != 0 && m_server != NULL) {
+		lazy.m_requested |= formats;
+		m_server->requestClipboardFormats(id, lazy.m_serial, formats);
+	}
+}
+
 void
 Client::handleHello(const Event&, void*)
 {
@@ -692,18 +888,23 @@ Client::handleHello(const Event&, void*)
 	// check versions
 	LOG((CLOG_DEBUG1 "got hello version %d.%d", major, minor));
 	if (major < kProtocolMajorVersion ||
-		(major == kProtocolMajorVersion && minor < kProtocolMinorVersion)) {
+		(major == kProtocolMajorVersion && minor < kProtocolMinorVersionMin)) {
 		sendConnectionFailedEvent(XIncompatibleClient(major, minor).what());
 		cleanupTimer();
 		cleanupConnection();
 		return;
 	}
 
-	// say hello back
-	LOG((CLOG_DEBUG1 "say hello version %d.%d", kProtocolMajorVersion, kProtocolMinorVersion));
+	// say hello back with the newest version we both speak.  servers
+	// reject minor versions they don't know.
+	SInt16 helloMinor = kProtocolMinorVersion;
+	if (major == kProtocolMajorVersion && minor < helloMinor) {
+		helloMinor = minor;
+	}
+	LOG((CLOG_DEBUG1 "say hello version %d.%d", kProtocolMajorVersion, helloMinor));
 	ProtocolUtil::writef(m_stream, kMsgHelloBack,
 							kProtocolMajorVersion,
-							kProtocolMinorVersion, &m_name);
+							helloMinor, &m_name);
 
 	// now connected but waiting to complete handshake
 	setupScreen();
@@ -845,3 +1046,18 @@ Client::sendDragInfo(UInt32 fileCount, String& info, size_t size)
 {
 	m_server->sendDragInfo(fileCount, info.c_str(), size);
 }
+
+
+//
+// Client::LazyClipboard
+//
+
+Client::LazyClipboard::LazyClipboard() :
+	m_serial(0),
+	m_formats(0),
+	m_requested(0),
+	m_offered(false),
+	m_clipboard()
+{
+	// do nothing
+}
@@ -20,12 +20,14 @@
 
 #include "synergy/IClient.h"
 
-#include "synergy/IClipboard.h"
+#include "synergy/Clipboard.h"
 #include "synergy/DragInformation.h"
 #include "synergy/INode.h"
 #include "synergy/ClientArgs.h"
 #include "net/NetworkAddress.h"
+#include "net/NameResolver.h"
 #include "base/EventTypes.h"
+#include "common/stdvector.h"
 
 class EventQueueTimer;
 namespace synergy { class Screen; }
@@ -34,8 +36,10 @@ class IDataSocket;
 class ISocketFactory;
 namespace synergy { class IStream; }
 class IEventQueue;
+class LatencyStats;
 class Thread;
 class TCPSocket;
+class SocketConnector;
 
 //! Synergy client
 /*!
@@ -93,6 +97,24 @@ public:
 	
 	//! Send dragging file information back to server
 	void				sendDragInfo(UInt32 fileCount, String& info, size_t size);
+
+	//! Offer clipboard formats
+	/*!
+	Takes ownership of the clipboard \c id for the formats offered by
+	the server.  \c formats holds (format, size, hash) triples as sent
+	in kMsgDClipboardFormats.  The data is requested from the server
+	when an application asks for it or, if the screen can't promise
+	data, right away.
+	*/
+	void				offerClipboard(ClipboardID id, UInt32 serial,
+							const std::vector<UInt32>& formats);
+
+	//! Received clipboard format
+	/*!
+	Handles the data of a format requested after offerClipboard().
+	*/
+	void				setClipboardFormat(ClipboardID id, UInt32 serial,
+							IClipboard::EFormat format, const String& data);
 	
 	//@}
 	//! @name accessors
@@ -130,6 +152,9 @@ public:
 	//! Return drag file list
 	DragFileList		getDragFileList() { return m_dragFileList; }
 
+	//! Get the input latency statistics
+	LatencyStats&		getLatencyStats() { return *m_latencyStats; }
+
 	//@}
 
 	// IScreen overrides
@@ -177,6 +202,8 @@ private:
 	void				cleanupScreen();
 	void				cleanupTimer();
 	void				cleanupStream();
+	void				connectTo(const NameResolver::AddressList&);
+	void				handleResolved(const Event&, void*);
 	void				handleConnected(const Event&, void*);
 	void				handleConnectionFailed(const Event&, void*);
 	void				handleConnectTimeout(const Event&, void*);
@@ -184,6 +211,9 @@ private:
 	void				handleDisconnected(const Event&, void*);
 	void				handleShapeChanged(const Event&, void*);
 	void				handleClipboardGrabbed(const Event&, void*);
+	void				handleClipboardChanged(const Event&, void*);
+	void				handleClipboardFormatsRequested(const Event&, void*);
+	void				requestClipboardFormats(ClipboardID, UInt32 formats);
 	void				handleHello(const Event&, void*);
 	void				handleSuspend(const Event& event, void*);
 	void				handleResume(const Event& event, void*);
@@ -212,6 +242,24 @@ private:
 	bool				m_sentClipboard[kClipboardEnd];
 	IClipboard::Time	m_timeClipboard[kClipboardEnd];
 	String				m_dataClipboard[kClipboardEnd];
+
+	// clipboards offered by the server with kMsgDClipboardFormats
+	class LazyClipboard {
+	public:
+		LazyClipboard();
+
+	public:
+		// the offer, formats asked for but not received yet and
+		// whether the screen took the offer
+		UInt32			m_serial;
+		UInt32			m_formats;
+		UInt32			m_requested;
+		bool			m_offered;
+
+		// the data received so far
+		Clipboard		m_clipboard;
+	};
+	LazyClipboard		m_lazyClipboard[kClipboardEnd];
 	IEventQueue*		m_events;
 	std::size_t			m_expectedFileSize;
 	String				m_receivedFileData;
@@ -220,7 +268,11 @@ private:
 	Thread*				m_sendFileThread;
 	Thread*				m_writeToDropDirThread;
 	TCPSocket*			m_socket;
+	NameResolver*		m_resolver;
+	bool				m_resolving;
+	SocketConnector*	m_connector;
 	bool				m_useSecureNetwork;
 	ClientArgs&			m_args;
 	Thread*				m_sendClipboardThread;
+	LatencyStats*		m_latencyStats;
 };
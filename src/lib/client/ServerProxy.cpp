@@ -24,9 +24,11 @@
 #include "synergy/StreamChunker.h"
 #include "synergy/Clipboard.h"
 #include "synergy/ProtocolUtil.h"
+#include "synergy/LatencyStats.h"
 #include "synergy/option_types.h"
 #include "synergy/protocol_types.h"
 #include "io/IStream.h"
+#include "arch/Arch.h"
 #include "base/Log.h"
 #include "base/IEventQueue.h"
 #include "base/TMethodEventJob.h"
@@ -49,6 +51,10 @@ ServerProxy::ServerProxy(Client* client, synergy::IStream* stream, IEventQueue*
 	m_dxMouse(0),
 	m_dyMouse(0),
 	m_ignoreMouse(false),
+	m_motionPending(false),
+	m_motionTime(0),
+	m_motionReadTime(0.0),
+	m_latencyEcho(false),
 	m_keepAliveAlarm(0.0),
 	m_keepAliveAlarmTimer(NULL),
 	m_parser(&ServerProxy::parseHandshakeMessage),
@@ -227,6 +233,12 @@ ServerProxy::parseMessage(const UInt8* code)
 		mouseRelativeMove();
 	}
 
+	else if (memcmp(code, kMsgDMouseMoveBatch, 4) == 0) {
+		if (!mouseMoveBatch()) {
+			return kUnknown;
+		}
+	}
+
 	else if (memcmp(code, kMsgDMouseWheel, 4) == 0) {
 		mouseWheel();
 	}
@@ -289,6 +301,14 @@ ServerProxy::parseMessage(const UInt8* code)
 		setClipboard();
 	}
 
+	else if (memcmp(code, kMsgDClipboardFormats, 4) == 0) {
+		clipboardFormats();
+	}
+
+	else if (memcmp(code, kMsgDClipboardFormat, 4) == 0) {
+		clipboardFormat();
+	}
+
 	else if (memcmp(code, kMsgCResetOptions, 4) == 0) {
 		resetOptions();
 	}
@@ -368,18 +388,46 @@ ServerProxy::onClipboardChanged(ClipboardID id, const IClipboard* clipboard)
 	LOG((CLOG_DEBUG "sent clipboard size=%d", data.size()));
 }
 
+void
+ServerProxy::requestClipboardFormats(ClipboardID id,
+				UInt32 serial, UInt32 formats)
+{
+	LOG((CLOG_DEBUG "query clipboard %d formats 0x%x serial=%d", id, formats, serial));
+	ProtocolUtil::writef(m_stream, kMsgQClipboardFormats, id, serial, formats);
+}
+
 void
 ServerProxy::flushCompressedMouse()
 {
 	if (m_compressMouse) {
 		m_compressMouse = false;
 		m_client->mouseMove(m_xMouse, m_yMouse);
+		motionInjected();
 	}
 	if (m_compressMouseRelative) {
 		m_compressMouseRelative = false;
 		m_client->mouseRelativeMove(m_dxMouse, m_dyMouse);
 		m_dxMouse = 0;
 		m_dyMouse = 0;
+		motionInjected();
+	}
+}
+
+void
+ServerProxy::motionInjected()
+{
+	if (!m_motionPending) {
+		return;
+	}
+	m_motionPending = false;
+
+	double hold = ARCH->monotonicTime() - m_motionReadTime;
+	m_client->getLatencyStats().recordInterval(LatencyStats::kClientInject, hold);
+
+	// let the server time the whole trip
+	if (m_latencyEcho) {
+		ProtocolUtil::writef(m_stream, kMsgDLatencyEcho,
+							m_motionTime, static_cast<UInt32>(hold * 1.0e6));
 	}
 }
 
@@ -530,6 +578,9 @@ ServerProxy::enter()
 	m_dyMouse               = 0;
 	m_seqNum                = seqNum;
 
+	// batched absolute motion continues from here
+	m_motionBatch.setPosition(x, y);
+
 	// forward
 	m_client->enter(x, y, seqNum, static_cast<KeyModifierMask>(mask), false);
 }
@@ -591,6 +642,48 @@ ServerProxy::grabClipboard()
 	m_client->grabClipboard(id);
 }
 
+void
+ServerProxy::clipboardFormats()
+{
+	// parse
+	ClipboardID id;
+	UInt32 serial;
+	std::vector<UInt32> formats;
+	ProtocolUtil::readf(m_stream, kMsgDClipboardFormats + 4,
+							&id, &serial, &formats);
+	LOG((CLOG_DEBUG "recv clipboard %d formats serial=%d", id, serial));
+
+	// validate
+	if (id >= kClipboardEnd) {
+		return;
+	}
+
+	// forward
+	m_client->offerClipboard(id, serial, formats);
+}
+
+void
+ServerProxy::clipboardFormat()
+{
+	// parse
+	ClipboardID id;
+	UInt32 serial;
+	UInt8 format;
+	String data;
+	ProtocolUtil::readf(m_stream, kMsgDClipboardFormat + 4,
+							&id, &serial, &format, &data);
+	LOG((CLOG_DEBUG "recv clipboard %d format %d size=%d", id, format, data.size()));
+
+	// validate
+	if (id >= kClipboardEnd || format >= IClipboard::kNumFormats) {
+		return;
+	}
+
+	// forward
+	m_client->setClipboardFormat(id, serial,
+							(IClipboard::EFormat)format, data);
+}
+
 void
 ServerProxy::keyDown()
 {
@@ -695,15 +788,76 @@ void
 ServerProxy::mouseMove()
 {
 	// parse
-	bool ignore;
 	SInt16 x, y;
 	ProtocolUtil::readf(m_stream, kMsgDMouseMove + 4, &x, &y);
+	LOG((CLOG_DEBUG2 "recv mouse move %d,%d", x, y));
+
+	moveMouse(x, y, m_stream->isReady());
+}
+
+void
+ServerProxy::mouseRelativeMove()
+{
+	// parse
+	SInt16 dx, dy;
+	ProtocolUtil::readf(m_stream, kMsgDMouseRelMove + 4, &dx, &dy);
+	LOG((CLOG_DEBUG2 "recv mouse relative move %d,%d", dx, dy));
+
+	moveMouseRelative(dx, dy, m_stream->isReady());
+}
+
+bool
+ServerProxy::mouseMoveBatch()
+{
+	double readTime = ARCH->monotonicTime();
+
+	// parse.  the samples run to the end of the packet.
+	UInt8 header;
+	ProtocolUtil::readf(m_stream, kMsgDMouseMoveBatch + 4, &header);
+	String data(m_stream->getSize(), '\0');
+	if (!data.empty()) {
+		m_stream->read(&data[0], static_cast<UInt32>(data.size()));
+	}
+
+	bool relative;
+	if (!m_motionBatch.decode(header, data, relative, m_motionSamples)) {
+		LOG((CLOG_ERR "bad mouse move batch from server"));
+		return false;
+	}
+
+	size_t n = m_motionSamples.size();
+	if (n != 0) {
+		LOG((CLOG_DEBUG2 "recv mouse move batch, %d samples over %dms", n,
+			m_motionSamples[n - 1].m_time - m_motionSamples[0].m_time));
+
+		// time the batch until its last sample is injected
+		m_motionPending  = true;
+		m_motionTime     = m_motionSamples[n - 1].m_time;
+		m_motionReadTime = readTime;
+	}
 
+	// every sample but the last is followed by more input
+	for (size_t i = 0; i < n; ++i) {
+		const MotionBatch::Sample& sample = m_motionSamples[i];
+		bool moreInput = (i + 1 < n || m_stream->isReady());
+		if (relative) {
+			moveMouseRelative(sample.m_x, sample.m_y, moreInput);
+		}
+		else {
+			moveMouse(sample.m_x, sample.m_y, moreInput);
+		}
+	}
+	return true;
+}
+
+void
+ServerProxy::moveMouse(SInt32 x, SInt32 y, bool moreInput)
+{
 	// note if we should ignore the move
-	ignore = m_ignoreMouse;
+	bool ignore = m_ignoreMouse;
 
 	// compress mouse motion events if more input follows
-	if (!ignore && !m_compressMouse && m_stream->isReady()) {
+	if (!ignore && !m_compressMouse && moreInput) {
 		m_compressMouse = true;
 	}
 
@@ -716,27 +870,22 @@ ServerProxy::mouseMove()
 		m_dxMouse = 0;
 		m_dyMouse = 0;
 	}
-	LOG((CLOG_DEBUG2 "recv mouse move %d,%d", x, y));
 
 	// forward
 	if (!ignore) {
 		m_client->mouseMove(x, y);
+		motionInjected();
 	}
 }
 
 void
-ServerProxy::mouseRelativeMove()
+ServerProxy::moveMouseRelative(SInt32 dx, SInt32 dy, bool moreInput)
 {
-	// parse
-	bool ignore;
-	SInt16 dx, dy;
-	ProtocolUtil::readf(m_stream, kMsgDMouseRelMove + 4, &dx, &dy);
-
 	// note if we should ignore the move
-	ignore = m_ignoreMouse;
+	bool ignore = m_ignoreMouse;
 
 	// compress mouse motion events if more input follows
-	if (!ignore && !m_compressMouseRelative && m_stream->isReady()) {
+	if (!ignore && !m_compressMouseRelative && moreInput) {
 		m_compressMouseRelative = true;
 	}
 
@@ -746,11 +895,11 @@ ServerProxy::mouseRelativeMove()
 		m_dxMouse += dx;
 		m_dyMouse += dy;
 	}
-	LOG((CLOG_DEBUG2 "recv mouse relative move %d,%d", dx, dy));
 
 	// forward
 	if (!ignore) {
 		m_client->mouseRelativeMove(dx, dy);
+		motionInjected();
 	}
 }
 
@@ -793,6 +942,9 @@ ServerProxy::resetOptions()
 	// reset keep alive
 	setKeepAliveRate(kKeepAliveRate);
 
+	// stop echoing motion times
+	m_latencyEcho = false;
+
 	// reset modifier translation table
 	for (KeyModifierID id = 0; id < kKeyModifierIDLast; ++id) {
 		m_modifierTranslationTable[id] = id;
@@ -835,6 +987,9 @@ ServerProxy::setOptions()
 			// update keep alive
 			setKeepAliveRate(1.0e-3 * static_cast<double>(options[i + 1]));
 		}
+		else if (options[i] == kOptionLatencyEcho) {
+			m_latencyEcho = (options[i + 1] != 0);
+		}
 		if (id != kKeyModifierIDNull) {
 			m_modifierTranslationTable[id] =
 				static_cast<KeyModifierID>(options[i + 1]);
@@ -20,6 +20,7 @@
 
 #include "synergy/clipboard_types.h"
 #include "synergy/key_types.h"
+#include "synergy/MotionBatch.h"
 #include "base/Event.h"
 #include "base/Stopwatch.h"
 #include "base/String.h"
@@ -52,6 +53,15 @@ public:
 	bool				onGrabClipboard(ClipboardID);
 	void				onClipboardChanged(ClipboardID, const IClipboard*);
 
+	//! Ask for clipboard formats
+	/*!
+	Asks the server for the data of \c formats (a mask of
+	\c 1 << IClipboard::EFormat) of the clipboard it offered with
+	\c serial.
+	*/
+	void				requestClipboardFormats(ClipboardID,
+							UInt32 serial, UInt32 formats);
+
 	//@}
 
 	// sending file chunk to server
@@ -73,6 +83,9 @@ private:
 	// if compressing mouse motion then send the last motion now
 	void				flushCompressedMouse();
 
+	// note that motion was injected, for the latency statistics
+	void				motionInjected();
+
 	void				sendInfo(const ClientInfo&);
 
 	void				resetKeepAliveAlarm();
@@ -91,6 +104,8 @@ private:
 	void				leave();
 	void				setClipboard();
 	void				grabClipboard();
+	void				clipboardFormats();
+	void				clipboardFormat();
 	void				keyDown();
 	void				keyRepeat();
 	void				keyUp();
@@ -98,6 +113,9 @@ private:
 	void				mouseUp();
 	void				mouseMove();
 	void				mouseRelativeMove();
+	bool				mouseMoveBatch();
+	void				moveMouse(SInt32 x, SInt32 y, bool moreInput);
+	void				moveMouseRelative(SInt32 dx, SInt32 dy, bool moreInput);
 	void				mouseWheel();
 	void				screensaver();
 	void				resetOptions();
@@ -123,6 +141,16 @@ private:
 
 	bool				m_ignoreMouse;
 
+	MotionBatch			m_motionBatch;
+	MotionBatch::Samples
+						m_motionSamples;
+
+	// the last batch read, until its motion is injected
+	bool				m_motionPending;
+	UInt32				m_motionTime;
+	double				m_motionReadTime;
+	bool				m_latencyEcho;
+
 	KeyModifierID		m_modifierTranslationTable[kKeyModifierIDLast];
 
 	double				m_keepAliveAlarm;
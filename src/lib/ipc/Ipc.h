@@ -21,6 +21,10 @@
 #define IPC_HOST "127.0.0.1"
 #define IPC_PORT 24801
 
+// unix domain socket used between the daemon and synergys/c; the gui
+// still connects over tcp.
+#define IPC_SOCKET_PATH "/tmp/.synergy-ipc"
+
 enum EIpcMessage {
 	kIpcHello,
 	kIpcLogLine,
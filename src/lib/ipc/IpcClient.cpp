@@ -27,8 +27,13 @@
 //
 
 IpcClient::IpcClient(IEventQueue* events, SocketMultiplexer* socketMultiplexer) :
+#if SYSAPI_UNIX
+	m_serverAddress(NetworkAddress::local(IPC_SOCKET_PATH)),
+	m_socket(events, socketMultiplexer, IArchNetwork::kUNIX),
+#else
 	m_serverAddress(NetworkAddress(IPC_HOST, IPC_PORT)),
 	m_socket(events, socketMultiplexer),
+#endif
 	m_server(nullptr),
 	m_events(events)
 {
@@ -44,6 +49,15 @@ IpcClient::IpcClient(IEventQueue* events, SocketMultiplexer* socketMultiplexer,
 	init();
 }
 
+IpcClient::IpcClient(IEventQueue* events, SocketMultiplexer* socketMultiplexer, const String& path) :
+	m_serverAddress(NetworkAddress::local(path)),
+	m_socket(events, socketMultiplexer, IArchNetwork::kUNIX),
+	m_server(nullptr),
+	m_events(events)
+{
+	init();
+}
+
 void
 IpcClient::init()
 {
@@ -35,12 +35,15 @@ class IpcClient {
 public:
 	IpcClient(IEventQueue* events, SocketMultiplexer* socketMultiplexer);
 	IpcClient(IEventQueue* events, SocketMultiplexer* socketMultiplexer, int port);
+
+	//! Connect to the unix domain socket at \c path instead of TCP.
+	IpcClient(IEventQueue* events, SocketMultiplexer* socketMultiplexer, const String& path);
 	virtual ~IpcClient();
 
 	//! @name manipulators
 	//@{
 
-	//! Connects to the IPC server at localhost.
+	//! Connects to the IPC server at localhost (or the local socket on unix).
 	void				connect();
 	
 	//! Disconnects from the IPC server.
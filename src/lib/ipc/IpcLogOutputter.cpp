@@ -203,7 +203,7 @@ IpcLogOutputter::sendBuffer()
 
 	IpcLogLineMessage message(getChunk(kMaxSendLines));
 	m_sending = true;
-	m_ipcServer.send(message, kIpcClientGui);
+	m_ipcServer.send(message, m_clientType);
 	m_sending = false;
 }
 
@@ -22,12 +22,18 @@
 #include "ipc/IpcClientProxy.h"
 #include "ipc/IpcMessage.h"
 #include "net/IDataSocket.h"
+#include "net/TCPSocket.h"
 #include "io/IStream.h"
 #include "base/IEventQueue.h"
 #include "base/TMethodEventJob.h"
 #include "base/Event.h"
 #include "base/Log.h"
 
+#if SYSAPI_UNIX
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
 //
 // IpcServer
 //
@@ -37,7 +43,12 @@ IpcServer::IpcServer(IEventQueue* events, SocketMultiplexer* socketMultiplexer)
 	m_events(events),
 	m_socketMultiplexer(socketMultiplexer),
 	m_socket(nullptr),
-	m_address(NetworkAddress(IPC_HOST, IPC_PORT))
+	m_address(NetworkAddress(IPC_HOST, IPC_PORT)),
+	m_localSocket(nullptr),
+#if SYSAPI_UNIX
+	m_localAddress(NetworkAddress::local(IPC_SOCKET_PATH)),
+#endif
+	m_localListening(false)
 {
 	init();
 }
@@ -46,7 +57,22 @@ IpcServer::IpcServer(IEventQueue* events, SocketMultiplexer* socketMultiplexer,
 	m_mock(false),
 	m_events(events),
 	m_socketMultiplexer(socketMultiplexer),
-	m_address(NetworkAddress(IPC_HOST, port))
+	m_socket(nullptr),
+	m_address(NetworkAddress(IPC_HOST, port)),
+	m_localSocket(nullptr),
+	m_localListening(false)
+{
+	init();
+}
+
+IpcServer::IpcServer(IEventQueue* events, SocketMultiplexer* socketMultiplexer, const String& path) :
+	m_mock(false),
+	m_events(events),
+	m_socketMultiplexer(socketMultiplexer),
+	m_socket(nullptr),
+	m_localSocket(nullptr),
+	m_localAddress(NetworkAddress::local(path)),
+	m_localListening(false)
 {
 	init();
 }
@@ -54,15 +80,28 @@ IpcServer::IpcServer(IEventQueue* events, SocketMultiplexer* socketMultiplexer,
 void
 IpcServer::init()
 {
-	m_socket = new TCPListenSocket(m_events, m_socketMultiplexer);
-
 	m_clientsMutex = ARCH->newMutex();
-	m_address.resolve();
 
-	m_events->adoptHandler(
-		m_events->forIListenSocket().connecting(), m_socket,
-		new TMethodEventJob<IpcServer>(
-		this, &IpcServer::handleClientConnecting));
+	// the invalid address has no port, so there's no tcp socket.
+	if (m_address.getPort() != 0) {
+		m_socket = new TCPListenSocket(m_events, m_socketMultiplexer);
+		m_address.resolve();
+
+		m_events->adoptHandler(
+			m_events->forIListenSocket().connecting(), m_socket,
+			new TMethodEventJob<IpcServer>(
+			this, &IpcServer::handleClientConnecting));
+	}
+
+	if (m_localAddress.isValid()) {
+		m_localSocket = new TCPListenSocket(
+			m_events, m_socketMultiplexer, IArchNetwork::kUNIX);
+
+		m_events->adoptHandler(
+			m_events->forIListenSocket().connecting(), m_localSocket,
+			new TMethodEventJob<IpcServer>(
+			this, &IpcServer::handleClientConnecting));
+	}
 }
 
 IpcServer::~IpcServer()
@@ -72,9 +111,21 @@ IpcServer::~IpcServer()
 	}
 
 	if (m_socket != nullptr) {
+		m_events->removeHandler(m_events->forIListenSocket().connecting(), m_socket);
 		delete m_socket;
 	}
 
+	if (m_localSocket != nullptr) {
+		m_events->removeHandler(m_events->forIListenSocket().connecting(), m_localSocket);
+		delete m_localSocket;
+	}
+
+#if SYSAPI_UNIX
+	if (m_localListening) {
+		unlink(m_localAddress.getHostname().c_str());
+	}
+#endif
+
 	ARCH->lockMutex(m_clientsMutex);
 	ClientList::iterator it;
 	for (it = m_clients.begin(); it != m_clients.end(); it++) {
@@ -83,24 +134,46 @@ IpcServer::~IpcServer()
 	m_clients.empty();
 	ARCH->unlockMutex(m_clientsMutex);
 	ARCH->closeMutex(m_clientsMutex);
-	
-	m_events->removeHandler(m_events->forIListenSocket().connecting(), m_socket);
 }
 
 void
 IpcServer::listen()
 {
-	m_socket->bind(m_address);
+	if (m_socket != nullptr) {
+		m_socket->bind(m_address);
+	}
+
+	if (m_localSocket != nullptr) {
+#if SYSAPI_UNIX
+		// a socket file left behind by a crashed daemon would stop the
+		// bind, and nothing can be listening on it if the tcp bind
+		// above succeeded.
+		String path = m_localAddress.getHostname();
+		unlink(path.c_str());
+		m_localSocket->bind(m_localAddress);
+		m_localListening = true;
+		chmod(path.c_str(), S_IRUSR | S_IWUSR);
+#else
+		m_localSocket->bind(m_localAddress);
+		m_localListening = true;
+#endif
+	}
 }
 
 void
-IpcServer::handleClientConnecting(const Event&, void*)
+IpcServer::handleClientConnecting(const Event& e, void*)
 {
-	synergy::IStream* stream = m_socket->accept();
+	TCPListenSocket* listenSocket = static_cast<TCPListenSocket*>(e.getTarget());
+	IDataSocket* stream = listenSocket->accept();
 	if (stream == NULL) {
 		return;
 	}
 
+	if (listenSocket == m_localSocket && !isPeerAllowed(stream)) {
+		delete stream;
+		return;
+	}
+
 	LOG((CLOG_DEBUG "accepted ipc client connection"));
 
 	ARCH->lockMutex(m_clientsMutex);
@@ -122,6 +195,35 @@ IpcServer::handleClientConnecting(const Event&, void*)
 		m_events->forIpcServer().clientConnected(), this, proxy, Event::kDontFreeData));
 }
 
+bool
+IpcServer::isPeerAllowed(IDataSocket* socket) const
+{
+	// the local listen socket only ever accepts tcp sockets.
+	int uid;
+	try {
+		uid = static_cast<TCPSocket*>(socket)->getPeerUser();
+	}
+	catch (std::exception& e) {
+		LOG((CLOG_WARN "rejected ipc client connection, %s", e.what()));
+		return false;
+	}
+
+	if (uid == -1) {
+		// can't tell on this platform; the socket file is only
+		// accessible to our user anyway.
+		return true;
+	}
+
+#if SYSAPI_UNIX
+	if (uid == 0 || uid == static_cast<int>(geteuid())) {
+		return true;
+	}
+#endif
+
+	LOG((CLOG_WARN "rejected ipc client connection from user %d", uid));
+	return false;
+}
+
 void
 IpcServer::handleClientDisconnected(const Event& e, void*)
 {
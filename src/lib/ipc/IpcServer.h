@@ -29,6 +29,7 @@
 class Event;
 class IpcClientProxy;
 class IpcMessage;
+class IDataSocket;
 class IEventQueue;
 class SocketMultiplexer;
 
@@ -38,17 +39,24 @@ The IPC server listens on localhost. The IPC client runs on both the
 client/server process or the GUI. The IPC server runs on the daemon process.
 This allows the GUI to send config changes to the daemon and client/server,
 and allows the daemon and client/server to send log data to the GUI.
+
+On unix the server also listens on a unix domain socket, which is cheaper
+than loopback TCP and lets the server check who is connecting; only
+clients running as the same user as the server (or as root) are accepted.
 */
 class IpcServer {
 public:
 	IpcServer(IEventQueue* events, SocketMultiplexer* socketMultiplexer);
 	IpcServer(IEventQueue* events, SocketMultiplexer* socketMultiplexer, int port);
+
+	//! Listen only on the unix domain socket at \c path.
+	IpcServer(IEventQueue* events, SocketMultiplexer* socketMultiplexer, const String& path);
 	virtual ~IpcServer();
 
 	//! @name manipulators
 	//@{
 
-	//! Opens a TCP socket only allowing local connections.
+	//! Opens the TCP and/or local sockets only allowing local connections.
 	virtual void		listen();
 
 	//! Send a message to all clients matching the filter type.
@@ -69,6 +77,7 @@ private:
 	void				handleClientDisconnected(const Event&, void*);
 	void				handleMessageReceived(const Event&, void*);
 	void				deleteClient(IpcClientProxy* proxy);
+	bool				isPeerAllowed(IDataSocket* socket) const;
 
 private:
 	typedef std::list<IpcClientProxy*> ClientList;
@@ -78,6 +87,9 @@ private:
 	SocketMultiplexer*	m_socketMultiplexer;
 	TCPListenSocket*	m_socket;
 	NetworkAddress		m_address;
+	TCPListenSocket*	m_localSocket;
+	NetworkAddress		m_localAddress;
+	bool				m_localListening;
 	ClientList			m_clients;
 	ArchMutex			m_clientsMutex;
 
@@ -87,6 +99,8 @@ public:
 		m_mock(true),
 		m_events(nullptr),
 		m_socketMultiplexer(nullptr),
-		m_socket(nullptr) { }
+		m_socket(nullptr),
+		m_localSocket(nullptr),
+		m_localListening(false) { }
 #endif
 };
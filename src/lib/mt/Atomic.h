@@ -0,0 +1,101 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/common.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#pragma intrinsic(_InterlockedExchange)
+#pragma intrinsic(_InterlockedExchangeAdd)
+#endif
+
+//! Atomic memory operations
+/*!
+The few atomic operations the lock-free data structures need.  Loads
+have acquire semantics, stores have release semantics and exchanges
+and fences are full barriers.  Values must be naturally aligned and no
+bigger than a pointer.
+*/
+class Atomic {
+public:
+	//! Full memory barrier
+	static void			fence()
+	{
+#if defined(_MSC_VER)
+		long barrier = 0;
+		_InterlockedExchange(&barrier, 1);
+#else
+		__sync_synchronize();
+#endif
+	}
+
+	//! Load with acquire semantics
+	template <class T>
+	static T			load(const volatile T* p)
+	{
+		T value = *p;
+#if defined(_MSC_VER)
+		_ReadWriteBarrier();
+#else
+		__sync_synchronize();
+#endif
+		return value;
+	}
+
+	//! Store with release semantics
+	template <class T>
+	static void			store(volatile T* p, T value)
+	{
+#if defined(_MSC_VER)
+		_ReadWriteBarrier();
+#else
+		__sync_synchronize();
+#endif
+		*p = value;
+	}
+
+	//! Add to an integer
+	/*!
+	Adds \c delta to \c *p and returns the new value.
+	*/
+	static long			add(volatile long* p, long delta)
+	{
+#if defined(_MSC_VER)
+		return _InterlockedExchangeAdd(p, delta) + delta;
+#else
+		return __sync_add_and_fetch(p, delta);
+#endif
+	}
+
+	//! Exchange a pointer
+	/*!
+	Stores \c value in \c *p and returns the old value.
+	*/
+	template <class T>
+	static T*			exchange(T* volatile* p, T* value)
+	{
+#if defined(_MSC_VER)
+		return static_cast<T*>(_InterlockedExchangePointer(
+							reinterpret_cast<void* volatile*>(p), value));
+#else
+		__sync_synchronize();
+		return __sync_lock_test_and_set(p, value);
+#endif
+	}
+};
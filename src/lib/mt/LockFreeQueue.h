@@ -0,0 +1,144 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "mt/Atomic.h"
+
+//! Lock-free queue
+/*!
+An unbounded FIFO queue that any number of threads may push onto
+while one thread pops from it, without locking.  Neither side ever
+waits for the other so a consumer that wants to sleep until there's
+something to pop needs some other way to be woken.  \c T should be
+cheap to copy, typically a pointer.
+*/
+template <class T>
+class LockFreeQueue {
+public:
+	LockFreeQueue();
+	~LockFreeQueue();
+
+	//! @name manipulators
+	//@{
+
+	//! Add element
+	/*!
+	Adds \c value to the back of the queue.  Any thread may call this.
+	*/
+	void				push(const T& value);
+
+	//! Remove element
+	/*!
+	Removes the element at the front of the queue into \c value and
+	returns true, or returns false if the queue is empty.  Only the
+	consumer thread may call this.
+	*/
+	bool				pop(T& value);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Test for empty queue
+	/*!
+	Returns true iff there's nothing to pop.  Only the consumer thread
+	may call this.  An element being pushed at the same time may or may
+	not be seen.
+	*/
+	bool				isEmpty() const;
+
+	//@}
+
+private:
+	// not implemented
+	LockFreeQueue(const LockFreeQueue&);
+	LockFreeQueue&		operator=(const LockFreeQueue&);
+
+private:
+	class Node {
+	public:
+		Node() : m_next(NULL), m_value() { }
+		Node(const T& value) : m_next(NULL), m_value(value) { }
+
+	public:
+		Node* volatile	m_next;
+		T				m_value;
+	};
+
+	// producers swap themselves in at the head.  the consumer owns the
+	// tail, which is always a node whose value was already popped.
+	Node* volatile		m_head;
+	Node*				m_tail;
+};
+
+template <class T>
+inline
+LockFreeQueue<T>::LockFreeQueue()
+{
+	m_head = m_tail = new Node;
+}
+
+template <class T>
+inline
+LockFreeQueue<T>::~LockFreeQueue()
+{
+	while (m_tail != NULL) {
+		Node* next = m_tail->m_next;
+		delete m_tail;
+		m_tail = next;
+	}
+}
+
+template <class T>
+inline
+void
+LockFreeQueue<T>::push(const T& value)
+{
+	Node* node = new Node(value);
+
+	// link the node after the old head.  until the link is stored the
+	// consumer can't see this node or any pushed after it.
+	Node* prev = Atomic::exchange(&m_head, node);
+	Atomic::store(&prev->m_next, node);
+}
+
+template <class T>
+inline
+bool
+LockFreeQueue<T>::pop(T& value)
+{
+	Node* next = Atomic::load(&m_tail->m_next);
+	if (next == NULL) {
+		return false;
+	}
+
+	// next becomes the tail so its value is dead from now on
+	value         = next->m_value;
+	next->m_value = T();
+	delete m_tail;
+	m_tail        = next;
+	return true;
+}
+
+template <class T>
+inline
+bool
+LockFreeQueue<T>::isEmpty() const
+{
+	return (Atomic::load(&m_tail->m_next) == NULL);
+}
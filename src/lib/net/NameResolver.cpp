@@ -0,0 +1,264 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "net/NameResolver.h"
+
+#include "net/XSocket.h"
+#include "mt/Lock.h"
+#include "mt/Mutex.h"
+#include "mt/Thread.h"
+#include "arch/Arch.h"
+#include "arch/XArch.h"
+#include "base/IEventQueue.h"
+#include "base/FunctionJob.h"
+#include "base/TMethodEventJob.h"
+#include "base/Log.h"
+
+//
+// NameResolver::Lookup
+//
+
+// the state of one lookup.  it's shared by the worker thread and the
+// resolver;  whichever is done with it last deletes it.
+class NameResolver::Lookup {
+public:
+	Lookup(IEventQueue* events, NameResolver* resolver,
+							const NetworkAddress& address, void* target);
+	~Lookup();
+
+public:
+	IEventQueue*		m_events;
+	NameResolver*		m_resolver;
+	LookupFunc			m_lookup;
+	NetworkAddress		m_address;
+	void*				m_target;
+	std::vector<ArchNetAddress>	m_found;
+	String				m_error;
+	Mutex				m_mutex;
+	bool				m_done;
+	bool				m_orphaned;
+};
+
+NameResolver::Lookup::Lookup(IEventQueue* events, NameResolver* resolver,
+				const NetworkAddress& address, void* target) :
+	m_events(events),
+	m_resolver(resolver),
+	m_lookup(resolver->m_lookup),
+	m_address(address),
+	m_target(target),
+	m_done(false),
+	m_orphaned(false)
+{
+	// do nothing
+}
+
+NameResolver::Lookup::~Lookup()
+{
+	for (size_t i = 0; i < m_found.size(); ++i) {
+		ARCH->closeAddr(m_found[i]);
+	}
+}
+
+static
+void
+systemLookup(const String& hostname, std::vector<ArchNetAddress>& addresses)
+{
+	ARCH->nameToAddrs(hostname, addresses);
+}
+
+//
+// NameResolver
+//
+
+NameResolver::NameResolver(IEventQueue* events,
+				double maxAge, LookupFunc lookup) :
+	m_events(events),
+	m_maxAge(maxAge),
+	m_lookup(lookup != NULL ? lookup : &systemLookup)
+{
+	m_events->adoptHandler(m_events->forNameResolver().resolved(), this,
+							new TMethodEventJob<NameResolver>(this,
+								&NameResolver::handleLookup));
+}
+
+NameResolver::~NameResolver()
+{
+	m_events->removeHandler(m_events->forNameResolver().resolved(), this);
+
+	// finished lookups won't be handled now so delete them.  the
+	// worker threads delete the others when they finish.
+	for (LookupSet::iterator i = m_lookups.begin(); i != m_lookups.end(); ++i) {
+		Lookup* lookup = *i;
+		bool done;
+		{
+			Lock lock(&lookup->m_mutex);
+			done                 = lookup->m_done;
+			lookup->m_orphaned   = true;
+		}
+		if (done) {
+			delete lookup;
+		}
+	}
+}
+
+void
+NameResolver::resolve(const NetworkAddress& address, void* target)
+{
+	LOG((CLOG_DEBUG1 "resolving '%s'", address.getHostname().c_str()));
+	Lookup* lookup = new Lookup(m_events, this, address, target);
+	m_lookups.insert(lookup);
+
+	// the thread runs detached;  it deletes nothing but the lookup
+	Thread* thread = new Thread(new FunctionJob(&NameResolver::lookupThread,
+							lookup));
+	delete thread;
+}
+
+void
+NameResolver::cancel(void* target)
+{
+	for (LookupSet::iterator i = m_lookups.begin(); i != m_lookups.end(); ++i) {
+		if ((*i)->m_target == target) {
+			(*i)->m_target = NULL;
+		}
+	}
+}
+
+void
+NameResolver::forget(const NetworkAddress& address)
+{
+	m_cache.erase(getKey(address));
+}
+
+bool
+NameResolver::getCached(const NetworkAddress& address,
+				AddressList& addresses) const
+{
+	Cache::const_iterator i = m_cache.find(getKey(address));
+	if (i == m_cache.end() ||
+		ARCH->monotonicTime() - i->second.m_time >= m_maxAge) {
+		return false;
+	}
+	addresses = i->second.m_addresses;
+	return true;
+}
+
+NameResolver::CacheKey
+NameResolver::getKey(const NetworkAddress& address)
+{
+	return CacheKey(address.getHostname(), address.getPort());
+}
+
+void
+NameResolver::lookupThread(void* data)
+{
+	Lookup* lookup         = reinterpret_cast<Lookup*>(data);
+	const String& hostname = lookup->m_address.getHostname();
+	const int port         = lookup->m_address.getPort();
+
+	// report errors the way NetworkAddress::resolve() does
+	try {
+		if (hostname.empty()) {
+			lookup->m_found.push_back(ARCH->newAnyAddr(IArchNetwork::kINET));
+		}
+		else {
+			lookup->m_lookup(hostname, lookup->m_found);
+		}
+	}
+	catch (XArchNetworkNameUnknown&) {
+		lookup->m_error = XSocketAddress(XSocketAddress::kNotFound,
+							hostname, port).what();
+	}
+	catch (XArchNetworkNameNoAddress&) {
+		lookup->m_error = XSocketAddress(XSocketAddress::kNoAddress,
+							hostname, port).what();
+	}
+	catch (XArchNetworkNameUnsupported&) {
+		lookup->m_error = XSocketAddress(XSocketAddress::kUnsupported,
+							hostname, port).what();
+	}
+	catch (XArchNetworkName&) {
+		lookup->m_error = XSocketAddress(XSocketAddress::kUnknown,
+							hostname, port).what();
+	}
+
+	bool orphaned;
+	{
+		Lock lock(&lookup->m_mutex);
+		lookup->m_done = true;
+		orphaned       = lookup->m_orphaned;
+		if (!orphaned) {
+			lookup->m_events->addEvent(Event(
+							lookup->m_events->forNameResolver().resolved(),
+							lookup->m_resolver, lookup,
+							Event::kDontFreeData));
+		}
+	}
+	if (orphaned) {
+		delete lookup;
+	}
+}
+
+void
+NameResolver::handleLookup(const Event& event, void*)
+{
+	Lookup* lookup = reinterpret_cast<Lookup*>(event.getData());
+	if (m_lookups.erase(lookup) == 0) {
+		return;
+	}
+
+	Result* result    = new Result;
+	result->m_address = lookup->m_address;
+	result->m_error   = lookup->m_error;
+	for (size_t i = 0; i < lookup->m_found.size(); ++i) {
+		result->m_addresses.push_back(NetworkAddress::resolved(
+							lookup->m_address.getHostname(),
+							lookup->m_address.getPort(),
+							lookup->m_found[i]));
+	}
+
+	if (result->m_addresses.empty()) {
+		if (result->m_error.empty()) {
+			result->m_error = XSocketAddress(XSocketAddress::kNoAddress,
+							lookup->m_address.getHostname(),
+							lookup->m_address.getPort()).what();
+		}
+		LOG((CLOG_DEBUG1 "failed to resolve '%s': %s", lookup->m_address.getHostname().c_str(), result->m_error.c_str()));
+	}
+	else {
+		LOG((CLOG_DEBUG1 "resolved '%s' to %d addresses", lookup->m_address.getHostname().c_str(), static_cast<int>(result->m_addresses.size())));
+		CacheEntry& entry  = m_cache[getKey(lookup->m_address)];
+		entry.m_time       = ARCH->monotonicTime();
+		entry.m_addresses  = result->m_addresses;
+	}
+
+	if (lookup->m_target != NULL) {
+		m_events->addEvent(Event(m_events->forNameResolver().resolved(),
+							lookup->m_target, result, Event::kDontFreeData));
+	}
+	else {
+		delete result;
+	}
+
+	// the worker posts the event with the lock held, so wait for it to
+	// let go before deleting the lookup
+	{
+		Lock lock(&lookup->m_mutex);
+	}
+	delete lookup;
+}
@@ -0,0 +1,140 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "net/NetworkAddress.h"
+#include "base/String.h"
+#include "common/stdmap.h"
+#include "common/stdset.h"
+#include "common/stdvector.h"
+
+class IEventQueue;
+class Event;
+
+//! Asynchronous host name resolver
+/*!
+Looks up host names on worker threads so a slow or dead DNS server
+doesn't stall the event loop.  Each lookup returns every IPv4 and IPv6
+address of the host and finishes with a
+\c NameResolverEvents::resolved() event sent to the requester.  The
+addresses of successful lookups are cached for a while so reconnecting
+to the same host needs no lookup at all.
+
+getaddrinfo() doesn't report the TTL of the records it found so the
+cache uses a fixed maximum age instead.
+*/
+class NameResolver {
+public:
+	typedef std::vector<NetworkAddress> AddressList;
+
+	//! Lookup function
+	/*!
+	Appends the addresses of the host name to the list or throws
+	\c XArchNetworkName.  This is called on a worker thread.
+	*/
+	typedef void (*LookupFunc)(const String& hostname,
+							std::vector<ArchNetAddress>& addresses);
+
+	//! Lookup result
+	class Result {
+	public:
+		//! The address that was looked up
+		NetworkAddress	m_address;
+
+		//! The addresses found, with the port set, in resolver order
+		AddressList		m_addresses;
+
+		//! Why the lookup failed;  empty if it succeeded
+		String			m_error;
+	};
+
+	/*!
+	Cached addresses are used for at most \c maxAge seconds.  \c lookup
+	is the function used to look up names;  NULL means the system
+	resolver.  Tests use it to simulate slow DNS servers.
+	*/
+	NameResolver(IEventQueue* events, double maxAge = 300.0,
+							LookupFunc lookup = NULL);
+	~NameResolver();
+
+	//! @name manipulators
+	//@{
+
+	//! Look up an address
+	/*!
+	Starts looking up the host name of \c address on a worker thread
+	and returns immediately.  When the lookup finishes a \c resolved()
+	event is sent to \c target with a \c Result the handler must
+	delete.  Addresses without a host name resolve to the wildcard
+	address.
+	*/
+	void				resolve(const NetworkAddress& address, void* target);
+
+	//! Cancel lookups
+	/*!
+	Drops the results of all unfinished lookups requested by
+	\c target.  Lookups can't be interrupted so the worker threads
+	run to completion in the background.
+	*/
+	void				cancel(void* target);
+
+	//! Forget cached addresses
+	/*!
+	Removes the cached addresses of \c address, e.g. when none of them
+	could be connected to, so the next resolve() looks them up again.
+	*/
+	void				forget(const NetworkAddress& address);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get cached addresses
+	/*!
+	Sets \c addresses to the cached addresses of \c address and returns
+	true if they're younger than the maximum age, otherwise returns
+	false.
+	*/
+	bool				getCached(const NetworkAddress& address,
+							AddressList& addresses) const;
+
+	//@}
+
+private:
+	class Lookup;
+	class CacheEntry {
+	public:
+		double			m_time;
+		AddressList		m_addresses;
+	};
+	typedef std::pair<String, int> CacheKey;
+	typedef std::map<CacheKey, CacheEntry> Cache;
+	typedef std::set<Lookup*> LookupSet;
+
+	static CacheKey		getKey(const NetworkAddress&);
+	static void			lookupThread(void*);
+	void				handleLookup(const Event&, void*);
+
+private:
+	IEventQueue*		m_events;
+	double				m_maxAge;
+	LookupFunc			m_lookup;
+	Cache				m_cache;
+	LookupSet			m_lookups;
+};
@@ -109,6 +109,32 @@ NetworkAddress::NetworkAddress(const String& hostname, int port) :
 	checkPort();
 }
 
+NetworkAddress
+NetworkAddress::local(const String& path)
+{
+	NetworkAddress addr;
+	addr.m_hostname = path;
+	try {
+		addr.m_address = ARCH->newLocalAddr(path);
+	}
+	catch (XArchNetwork&) {
+		throw XSocketAddress(XSocketAddress::kUnsupported, path, 0);
+	}
+	return addr;
+}
+
+NetworkAddress
+NetworkAddress::resolved(const String& hostname, int port,
+				ArchNetAddress address)
+{
+	NetworkAddress addr;
+	addr.m_hostname = hostname;
+	addr.m_port     = port;
+	addr.m_address  = ARCH->copyAddr(address);
+	ARCH->setAddrPort(addr.m_address, port);
+	return addr;
+}
+
 NetworkAddress::~NetworkAddress()
 {
 	if (m_address != NULL) {
@@ -135,6 +161,12 @@ NetworkAddress::operator=(const NetworkAddress& addr)
 void
 NetworkAddress::resolve()
 {
+	// local addresses are fixed by their path
+	if (m_address != NULL &&
+		ARCH->getAddrFamily(m_address) == IArchNetwork::kUNIX) {
+		return;
+	}
+
 	// discard previous address
 	if (m_address != NULL) {
 		ARCH->closeAddr(m_address);
@@ -171,6 +203,10 @@ NetworkAddress::resolve()
 bool
 NetworkAddress::operator==(const NetworkAddress& addr) const
 {
+	// addresses that haven't been resolved have no address to compare
+	if (m_address == NULL || addr.m_address == NULL) {
+		return (m_address == addr.m_address);
+	}
 	return ARCH->isEqualAddr(m_address, addr.m_address);
 }
 
@@ -51,6 +51,24 @@ public:
 	*/
 	NetworkAddress(const String& hostname, int port);
 
+	//! Construct local address
+	/*!
+	Returns the local (unix domain socket) address for the socket file
+	at \c path.  Local addresses have no port and need no resolving.
+	Throws \c XSocketAddress with an error of \c kUnsupported if local
+	sockets aren't supported on this platform.
+	*/
+	static NetworkAddress	local(const String& path);
+
+	//! Construct resolved address
+	/*!
+	Returns an address for \c hostname and \c port that has already
+	been resolved to \c address, e.g. by a NameResolver.  \c address
+	is copied and given the port.
+	*/
+	static NetworkAddress	resolved(const String& hostname, int port,
+							ArchNetAddress address);
+
 	NetworkAddress(const NetworkAddress&);
 
 	~NetworkAddress();
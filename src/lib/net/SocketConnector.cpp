@@ -0,0 +1,274 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "net/SocketConnector.h"
+
+#include "net/IDataSocket.h"
+#include "net/ISocketFactory.h"
+#include "arch/Arch.h"
+#include "base/IEventQueue.h"
+#include "base/TMethodEventJob.h"
+#include "base/XBase.h"
+#include "base/Log.h"
+#include "common/PluginVersion.h"
+
+//
+// SocketConnector
+//
+
+// RFC 6555 suggests 150 to 250 ms
+const double			SocketConnector::s_attemptDelay = 0.25;
+
+SocketConnector::SocketConnector(IEventQueue* events,
+				ISocketFactory* socketFactory, bool secure) :
+	m_events(events),
+	m_socketFactory(socketFactory),
+	m_secure(secure),
+	m_next(0),
+	m_timer(NULL),
+	m_socket(NULL)
+{
+	assert(m_socketFactory != NULL);
+}
+
+SocketConnector::~SocketConnector()
+{
+	cleanupTimer();
+	while (!m_attempts.empty()) {
+		removeAttempt(m_attempts.size() - 1, true);
+	}
+	if (m_socket != NULL) {
+		deleteSocket(m_socket);
+	}
+}
+
+void
+SocketConnector::connect(const NameResolver::AddressList& addresses)
+{
+	assert(!addresses.empty());
+	assert(m_addresses.empty());
+
+	// alternate address families, starting with the resolver's
+	// preferred one
+	const IArchNetwork::EAddressFamily family =
+		ARCH->getAddrFamily(addresses[0].getAddress());
+	NameResolver::AddressList preferred, other;
+	for (size_t i = 0; i < addresses.size(); ++i) {
+		if (ARCH->getAddrFamily(addresses[i].getAddress()) == family) {
+			preferred.push_back(addresses[i]);
+		}
+		else {
+			other.push_back(addresses[i]);
+		}
+	}
+	for (size_t i = 0; i < preferred.size() || i < other.size(); ++i) {
+		if (i < preferred.size()) {
+			m_addresses.push_back(preferred[i]);
+		}
+		if (i < other.size()) {
+			m_addresses.push_back(other[i]);
+		}
+	}
+
+	startAttempt();
+}
+
+IDataSocket*
+SocketConnector::orphanSocket()
+{
+	IDataSocket* socket = m_socket;
+	m_socket = NULL;
+	return socket;
+}
+
+const NetworkAddress&
+SocketConnector::getAddress() const
+{
+	return m_address;
+}
+
+void*
+SocketConnector::getEventTarget() const
+{
+	return const_cast<void*>(reinterpret_cast<const void*>(this));
+}
+
+void
+SocketConnector::startAttempt()
+{
+	while (m_next < m_addresses.size()) {
+		const NetworkAddress& address = m_addresses[m_next++];
+		LOG((CLOG_DEBUG1 "connecting to %s:%d", ARCH->addrToString(address.getAddress()).c_str(), address.getPort()));
+		bool added = false;
+		try {
+			Attempt attempt;
+			attempt.m_socket  = m_socketFactory->create(m_secure);
+			attempt.m_address = address;
+			m_attempts.push_back(attempt);
+			added = true;
+
+			void* target = attempt.m_socket->getEventTarget();
+			m_events->adoptHandler(m_events->forIDataSocket().connected(),
+							target,
+							new TMethodEventJob<SocketConnector>(this,
+								&SocketConnector::handleConnected));
+			m_events->adoptHandler(m_events->forIDataSocket().connectionFailed(),
+							target,
+							new TMethodEventJob<SocketConnector>(this,
+								&SocketConnector::handleConnectionFailed));
+
+			attempt.m_socket->connect(address);
+		}
+		catch (XBase& e) {
+			LOG((CLOG_DEBUG1 "connection to %s failed: %s", ARCH->addrToString(address.getAddress()).c_str(), e.what()));
+			m_error = e.what();
+			if (added) {
+				removeAttempt(m_attempts.size() - 1, true);
+			}
+			continue;
+		}
+
+		// give this attempt a head start before racing the next one
+		if (!m_secure && m_next < m_addresses.size()) {
+			setupTimer();
+		}
+		return;
+	}
+
+	if (m_attempts.empty()) {
+		sendFailedEvent();
+	}
+}
+
+void
+SocketConnector::removeAttempt(size_t index, bool deleteIt)
+{
+	IDataSocket* socket = m_attempts[index].m_socket;
+	m_events->removeHandler(m_events->forIDataSocket().connected(),
+							socket->getEventTarget());
+	m_events->removeHandler(m_events->forIDataSocket().connectionFailed(),
+							socket->getEventTarget());
+	m_attempts.erase(m_attempts.begin() + index);
+	if (deleteIt) {
+		deleteSocket(socket);
+	}
+}
+
+void
+SocketConnector::deleteSocket(IDataSocket* socket)
+{
+	// secure sockets were allocated by the plugin so it must delete them
+	if (m_secure) {
+		ARCH->plugin().invoke(s_pluginNames[kSecureSocket], "deleteSocket", NULL);
+	}
+	else {
+		delete socket;
+	}
+}
+
+void
+SocketConnector::setupTimer()
+{
+	cleanupTimer();
+	m_timer = m_events->newOneShotTimer(s_attemptDelay, NULL);
+	m_events->adoptHandler(Event::kTimer, m_timer,
+							new TMethodEventJob<SocketConnector>(this,
+								&SocketConnector::handleAttemptTimeout));
+}
+
+void
+SocketConnector::cleanupTimer()
+{
+	if (m_timer != NULL) {
+		m_events->removeHandler(Event::kTimer, m_timer);
+		m_events->deleteTimer(m_timer);
+		m_timer = NULL;
+	}
+}
+
+void
+SocketConnector::sendFailedEvent()
+{
+	IDataSocket::ConnectionFailedInfo* info =
+		new IDataSocket::ConnectionFailedInfo(m_error.c_str());
+	m_events->addEvent(Event(m_events->forIDataSocket().connectionFailed(),
+							getEventTarget(), info, Event::kDontFreeData));
+}
+
+size_t
+SocketConnector::findAttempt(void* target) const
+{
+	for (size_t i = 0; i < m_attempts.size(); ++i) {
+		if (m_attempts[i].m_socket->getEventTarget() == target) {
+			return i;
+		}
+	}
+	return m_attempts.size();
+}
+
+void
+SocketConnector::handleConnected(const Event& event, void*)
+{
+	size_t index = findAttempt(event.getTarget());
+	if (index == m_attempts.size()) {
+		return;
+	}
+
+	// the winner
+	m_socket  = m_attempts[index].m_socket;
+	m_address = m_attempts[index].m_address;
+	LOG((CLOG_DEBUG1 "connected to %s:%d", ARCH->addrToString(m_address.getAddress()).c_str(), m_address.getPort()));
+	removeAttempt(index, false);
+
+	// stop the others
+	cleanupTimer();
+	while (!m_attempts.empty()) {
+		removeAttempt(m_attempts.size() - 1, true);
+	}
+	m_next = m_addresses.size();
+
+	m_events->addEvent(Event(m_events->forIDataSocket().connected(),
+							getEventTarget()));
+}
+
+void
+SocketConnector::handleConnectionFailed(const Event& event, void*)
+{
+	IDataSocket::ConnectionFailedInfo* info =
+		reinterpret_cast<IDataSocket::ConnectionFailedInfo*>(event.getData());
+	m_error = info->m_what;
+	delete info;
+
+	size_t index = findAttempt(event.getTarget());
+	if (index == m_attempts.size()) {
+		return;
+	}
+	LOG((CLOG_DEBUG1 "connection to %s failed: %s", ARCH->addrToString(m_attempts[index].m_address.getAddress()).c_str(), m_error.c_str()));
+	removeAttempt(index, true);
+
+	// don't wait for the timer
+	cleanupTimer();
+	startAttempt();
+}
+
+void
+SocketConnector::handleAttemptTimeout(const Event&, void*)
+{
+	cleanupTimer();
+	startAttempt();
+}
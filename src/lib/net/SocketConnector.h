@@ -0,0 +1,118 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "net/NameResolver.h"
+#include "common/stdvector.h"
+
+class IDataSocket;
+class ISocketFactory;
+class IEventQueue;
+class EventQueueTimer;
+class Event;
+
+//! Races connections to a host's addresses
+/*!
+Connects to one of several addresses of the same host the "Happy
+Eyeballs" way:  addresses are tried alternating between IPv4 and IPv6
+and a new attempt starts whenever the previous one hasn't connected
+within a short delay or has failed, without giving up on the earlier
+attempts.  The first attempt to connect wins and the others are
+closed.
+
+The connector sends an \c IDataSocketEvents::connected() event to its
+event target when a socket has connected, after which orphanSocket()
+returns it, or an \c IDataSocketEvents::connectionFailed() event with
+the last error when every address has failed.
+
+The secure socket plugin supports only one socket at a time so secure
+connections are attempted one after another.
+*/
+class SocketConnector {
+public:
+	SocketConnector(IEventQueue* events,
+							ISocketFactory* socketFactory, bool secure);
+	~SocketConnector();
+
+	//! @name manipulators
+	//@{
+
+	//! Start connecting
+	/*!
+	Starts connecting to \c addresses, which must not be empty.
+	*/
+	void				connect(const NameResolver::AddressList& addresses);
+
+	//! Get the connected socket
+	/*!
+	Returns the socket that connected and gives up ownership of it, or
+	returns NULL if no socket has connected.  A secure socket must be
+	deleted through the plugin.
+	*/
+	IDataSocket*		orphanSocket();
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get the connected address
+	/*!
+	Returns the address the connected socket connected to.
+	*/
+	const NetworkAddress&	getAddress() const;
+
+	//! Get event target
+	void*				getEventTarget() const;
+
+	//@}
+
+	//! Delay before the next attempt starts, in seconds
+	static const double	s_attemptDelay;
+
+private:
+	class Attempt {
+	public:
+		IDataSocket*	m_socket;
+		NetworkAddress	m_address;
+	};
+	typedef std::vector<Attempt> AttemptList;
+
+	void				startAttempt();
+	void				removeAttempt(size_t index, bool deleteSocket);
+	void				deleteSocket(IDataSocket*);
+	void				setupTimer();
+	void				cleanupTimer();
+	void				sendFailedEvent();
+	size_t				findAttempt(void* target) const;
+	void				handleConnected(const Event&, void*);
+	void				handleConnectionFailed(const Event&, void*);
+	void				handleAttemptTimeout(const Event&, void*);
+
+private:
+	IEventQueue*		m_events;
+	ISocketFactory*		m_socketFactory;
+	bool				m_secure;
+	NameResolver::AddressList	m_addresses;
+	size_t				m_next;
+	AttemptList			m_attempts;
+	EventQueueTimer*	m_timer;
+	IDataSocket*		m_socket;
+	NetworkAddress		m_address;
+	String				m_error;
+};
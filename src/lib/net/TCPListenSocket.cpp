@@ -34,13 +34,15 @@
 // TCPListenSocket
 //
 
-TCPListenSocket::TCPListenSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer) :
+TCPListenSocket::TCPListenSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer,
+							IArchNetwork::EAddressFamily family) :
 	m_events(events),
-	m_socketMultiplexer(socketMultiplexer)
+	m_socketMultiplexer(socketMultiplexer),
+	m_family(family)
 {
 	m_mutex = new Mutex;
 	try {
-		m_socket = ARCH->newSocket(IArchNetwork::kINET, IArchNetwork::kSTREAM);
+		m_socket = ARCH->newSocket(m_family, IArchNetwork::kSTREAM);
 	}
 	catch (XArchNetwork& e) {
 		throw XSocketCreate(e.what());
@@ -66,6 +68,19 @@ TCPListenSocket::bind(const NetworkAddress& addr)
 {
 	try {
 		Lock lock(m_mutex);
+
+		// an unbound socket can switch between IPv4 and IPv6
+		IArchNetwork::EAddressFamily family =
+			ARCH->getAddrFamily(addr.getAddress());
+		if (family != m_family && m_family != IArchNetwork::kUNIX &&
+			(family == IArchNetwork::kINET ||
+			 family == IArchNetwork::kINET6)) {
+			ArchSocket socket = ARCH->newSocket(family, IArchNetwork::kSTREAM);
+			ARCH->closeSocket(m_socket);
+			m_socket = socket;
+			m_family = family;
+		}
+
 		ARCH->setReuseAddrOnSocket(m_socket, true);
 		ARCH->bindSocket(m_socket, addr.getAddress());
 		ARCH->listenOnSocket(m_socket);
@@ -110,7 +125,8 @@ TCPListenSocket::accept()
 {
 	IDataSocket* socket = NULL;
 	try {
-		socket = new TCPSocket(m_events, m_socketMultiplexer, ARCH->acceptSocket(m_socket, NULL));
+		socket = new TCPSocket(m_events, m_socketMultiplexer,
+							ARCH->acceptSocket(m_socket, NULL), m_family);
 		if (socket != NULL) {
 			setListeningJob();
 		}
@@ -32,7 +32,8 @@ A listen socket using TCP.
 */
 class TCPListenSocket : public IListenSocket {
 public:
-	TCPListenSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer);
+	TCPListenSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer,
+							IArchNetwork::EAddressFamily family = IArchNetwork::kINET);
 	virtual ~TCPListenSocket();
 
 	// ISocket overrides
@@ -58,4 +59,6 @@ protected:
 	Mutex*				m_mutex;
 	IEventQueue*		m_events;
 	SocketMultiplexer*	m_socketMultiplexer;
+	IArchNetwork::EAddressFamily
+						m_family;
 };
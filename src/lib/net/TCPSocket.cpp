@@ -33,11 +33,16 @@
 #include <cstdlib>
 #include <memory>
 
+// the most data that hasn't been sent yet to let the kernel queue on a
+// socket.  anything written after it waits at most this long behind it.
+#define UNSENT_LOW_WATER (32 * 1024)
+
 //
 // TCPSocket
 //
 
-TCPSocket::TCPSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer) :
+TCPSocket::TCPSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer,
+							IArchNetwork::EAddressFamily family) :
 	IDataSocket(events),
 	m_mutex(),
 	m_flushed(&m_mutex, true),
@@ -45,16 +50,17 @@ TCPSocket::TCPSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer)
 	m_socketMultiplexer(socketMultiplexer)
 {
 	try {
-		m_socket = ARCH->newSocket(IArchNetwork::kINET, IArchNetwork::kSTREAM);
+		m_socket = ARCH->newSocket(family, IArchNetwork::kSTREAM);
 	}
 	catch (XArchNetwork& e) {
 		throw XSocketCreate(e.what());
 	}
 
-	init();
+	init(family);
 }
 
-TCPSocket::TCPSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer, ArchSocket socket) :
+TCPSocket::TCPSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer, ArchSocket socket,
+							IArchNetwork::EAddressFamily family) :
 	IDataSocket(events),
 	m_mutex(),
 	m_socket(socket),
@@ -65,7 +71,7 @@ TCPSocket::TCPSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer,
 	assert(m_socket != NULL);
 
 	// socket starts in connected state
-	init();
+	init(family);
 	onConnected();
 	setJob(newJob());
 }
@@ -170,7 +176,7 @@ TCPSocket::write(const void* buffer, UInt32 n)
 		}
 
 		// copy data to the output buffer
-		wasEmpty = (m_outputBuffer.getSize() == 0);
+		wasEmpty = !hasOutput();
 		m_outputBuffer.write(buffer, n);
 
 		// there's data to write
@@ -183,6 +189,39 @@ TCPSocket::write(const void* buffer, UInt32 n)
 	}
 }
 
+void
+TCPSocket::writeBulk(const void* buffer, UInt32 n)
+{
+	bool wasEmpty;
+	{
+		Lock lock(&m_mutex);
+
+		// must not have shutdown output
+		if (!m_writable) {
+			sendEvent(m_events->forIStream().outputError());
+			return;
+		}
+
+		// ignore empty writes
+		if (n == 0) {
+			return;
+		}
+
+		// queue the unit behind the other bulk data
+		wasEmpty = !hasOutput();
+		m_bulkBuffer.write(buffer, n);
+		m_bulkSizes.push_back(n);
+
+		// there's data to write
+		m_flushed = false;
+	}
+
+	// make sure we're waiting to write
+	if (wasEmpty) {
+		setJob(newJob());
+	}
+}
+
 void
 TCPSocket::flush()
 {
@@ -281,6 +320,19 @@ TCPSocket::connect(const NetworkAddress& addr)
 		}
 
 		try {
+			// an unconnected socket can switch between IPv4 and IPv6
+			IArchNetwork::EAddressFamily family =
+				ARCH->getAddrFamily(addr.getAddress());
+			if (family != m_family && m_family != IArchNetwork::kUNIX &&
+				(family == IArchNetwork::kINET ||
+				 family == IArchNetwork::kINET6)) {
+				ArchSocket socket =
+					ARCH->newSocket(family, IArchNetwork::kSTREAM);
+				ARCH->closeSocket(m_socket);
+				m_socket = socket;
+				init(family);
+			}
+
 			if (ARCH->connectSocket(m_socket, addr.getAddress())) {
 				sendEvent(m_events->forIDataSocket().connected());
 				onConnected();
@@ -297,19 +349,38 @@ TCPSocket::connect(const NetworkAddress& addr)
 	setJob(newJob());
 }
 
+int
+TCPSocket::getPeerUser() const
+{
+	Lock lock(&m_mutex);
+	if (m_socket == NULL) {
+		throw XIOClosed();
+	}
+	return ARCH->getPeerUserOnSocket(m_socket);
+}
+
 void
-TCPSocket::init()
+TCPSocket::init(IArchNetwork::EAddressFamily family)
 {
 	// default state
 	m_connected = false;
 	m_readable  = false;
 	m_writable  = false;
+	m_family    = family;
+
+	// local sockets have no Nagle algorithm to turn off
+	if (family == IArchNetwork::kUNIX) {
+		return;
+	}
 
 	try {
 		// turn off Nagle algorithm.  we send lots of very short messages
 		// that should be sent without (much) delay.  for example, the
 		// mouse motion messages are much less useful if they're delayed.
 		ARCH->setNoDelayOnSocket(m_socket, true);
+
+		// and don't let bulk data queue up in the kernel ahead of them
+		if (getenv("LOWAT") == NULL || atoi(getenv("LOWAT")) > 0) ARCH->setUnsentLowWaterOnSocket(m_socket, getenv("LOWAT") ? atoi(getenv("LOWAT")) : UNSENT_LOW_WATER);
 	}
 	catch (XArchNetwork& e) {
 		try {
@@ -353,13 +424,13 @@ TCPSocket::newJob()
 								m_socket, m_readable, m_writable);
 	}
 	else {
-		if (!(m_readable || (m_writable && (m_outputBuffer.getSize() > 0)))) {
+		if (!(m_readable || (m_writable && hasOutput()))) {
 			return NULL;
 		}
 		return new TSocketMultiplexerMethodJob<TCPSocket>(
 								this, &TCPSocket::serviceConnected,
 								m_socket, m_readable,
-								m_writable && (m_outputBuffer.getSize() > 0));
+								m_writable && hasOutput());
 	}
 }
 
@@ -396,6 +467,8 @@ void
 TCPSocket::onOutputShutdown()
 {
 	m_outputBuffer.pop(m_outputBuffer.getSize());
+	m_bulkBuffer.pop(m_bulkBuffer.getSize());
+	m_bulkSizes.clear();
 	m_writable = false;
 
 	// we're now flushed
@@ -412,6 +485,29 @@ TCPSocket::onDisconnected()
 	m_connected = false;
 }
 
+bool
+TCPSocket::hasOutput() const
+{
+	// note -- must have m_mutex locked on entry
+	return (m_outputBuffer.getSize() > 0 || m_bulkBuffer.getSize() > 0);
+}
+
+void
+TCPSocket::promoteBulk()
+{
+	// note -- must have m_mutex locked on entry
+
+	// once the output buffer is empty move the next bulk unit into it.
+	// units go whole so nothing written later can split one.
+	static UInt32 budget = getenv("BUDGET") ? atoi(getenv("BUDGET")) : 1;
+	while (m_outputBuffer.getSize() < budget && !m_bulkSizes.empty()) {
+		UInt32 n = m_bulkSizes.front();
+		m_bulkSizes.pop_front();
+		m_outputBuffer.write(m_bulkBuffer.peek(n), n);
+		m_bulkBuffer.pop(n);
+	}
+}
+
 ISocketMultiplexerJob*
 TCPSocket::serviceConnecting(ISocketMultiplexerJob* job,
 				bool, bool write, bool error)
@@ -469,46 +565,32 @@ TCPSocket::serviceConnected(ISocketMultiplexerJob* job,
 	}
 
 	bool needNewJob = false;
-	
-	static bool s_retry = false;
-	static int s_retrySize = 0;
-	static void* s_staticBuffer = NULL;
 
 	if (write) {
 		try {
-			// write data
-			int bufferSize = 0;
+			// write data.  a secure socket that has to retry a write is
+			// handed the same (possibly larger) buffer again, which ssl
+			// allows because the write buffer is allowed to move.  bulk
+			// data is only taken once the output buffer is empty, which
+			// a pending retry never is.
+			promoteBulk();
+			int bufferSize = m_outputBuffer.getSize();
 			int bytesWrote = 0;
 			int status = 0;
 
-			if (s_retry) {
-				bufferSize = s_retrySize;
-			}
-			else {
-				bufferSize = m_outputBuffer.getSize();
-				s_staticBuffer = malloc(bufferSize);
-				memcpy(s_staticBuffer, m_outputBuffer.peek(bufferSize), bufferSize);
- 			}
-
 			if (bufferSize == 0) {
 				return job;
 			}
 
+			const void* buffer = m_outputBuffer.peek(bufferSize);
+
 			if (isSecure()) {
 				if (isSecureReady()) {
-					status = secureWrite(s_staticBuffer, bufferSize, bytesWrote);
-					if (status > 0) {
-						s_retry = false;
-						bufferSize = 0;
-						free(s_staticBuffer);
-						s_staticBuffer = NULL;
-					}
-					else if (status < 0) {
+					status = secureWrite(buffer, bufferSize, bytesWrote);
+					if (status < 0) {
 						return NULL;
 					}
 					else if (status == 0) {
-						s_retry = true;
-						s_retrySize = bufferSize;
 						return newJob();
 					}
 				}
@@ -517,16 +599,13 @@ TCPSocket::serviceConnected(ISocketMultiplexerJob* job,
 				}
 			}
 			else {
-				bytesWrote = (UInt32)ARCH->writeSocket(m_socket, s_staticBuffer, bufferSize);
-				bufferSize = 0;
-				free(s_staticBuffer);
-				s_staticBuffer = NULL;
+				bytesWrote = (UInt32)ARCH->writeSocket(m_socket, buffer, bufferSize);
 			}
 
 			// discard written data
 			if (bytesWrote > 0) {
 				m_outputBuffer.pop(bytesWrote);
-				if (m_outputBuffer.getSize() == 0) {
+				if (!hasOutput()) {
 					sendEvent(m_events->forIStream().outputFlushed());
 					m_flushed = true;
 					m_flushed.broadcast();
@@ -563,7 +642,8 @@ TCPSocket::serviceConnected(ISocketMultiplexerJob* job,
 
 	if (read && m_readable) {
 		try {
-			static UInt8 buffer[4096];
+			// large enough for a whole tls record
+			static UInt8 buffer[16 * 1024];
 			memset(buffer, 0, sizeof(buffer));
 			int bytesRead = 0;
 			int status = 0;
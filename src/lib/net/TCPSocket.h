@@ -23,6 +23,7 @@
 #include "mt/CondVar.h"
 #include "mt/Mutex.h"
 #include "arch/IArchNetwork.h"
+#include "common/stddeque.h"
 
 class Mutex;
 class Thread;
@@ -33,11 +34,16 @@ class SocketMultiplexer;
 //! TCP data socket
 /*!
 A data socket using TCP.
+
+Data written with write() goes out ahead of data written with
+writeBulk(), so short messages aren't stuck behind a large transfer.
 */
 class TCPSocket : public IDataSocket {
 public:
-	TCPSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer);
-	TCPSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer, ArchSocket socket);
+	TCPSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer,
+							IArchNetwork::EAddressFamily family = IArchNetwork::kINET);
+	TCPSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer, ArchSocket socket,
+							IArchNetwork::EAddressFamily family = IArchNetwork::kINET);
 	virtual ~TCPSocket();
 
 	// ISocket overrides
@@ -62,6 +68,26 @@ public:
 	virtual void		secureAccept() {}
 	virtual void		setFingerprintFilename(String& f) {}
 
+	//! Get the peer's user
+	/*!
+	Returns the user id of the process on the other end of a local
+	socket, or -1 if it's unknown.  Throws if the socket is closed or
+	the user can't be queried.
+	*/
+	int					getPeerUser() const;
+
+	//! Write bulk data
+	/*!
+	Queues \c n bytes from \c buffer to be written once everything
+	passed to write() has been written.  Each call is a unit that's
+	written whole and in order with the other bulk writes, so data
+	from write() is only ever sent between units.  Keep units small
+	so write() isn't kept waiting long.  Bulk data may also be sent
+	between any two calls to write(), so each of those must be a whole
+	message.
+	*/
+	void				writeBulk(const void* buffer, UInt32 n);
+
 protected:
 	ArchSocket			getSocket() { return m_socket; }
 	IEventQueue*		getEvents() { return m_events; }
@@ -81,13 +107,15 @@ protected:
 	void				sendEvent(Event::Type);
 
 private:
-	void				init();
+	void				init(IArchNetwork::EAddressFamily family);
 
 	void				sendConnectionFailedEvent(const char*);
 	void				onConnected();
 	void				onInputShutdown();
 	void				onOutputShutdown();
 	void				onDisconnected();
+	bool				hasOutput() const;
+	void				promoteBulk();
 
 	ISocketMultiplexerJob*
 						serviceConnecting(ISocketMultiplexerJob*,
@@ -105,8 +133,12 @@ private:
 	ArchSocket			m_socket;
 	StreamBuffer		m_inputBuffer;
 	StreamBuffer		m_outputBuffer;
+	StreamBuffer		m_bulkBuffer;
+	std::deque<UInt32>	m_bulkSizes;
 	CondVar<bool>		m_flushed;
 	bool				m_connected;
 	IEventQueue*		m_events;
 	SocketMultiplexer*	m_socketMultiplexer;
+	IArchNetwork::EAddressFamily
+						m_family;
 };
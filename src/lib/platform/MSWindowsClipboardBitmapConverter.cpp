@@ -18,6 +18,7 @@
 
 #include "platform/MSWindowsClipboardBitmapConverter.h"
 
+#include "synergy/PixelKernels.h"
 #include "base/Log.h"
 
 //
@@ -137,7 +138,9 @@ MSWindowsClipboardBitmapConverter::toIClipboard(HANDLE data) const
 	DeleteDC(dstDC);
 	GdiFlush();
 
-	// extract data
+	// extract data.  GDI leaves the alpha of 32 bit pixels zero,
+	// which other platforms take to mean transparent.
+	PixelKernels::fillAlpha((UInt8*)raw, w * h, 0xff);
 	String image((const char*)&info, info.biSize);
 	image.append((const char*)raw, 4 * w * h);
 
@@ -0,0 +1,370 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "platform/NullScreen.h"
+
+#include "base/Log.h"
+
+// the size of every headless screen
+#define WIDTH  1920
+#define HEIGHT 1080
+
+//
+// NullScreen
+//
+
+NullScreen::NullScreen(IEventQueue* events, bool isPrimary) :
+	PlatformScreen(events),
+	m_isPrimary(isPrimary),
+	m_entered(isPrimary),
+	m_x(WIDTH / 2),
+	m_y(HEIGHT / 2)
+{
+	for (UInt8 i = 0; i < NumButtonIDs; ++i) {
+		m_buttons[i] = false;
+	}
+}
+
+NullScreen::~NullScreen()
+{
+	// do nothing
+}
+
+void*
+NullScreen::getEventTarget() const
+{
+	return const_cast<NullScreen*>(this);
+}
+
+bool
+NullScreen::getClipboard(ClipboardID id, IClipboard* clipboard) const
+{
+	return Clipboard::copy(clipboard, &m_clipboards[id]);
+}
+
+void
+NullScreen::getShape(SInt32& x, SInt32& y, SInt32& w, SInt32& h) const
+{
+	x = 0;
+	y = 0;
+	w = WIDTH;
+	h = HEIGHT;
+}
+
+void
+NullScreen::getCursorPos(SInt32& x, SInt32& y) const
+{
+	x = m_x;
+	y = m_y;
+}
+
+void
+NullScreen::reconfigure(UInt32)
+{
+	// do nothing
+}
+
+void
+NullScreen::warpCursor(SInt32 x, SInt32 y)
+{
+	m_x = x;
+	m_y = y;
+}
+
+UInt32
+NullScreen::registerHotKey(KeyID, KeyModifierMask)
+{
+	// there's no user to press it
+	return 0;
+}
+
+void
+NullScreen::unregisterHotKey(UInt32)
+{
+	// do nothing
+}
+
+void
+NullScreen::fakeInputBegin()
+{
+	// do nothing
+}
+
+void
+NullScreen::fakeInputEnd()
+{
+	// do nothing
+}
+
+SInt32
+NullScreen::getJumpZoneSize() const
+{
+	return 1;
+}
+
+bool
+NullScreen::isAnyMouseButtonDown(UInt32& buttonID) const
+{
+	for (UInt8 i = kButtonLeft; i < NumButtonIDs; ++i) {
+		if (m_buttons[i]) {
+			buttonID = i;
+			return true;
+		}
+	}
+	buttonID = kButtonNone;
+	return false;
+}
+
+void
+NullScreen::getCursorCenter(SInt32& x, SInt32& y) const
+{
+	x = WIDTH / 2;
+	y = HEIGHT / 2;
+}
+
+void
+NullScreen::fakeMouseButton(ButtonID id, bool press)
+{
+	LOG((CLOG_DEBUG1 "fake button %d %s", id, press ? "down" : "up"));
+	if (id < NumButtonIDs) {
+		m_buttons[id] = press;
+	}
+}
+
+void
+NullScreen::fakeMouseMove(SInt32 x, SInt32 y)
+{
+	LOG((CLOG_DEBUG1 "fake move %d,%d", x, y));
+	m_x = x;
+	m_y = y;
+}
+
+void
+NullScreen::fakeMouseRelativeMove(SInt32 dx, SInt32 dy) const
+{
+	LOG((CLOG_DEBUG1 "fake relative move %+d,%+d", dx, dy));
+	m_x += dx;
+	m_y += dy;
+}
+
+void
+NullScreen::fakeMouseWheel(SInt32 xDelta, SInt32 yDelta) const
+{
+	LOG((CLOG_DEBUG1 "fake wheel %+d,%+d", xDelta, yDelta));
+}
+
+void
+NullScreen::updateKeyMap()
+{
+	// do nothing
+}
+
+void
+NullScreen::updateKeyState()
+{
+	// do nothing
+}
+
+void
+NullScreen::setHalfDuplexMask(KeyModifierMask)
+{
+	// do nothing
+}
+
+void
+NullScreen::fakeKeyDown(KeyID id, KeyModifierMask mask, KeyButton button)
+{
+	LOG((CLOG_DEBUG1 "fake key down id=0x%08x, mask=0x%04x, button=0x%04x", id, mask, button));
+	m_keys.insert(button);
+}
+
+bool
+NullScreen::fakeKeyRepeat(KeyID id, KeyModifierMask mask,
+				SInt32 count, KeyButton button)
+{
+	LOG((CLOG_DEBUG1 "fake key repeat id=0x%08x, mask=0x%04x, count=%d, button=0x%04x", id, mask, count, button));
+	return (m_keys.count(button) != 0);
+}
+
+bool
+NullScreen::fakeKeyUp(KeyButton button)
+{
+	LOG((CLOG_DEBUG1 "fake key up button=0x%04x", button));
+	return (m_keys.erase(button) != 0);
+}
+
+void
+NullScreen::fakeAllKeysUp()
+{
+	LOG((CLOG_DEBUG1 "fake all keys up"));
+	m_keys.clear();
+}
+
+bool
+NullScreen::fakeCtrlAltDel()
+{
+	LOG((CLOG_DEBUG1 "fake ctrl+alt+del"));
+	return true;
+}
+
+bool
+NullScreen::isKeyDown(KeyButton button) const
+{
+	return (m_keys.count(button) != 0);
+}
+
+KeyModifierMask
+NullScreen::getActiveModifiers() const
+{
+	return 0;
+}
+
+KeyModifierMask
+NullScreen::pollActiveModifiers() const
+{
+	return 0;
+}
+
+SInt32
+NullScreen::pollActiveGroup() const
+{
+	return 0;
+}
+
+void
+NullScreen::pollPressedKeys(KeyButtonSet& pressedKeys) const
+{
+	pressedKeys = m_keys;
+}
+
+void
+NullScreen::enable()
+{
+	// do nothing
+}
+
+void
+NullScreen::disable()
+{
+	// do nothing
+}
+
+void
+NullScreen::enter()
+{
+	LOG((CLOG_DEBUG1 "entering screen"));
+	m_entered = true;
+}
+
+bool
+NullScreen::leave()
+{
+	LOG((CLOG_DEBUG1 "leaving screen"));
+	m_entered = false;
+	return true;
+}
+
+bool
+NullScreen::setClipboard(ClipboardID id, const IClipboard* clipboard)
+{
+	// a NULL clipboard just takes ownership
+	if (clipboard == NULL) {
+		return true;
+	}
+	LOG((CLOG_DEBUG1 "set clipboard %d", id));
+	return Clipboard::copy(&m_clipboards[id], clipboard);
+}
+
+void
+NullScreen::checkClipboards()
+{
+	// nothing else changes the clipboards
+}
+
+void
+NullScreen::openScreensaver(bool)
+{
+	// do nothing
+}
+
+void
+NullScreen::closeScreensaver()
+{
+	// do nothing
+}
+
+void
+NullScreen::screensaver(bool activate)
+{
+	LOG((CLOG_DEBUG1 "screensaver %s", activate ? "on" : "off"));
+}
+
+void
+NullScreen::resetOptions()
+{
+	// do nothing
+}
+
+void
+NullScreen::setOptions(const OptionsList&)
+{
+	// do nothing
+}
+
+void
+NullScreen::setSequenceNumber(UInt32)
+{
+	// do nothing
+}
+
+bool
+NullScreen::isPrimary() const
+{
+	return m_isPrimary;
+}
+
+bool
+NullScreen::isDraggingStarted()
+{
+	return false;
+}
+
+void
+NullScreen::handleSystemEvent(const Event&, void*)
+{
+	// there is no system
+}
+
+void
+NullScreen::updateButtons()
+{
+	// do nothing
+}
+
+IKeyState*
+NullScreen::getKeyState() const
+{
+	// every key state method is overridden
+	return const_cast<NullScreen*>(this);
+}
+
+bool
+NullScreen::isEntered() const
+{
+	return m_entered;
+}
@@ -0,0 +1,112 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "synergy/PlatformScreen.h"
+#include "synergy/Clipboard.h"
+
+//! Headless screen
+/*!
+A screen with no display behind it, for running many clients in one
+process when testing how a server scales.  It keeps a virtual cursor,
+the keys and buttons that are down and a copy of each clipboard, and
+accepts every injected event, logging each one at DEBUG1.
+*/
+class NullScreen : public PlatformScreen {
+public:
+	NullScreen(IEventQueue* events, bool isPrimary);
+	virtual ~NullScreen();
+
+	// IScreen overrides
+	virtual void*		getEventTarget() const;
+	virtual bool		getClipboard(ClipboardID id, IClipboard*) const;
+	virtual void		getShape(SInt32& x, SInt32& y,
+							SInt32& width, SInt32& height) const;
+	virtual void		getCursorPos(SInt32& x, SInt32& y) const;
+
+	// IPrimaryScreen overrides
+	virtual void		reconfigure(UInt32 activeSides);
+	virtual void		warpCursor(SInt32 x, SInt32 y);
+	virtual UInt32		registerHotKey(KeyID key, KeyModifierMask mask);
+	virtual void		unregisterHotKey(UInt32 id);
+	virtual void		fakeInputBegin();
+	virtual void		fakeInputEnd();
+	virtual SInt32		getJumpZoneSize() const;
+	virtual bool		isAnyMouseButtonDown(UInt32& buttonID) const;
+	virtual void		getCursorCenter(SInt32& x, SInt32& y) const;
+
+	// ISecondaryScreen overrides
+	virtual void		fakeMouseButton(ButtonID id, bool press);
+	virtual void		fakeMouseMove(SInt32 x, SInt32 y);
+	virtual void		fakeMouseRelativeMove(SInt32 dx, SInt32 dy) const;
+	virtual void		fakeMouseWheel(SInt32 xDelta, SInt32 yDelta) const;
+
+	// IKeyState overrides
+	virtual void		updateKeyMap();
+	virtual void		updateKeyState();
+	virtual void		setHalfDuplexMask(KeyModifierMask);
+	virtual void		fakeKeyDown(KeyID id, KeyModifierMask mask,
+							KeyButton button);
+	virtual bool		fakeKeyRepeat(KeyID id, KeyModifierMask mask,
+							SInt32 count, KeyButton button);
+	virtual bool		fakeKeyUp(KeyButton button);
+	virtual void		fakeAllKeysUp();
+	virtual bool		fakeCtrlAltDel();
+	virtual bool		isKeyDown(KeyButton) const;
+	virtual KeyModifierMask
+						getActiveModifiers() const;
+	virtual KeyModifierMask
+						pollActiveModifiers() const;
+	virtual SInt32		pollActiveGroup() const;
+	virtual void		pollPressedKeys(KeyButtonSet& pressedKeys) const;
+
+	// IPlatformScreen overrides
+	virtual void		enable();
+	virtual void		disable();
+	virtual void		enter();
+	virtual bool		leave();
+	virtual bool		setClipboard(ClipboardID, const IClipboard*);
+	virtual void		checkClipboards();
+	virtual void		openScreensaver(bool notify);
+	virtual void		closeScreensaver();
+	virtual void		screensaver(bool activate);
+	virtual void		resetOptions();
+	virtual void		setOptions(const OptionsList& options);
+	virtual void		setSequenceNumber(UInt32);
+	virtual bool		isPrimary() const;
+	virtual bool		isDraggingStarted();
+
+protected:
+	// PlatformScreen overrides
+	virtual void		handleSystemEvent(const Event&, void*);
+	virtual void		updateButtons();
+	virtual IKeyState*	getKeyState() const;
+
+	//! Test if the cursor is on this screen
+	bool				isEntered() const;
+
+private:
+	bool				m_isPrimary;
+	bool				m_entered;
+	mutable SInt32		m_x;
+	mutable SInt32		m_y;
+	bool				m_buttons[NumButtonIDs];
+	KeyButtonSet		m_keys;
+	Clipboard			m_clipboards[kClipboardEnd];
+};
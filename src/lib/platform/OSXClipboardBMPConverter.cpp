@@ -17,6 +17,7 @@
  */
 
 #include "platform/OSXClipboardBMPConverter.h"
+#include "synergy/PixelKernels.h"
 #include "base/Log.h"
 
 // BMP file header structure
@@ -125,10 +126,15 @@ OSXClipboardBMPConverter::toIClipboard(const String& bmp) const
 	UInt32 offset = fromLEU32(rawBMPHeader + 10);
 
 	// construct BMP
+	String dib;
 	if (offset == 14 + 40) {
-		return bmp.substr(14);
+		dib = bmp.substr(14);
 	}
 	else {
-		return bmp.substr(14, 40) + bmp.substr(offset, bmp.size() - offset);
+		dib = bmp.substr(14, 40) + bmp.substr(offset, bmp.size() - offset);
 	}
+
+	// we keep bitmaps bottom-up
+	PixelKernels::makeBottomUp(dib);
+	return dib;
 }
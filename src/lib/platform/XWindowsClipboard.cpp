@@ -23,11 +23,11 @@
 #include "platform/XWindowsClipboardUTF8Converter.h"
 #include "platform/XWindowsClipboardHTMLConverter.h"
 #include "platform/XWindowsClipboardBMPConverter.h"
+#include "platform/XWindowsClipboardPNGConverter.h"
 #include "platform/XWindowsUtil.h"
 #include "mt/Thread.h"
 #include "arch/Arch.h"
 #include "base/Log.h"
-#include "base/Stopwatch.h"
 #include "common/stdvector.h"
 
 #include <cstdio>
@@ -46,7 +46,20 @@ XWindowsClipboard::XWindowsClipboard(Display* display,
 	m_time(0),
 	m_owner(false),
 	m_timeOwned(0),
-	m_timeLost(0)
+	m_timeLost(0),
+	m_fetch(NULL),
+	m_fetchState(kFetchIdle),
+	m_fetchTime(0),
+	m_fetchOwnerTime(0),
+	m_fetchFormats(0),
+	m_fetchOldFormats(0),
+	m_fetchTried(0),
+	m_fetchConverter(0),
+	m_fetchChanged(false),
+	m_fetched(false),
+	m_conversionHits(0),
+	m_conversionMisses(0),
+	m_requestedFormats(0)
 {
 	// get some atoms
 	m_atomTargets         = XInternAtom(m_display, "TARGETS", False);
@@ -55,7 +68,6 @@ XWindowsClipboard::XWindowsClipboard(Display* display,
 	m_atomInteger         = XInternAtom(m_display, "INTEGER", False);
 	m_atomAtom            = XInternAtom(m_display, "ATOM", False);
 	m_atomAtomPair        = XInternAtom(m_display, "ATOM_PAIR", False);
-	m_atomData            = XInternAtom(m_display, "CLIP_TEMPORARY", False);
 	m_atomINCR            = XInternAtom(m_display, "INCR", False);
 	m_atomMotifClipLock   = XInternAtom(m_display, "_MOTIF_CLIP_LOCK", False);
 	m_atomMotifClipHeader = XInternAtom(m_display, "_MOTIF_CLIP_HEADER", False);
@@ -63,21 +75,25 @@ XWindowsClipboard::XWindowsClipboard(Display* display,
 								"_MOTIF_CLIP_LOCK_ACCESS_VALID", False);
 	m_atomGDKSelection    = XInternAtom(m_display, "GDK_SELECTION", False);
 
-	// set selection atom based on clipboard id
+	// set selection atom based on clipboard id.  each selection gets
+	// its own property to receive data so both can be fetched at once.
 	switch (id) {
 	case kClipboardClipboard:
 		m_selection = XInternAtom(m_display, "CLIPBOARD", False);
+		m_atomData  = XInternAtom(m_display, "CLIP_TEMPORARY", False);
 		break;
 
 	case kClipboardSelection:
 	default:
 		m_selection = XA_PRIMARY;
+		m_atomData  = XInternAtom(m_display, "CLIP_TEMPORARY_PRIMARY", False);
 		break;
 	}
 
 	// add converters, most desired first
 	m_converters.push_back(new XWindowsClipboardHTMLConverter(m_display,
 								"text/html"));
+	m_converters.push_back(new XWindowsClipboardPNGConverter(m_display));
 	m_converters.push_back(new XWindowsClipboardBMPConverter(m_display));
 	m_converters.push_back(new XWindowsClipboardUTF8Converter(m_display,
 								"text/plain;charset=UTF-8"));
@@ -98,7 +114,9 @@ XWindowsClipboard::XWindowsClipboard(Display* display,
 
 XWindowsClipboard::~XWindowsClipboard()
 {
+	delete m_fetch;
 	clearReplies();
+	clearConversions();
 	clearConverters();
 }
 
@@ -110,6 +128,7 @@ XWindowsClipboard::lost(Time time)
 		m_owner    = false;
 		m_timeLost = time;
 		clearCache();
+		answerHeldRequests(true);
 	}
 }
 
@@ -130,6 +149,10 @@ XWindowsClipboard::addRequest(Window owner, Window requestor,
 					success = insertMultipleReply(requestor, time, property);
 				}
 			}
+			else if (holdRequest(requestor, target, time, property)) {
+				// answered when the data arrives
+				success = true;
+			}
 			else {
 				addSimpleRequest(requestor, target, time, property);
 
@@ -164,28 +187,34 @@ XWindowsClipboard::addSimpleRequest(Window requestor,
 	}
 
 	// handle targets
-	String data;
-	Atom type  = None;
-	int format = 0;
-	if (target == m_atomTargets) {
-		type = getTargetsData(data, &format);
-	}
-	else if (target == m_atomTimestamp) {
-		type = getTimestampData(data, &format);
+	ReplyData* data = NULL;
+	Atom type       = None;
+	int format      = 0;
+	if (target == m_atomTargets || target == m_atomTimestamp) {
+		String small;
+		if (target == m_atomTargets) {
+			type = getTargetsData(small, &format);
+		}
+		else {
+			type = getTimestampData(small, &format);
+		}
+		data = ReplyData::adopt(small);
 	}
 	else {
 		IXWindowsClipboardConverter* converter = getConverter(target);
 		if (converter != NULL) {
 			IClipboard::EFormat clipboardFormat = converter->getFormat();
 			if (m_added[clipboardFormat]) {
-				try {
-					data   = converter->fromIClipboard(m_data[clipboardFormat]);
+				data = getConvertedData(converter);
+				if (data != NULL) {
 					format = converter->getDataSize();
 					type   = converter->getAtom();
 				}
-				catch (...) {
-					// ignore -- cannot convert
-				}
+			}
+			else if (m_available[clipboardFormat]) {
+				// promised but not here yet.  we can't hold part of a
+				// MULTIPLE request so fail it but ask for the data.
+				m_requestedFormats |= (1u << clipboardFormat);
 			}
 		}
 	}
@@ -200,11 +229,76 @@ XWindowsClipboard::addSimpleRequest(Window requestor,
 	else {
 		// failure
 		LOG((CLOG_DEBUG1 "failed"));
+		if (data != NULL) {
+			data->unref();
+		}
 		insertReply(new Reply(requestor, target, time));
 		return false;
 	}
 }
 
+bool
+XWindowsClipboard::holdRequest(Window requestor,
+				Atom target, ::Time time, Atom property)
+{
+	IXWindowsClipboardConverter* converter = getConverter(target);
+	if (converter == NULL || converter->getAtom() != target) {
+		return false;
+	}
+	IClipboard::EFormat format = converter->getFormat();
+	if (m_added[format] || !m_available[format]) {
+		return false;
+	}
+
+	LOG((CLOG_DEBUG1 "holding request until format %d arrives", format));
+	HeldRequest request;
+	request.m_requestor = requestor;
+	request.m_target    = target;
+	request.m_time      = time;
+	request.m_property  = property;
+	m_heldRequests.push_back(request);
+	m_requestedFormats |= (1u << format);
+	return true;
+}
+
+void
+XWindowsClipboard::answerHeldRequests(bool fail)
+{
+	bool answered = false;
+	for (HeldRequestList::iterator index = m_heldRequests.begin();
+								index != m_heldRequests.end(); ) {
+		IXWindowsClipboardConverter* converter = getConverter(index->m_target);
+		if (!fail && converter != NULL &&
+			!m_added[converter->getFormat()]) {
+			++index;
+			continue;
+		}
+
+		// addSimpleRequest() fails the request if the format is missing
+		addSimpleRequest(index->m_requestor, index->m_target,
+							index->m_time, index->m_property);
+		index    = m_heldRequests.erase(index);
+		answered = true;
+	}
+	if (answered) {
+		pushReplies();
+	}
+}
+
+bool
+XWindowsClipboard::isPromised(EFormat format) const
+{
+	return (m_owner && m_available[format]);
+}
+
+UInt32
+XWindowsClipboard::takeRequestedFormats()
+{
+	UInt32 formats     = m_requestedFormats;
+	m_requestedFormats = 0;
+	return formats;
+}
+
 bool
 XWindowsClipboard::processRequest(Window requestor,
 				::Time /*time*/, Atom property)
@@ -236,10 +330,23 @@ XWindowsClipboard::processRequest(Window requestor,
 bool
 XWindowsClipboard::destroyRequest(Window requestor)
 {
+	// forget held requests for this window
+	bool held = false;
+	for (HeldRequestList::iterator index = m_heldRequests.begin();
+								index != m_heldRequests.end(); ) {
+		if (index->m_requestor == requestor) {
+			index = m_heldRequests.erase(index);
+			held  = true;
+		}
+		else {
+			++index;
+		}
+	}
+
 	ReplyMap::iterator index = m_replies.find(requestor);
 	if (index == m_replies.end()) {
 		// unknown requestor window
-		return false;
+		return held;
 	}
 
 	// destroy all replies for this window
@@ -279,8 +386,10 @@ XWindowsClipboard::empty()
 	}
 
 	// clear all data.  since we own the data now, the cache is up
-	// to date.
+	// to date.  requests held for the old data can't be answered.
+	abortFetch();
 	clearCache();
+	answerHeldRequests(true);
 	m_cached = true;
 
 	// FIXME -- actually delete motif clipboard items?
@@ -305,10 +414,41 @@ XWindowsClipboard::add(EFormat format, const String& data)
 
 	LOG((CLOG_DEBUG "add %d bytes to clipboard %d format: %d", data.size(), m_id, format));
 
-	m_data[format]  = data;
-	m_added[format] = true;
+	m_data[format]      = data;
+	m_added[format]     = true;
+	m_available[format] = false;
+
+	// data converted from the format's old data is stale.  replies
+	// already sending it keep their own reference.
+	for (ConversionCache::iterator index = m_conversions.begin();
+								index != m_conversions.end(); ) {
+		IXWindowsClipboardConverter* converter = getConverter(index->first);
+		if (converter != NULL && converter->getFormat() == format) {
+			index->second->unref();
+			m_conversions.erase(index++);
+		}
+		else {
+			++index;
+		}
+	}
 
 	// FIXME -- set motif clipboard item?
+
+	// answer requests that were waiting for this format
+	answerHeldRequests(false);
+}
+
+void
+XWindowsClipboard::promise(EFormat format)
+{
+	assert(m_open);
+	assert(m_owner);
+
+	LOG((CLOG_DEBUG "promise format %d on clipboard %d", format, m_id));
+
+	if (!m_added[format]) {
+		m_available[format] = true;
+	}
 }
 
 bool
@@ -343,9 +483,6 @@ XWindowsClipboard::open(Time time) const
 	m_open = true;
 	m_time = time;
 
-	// be sure to flush the cache later if it's dirty
-	m_checkCache = true;
-
 	return true;
 }
 
@@ -368,7 +505,6 @@ XWindowsClipboard::close() const
 IClipboard::Time
 XWindowsClipboard::getTime() const
 {
-	checkCache();
 	return m_timeOwned;
 }
 
@@ -377,8 +513,7 @@ XWindowsClipboard::has(EFormat format) const
 {
 	assert(m_open);
 
-	fillCache();
-	return m_added[format];
+	return m_added[format] || m_available[format];
 }
 
 String
@@ -386,10 +521,31 @@ XWindowsClipboard::get(EFormat format) const
 {
 	assert(m_open);
 
-	fillCache();
+	// data that hasn't been fetched (or added) yet reads as empty
+	if (!m_added[format]) {
+		return String();
+	}
 	return m_data[format];
 }
 
+bool
+XWindowsClipboard::isCached() const
+{
+	return m_cached;
+}
+
+bool
+XWindowsClipboard::isCached(EFormat format) const
+{
+	return m_added[format];
+}
+
+UInt32
+XWindowsClipboard::getConversionHits() const
+{
+	return m_conversionHits;
+}
+
 void
 XWindowsClipboard::clearConverters()
 {
@@ -428,88 +584,224 @@ XWindowsClipboard::getConverter(Atom target, bool onlyIfNotAdded) const
 }
 
 void
-XWindowsClipboard::checkCache() const
+XWindowsClipboard::clearCache() const
 {
-	if (!m_checkCache) {
-		return;
+	const_cast<XWindowsClipboard*>(this)->doClearCache();
+}
+
+void
+XWindowsClipboard::doClearCache()
+{
+	clearConversions();
+	m_cached = false;
+	for (SInt32 index = 0; index < kNumFormats; ++index) {
+		m_data[index]      = "";
+		m_added[index]     = false;
+		m_available[index] = false;
 	}
-	m_checkCache = false;
+}
 
-	// get the time the clipboard ownership was taken by the current
-	// owner.
-	if (m_motif) {
-		m_timeOwned = motifGetTime();
+UInt32
+XWindowsClipboard::getCachedFormats() const
+{
+	UInt32 formats = 0;
+	for (SInt32 format = 0; format < kNumFormats; ++format) {
+		if (m_added[format] || m_available[format]) {
+			formats |= (1u << format);
+		}
 	}
-	else {
-		m_timeOwned = icccmGetTime();
+	return formats;
+}
+
+void
+XWindowsClipboard::setFetchedFormat(EFormat format, const String& data)
+{
+	// m_data still has the old data, if any, even when it's stale
+	if (m_data[format] != data) {
+		m_fetchChanged = true;
 	}
+	m_data[format]      = data;
+	m_added[format]     = true;
+	m_available[format] = false;
+}
 
-	// if we can't get the time then use the time passed to us
-	if (m_timeOwned == 0) {
-		m_timeOwned = m_time;
+void
+XWindowsClipboard::dropFormat(EFormat format)
+{
+	m_data[format]      = "";
+	m_added[format]     = false;
+	m_available[format] = false;
+}
+
+void
+XWindowsClipboard::fetch(::Time time, UInt32 formats)
+{
+	// we can't ask ourself for the data
+	if (m_owner) {
+		return;
 	}
 
-	// if the cache is dirty then flush it
-	if (m_timeOwned != m_cacheTime) {
-		clearCache();
+	// add the formats to a fetch that's already running
+	m_fetchFormats |= formats;
+	if (m_fetchState != kFetchIdle) {
+		return;
 	}
+
+	LOG((CLOG_DEBUG "fetch clipboard %d", m_id));
+	m_fetchTime       = time;
+	m_fetchOwnerTime  = 0;
+	m_fetchOldFormats = getCachedFormats();
+	m_fetchTried      = 0;
+	m_fetchChanged    = false;
+
+	// a motif owner keeps the data on the root window so we can read
+	// it right away
+	if (m_id == kClipboardClipboard && motifLockClipboard()) {
+		const bool motif = motifOwnsClipboard();
+		LOG((CLOG_DEBUG1 "motif does %sown clipboard", motif ? "" : "not "));
+		if (motif) {
+			// keep the old data in m_data to see if the new data differs
+			for (SInt32 format = 0; format < kNumFormats; ++format) {
+				m_added[format]     = false;
+				m_available[format] = false;
+			}
+			motifFillCache();
+			for (SInt32 format = 0; format < kNumFormats; ++format) {
+				if (!m_added[format]) {
+					dropFormat(static_cast<EFormat>(format));
+				}
+			}
+			m_cached = true;
+		}
+		motifUnlockClipboard();
+		if (motif) {
+			endFetch();
+			return;
+		}
+	}
+
+	// see if the selection has changed hands since we last read it
+	startConversion(kFetchTime, m_atomTimestamp);
 }
 
-void
-XWindowsClipboard::clearCache() const
+bool
+XWindowsClipboard::processFetchEvent(XEvent* xevent)
 {
-	const_cast<XWindowsClipboard*>(this)->doClearCache();
+	if (m_fetch == NULL || !m_fetch->processEvent(m_display, xevent)) {
+		return false;
+	}
+	if (m_fetch->isDone()) {
+		endConversion();
+	}
+	return true;
 }
 
 void
-XWindowsClipboard::doClearCache()
+XWindowsClipboard::checkFetch()
 {
-	m_checkCache = false;
-	m_cached     = false;
-	for (SInt32 index = 0; index < kNumFormats; ++index) {
-		m_data[index]  = "";
-		m_added[index] = false;
+	if (m_fetch != NULL && m_fetch->checkTimeout()) {
+		endConversion();
 	}
 }
 
+bool
+XWindowsClipboard::takeFetched()
+{
+	bool fetched = m_fetched;
+	m_fetched    = false;
+	return fetched;
+}
+
+bool
+XWindowsClipboard::isFetching() const
+{
+	return (m_fetchState != kFetchIdle);
+}
+
+void
+XWindowsClipboard::startConversion(EFetchState state, Atom target)
+{
+	assert(m_fetch == NULL);
+
+	m_fetchState = state;
+	m_fetch      = new CICCCMGetClipboard(m_window, m_fetchTime, m_atomData);
+	m_fetch->start(m_display, m_selection, target);
+}
+
 void
-XWindowsClipboard::fillCache() const
+XWindowsClipboard::endConversion()
 {
-	// get the selection data if not already cached
-	checkCache();
-	if (!m_cached) {
-		const_cast<XWindowsClipboard*>(this)->doFillCache();
+	assert(m_fetch != NULL);
+
+	// take the result.  a target of None means we have no data.
+	Atom target = None;
+	String data;
+	if (!m_fetch->isSuccess()) {
+		LOG((CLOG_DEBUG1 "can't get data for selection of clipboard %d", m_id));
+		LOGC(m_fetch->m_error, (CLOG_WARN "ICCCM violation by clipboard owner"));
+	}
+	else if (m_fetch->m_actualTarget == None) {
+		LOG((CLOG_DEBUG1 "selection conversion failed for clipboard %d", m_id));
+	}
+	else {
+		target = m_fetch->m_actualTarget;
+		data.swap(m_fetch->m_data);
+	}
+	delete m_fetch;
+	m_fetch = NULL;
+
+	// continue with the next step
+	switch (m_fetchState) {
+	case kFetchTime:
+		fetchedTime(target, data);
+		break;
+
+	case kFetchTargets:
+		fetchedTargets(target, data);
+		break;
+
+	case kFetchFormat:
+		fetchedFormat(target, data);
+		break;
+
+	case kFetchIdle:
+		break;
 	}
 }
 
 void
-XWindowsClipboard::doFillCache()
+XWindowsClipboard::fetchedTime(Atom target, const String& data)
 {
-	if (m_motif) {
-		motifFillCache();
+	if (target == m_atomInteger && data.size() >= sizeof(Time)) {
+		m_fetchOwnerTime = *reinterpret_cast<const Time*>(data.data());
+		LOG((CLOG_DEBUG1 "got ICCCM time %d", m_fetchOwnerTime));
 	}
 	else {
-		icccmFillCache();
+		// no timestamp
+		LOG((CLOG_DEBUG1 "can't get ICCCM time"));
+	}
+
+	// the cached list of formats is good if the owner hasn't changed.
+	// if the owner doesn't tell us when it took the selection then we
+	// can't know so we read the list again.
+	if (m_cached && m_fetchOwnerTime != 0 && m_fetchOwnerTime == m_cacheTime) {
+		fetchNextFormat();
+	}
+	else {
+		startConversion(kFetchTargets, m_atomTargets);
 	}
-	m_checkCache = false;
-	m_cached     = true;
-	m_cacheTime  = m_timeOwned;
 }
 
 void
-XWindowsClipboard::icccmFillCache()
+XWindowsClipboard::fetchedTargets(Atom target, String& data)
 {
 	LOG((CLOG_DEBUG "ICCCM fill clipboard %d", m_id));
 
-	// see if we can get the list of available formats from the selection.
+	// see if we got the list of available formats from the selection.
 	// if not then use a default list of formats.  note that some clipboard
 	// owners are broken and report TARGETS as the type of the TARGETS data
 	// instead of the correct type ATOM;  allow either.
-	const Atom atomTargets = m_atomTargets;
-	Atom target;
-	String data;
-	if (!icccmGetSelection(atomTargets, &target, &data) ||
-		(target != m_atomAtom && target != m_atomTargets)) {
+	if (target != m_atomAtom && target != m_atomTargets) {
 		LOG((CLOG_DEBUG1 "selection doesn't support TARGETS"));
 		data = "";
 		XWindowsUtil::appendAtomData(data, XA_STRING);
@@ -520,88 +812,136 @@ XWindowsClipboard::icccmFillCache()
 	const UInt32 numTargets = data.size() / sizeof(Atom);
 	LOG((CLOG_DEBUG "  available targets: %s", XWindowsUtil::atomsToString(m_display, targets, numTargets).c_str()));
 
-	// try each converter in order (because they're in order of
-	// preference).
+	// note the formats we have a converter for
+	bool listed[kNumFormats];
+	bool found = false;
+	for (SInt32 format = 0; format < kNumFormats; ++format) {
+		listed[format] = false;
+	}
 	for (ConverterList::const_iterator index = m_converters.begin();
 								index != m_converters.end(); ++index) {
 		IXWindowsClipboardConverter* converter = *index;
-
-		// skip already handled targets
-		if (m_added[converter->getFormat()]) {
-			continue;
-		}
-
-		// see if atom is in target list
-		Atom target = None;
-		// XXX -- just ask for the converter's target to see if it's
-		// available rather than checking TARGETS.  i've seen clipboard
-		// owners that don't report all the targets they support.
-		target = converter->getAtom();
-		/*
 		for (UInt32 i = 0; i < numTargets; ++i) {
 			if (converter->getAtom() == targets[i]) {
-				target = targets[i];
+				listed[converter->getFormat()] = true;
+				found = true;
 				break;
 			}
 		}
-		*/
-		if (target == None) {
-			continue;
+	}
+
+	// i've seen clipboard owners that don't report all the targets
+	// they support.  if none of ours was reported then ask for each
+	// format to see if it's available.
+	if (!found) {
+		LOG((CLOG_DEBUG1 "no known targets, probing each format"));
+		for (SInt32 format = 0; format < kNumFormats; ++format) {
+			listed[format] = true;
+			m_fetchFormats |= (1u << format);
 		}
+	}
 
-		// get the data
-		Atom actualTarget;
-		String targetData;
-		if (!icccmGetSelection(target, &actualTarget, &targetData)) {
-			LOG((CLOG_DEBUG1 "  no data for target %s", XWindowsUtil::atomToString(m_display, target).c_str()));
-			continue;
+	// the selection may have new data so the cached data is stale.
+	// keep it in m_data anyway to see if the new data differs.
+	for (SInt32 format = 0; format < kNumFormats; ++format) {
+		if (listed[format]) {
+			m_added[format]     = false;
+			m_available[format] = true;
 		}
+		else {
+			dropFormat(static_cast<EFormat>(format));
+		}
+	}
+	m_cached    = true;
+	m_cacheTime = m_fetchOwnerTime;
 
-		// add to clipboard and note we've done it
+	fetchNextFormat();
+}
+
+void
+XWindowsClipboard::fetchedFormat(Atom target, const String& data)
+{
+	IXWindowsClipboardConverter* converter = m_converters[m_fetchConverter];
+	if (target == None) {
+		LOG((CLOG_DEBUG1 "  no data for target %s", XWindowsUtil::atomToString(m_display, converter->getAtom()).c_str()));
+	}
+	else {
 		IClipboard::EFormat format = converter->getFormat();
-		m_data[format]  = converter->toIClipboard(targetData);
-		m_added[format] = true;
-		LOG((CLOG_DEBUG "added format %d for target %s (%u %s)", format, XWindowsUtil::atomToString(m_display, target).c_str(), targetData.size(), targetData.size() == 1 ? "byte" : "bytes"));
+		setFetchedFormat(format, converter->toIClipboard(data));
+		LOG((CLOG_DEBUG "added format %d for target %s (%u %s)", format, XWindowsUtil::atomToString(m_display, converter->getAtom()).c_str(), data.size(), data.size() == 1 ? "byte" : "bytes"));
 	}
+
+	fetchNextFormat();
 }
 
-bool
-XWindowsClipboard::icccmGetSelection(Atom target,
-				Atom* actualTarget, String* data) const
-{
-	assert(actualTarget != NULL);
-	assert(data         != NULL);
-
-	// request data conversion
-	CICCCMGetClipboard getter(m_window, m_time, m_atomData);
-	if (!getter.readClipboard(m_display, m_selection,
-								target, actualTarget, data)) {
-		LOG((CLOG_DEBUG1 "can't get data for selection target %s", XWindowsUtil::atomToString(m_display, target).c_str()));
-		LOGC(getter.m_error, (CLOG_WARN "ICCCM violation by clipboard owner"));
-		return false;
-	}
-	else if (*actualTarget == None) {
-		LOG((CLOG_DEBUG1 "selection conversion failed for target %s", XWindowsUtil::atomToString(m_display, target).c_str()));
-		return false;
+void
+XWindowsClipboard::fetchNextFormat()
+{
+	// ask for the wanted formats we don't have with each converter we
+	// haven't tried in order (because they're in order of preference).
+	// formats added to the fetch late start over from the first
+	// converter but converters that failed aren't tried again.
+	for (UInt32 i = 0; i < m_converters.size(); ++i) {
+		IXWindowsClipboardConverter* converter = m_converters[i];
+		IClipboard::EFormat format = converter->getFormat();
+		if ((m_fetchTried & (1u << i)) != 0 ||
+			(m_fetchFormats & (1u << format)) == 0 ||
+			m_added[format] || !m_available[format]) {
+			continue;
+		}
+
+		m_fetchTried    |= (1u << i);
+		m_fetchConverter = i;
+		startConversion(kFetchFormat, converter->getAtom());
+		return;
 	}
-	return true;
+
+	endFetch();
 }
 
-IClipboard::Time
-XWindowsClipboard::icccmGetTime() const
+void
+XWindowsClipboard::endFetch()
 {
-	Atom actualTarget;
-	String data;
-	if (icccmGetSelection(m_atomTimestamp, &actualTarget, &data) &&
-		actualTarget == m_atomInteger) {
-		Time time = *reinterpret_cast<const Time*>(data.data());
-		LOG((CLOG_DEBUG1 "got ICCCM time %d", time));
-		return time;
+	// wanted formats that no converter could get aren't available
+	for (SInt32 format = 0; format < kNumFormats; ++format) {
+		if ((m_fetchFormats & (1u << format)) != 0 &&
+			!m_added[format] && m_available[format]) {
+			dropFormat(static_cast<EFormat>(format));
+		}
 	}
-	else {
-		// no timestamp
-		LOG((CLOG_DEBUG1 "can't get ICCCM time"));
-		return 0;
+	if (getCachedFormats() != m_fetchOldFormats) {
+		m_fetchChanged = true;
+	}
+
+	// use the time the owner took the selection.  if it won't tell us
+	// then use the time we looked, unless the selection is unchanged.
+	if (m_fetchOwnerTime != 0) {
+		if (m_fetchOwnerTime != m_timeOwned) {
+			m_fetchChanged = true;
+		}
+		m_timeOwned = m_fetchOwnerTime;
+	}
+	else if (m_fetchChanged || m_timeOwned == 0) {
+		m_timeOwned = m_fetchTime;
+	}
+
+	LOG((CLOG_DEBUG "fetched clipboard %d%s", m_id, m_fetchChanged ? "" : " (unchanged)"));
+	m_fetchState   = kFetchIdle;
+	m_fetchFormats = 0;
+	if (m_fetchChanged) {
+		m_fetched = true;
+	}
+}
+
+void
+XWindowsClipboard::abortFetch()
+{
+	if (m_fetchState != kFetchIdle) {
+		LOG((CLOG_DEBUG1 "abort fetch of clipboard %d", m_id));
+		delete m_fetch;
+		m_fetch        = NULL;
+		m_fetchState   = kFetchIdle;
+		m_fetchFormats = 0;
 	}
 }
 
@@ -797,8 +1137,7 @@ XWindowsClipboard::motifFillCache()
 
 		// add to clipboard and note we've done it
 		IClipboard::EFormat format = converter->getFormat();
-		m_data[format]  = converter->toIClipboard(targetData);
-		m_added[format] = true;
+		setFetchedFormat(format, converter->toIClipboard(targetData));
 		LOG((CLOG_DEBUG "added format %d for target %s", format, XWindowsUtil::atomToString(m_display, target).c_str()));
 	}
 }
@@ -807,11 +1146,11 @@ bool
 XWindowsClipboard::motifGetSelection(const MotifClipFormat* format,
 							Atom* actualTarget, String* data) const
 {
-	// if the current clipboard owner and the owner indicated by the
-	// motif clip header are the same then transfer via a property on
-	// the root window, otherwise transfer as a normal ICCCM client.
+	// the data is only on the root window if the current clipboard
+	// owner and the owner indicated by the motif clip header are the
+	// same.  otherwise the caller must fetch as a normal ICCCM client.
 	if (!motifOwnsClipboard()) {
-		return icccmGetSelection(format->m_type, actualTarget, data);
+		return false;
 	}
 
 	// use motif way
@@ -828,12 +1167,6 @@ XWindowsClipboard::motifGetSelection(const MotifClipFormat* format,
 								actualTarget, NULL, False);
 }
 
-IClipboard::Time
-XWindowsClipboard::motifGetTime() const
-{
-	return icccmGetTime();
-}
-
 bool
 XWindowsClipboard::insertMultipleReply(Window requestor,
 				::Time time, Atom property)
@@ -879,7 +1212,7 @@ XWindowsClipboard::insertMultipleReply(Window requestor,
 
 	// add reply for MULTIPLE request
 	insertReply(new Reply(requestor, m_atomMultiple,
-								time, property, String(), None, 32));
+								time, property, NULL, None, 32));
 
 	return true;
 }
@@ -1002,13 +1335,15 @@ XWindowsClipboard::sendReply(Reply* reply)
 		LOG((CLOG_DEBUG1 "clipboard: setting property on 0x%08x,%d,%d", reply->m_requestor, reply->m_target, reply->m_property));
 
 		// send using INCR if already sending incrementally or if reply
-		// is too large, otherwise just send it.
-		const UInt32 maxRequestSize = 3 * XMaxRequestSize(m_display);
-		const bool useINCR = (reply->m_data.size() > maxRequestSize);
+		// is too large, otherwise just send it.  use the biggest
+		// property the server will take so there are few pieces.
+		const UInt32 maxRequestSize =
+								XWindowsUtil::getMaxPropertySize(m_display);
+		const bool useINCR = (reply->getSize() > maxRequestSize);
 
 		// send INCR reply if incremental and we haven't replied yet
 		if (useINCR && !reply->m_replied) {
-			UInt32 size = reply->m_data.size();
+			UInt32 size = reply->getSize();
 			if (!XWindowsUtil::setWindowProperty(m_display,
 								reply->m_requestor, reply->m_property,
 								&size, 4, m_atomINCR, 32)) {
@@ -1019,14 +1354,16 @@ XWindowsClipboard::sendReply(Reply* reply)
 		// send more INCR reply or entire non-incremental reply
 		else {
 			// how much more data should we send?
-			UInt32 size = reply->m_data.size() - reply->m_ptr;
+			UInt32 size = reply->getSize() - reply->m_ptr;
 			if (size > maxRequestSize)
 				size = maxRequestSize;
 
-			// send it
+			// send it.  a MULTIPLE reply has no data of its own.
+			const char* data = (reply->m_data == NULL) ? "" :
+								reply->m_data->get().data();
 			if (!XWindowsUtil::setWindowProperty(m_display,
 								reply->m_requestor, reply->m_property,
-								reply->m_data.data() + reply->m_ptr,
+								data + reply->m_ptr,
 								size,
 								reply->m_type, reply->m_format)) {
 				failed = true;
@@ -1182,7 +1519,6 @@ bool
 XWindowsClipboard::wasOwnedAtTime(::Time time) const
 {
 	// not owned if we've never owned the selection
-	checkCache();
 	if (m_timeOwned == 0) {
 		return false;
 	}
@@ -1227,8 +1563,9 @@ XWindowsClipboard::getTargetsData(String& data, int* format) const
 								index != m_converters.end(); ++index) {
 		IXWindowsClipboardConverter* converter = *index;
 
-		// skip formats we don't have
-		if (m_added[converter->getFormat()]) {
+		// skip formats we don't have or haven't promised
+		if (m_added[converter->getFormat()] ||
+			m_available[converter->getFormat()]) {
 			XWindowsUtil::appendAtomData(data, converter->getAtom());
 		}
 	}
@@ -1242,12 +1579,57 @@ XWindowsClipboard::getTimestampData(String& data, int* format) const
 {
 	assert(format != NULL);
 
-	checkCache();
 	XWindowsUtil::appendTimeData(data, m_timeOwned);
 	*format = 32;
 	return m_atomInteger;
 }
 
+XWindowsClipboard::ReplyData*
+XWindowsClipboard::getConvertedData(IXWindowsClipboardConverter* converter)
+{
+	// every requestor of a target gets the same bytes until the data
+	// changes so only convert once.  a large image may be asked for
+	// by several requestors or pasted many times.
+	Atom target = converter->getAtom();
+	ConversionCache::iterator index = m_conversions.find(target);
+	if (index != m_conversions.end()) {
+		++m_conversionHits;
+		LOG((CLOG_DEBUG2 "using converted data for target %s (%d hits)", XWindowsUtil::atomToString(m_display, target).c_str(), m_conversionHits));
+		index->second->ref();
+		return index->second;
+	}
+
+	String data;
+	try {
+		data = converter->fromIClipboard(m_data[converter->getFormat()]);
+	}
+	catch (...) {
+		// ignore -- cannot convert
+		return NULL;
+	}
+
+	++m_conversionMisses;
+	ReplyData* replyData = ReplyData::adopt(data);
+	replyData->ref();
+	m_conversions.insert(std::make_pair(target, replyData));
+	return replyData;
+}
+
+void
+XWindowsClipboard::clearConversions()
+{
+	if (m_conversionHits != 0 || m_conversionMisses != 0) {
+		LOG((CLOG_DEBUG "clipboard %d conversions: %d hits, %d misses", m_id, m_conversionHits, m_conversionMisses));
+	}
+	for (ConversionCache::iterator index = m_conversions.begin();
+								index != m_conversions.end(); ++index) {
+		index->second->unref();
+	}
+	m_conversions.clear();
+	m_conversionHits   = 0;
+	m_conversionMisses = 0;
+}
+
 
 //
 // XWindowsClipboard::CICCCMGetClipboard
@@ -1258,12 +1640,14 @@ XWindowsClipboard::CICCCMGetClipboard::CICCCMGetClipboard(
 	m_requestor(requestor),
 	m_time(time),
 	m_property(property),
+	m_selection(None),
 	m_incr(false),
 	m_failed(false),
 	m_done(false),
 	m_reading(false),
-	m_data(NULL),
-	m_actualTarget(NULL),
+	m_lastProgress(0.0),
+	m_data(),
+	m_actualTarget(None),
 	m_error(false)
 {
 	// do nothing
@@ -1274,101 +1658,73 @@ XWindowsClipboard::CICCCMGetClipboard::~CICCCMGetClipboard()
 	// do nothing
 }
 
-bool
-XWindowsClipboard::CICCCMGetClipboard::readClipboard(Display* display,
-				Atom selection, Atom target, Atom* actualTarget, String* data)
+void
+XWindowsClipboard::CICCCMGetClipboard::start(Display* display,
+				Atom selection, Atom target)
 {
-	assert(actualTarget != NULL);
-	assert(data         != NULL);
-
 	LOG((CLOG_DEBUG1 "request selection=%s, target=%s, window=%x", XWindowsUtil::atomToString(display, selection).c_str(), XWindowsUtil::atomToString(display, target).c_str(), m_requestor));
 
-	m_atomNone = XInternAtom(display, "NONE", False);
-	m_atomIncr = XInternAtom(display, "INCR", False);
-
-	// save output pointers
-	m_actualTarget = actualTarget;
-	m_data         = data;
-
-	// assume failure
-	*m_actualTarget = None;
-	*m_data         = "";
+	m_atomNone  = XInternAtom(display, "NONE", False);
+	m_atomIncr  = XInternAtom(display, "INCR", False);
+	m_selection = selection;
 
 	// delete target property
 	XDeleteProperty(display, m_requestor, m_property);
 
-	// select window for property changes
+	// select window for property changes.  we leave the mask alone
+	// afterwards since the other selection may be fetching too.
 	XWindowAttributes attr;
 	XGetWindowAttributes(display, m_requestor, &attr);
 	XSelectInput(display, m_requestor,
 								attr.your_event_mask | PropertyChangeMask);
 
-	// request data conversion
+	// request data conversion.  the reply arrives with the other
+	// events on the display.
 	XConvertSelection(display, selection, target,
 								m_property, m_requestor, m_time);
+	XFlush(display);
 
-	// synchronize with server before we start following timeout countdown
-	XSync(display, False);
-
-	// Xlib inexplicably omits the ability to wait for an event with
-	// a timeout.  (it's inexplicable because there's no portable way
-	// to do it.)  we'll poll until we have what we're looking for or
-	// a timeout expires.  we use a timeout so we don't get locked up
-	// by badly behaved selection owners.
-	XEvent xevent;
-	std::vector<XEvent> events;
-	Stopwatch timeout(true);
-	static const double s_timeout = 0.25;	// FIXME -- is this too short?
-	bool noWait = false;
-	while (!m_done && !m_failed) {
-		// fail if timeout has expired
-		if (timeout.getTime() >= s_timeout) {
-			m_failed = true;
-			break;
-		}
-
-		// process events if any otherwise sleep
-		if (noWait || XPending(display) > 0) {
-			while (!m_done && !m_failed && (noWait || XPending(display) > 0)) {
-				XNextEvent(display, &xevent);
-				if (!processEvent(display, &xevent)) {
-					// not processed so save it
-					events.push_back(xevent);
-				}
-				else {
-					// reset timer since we've made some progress
-					timeout.reset();
-
-					// don't sleep anymore, just block waiting for events.
-					// we're assuming here that the clipboard owner will
-					// complete the protocol correctly.  if we continue to
-					// sleep we'll get very bad performance.
-					noWait = true;
-				}
-			}
-		}
-		else {
-			ARCH->sleep(0.01);
-		}
-	}
+	// start the timeout countdown
+	m_lastProgress = ARCH->monotonicTime();
+}
 
-	// put unprocessed events back
-	for (UInt32 i = events.size(); i > 0; --i) {
-		XPutBackEvent(display, &events[i - 1]);
+bool
+XWindowsClipboard::CICCCMGetClipboard::checkTimeout()
+{
+	// we use a timeout so we don't wait forever on badly behaved
+	// selection owners.  since we don't block while we wait the
+	// timeout can be generous.
+	static const double s_timeout = 1.0;
+	if (!m_done && !m_failed &&
+		ARCH->monotonicTime() - m_lastProgress >= s_timeout) {
+		LOG((CLOG_DEBUG1 "request timed out"));
+		m_failed = true;
+		return true;
 	}
+	return false;
+}
 
-	// restore mask
-	XSelectInput(display, m_requestor, attr.your_event_mask);
+bool
+XWindowsClipboard::CICCCMGetClipboard::isDone() const
+{
+	return (m_done || m_failed);
+}
 
-	// return success or failure
-	LOG((CLOG_DEBUG1 "request %s", m_failed ? "failed" : "succeeded"));
-	return !m_failed;
+bool
+XWindowsClipboard::CICCCMGetClipboard::isSuccess() const
+{
+	return (m_done && !m_failed);
 }
 
 bool
 XWindowsClipboard::CICCCMGetClipboard::processEvent(
 				Display* display, XEvent* xevent)
 {
+	// ignore events after we're finished
+	if (m_done || m_failed) {
+		return false;
+	}
+
 	// process event
 	switch (xevent->type) {
 	case DestroyNotify:
@@ -1381,10 +1737,12 @@ XWindowsClipboard::CICCCMGetClipboard::processEvent(
 		return false;
 
 	case SelectionNotify:
-		if (xevent->xselection.requestor == m_requestor) {
+		if (xevent->xselection.requestor == m_requestor &&
+			xevent->xselection.selection == m_selection) {
 			// done if we can't convert
 			if (xevent->xselection.property == None ||
 				xevent->xselection.property == m_atomNone) {
+				LOG((CLOG_DEBUG1 "request failed, can't convert"));
 				m_done = true;
 				return true;
 			}
@@ -1419,11 +1777,14 @@ XWindowsClipboard::CICCCMGetClipboard::processEvent(
 		return false;
 	}
 
+	// reset timer since we've made some progress
+	m_lastProgress = ARCH->monotonicTime();
+
 	// get the data from the property
 	Atom target;
-	const String::size_type oldSize = m_data->size();
+	const String::size_type oldSize = m_data.size();
 	if (!XWindowsUtil::getWindowProperty(display, m_requestor,
-								m_property, m_data, &target, NULL, True)) {
+								m_property, &m_data, &target, NULL, True)) {
 		// unable to read property
 		m_failed = true;
 		return true;
@@ -1437,7 +1798,7 @@ XWindowsClipboard::CICCCMGetClipboard::processEvent(
 			m_failed = true;
 			m_error  = true;
 		}
-		else if (m_data->size() == oldSize) {
+		else if (m_data.size() == oldSize) {
 			m_failed = true;
 			m_error  = true;
 		}
@@ -1445,7 +1806,7 @@ XWindowsClipboard::CICCCMGetClipboard::processEvent(
 			m_incr   = true;
 
 			// discard INCR data
-			*m_data = "";
+			m_data = "";
 		}
 	}
 
@@ -1454,12 +1815,12 @@ XWindowsClipboard::CICCCMGetClipboard::processEvent(
 		// if first incremental chunk then save target
 		if (oldSize == 0) {
 			LOG((CLOG_DEBUG1 "  INCR first chunk, target %s", XWindowsUtil::atomToString(display, target).c_str()));
-			*m_actualTarget = target;
+			m_actualTarget = target;
 		}
 
 		// secondary chunks must have the same target
 		else {
-			if (target != *m_actualTarget) {
+			if (target != m_actualTarget) {
 				LOG((CLOG_WARN "  INCR target mismatch"));
 				m_failed = true;
 				m_error  = true;
@@ -1467,8 +1828,8 @@ XWindowsClipboard::CICCCMGetClipboard::processEvent(
 		}
 
 		// note if this is the final chunk
-		if (m_data->size() == oldSize) {
-			LOG((CLOG_DEBUG1 "  INCR final chunk: %d bytes total", m_data->size()));
+		if (m_data.size() == oldSize) {
+			LOG((CLOG_DEBUG1 "  INCR final chunk: %d bytes total", m_data.size()));
 			m_done = true;
 		}
 	}
@@ -1476,12 +1837,13 @@ XWindowsClipboard::CICCCMGetClipboard::processEvent(
 	// not incremental;  save the target.
 	else {
 		LOG((CLOG_DEBUG1 "  target %s", XWindowsUtil::atomToString(display, target).c_str()));
-		*m_actualTarget = target;
-		m_done          = true;
+		m_actualTarget = target;
+		m_done         = true;
 	}
 
 	// this event has been processed
-	LOGC(!m_incr, (CLOG_DEBUG1 "  got data, %d bytes", m_data->size()));
+	LOGC(!m_incr, (CLOG_DEBUG1 "  got data, %d bytes", m_data.size()));
+	LOGC(isDone(), (CLOG_DEBUG1 "request %s", m_failed ? "failed" : "succeeded"));
 	return true;
 }
 
@@ -1497,7 +1859,7 @@ XWindowsClipboard::Reply::Reply(Window requestor, Atom target, ::Time time) :
 	m_property(None),
 	m_replied(false),
 	m_done(false),
-	m_data(),
+	m_data(NULL),
 	m_type(None),
 	m_format(32),
 	m_ptr(0)
@@ -1506,7 +1868,7 @@ XWindowsClipboard::Reply::Reply(Window requestor, Atom target, ::Time time) :
 }
 
 XWindowsClipboard::Reply::Reply(Window requestor, Atom target, ::Time time,
-				Atom property, const String& data, Atom type, int format) :
+				Atom property, ReplyData* data, Atom type, int format) :
 	m_requestor(requestor),
 	m_target(target),
 	m_time(time),
@@ -1520,3 +1882,56 @@ XWindowsClipboard::Reply::Reply(Window requestor, Atom target, ::Time time,
 {
 	// do nothing
 }
+
+XWindowsClipboard::Reply::~Reply()
+{
+	if (m_data != NULL) {
+		m_data->unref();
+	}
+}
+
+UInt32
+XWindowsClipboard::Reply::getSize() const
+{
+	return (m_data == NULL) ? 0 : static_cast<UInt32>(m_data->get().size());
+}
+
+
+//
+// XWindowsClipboard::ReplyData
+//
+
+XWindowsClipboard::ReplyData::ReplyData() :
+	m_data(),
+	m_refCount(1)
+{
+	// do nothing
+}
+
+XWindowsClipboard::ReplyData::~ReplyData()
+{
+	// do nothing
+}
+
+XWindowsClipboard::ReplyData*
+XWindowsClipboard::ReplyData::adopt(String& data)
+{
+	ReplyData* replyData = new ReplyData;
+	replyData->m_data.swap(data);
+	return replyData;
+}
+
+void
+XWindowsClipboard::ReplyData::ref()
+{
+	++m_refCount;
+}
+
+void
+XWindowsClipboard::ReplyData::unref()
+{
+	assert(m_refCount > 0);
+	if (--m_refCount == 0) {
+		delete this;
+	}
+}
@@ -86,6 +86,88 @@ public:
 	*/
 	Atom				getSelection() const;
 
+	//! Promise a format
+	/*!
+	Marks \c format as available without supplying its data.  Requests
+	for the format are held until the data is add()ed.  The clipboard
+	must be open and owned (see empty()).
+	*/
+	void				promise(EFormat format);
+
+	//! Get and clear requested formats
+	/*!
+	Returns the promised formats (as a mask of \c 1 << EFormat) that
+	requestors have asked for since the last call, then clears the mask.
+	*/
+	UInt32				takeRequestedFormats();
+
+	//! Test if format is promised
+	/*!
+	Returns true iff we own the clipboard and \c format was promised
+	but hasn't been added yet.
+	*/
+	bool				isPromised(EFormat format) const;
+
+	//! Fetch selection
+	/*!
+	Starts reading the selection's timestamp, its list of formats and
+	the data of \c formats (a mask of \c 1 << EFormat) that aren't cached
+	yet, without waiting for the selection owner.  X events for the
+	fetch must be passed to processFetchEvent().  Formats asked for
+	while a fetch is running are added to it.  Does nothing if we own
+	the selection.
+	*/
+	void				fetch(::Time time, UInt32 formats);
+
+	//! Process fetch event
+	/*!
+	Continues the running fetch with \c xevent.  Returns true iff the
+	event was for the fetch.
+	*/
+	bool				processFetchEvent(XEvent* xevent);
+
+	//! Check fetch timeout
+	/*!
+	Gives up on the current conversion of the running fetch if the
+	selection owner hasn't made progress for a while.  Should be called
+	periodically while isFetching().
+	*/
+	void				checkFetch();
+
+	//! Get and clear fetched flag
+	/*!
+	Returns true iff a fetch has finished and changed the cached
+	selection since the last call, then clears the flag.
+	*/
+	bool				takeFetched();
+
+	//! Test if fetching
+	/*!
+	Returns true iff a fetch is running.
+	*/
+	bool				isFetching() const;
+
+	//! Test if cached
+	/*!
+	Returns true iff the list of formats is known, i.e. we own the
+	selection or a fetch has read it since the selection was lost.
+	*/
+	bool				isCached() const;
+
+	//! Test if format data is cached
+	/*!
+	Returns true iff the data of \c format is cached.  has() is also
+	true for formats that are available but haven't been fetched.
+	*/
+	bool				isCached(EFormat format) const;
+
+	//! Get conversion cache hits
+	/*!
+	Returns the number of requests, since the data last changed, that
+	were answered with data already converted for an earlier request.
+	*/
+	UInt32				getConversionHits() const;
+
 	// IClipboard overrides
 	virtual bool		empty();
 	virtual void		add(EFormat, const String& data);
@@ -118,43 +200,76 @@ private:
 							Window requestor, Atom target,
 							::Time time, Atom property);
 
-	// if not already checked then see if the cache is stale and, if so,
-	// clear it.  this has the side effect of updating m_timeOwned.
-	void				checkCache() const;
+	// hold a request for a promised format that hasn't been added yet.
+	// returns false if the request can be answered right away.
+	bool				holdRequest(Window requestor, Atom target,
+							::Time time, Atom property);
+
+	// answer held requests whose format has been added.  iff fail is
+	// true then also answer the remaining held requests with failure.
+	void				answerHeldRequests(bool fail);
 
 	// clear the cache, resetting the cached flag and the added flag for
 	// each format.
 	void				clearCache() const;
 	void				doClearCache();
 
-	// cache all formats of the selection
-	void				fillCache() const;
-	void				doFillCache();
+	// get the formats that were added or are available as a mask
+	UInt32				getCachedFormats() const;
+
+	// save fetched data, noting if it differs from what we had
+	void				setFetchedFormat(EFormat, const String& data);
+
+	// forget a format that isn't on the selection
+	void				dropFormat(EFormat);
+
+	// fetch steps.  each starts a conversion or ends the fetch.
+	enum EFetchState { kFetchIdle, kFetchTime, kFetchTargets, kFetchFormat };
+	void				startConversion(EFetchState, Atom target);
+	void				endConversion();
+	void				fetchedTime(Atom target, const String& data);
+	void				fetchedTargets(Atom target, String& data);
+	void				fetchedFormat(Atom target, const String& data);
+	void				fetchNextFormat();
+	void				endFetch();
+	void				abortFetch();
 
 	//
 	// helper classes
 	//
 
-	// read an ICCCM conforming selection
+	// read an ICCCM conforming selection.  the conversion doesn't wait
+	// for the selection owner;  it's driven by the events passed to
+	// processEvent().
 	class CICCCMGetClipboard {
 	public:
 		CICCCMGetClipboard(Window requestor, Time time, Atom property);
 		~CICCCMGetClipboard();
 
-		// convert the given selection to the given type.  returns
-		// true iff the conversion was successful or the conversion
-		// cannot be performed (in which case *actualTarget == None).
-		bool			readClipboard(Display* display,
-							Atom selection, Atom target,
-							Atom* actualTarget, String* data);
+		// start converting the given selection to the given type
+		void			start(Display* display,
+							Atom selection, Atom target);
 
-	private:
+		// process an event.  returns true iff the event was for this
+		// conversion.
 		bool			processEvent(Display* display, XEvent* event);
 
+		// fail the conversion if the selection owner hasn't made any
+		// progress for too long.  returns true iff it failed.
+		bool			checkTimeout();
+
+		// true iff the conversion has finished or failed
+		bool			isDone() const;
+
+		// true iff the conversion was successful or the conversion
+		// cannot be performed (in which case m_actualTarget == None).
+		bool			isSuccess() const;
+
 	private:
 		Window			m_requestor;
 		Time			m_time;
 		Atom			m_property;
+		Atom			m_selection;
 		bool			m_incr;
 		bool			m_failed;
 		bool			m_done;
@@ -166,14 +281,17 @@ private:
 		// true iff we've received the selection notify
 		bool			m_reading;
 
+		// time of the last progress, for the timeout
+		double			m_lastProgress;
+
+	public:
 		// the converted selection data
-		String*		m_data;
+		String			m_data;
 
 		// the actual type of the data.  if this is None then the
 		// selection owner cannot convert to the requested type.
-		Atom*			m_actualTarget;
+		Atom			m_actualTarget;
 
-	public:
 		// true iff the selection owner didn't follow ICCCM conventions
 		bool			m_error;
 	};
@@ -218,12 +336,41 @@ private:
 		SInt32			m_pad3[4];
 	};
 
+	// converted data to send to requestors.  it's never changed once
+	// made so every reply for the same target can share it.  it's
+	// deleted when the last reference is released.
+	class ReplyData {
+	public:
+		// takes the contents of data, leaving it empty
+		static ReplyData*	adopt(String& data);
+
+		void			ref();
+		void			unref();
+
+		const String&	get() const { return m_data; }
+
+	private:
+		ReplyData();
+		ReplyData(const ReplyData&);
+		~ReplyData();
+		ReplyData&		operator=(const ReplyData&);
+
+	private:
+		String			m_data;
+		UInt32			m_refCount;
+	};
+	typedef std::map<Atom, ReplyData*> ConversionCache;
+
 	// stores data needed to respond to a selection request
 	class Reply {
 	public:
 		Reply(Window, Atom target, ::Time);
 		Reply(Window, Atom target, ::Time, Atom property,
-							const String& data, Atom type, int format);
+							ReplyData* data, Atom type, int format);
+		~Reply();
+
+		// the number of bytes to send
+		UInt32			getSize() const;
 
 	public:
 		// information about the request
@@ -238,23 +385,31 @@ private:
 		// true iff the reply has sent its last message
 		bool			m_done;
 
-		// the data to send and its type and format
-		String			m_data;
+		// the data to send (a reference) and its type and format
+		ReplyData*		m_data;
 		Atom			m_type;
 		int				m_format;
 
 		// index of next byte in m_data to send
 		UInt32			m_ptr;
+
+	private:
+		Reply(const Reply&);
+		Reply&			operator=(const Reply&);
 	};
 	typedef std::list<Reply*> ReplyList;
 	typedef std::map<Window, ReplyList> ReplyMap;
 	typedef std::map<Window, long> ReplyEventMask;
 
-	// ICCCM interoperability methods
-	void				icccmFillCache();
-	bool				icccmGetSelection(Atom target,
-							Atom* actualTarget, String* data) const;
-	Time				icccmGetTime() const;
+	// a request waiting for a promised format
+	class HeldRequest {
+	public:
+		Window			m_requestor;
+		Atom			m_target;
+		::Time			m_time;
+		Atom			m_property;
+	};
+	typedef std::list<HeldRequest> HeldRequestList;
 
 	// motif interoperability methods
 	bool				motifLockClipboard() const;
@@ -263,7 +418,6 @@ private:
 	void				motifFillCache();
 	bool				motifGetSelection(const MotifClipFormat*,
 							Atom* actualTarget, String* data) const;
-	Time				motifGetTime() const;
 
 	// reply methods
 	bool				insertMultipleReply(Window, ::Time, Atom);
@@ -281,6 +435,8 @@ private:
 	// data conversion methods
 	Atom				getTargetsData(String&, int* format) const;
 	Atom				getTimestampData(String&, int* format) const;
+	ReplyData*			getConvertedData(IXWindowsClipboardConverter*);
+	void				clearConversions();
 
 private:
 	typedef std::vector<IXWindowsClipboardConverter*> ConverterList;
@@ -299,16 +455,44 @@ private:
 	mutable bool		m_motif;
 
 	// the added/cached clipboard data
-	mutable bool		m_checkCache;
 	bool				m_cached;
 	Time				m_cacheTime;
 	bool				m_added[kNumFormats];
 	String				m_data[kNumFormats];
 
+	// formats known to be on the clipboard whose data isn't cached yet
+	bool				m_available[kNumFormats];
+
+	// the running fetch.  m_fetch is the current conversion, the
+	// formats are a mask of formats still wanted and the tried mask
+	// has a bit for each converter that's been asked for.
+	CICCCMGetClipboard*	m_fetch;
+	EFetchState			m_fetchState;
+	::Time				m_fetchTime;
+	::Time				m_fetchOwnerTime;
+	UInt32				m_fetchFormats;
+	UInt32				m_fetchOldFormats;
+	UInt32				m_fetchTried;
+	UInt32				m_fetchConverter;
+	bool				m_fetchChanged;
+
+	// true iff a fetch changed the cache since takeFetched()
+	bool				m_fetched;
+
+	// data converted for requestors, by target, while we own the
+	// clipboard and the number of requests that found it here or not
+	ConversionCache		m_conversions;
+	UInt32				m_conversionHits;
+	UInt32				m_conversionMisses;
+
 	// conversion request replies
 	ReplyMap			m_replies;
 	ReplyEventMask		m_eventMasks;
 
+	// requests for promised formats and the formats they asked for
+	HeldRequestList		m_heldRequests;
+	UInt32				m_requestedFormats;
+
 	// clipboard format converters
 	ConverterList		m_converters;
 
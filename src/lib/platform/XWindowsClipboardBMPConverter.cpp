@@ -18,6 +18,8 @@
 
 #include "platform/XWindowsClipboardBMPConverter.h"
 
+#include "synergy/PixelKernels.h"
+
 // BMP file header structure
 struct CBMPHeader {
 public:
@@ -134,10 +136,15 @@ XWindowsClipboardBMPConverter::toIClipboard(const String& bmp) const
 	UInt32 offset = fromLEU32(rawBMPHeader + 10);
 
 	// construct BMP
+	String dib;
 	if (offset == 14 + 40) {
-		return bmp.substr(14);
+		dib = bmp.substr(14);
 	}
 	else {
-		return bmp.substr(14, 40) + bmp.substr(offset, bmp.size() - offset);
+		dib = bmp.substr(14, 40) + bmp.substr(offset, bmp.size() - offset);
 	}
+
+	// we keep bitmaps bottom-up
+	PixelKernels::makeBottomUp(dib);
+	return dib;
 }
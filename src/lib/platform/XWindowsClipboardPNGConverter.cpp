@@ -0,0 +1,74 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "platform/XWindowsClipboardPNGConverter.h"
+
+// every PNG file starts with this
+static const char		s_pngSignature[] = "\x89PNG\r\n\x1a\n";
+static const UInt32		s_pngSignatureSize = 8;
+
+//
+// XWindowsClipboardPNGConverter
+//
+
+XWindowsClipboardPNGConverter::XWindowsClipboardPNGConverter(
+				Display* display) :
+	m_atom(XInternAtom(display, "image/png", False))
+{
+	// do nothing
+}
+
+XWindowsClipboardPNGConverter::~XWindowsClipboardPNGConverter()
+{
+	// do nothing
+}
+
+IClipboard::EFormat
+XWindowsClipboardPNGConverter::getFormat() const
+{
+	return IClipboard::kPNG;
+}
+
+Atom
+XWindowsClipboardPNGConverter::getAtom() const
+{
+	return m_atom;
+}
+
+int
+XWindowsClipboardPNGConverter::getDataSize() const
+{
+	return 8;
+}
+
+String
+XWindowsClipboardPNGConverter::fromIClipboard(const String& png) const
+{
+	return png;
+}
+
+String
+XWindowsClipboardPNGConverter::toIClipboard(const String& png) const
+{
+	// check the signature so we never pass on something else
+	if (png.size() <= s_pngSignatureSize ||
+		png.compare(0, s_pngSignatureSize,
+					s_pngSignature, s_pngSignatureSize) != 0) {
+		return String();
+	}
+	return png;
+}
@@ -113,6 +113,7 @@ XWindowsScreen::XWindowsScreen(
 	m_ic(NULL),
 	m_lastKeycode(0),
 	m_sequenceNumber(0),
+	m_clipboardFetchTimer(NULL),
 	m_screensaver(NULL),
 	m_screensaverNotify(false),
 	m_xtestIsXineramaUnaware(true),
@@ -203,6 +204,10 @@ XWindowsScreen::~XWindowsScreen()
 
 	m_events->adoptBuffer(NULL);
 	m_events->removeHandler(Event::kSystem, m_events->getSystemTarget());
+	if (m_clipboardFetchTimer != NULL) {
+		m_events->removeHandler(Event::kTimer, m_clipboardFetchTimer);
+		m_events->deleteTimer(m_clipboardFetchTimer);
+	}
 	for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
 		delete m_clipboard[id];
 	}
@@ -409,6 +414,68 @@ XWindowsScreen::setClipboard(ClipboardID id, const IClipboard* clipboard)
 	}
 }
 
+bool
+XWindowsScreen::offerClipboard(ClipboardID id,
+				const IClipboard* clipboard, UInt32 formats)
+{
+	// fail if we don't have the requested clipboard
+	if (m_clipboard[id] == NULL) {
+		return false;
+	}
+
+	// get the actual time.  ICCCM does not allow CurrentTime.
+	Time timestamp = XWindowsUtil::getCurrentTime(
+								m_display, m_clipboard[id]->getWindow());
+
+	// take ownership, save the data we have and promise the rest
+	XWindowsClipboard* dst = m_clipboard[id];
+	if (!dst->open(timestamp)) {
+		return false;
+	}
+	bool success = false;
+	if (dst->empty()) {
+		if (clipboard != NULL && clipboard->open(timestamp)) {
+			for (SInt32 format = 0;
+							format != IClipboard::kNumFormats; ++format) {
+				IClipboard::EFormat eFormat = (IClipboard::EFormat)format;
+				if (clipboard->has(eFormat)) {
+					dst->add(eFormat, clipboard->get(eFormat));
+				}
+			}
+			clipboard->close();
+		}
+		for (SInt32 format = 0; format != IClipboard::kNumFormats; ++format) {
+			IClipboard::EFormat eFormat = (IClipboard::EFormat)format;
+			if ((formats & (1u << format)) != 0 && !dst->has(eFormat)) {
+				dst->promise(eFormat);
+			}
+		}
+		success = true;
+	}
+	dst->close();
+	return success;
+}
+
+void
+XWindowsScreen::setClipboardFormat(ClipboardID id,
+				IClipboard::EFormat format, const String& data)
+{
+	// fail if we don't have the requested clipboard
+	if (m_clipboard[id] == NULL) {
+		return;
+	}
+
+	// ignore data we didn't promise or that's for an old clipboard
+	Time timestamp = XWindowsUtil::getCurrentTime(
+								m_display, m_clipboard[id]->getWindow());
+	if (m_clipboard[id]->open(timestamp)) {
+		if (m_clipboard[id]->isPromised(format)) {
+			m_clipboard[id]->add(format, data);
+		}
+		m_clipboard[id]->close();
+	}
+}
+
 void
 XWindowsScreen::checkClipboards()
 {
@@ -497,10 +564,77 @@ XWindowsScreen::getClipboard(ClipboardID id, IClipboard* clipboard) const
 	Time timestamp = XWindowsUtil::getCurrentTime(
 								m_display, m_clipboard[id]->getWindow());
 
+	// look for new data without waiting for the selection owner.  we
+	// copy what we have now and send clipboardChanged if that changes.
+	const_cast<XWindowsScreen*>(this)->fetchClipboard(id, timestamp,
+								(1u << IClipboard::kNumFormats) - 1);
+	if (!m_clipboard[id]->isCached()) {
+		return false;
+	}
+
 	// copy the clipboard
 	return Clipboard::copy(clipboard, m_clipboard[id], timestamp);
 }
 
+bool
+XWindowsScreen::getClipboardFormats(ClipboardID id,
+				UInt32& formats, IClipboard::Time& time) const
+{
+	// fail if we don't have the requested clipboard
+	if (m_clipboard[id] == NULL) {
+		return false;
+	}
+
+	// get the actual time.  ICCCM does not allow CurrentTime.
+	Time timestamp = XWindowsUtil::getCurrentTime(
+								m_display, m_clipboard[id]->getWindow());
+
+	// look for a new list of formats in the background
+	const_cast<XWindowsScreen*>(this)->fetchClipboard(id, timestamp, 0);
+	const XWindowsClipboard* clipboard = m_clipboard[id];
+	if (!clipboard->isCached() || !clipboard->open(timestamp)) {
+		return false;
+	}
+	formats = 0;
+	for (SInt32 format = 0; format != IClipboard::kNumFormats; ++format) {
+		if (clipboard->has((IClipboard::EFormat)format)) {
+			formats |= (1u << format);
+		}
+	}
+	time = clipboard->getTime();
+	clipboard->close();
+	return true;
+}
+
+bool
+XWindowsScreen::getClipboardFormat(ClipboardID id,
+				IClipboard::EFormat format, String& data) const
+{
+	// fail if we don't have the requested clipboard
+	if (m_clipboard[id] == NULL) {
+		return false;
+	}
+
+	// get the actual time.  ICCCM does not allow CurrentTime.
+	Time timestamp = XWindowsUtil::getCurrentTime(
+								m_display, m_clipboard[id]->getWindow());
+
+	// fetch the data in the background if we don't have it yet.  the
+	// clipboardChanged event says when to ask again.
+	const_cast<XWindowsScreen*>(this)->fetchClipboard(id, timestamp,
+								1u << format);
+	const XWindowsClipboard* clipboard = m_clipboard[id];
+	if (!clipboard->open(timestamp)) {
+		return false;
+	}
+	bool result = clipboard->isCached(format);
+	if (result) {
+		data = clipboard->get(format);
+	}
+	clipboard->close();
+	return result;
+}
+
 void
 XWindowsScreen::getShape(SInt32& x, SInt32& y, SInt32& w, SInt32& h) const
 {
@@ -1331,10 +1465,13 @@ XWindowsScreen::handleSystemEvent(const Event& event, void*)
 		break;
 
 	case SelectionNotify:
-		// notification of selection transferred.  we shouldn't
-		// get this here because we handle them in the selection
-		// retrieval methods.  we'll just delete the property
-		// with the data (satisfying the usual ICCCM protocol).
+		// notification of selection transferred
+		if (processClipboardFetch(xevent)) {
+			return;
+		}
+
+		// not for us.  we'll just delete the property with the
+		// data (satisfying the usual ICCCM protocol).
 		if (xevent->xselection.property != None) {
 			XDeleteProperty(m_display,
 								xevent->xselection.requestor,
@@ -1354,12 +1491,30 @@ XWindowsScreen::handleSystemEvent(const Event& event, void*)
 								xevent->xselectionrequest.target,
 								xevent->xselectionrequest.time,
 								xevent->xselectionrequest.property);
+
+				// ask for promised formats the requestor wants
+				UInt32 formats = m_clipboard[id]->takeRequestedFormats();
+				if (formats != 0) {
+					ClipboardFormatsInfo* info =
+						(ClipboardFormatsInfo*)malloc(
+											sizeof(ClipboardFormatsInfo));
+					info->m_id             = id;
+					info->m_sequenceNumber = m_sequenceNumber;
+					info->m_formats        = formats;
+					sendEvent(m_events->forClipboard().
+									clipboardFormatsRequested(), info);
+				}
 				return;
 			}
 		}
 		break;
 
 	case PropertyNotify:
+		// new data for a selection we're fetching
+		if (processClipboardFetch(xevent)) {
+			return;
+		}
+
 		// property delete may be part of a selection conversion
 		if (xevent->xproperty.state == PropertyDelete) {
 			processClipboardRequest(xevent->xproperty.window,
@@ -1728,6 +1883,71 @@ XWindowsScreen::destroyClipboardRequest(Window requestor)
 	}
 }
 
+void
+XWindowsScreen::fetchClipboard(ClipboardID id, Time time, UInt32 formats)
+{
+	m_clipboard[id]->fetch(time, formats);
+
+	// watch for selection owners that don't answer
+	if (m_clipboard[id]->isFetching() && m_clipboardFetchTimer == NULL) {
+		m_clipboardFetchTimer = m_events->newTimer(0.1, NULL);
+		m_events->adoptHandler(Event::kTimer, m_clipboardFetchTimer,
+							new TMethodEventJob<XWindowsScreen>(this,
+								&XWindowsScreen::handleClipboardFetchTimer));
+	}
+
+	// some fetches (e.g. from motif) finish right away
+	finishClipboardFetches();
+}
+
+bool
+XWindowsScreen::processClipboardFetch(XEvent* xevent)
+{
+	// check every clipboard until one takes the event
+	for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
+		if (m_clipboard[id] != NULL &&
+			m_clipboard[id]->processFetchEvent(xevent)) {
+			finishClipboardFetches();
+			return true;
+		}
+	}
+	return false;
+}
+
+void
+XWindowsScreen::finishClipboardFetches()
+{
+	bool fetching = false;
+	for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
+		if (m_clipboard[id] == NULL) {
+			continue;
+		}
+		if (m_clipboard[id]->takeFetched()) {
+			sendClipboardEvent(m_events->forClipboard().clipboardChanged(), id);
+		}
+		if (m_clipboard[id]->isFetching()) {
+			fetching = true;
+		}
+	}
+
+	if (!fetching && m_clipboardFetchTimer != NULL) {
+		m_events->removeHandler(Event::kTimer, m_clipboardFetchTimer);
+		m_events->deleteTimer(m_clipboardFetchTimer);
+		m_clipboardFetchTimer = NULL;
+	}
+}
+
+void
+XWindowsScreen::handleClipboardFetchTimer(const Event&, void*)
+{
+	for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
+		if (m_clipboard[id] != NULL) {
+			m_clipboard[id]->checkFetch();
+		}
+	}
+	finishClipboardFetches();
+}
+
 void
 XWindowsScreen::onError()
 {
@@ -77,6 +77,10 @@ public:
 	virtual bool		leave();
 	virtual bool		setClipboard(ClipboardID, const IClipboard*);
 	virtual void		checkClipboards();
+	virtual bool		offerClipboard(ClipboardID,
+							const IClipboard*, UInt32 formats);
+	virtual void		setClipboardFormat(ClipboardID,
+							IClipboard::EFormat, const String& data);
 	virtual void		openScreensaver(bool notify);
 	virtual void		closeScreensaver();
 	virtual void		screensaver(bool activate);
@@ -84,6 +88,10 @@ public:
 	virtual void		setOptions(const OptionsList& options);
 	virtual void		setSequenceNumber(UInt32);
 	virtual bool		isPrimary() const;
+	virtual bool		getClipboardFormats(ClipboardID,
+							UInt32& formats, IClipboard::Time&) const;
+	virtual bool		getClipboardFormat(ClipboardID,
+							IClipboard::EFormat, String& data) const;
 
 protected:
 	// IPlatformScreen overrides
@@ -110,6 +118,19 @@ private:
 	// terminate a selection request
 	void				destroyClipboardRequest(Window window);
 
+	// start or extend a background fetch of the selection.  a
+	// clipboardChanged event is sent when it has something new.
+	void				fetchClipboard(ClipboardID, Time, UInt32 formats);
+
+	// continue a selection fetch.  returns true iff the event was
+	// for a fetch.
+	bool				processClipboardFetch(XEvent*);
+
+	// report finished selection fetches and stop the timeout timer
+	// when no fetch is running
+	void				finishClipboardFetches();
+	void				handleClipboardFetchTimer(const Event&, void*);
+
 	// X I/O error handler
 	void				onError();
 	static int			ioErrorHandler(Display*);
@@ -210,6 +231,7 @@ private:
 	// clipboards
 	XWindowsClipboard*	m_clipboard[kClipboardEnd];
 	UInt32				m_sequenceNumber;
+	EventQueueTimer*	m_clipboardFetchTimer;
 
 	// screen saver stuff
 	XWindowsScreenSaver*	m_screensaver;
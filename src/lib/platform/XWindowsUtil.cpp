@@ -1385,7 +1385,7 @@ XWindowsUtil::setWindowProperty(Display* display, Window window,
 				Atom property, const void* vdata, UInt32 size,
 				Atom type, SInt32 format)
 {
-	const UInt32 length       = 4 * XMaxRequestSize(display);
+	const UInt32 length       = getMaxPropertySize(display);
 	const unsigned char* data = reinterpret_cast<const unsigned char*>(vdata);
 	UInt32 datumSize    = static_cast<UInt32>(format / 8);
 	// format 32 on 64bit systems is 8 bytes not 4.
@@ -1426,6 +1426,21 @@ XWindowsUtil::setWindowProperty(Display* display, Window window,
 	return !error;
 }
 
+UInt32
+XWindowsUtil::getMaxPropertySize(Display* display)
+{
+	// request sizes are in 4 byte units.  XExtendedMaxRequestSize() is
+	// zero if the server doesn't do BIG-REQUESTS.  leave room for the
+	// ChangeProperty header (6 units plus 1 for a big request length)
+	// and keep a multiple of 8 bytes so 32 bit data on 64 bit systems
+	// isn't split.
+	long units = XExtendedMaxRequestSize(display);
+	if (units <= 0) {
+		units = XMaxRequestSize(display);
+	}
+	return static_cast<UInt32>(4 * (units - 8)) & ~static_cast<UInt32>(7);
+}
+
 Time
 XWindowsUtil::getCurrentTime(Display* display, Window window)
 {
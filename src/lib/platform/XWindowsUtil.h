@@ -57,6 +57,14 @@ public:
 							const void* data, UInt32 size,
 							Atom type, SInt32 format);
 
+	//! Get largest property size
+	/*!
+	Returns the largest number of bytes of property data that fit in a
+	single request to the server, using the BIG-REQUESTS extension if
+	the server supports it.
+	*/
+	static UInt32		getMaxPropertySize(Display*);
+
 	//! Get X server time
 	/*!
 	Returns the current X server time.
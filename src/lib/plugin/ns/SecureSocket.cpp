@@ -22,6 +22,8 @@
 #include "mt/Lock.h"
 #include "arch/XArch.h"
 #include "base/Log.h"
+#include "base/IEventQueue.h"
+#include "base/TMethodEventJob.h"
 
 #include <openssl/ssl.h>
 #include <openssl/err.h>
@@ -36,9 +38,24 @@
 
 #define MAX_ERROR_SIZE 65535
 
-// maxmium retry time limit set to 10s
-static const int s_maxRetry = 1000;
-static const float s_retryDelay = 0.01f;
+// give up on a handshake that hasn't completed after 10s
+static const double s_handshakeTimeout = 10.0;
+
+// session cache limits for the shared server context
+static const long s_sessionCacheSize = 1024;
+static const long s_sessionTimeout = 60 * 60 * 24;
+static const unsigned char s_sessionIdContext[] = "synergy";
+
+// prefer aead ciphers with forward secrecy, but keep the rest of the
+// high grade ciphers so older peers can still connect.
+static const char s_cipherList[] =
+	"ECDHE-RSA-AES128-GCM-SHA256:ECDHE-RSA-CHACHA20-POLY1305:"
+	"ECDHE-RSA-AES256-GCM-SHA384:HIGH:!aNULL:!eNULL:!MD5:!RC4:!3DES";
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+static const char s_cipherSuites[] =
+	"TLS_AES_128_GCM_SHA256:TLS_CHACHA20_POLY1305_SHA256:"
+	"TLS_AES_256_GCM_SHA384";
+#endif
 
 enum {
 	kMsgSize = 128
@@ -54,12 +71,35 @@ struct Ssl {
 	SSL*		m_ssl;
 };
 
+// one context per role is shared by every socket in the process, so
+// the server session cache and the client session survive reconnects.
+// contexts and the client session are only used on the multiplexer
+// thread once the socket has been created.
+static SSL_CTX* s_serverContext = NULL;
+static SSL_CTX* s_clientContext = NULL;
+static SSL_SESSION* s_clientSession = NULL;
+static String s_serverCertificate;
+
+static int
+saveClientSession(SSL*, SSL_SESSION* session)
+{
+	// keep the most recent session so the next connect can resume it
+	if (s_clientSession != NULL) {
+		SSL_SESSION_free(s_clientSession);
+	}
+	s_clientSession = session;
+	return 1;
+}
+
 SecureSocket::SecureSocket(
 		IEventQueue* events,
 		SocketMultiplexer* socketMultiplexer) :
 	TCPSocket(events, socketMultiplexer),
 	m_secureReady(false),
-	m_fatal(false)
+	m_fatal(false),
+	m_wantRead(false),
+	m_wantWrite(false),
+	m_handshakeTimer(NULL)
 {
 }
 
@@ -69,24 +109,30 @@ SecureSocket::SecureSocket(
 		ArchSocket socket) :
 	TCPSocket(events, socketMultiplexer, socket),
 	m_secureReady(false),
-	m_fatal(false)
+	m_fatal(false),
+	m_wantRead(false),
+	m_wantWrite(false),
+	m_handshakeTimer(NULL)
 {
 }
 
 SecureSocket::~SecureSocket()
 {
 	isFatal(true);
+
+	// stop the multiplexer from servicing this socket before the ssl
+	// state is freed.  removing the job waits for a running job to end.
+	setJob(NULL);
+	stopHandshakeTimer();
+
 	if (m_ssl->m_ssl != NULL) {
 		SSL_shutdown(m_ssl->m_ssl);
 
 		SSL_free(m_ssl->m_ssl);
 		m_ssl->m_ssl = NULL;
 	}
-	if (m_ssl->m_context != NULL) {
-		SSL_CTX_free(m_ssl->m_context);
-		m_ssl->m_context = NULL;
-	}
-	ARCH->sleep(1);
+	// the context is shared, see cleanupContexts()
+	m_ssl->m_context = NULL;
 	delete m_ssl;
 }
 
@@ -103,6 +149,7 @@ SecureSocket::close()
 void
 SecureSocket::secureConnect()
 {
+	startHandshakeTimer();
 	setJob(new TSocketMultiplexerMethodJob<SecureSocket>(
 			this, &SecureSocket::serviceConnect,
 			getSocket(), isReadable(), isWritable()));
@@ -111,6 +158,7 @@ SecureSocket::secureConnect()
 void
 SecureSocket::secureAccept()
 {
+	startHandshakeTimer();
 	setJob(new TSocketMultiplexerMethodJob<SecureSocket>(
 			this, &SecureSocket::serviceAccept,
 			getSocket(), isReadable(), isWritable()));
@@ -123,7 +171,7 @@ SecureSocket::secureRead(void* buffer, int size, int& read)
 		LOG((CLOG_DEBUG2 "reading secure socket"));
 		read = SSL_read(m_ssl->m_ssl, buffer, size);
 		
-		static int retry;
+		int retry = 0;
 
 		// Check result will cleanup the connection in the case of a fatal
 		checkResult(read, retry);
@@ -150,7 +198,7 @@ SecureSocket::secureWrite(const void* buffer, int size, int& wrote)
 
 		wrote = SSL_write(m_ssl->m_ssl, buffer, size);
 		
-		static int retry;
+		int retry = 0;
 
 		// Check result will cleanup the connection in the case of a fatal
 		checkResult(wrote, retry);
@@ -185,9 +233,38 @@ SecureSocket::initSsl(bool server)
 	initContext(server);
 }
 
+void
+SecureSocket::cleanupContexts()
+{
+	if (s_clientSession != NULL) {
+		SSL_SESSION_free(s_clientSession);
+		s_clientSession = NULL;
+	}
+	if (s_serverContext != NULL) {
+		SSL_CTX_free(s_serverContext);
+		s_serverContext = NULL;
+	}
+	if (s_clientContext != NULL) {
+		SSL_CTX_free(s_clientContext);
+		s_clientContext = NULL;
+	}
+	s_serverCertificate.clear();
+}
+
+bool
+SecureSocket::isSessionReused() const
+{
+	return m_ssl->m_ssl != NULL && SSL_session_reused(m_ssl->m_ssl) != 0;
+}
+
 bool
 SecureSocket::loadCertificates(String& filename)
 {
+	// the context is shared, only load the certificate the first time
+	if (!filename.empty() && filename == s_serverCertificate) {
+		return true;
+	}
+
 	if (filename.empty()) {
 		showError("ssl certificate is not specified");
 		return false;
@@ -224,11 +301,22 @@ SecureSocket::loadCertificates(String& filename)
 		return false;
 	}
 
+	s_serverCertificate = filename;
 	return true;
 }
 
 void
 SecureSocket::initContext(bool server)
+{
+	SSL_CTX*& context = server ? s_serverContext : s_clientContext;
+	if (context == NULL) {
+		context = createContext(server);
+	}
+	m_ssl->m_context = context;
+}
+
+SSL_CTX*
+SecureSocket::createContext(bool server)
 {
 	SSL_library_init();
 
@@ -254,14 +342,54 @@ SecureSocket::initContext(bool server)
 	
 	// create new context from method
 	SSL_METHOD* m = const_cast<SSL_METHOD*>(method);
-	m_ssl->m_context = SSL_CTX_new(m);
+	SSL_CTX* context = SSL_CTX_new(m);
+
+	if (context == NULL) {
+		showError();
+		return NULL;
+	}
 
 	// drop SSLv3 support
-	SSL_CTX_set_options(m_ssl->m_context, SSL_OP_NO_SSLv3);
+	SSL_CTX_set_options(context, SSL_OP_NO_SSLv3);
 
-	if (m_ssl->m_context == NULL) {
-		showError();
+	// openssl keeps a copy of the buffer on partial writes, so the
+	// socket may grow its output buffer between retries.
+	SSL_CTX_set_mode(context,
+		SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+
+	if (SSL_CTX_set_cipher_list(context, s_cipherList) == 0) {
+		showError("could not set ssl cipher list");
+	}
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+	if (SSL_CTX_set_ciphersuites(context, s_cipherSuites) == 0) {
+		showError("could not set tls 1.3 cipher suites");
+	}
+#endif
+
+	if (server) {
+		SSL_CTX_set_options(context, SSL_OP_CIPHER_SERVER_PREFERENCE);
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+		// ecdhe is enabled by default from openssl 1.1.0
+		SSL_CTX_set_ecdh_auto(context, 1);
+#endif
+
+		// cache sessions so reconnecting clients can skip the full
+		// handshake; session tickets are enabled by default.
+		SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_SERVER);
+		SSL_CTX_sess_set_cache_size(context, s_sessionCacheSize);
+		SSL_CTX_set_timeout(context, s_sessionTimeout);
+		SSL_CTX_set_session_id_context(context, s_sessionIdContext,
+			sizeof(s_sessionIdContext) - 1);
+	}
+	else {
+		// tls 1.3 tickets arrive after the handshake, so sessions are
+		// captured from the callback rather than when connect returns.
+		SSL_CTX_set_session_cache_mode(context,
+			SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+		SSL_CTX_sess_set_new_cb(context, saveClientSession);
 	}
+
+	return context;
 }
 
 void
@@ -271,31 +399,36 @@ SecureSocket::createSSL()
 	// get new SSL state with context
 	if (m_ssl->m_ssl == NULL) {
 		m_ssl->m_ssl = SSL_new(m_ssl->m_context);
+
+		// try to resume the last session with the server
+		if (m_ssl->m_context == s_clientContext && s_clientSession != NULL) {
+			SSL_set_session(m_ssl->m_ssl, s_clientSession);
+		}
 	}
 }
 
 int
 SecureSocket::secureAccept(int socket)
 {
-	createSSL();
+	if (m_ssl->m_ssl == NULL) {
+		createSSL();
 
-	// set connection socket to SSL state
-	SSL_set_fd(m_ssl->m_ssl, socket);
+		// set connection socket to SSL state
+		SSL_set_fd(m_ssl->m_ssl, socket);
+	}
 	
 	LOG((CLOG_DEBUG2 "accepting secure socket"));
 	int r = SSL_accept(m_ssl->m_ssl);
 	
-	static int retry;
+	int retry = 0;
 
 	checkResult(r, retry);
 
 	if (isFatal()) {
-		// tell user and sleep so the socket isn't hammered.
+		// tell user, the job is dropped so the socket isn't hammered.
 		LOG((CLOG_ERR "failed to accept secure socket"));
 		LOG((CLOG_INFO "client connection may not be secure"));
 		m_secureReady = false;
-		ARCH->sleep(1);
-		retry = 0;
 		return -1; // Failed, error out
 	}
 
@@ -314,7 +447,6 @@ SecureSocket::secureAccept(int socket)
 	if (retry > 0) {
 		LOG((CLOG_DEBUG2 "retry accepting secure socket"));
 		m_secureReady = false;
-		ARCH->sleep(s_retryDelay);
 		return 0;
 	}
 
@@ -326,21 +458,22 @@ SecureSocket::secureAccept(int socket)
 int
 SecureSocket::secureConnect(int socket)
 {
-	createSSL();
+	if (m_ssl->m_ssl == NULL) {
+		createSSL();
 
-	// attach the socket descriptor
-	SSL_set_fd(m_ssl->m_ssl, socket);
+		// attach the socket descriptor
+		SSL_set_fd(m_ssl->m_ssl, socket);
+	}
 	
 	LOG((CLOG_DEBUG2 "connecting secure socket"));
 	int r = SSL_connect(m_ssl->m_ssl);
 	
-	static int retry;
+	int retry = 0;
 
 	checkResult(r, retry);
 
 	if (isFatal()) {
 		LOG((CLOG_ERR "failed to connect secure socket"));
-		retry = 0;
 		return -1;
 	}
 
@@ -348,11 +481,9 @@ SecureSocket::secureConnect(int socket)
 	if (retry > 0) {
 		LOG((CLOG_DEBUG2 "retry connect secure socket"));
 		m_secureReady = false;
-		ARCH->sleep(s_retryDelay);
 		return 0;
 	}
 
-	retry = 0;
 	// No error, set ready, process and return ok
 	m_secureReady = true;
 	if (verifyCertFingerprint()) {
@@ -402,6 +533,8 @@ SecureSocket::checkResult(int status, int& retry)
 {
 	// ssl errors are a little quirky. the "want" errors are normal and
 	// should result in a retry.
+	m_wantRead = false;
+	m_wantWrite = false;
 
 	int errorCode = SSL_get_error(m_ssl->m_ssl, status);
 
@@ -418,6 +551,7 @@ SecureSocket::checkResult(int status, int& retry)
 		break;
 
 	case SSL_ERROR_WANT_READ:
+		m_wantRead = true;
 		retry++;
 		LOG((CLOG_DEBUG2 "want to read, error=%d, attempt=%d", errorCode, retry));
 		break;
@@ -427,6 +561,7 @@ SecureSocket::checkResult(int status, int& retry)
 		// select action actually triggers on a write. This isn't necessary for 
 		// m_readable because the socket logic is always readable
 		m_writable = true;
+		m_wantWrite = true;
 		retry++;
 		LOG((CLOG_DEBUG2 "want to write, error=%d, attempt=%d", errorCode, retry));
 		break;
@@ -472,12 +607,6 @@ SecureSocket::checkResult(int status, int& retry)
 		break;
 	}
 
-	// If the retry max would exceed the allowed, treat it as a fatal error
-	if (retry > s_maxRetry) {
-		LOG((CLOG_DEBUG "retry exceeded %f sec", s_maxRetry * s_retryDelay));
-		isFatal(true);
-	}
-
 	if (isFatal()) {
 		retry = 0;
 		showError();
@@ -591,17 +720,32 @@ SecureSocket::verifyCertFingerprint()
 
 ISocketMultiplexerJob*
 SecureSocket::serviceConnect(ISocketMultiplexerJob* job,
-				bool, bool write, bool error)
+				bool, bool, bool)
+{
+	return serviceHandshake(job, false);
+}
+
+ISocketMultiplexerJob*
+SecureSocket::serviceAccept(ISocketMultiplexerJob* job,
+				bool, bool, bool)
+{
+	return serviceHandshake(job, true);
+}
+
+ISocketMultiplexerJob*
+SecureSocket::serviceHandshake(ISocketMultiplexerJob* job, bool server)
 {
 	Lock lock(&getMutex());
 
-	int status = 0;
+	int socket = 0;
 #ifdef SYSAPI_WIN32
-	status = secureConnect(static_cast<int>(getSocket()->m_socket));
+	socket = static_cast<int>(getSocket()->m_socket);
 #elif SYSAPI_UNIX
-	status = secureConnect(getSocket()->m_fd);
+	socket = getSocket()->m_fd;
 #endif
 
+	int status = server ? secureAccept(socket) : secureConnect(socket);
+
 	// If status < 0, error happened
 	if (status < 0) {
 		return NULL;
@@ -609,41 +753,71 @@ SecureSocket::serviceConnect(ISocketMultiplexerJob* job,
 
 	// If status > 0, success
 	if (status > 0) {
+		sendEvent(getEvents()->forIDataSocket().secureConnected());
 		return newJob();
 	}
 
-	// Retry case
+	// Retry case.  only wait for what ssl is blocked on; a connected
+	// socket is nearly always writable so polling for that while ssl
+	// waits for the peer would spin the multiplexer.
+	bool readable = m_wantRead;
+	bool writable = m_wantWrite;
+	if (!readable && !writable) {
+		readable = isReadable();
+		writable = isWritable();
+	}
+
+	if (job->isReadable() == readable && job->isWritable() == writable) {
+		return job;
+	}
+
 	return new TSocketMultiplexerMethodJob<SecureSocket>(
-			this, &SecureSocket::serviceConnect,
-			getSocket(), isReadable(), isWritable());
+			this, server ? &SecureSocket::serviceAccept :
+							&SecureSocket::serviceConnect,
+			getSocket(), readable, writable);
 }
 
-ISocketMultiplexerJob*
-SecureSocket::serviceAccept(ISocketMultiplexerJob* job,
-				bool, bool write, bool error)
+void
+SecureSocket::startHandshakeTimer()
 {
-	Lock lock(&getMutex());
+	stopHandshakeTimer();
 
-	int status = 0;
-#ifdef SYSAPI_WIN32
-	status = secureAccept(static_cast<int>(getSocket()->m_socket));
-#elif SYSAPI_UNIX
-	status = secureAccept(getSocket()->m_fd);
-#endif
-		// If status < 0, error happened
-	if (status < 0) {
-		return NULL;
+	m_handshakeTimer = getEvents()->newOneShotTimer(s_handshakeTimeout, NULL);
+	getEvents()->adoptHandler(Event::kTimer, m_handshakeTimer,
+							new TMethodEventJob<SecureSocket>(this,
+								&SecureSocket::handleHandshakeTimeout));
+}
+
+void
+SecureSocket::stopHandshakeTimer()
+{
+	if (m_handshakeTimer != NULL) {
+		getEvents()->removeHandler(Event::kTimer, m_handshakeTimer);
+		getEvents()->deleteTimer(m_handshakeTimer);
+		m_handshakeTimer = NULL;
 	}
+}
 
-	// If status > 0, success
-	if (status > 0) {
-		return newJob();
+void
+SecureSocket::handleHandshakeTimeout(const Event&, void*)
+{
+	stopHandshakeTimer();
+
+	{
+		Lock lock(&getMutex());
+		if (m_secureReady || isFatal()) {
+			return;
+		}
+
+		LOG((CLOG_ERR "secure handshake timed out after %.0f sec",
+			s_handshakeTimeout));
+		isFatal(true);
 	}
 
-	// Retry case
-	return new TSocketMultiplexerMethodJob<SecureSocket>(
-			this, &SecureSocket::serviceAccept,
-			getSocket(), isReadable(), isWritable());
+	// must not hold the mutex here, the multiplexer may be waiting on
+	// it to finish servicing this socket.
+	setJob(NULL);
+	disconnect();
 }
 
 void
@@ -712,5 +886,9 @@ SecureSocket::showSecureConnectInfo()
 		SSL_CIPHER_description(cipher, msg, kMsgSize);
 		LOG((CLOG_INFO "%s", msg));
 		}
+
+	if (isSessionReused()) {
+		LOG((CLOG_INFO "resumed ssl session"));
+	}
 	return;
 }
@@ -23,8 +23,10 @@
 class IEventQueue;
 class SocketMultiplexer;
 class ISocketMultiplexerJob;
+class EventQueueTimer;
 
 struct Ssl;
+struct ssl_ctx_st;
 
 //! Secure socket
 /*!
@@ -52,10 +54,15 @@ public:
 	int					secureWrite(const void* buffer, int size, int& wrote);
 	void				initSsl(bool server);
 	bool				loadCertificates(String& CertFile);
+	bool				isSessionReused() const;
+
+	//! Free the process wide ssl contexts
+	static void			cleanupContexts();
 
 private:
 	// SSL
 	void				initContext(bool server);
+	ssl_ctx_st*			createContext(bool server);
 	void				createSSL();
 	int					secureAccept(int s);
 	int					secureConnect(int s);
@@ -64,6 +71,9 @@ private:
 	void				showError(const char* reason = NULL);
 	String				getError();
 	void				disconnect();
+	void				startHandshakeTimer();
+	void				stopHandshakeTimer();
+	void				handleHandshakeTimeout(const Event&, void*);
 	void				formatFingerprint(String& fingerprint,
 											bool hex = true,
 											bool separator = true);
@@ -77,6 +87,10 @@ private:
 						serviceAccept(ISocketMultiplexerJob*,
 							bool, bool, bool);
 
+	ISocketMultiplexerJob*
+						serviceHandshake(ISocketMultiplexerJob*,
+							bool server);
+
 	void				showSecureConnectInfo();
 	void				showSecureLibInfo();
 	void				showSecureCipherInfo();
@@ -85,4 +99,10 @@ private:
 	Ssl*				m_ssl;
 	bool				m_secureReady;
 	bool				m_fatal;
+
+	// the direction the handshake is blocked on.  the multiplexer job
+	// only polls for this so an idle peer doesn't spin the service thread.
+	bool				m_wantRead;
+	bool				m_wantWrite;
+	EventQueueTimer*	m_handshakeTimer;
 };
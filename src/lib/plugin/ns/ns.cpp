@@ -122,6 +122,8 @@ cleanup()
 	if (g_secureListenSocket != NULL) {
 		delete g_secureListenSocket;
 	}
+
+	SecureSocket::cleanupContexts();
 }
 
 }
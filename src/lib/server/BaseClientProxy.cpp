@@ -42,6 +42,20 @@ BaseClientProxy::setJumpCursorPos(SInt32 x, SInt32 y)
 	m_y = y;
 }
 
+bool
+BaseClientProxy::offerClipboard(ClipboardID, UInt32, const IClipboard*, UInt32)
+{
+	// can't fetch formats on request by default
+	return false;
+}
+
+void
+BaseClientProxy::setClipboardFormat(ClipboardID, UInt32,
+				IClipboard::EFormat, const String&)
+{
+	// do nothing
+}
+
 void
 BaseClientProxy::getJumpCursorPos(SInt32& x, SInt32& y) const
 {
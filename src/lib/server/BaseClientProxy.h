@@ -19,6 +19,7 @@
 #pragma once
 
 #include "synergy/IClient.h"
+#include "synergy/IClipboard.h"
 #include "base/String.h"
 
 namespace synergy { class IStream; }
@@ -41,6 +42,25 @@ public:
 	*/
 	void				setJumpCursorPos(SInt32 x, SInt32 y);
 
+	//! Offer clipboard formats
+	/*!
+	Offer the clipboard indicated by \c id with the data already in
+	\c clipboard and the other \c formats to be fetched on request.
+	\c serial identifies the offer in later requests.  Returns false if
+	the client can't fetch formats on request, in which case it must be
+	sent all the data with setClipboard().
+	*/
+	virtual bool		offerClipboard(ClipboardID id, UInt32 serial,
+							const IClipboard* clipboard, UInt32 formats);
+
+	//! Send clipboard format
+	/*!
+	Send the data of a format the client asked for after an
+	offerClipboard().
+	*/
+	virtual void		setClipboardFormat(ClipboardID id, UInt32 serial,
+							IClipboard::EFormat format, const String& data);
+
 	//@}
 	//! @name accessors
 	//@{
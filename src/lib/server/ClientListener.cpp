@@ -21,6 +21,7 @@
 #include "server/ClientProxy.h"
 #include "server/ClientProxyUnknown.h"
 #include "synergy/PacketStreamFilter.h"
+#include "synergy/ProtocolWorker.h"
 #include "net/IDataSocket.h"
 #include "net/IListenSocket.h"
 #include "net/ISocketFactory.h"
@@ -41,7 +42,8 @@ ClientListener::ClientListener(const NetworkAddress& address,
 	m_socketFactory(socketFactory),
 	m_server(NULL),
 	m_events(events),
-	m_useSecureNetwork(false)
+	m_useSecureNetwork(false),
+	m_useProtocolWorkers(false)
 {
 	assert(m_socketFactory != NULL);
 
@@ -102,6 +104,11 @@ ClientListener::~ClientListener()
 		client = getNextClient();
 	}
 
+	// stop waiting for handshakes, the listen socket owns the sockets
+	while (!m_handshakingSockets.empty()) {
+		removeSecureHandlers(*m_handshakingSockets.begin());
+	}
+
 	m_events->removeHandler(m_events->forIListenSocket().connecting(), m_listen);
 	cleanupListenSocket();
 	delete m_socketFactory;
@@ -114,6 +121,12 @@ ClientListener::setServer(Server* server)
 	m_server = server;
 }
 
+void
+ClientListener::setProtocolWorkers(bool enable)
+{
+	m_useProtocolWorkers = enable;
+}
+
 void
 ClientListener::deleteSocket(void* socket)
 {
@@ -145,23 +158,43 @@ ClientListener::handleClientConnecting(const Event&, void*)
 	LOG((CLOG_NOTE "accepted client connection"));
 
 	if (m_useSecureNetwork) {
-		LOG((CLOG_DEBUG2 "attempting sercure Connection"));
-		while (!socket->isReady()) {
-			if (socket->isFatal()) {
-				m_listen->deleteSocket(socket);
-				return;
-			}
-			LOG((CLOG_DEBUG2 "retrying sercure Connection"));
-			ARCH->sleep(.5f);
-		}
+		// the handshake is driven by the socket multiplexer, so wait for
+		// it to finish (or fail) without blocking other clients.
+		LOG((CLOG_DEBUG2 "attempting secure connection"));
+		m_handshakingSockets.insert(socket);
+		m_events->adoptHandler(m_events->forIDataSocket().secureConnected(),
+							socket->getEventTarget(),
+							new TMethodEventJob<ClientListener>(this,
+								&ClientListener::handleClientAccepted, socket));
+		m_events->adoptHandler(m_events->forISocket().disconnected(),
+							socket->getEventTarget(),
+							new TMethodEventJob<ClientListener>(this,
+								&ClientListener::handleClientSecureFailed, socket));
+		return;
 	}
 
-	LOG((CLOG_DEBUG2 "sercure Connection established:%d"));
+	handleClientAccepted(Event(), socket);
+}
+
+void
+ClientListener::handleClientAccepted(const Event&, void* vsocket)
+{
+	IDataSocket* socket = reinterpret_cast<IDataSocket*>(vsocket);
+
+	if (m_useSecureNetwork) {
+		removeSecureHandlers(socket);
+		LOG((CLOG_DEBUG2 "secure connection established"));
+	}
 
 	synergy::IStream* stream  = socket;
 	// filter socket messages, including a packetizing filter
 	bool adopt = !m_useSecureNetwork;
-	stream = new PacketStreamFilter(m_events, stream, adopt);
+	if (m_useProtocolWorkers) {
+		stream = new ProtocolWorker(m_events, stream, adopt);
+	}
+	else {
+		stream = new PacketStreamFilter(m_events, stream, adopt);
+	}
 
 	assert(m_server != NULL);
 
@@ -178,6 +211,16 @@ ClientListener::handleClientConnecting(const Event&, void*)
 								&ClientListener::handleUnknownClient, client));
 }
 
+void
+ClientListener::handleClientSecureFailed(const Event&, void* vsocket)
+{
+	IDataSocket* socket = reinterpret_cast<IDataSocket*>(vsocket);
+
+	LOG((CLOG_DEBUG1 "secure connection failed"));
+	removeSecureHandlers(socket);
+	m_listen->deleteSocket(socket);
+}
+
 void
 ClientListener::handleUnknownClient(const Event&, void* vclient)
 {
@@ -240,6 +283,16 @@ ClientListener::handleClientDisconnected(const Event&, void* vclient)
 	}
 }
 
+void
+ClientListener::removeSecureHandlers(IDataSocket* socket)
+{
+	m_events->removeHandler(m_events->forIDataSocket().secureConnected(),
+							socket->getEventTarget());
+	m_events->removeHandler(m_events->forISocket().disconnected(),
+							socket->getEventTarget());
+	m_handshakingSockets.erase(socket);
+}
+
 void
 ClientListener::cleanupListenSocket()
 {
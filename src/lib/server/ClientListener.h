@@ -26,6 +26,7 @@
 
 class ClientProxy;
 class ClientProxyUnknown;
+class IDataSocket;
 class NetworkAddress;
 class IListenSocket;
 class ISocketFactory;
@@ -46,6 +47,14 @@ public:
 
 	void				setServer(Server* server);
 
+	//! Use protocol threads
+	/*!
+	If \c enable is true then clients accepted from now on get a
+	ProtocolWorker, which decodes and encodes their messages on a thread
+	of its own, instead of a PacketStreamFilter.
+	*/
+	void				setProtocolWorkers(bool enable);
+
 	//@}
 
 	void				deleteSocket(void* socket);
@@ -69,20 +78,26 @@ public:
 private:
 	// client connection event handlers
 	void				handleClientConnecting(const Event&, void*);
+	void				handleClientAccepted(const Event&, void*);
+	void				handleClientSecureFailed(const Event&, void*);
 	void				handleUnknownClient(const Event&, void*);
 	void				handleClientDisconnected(const Event&, void*);
 
 	void				cleanupListenSocket();
+	void				removeSecureHandlers(IDataSocket*);
 
 private:
 	typedef std::set<ClientProxyUnknown*> NewClients;
 	typedef std::deque<ClientProxy*> WaitingClients;
+	typedef std::set<IDataSocket*> HandshakingSockets;
 
 	IListenSocket*		m_listen;
 	ISocketFactory*		m_socketFactory;
 	NewClients			m_newClients;
 	WaitingClients		m_waitingClients;
+	HandshakingSockets	m_handshakingSockets;
 	Server*				m_server;
 	IEventQueue*		m_events;
 	bool				m_useSecureNetwork;
+	bool				m_useProtocolWorkers;
 };
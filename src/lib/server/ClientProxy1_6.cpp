@@ -21,6 +21,7 @@
 #include "synergy/ProtocolUtil.h"
 #include "synergy/StreamChunker.h"
 #include "synergy/ClipboardChunk.h"
+#include "synergy/ProtocolWorker.h"
 #include "io/IStream.h"
 #include "base/TMethodEventJob.h"
 #include "base/Log.h"
@@ -31,16 +32,30 @@
 
 ClientProxy1_6::ClientProxy1_6(const String& name, synergy::IStream* stream, Server* server, IEventQueue* events) :
 	ClientProxy1_5(name, stream, server, events),
-	m_events(events)
+	m_events(events),
+	m_worker(dynamic_cast<ProtocolWorker*>(stream))
 {
 	m_events->adoptHandler(m_events->forClipboard().clipboardSending(),
 								this,
 								new TMethodEventJob<ClientProxy1_6>(this,
 									&ClientProxy1_6::handleClipboardSendingEvent));
+
+	// let the protocol thread do the clipboard chunking, if there is one
+	if (m_worker != NULL) {
+		m_worker->setDecodeClipboards(true);
+		m_events->adoptHandler(m_events->forClipboard().clipboardReceived(),
+								stream->getEventTarget(),
+								new TMethodEventJob<ClientProxy1_6>(this,
+									&ClientProxy1_6::handleClipboardReceivedEvent));
+	}
 }
 
 ClientProxy1_6::~ClientProxy1_6()
 {
+	if (m_worker != NULL) {
+		m_events->removeHandler(m_events->forClipboard().clipboardReceived(),
+								m_worker->getEventTarget());
+	}
 }
 
 void
@@ -57,7 +72,12 @@ ClientProxy1_6::setClipboard(ClipboardID id, const IClipboard* clipboard)
 		size_t size = data.size();
 		LOG((CLOG_DEBUG "sending clipboard %d to \"%s\"", id, getName().c_str()));
 
-		StreamChunker::sendClipboard(data, size, id, 0, m_events, this);
+		if (m_worker != NULL) {
+			m_worker->sendClipboard(id, 0, data);
+		}
+		else {
+			StreamChunker::sendClipboard(data, size, id, 0, m_events, this);
+		}
 
 		LOG((CLOG_DEBUG "sent clipboard size=%d", size));
 	}
@@ -69,6 +89,27 @@ ClientProxy1_6::handleClipboardSendingEvent(const Event& event, void*)
 	ClipboardChunk::send(getStream(), event.getData());
 }
 
+void
+ClientProxy1_6::handleClipboardReceivedEvent(const Event& event, void*)
+{
+	ProtocolWorker::ClipboardInfo* received =
+		static_cast<ProtocolWorker::ClipboardInfo*>(event.getData());
+	const ClipboardID id = received->m_id;
+	const UInt32 seq     = received->m_sequenceNumber;
+	LOG((CLOG_DEBUG "received client \"%s\" clipboard %d seqnum=%d", getName().c_str(), id, seq));
+
+	// save clipboard
+	m_clipboard[id].m_clipboard.swap(received->m_clipboard);
+	m_clipboard[id].m_sequenceNumber = seq;
+
+	// notify
+	ClipboardInfo* info = new ClipboardInfo;
+	info->m_id = id;
+	info->m_sequenceNumber = seq;
+	m_events->addEvent(Event(m_events->forClipboard().clipboardChanged(),
+							 getEventTarget(), info));
+}
+
 bool
 ClientProxy1_6::recvClipboard()
 {
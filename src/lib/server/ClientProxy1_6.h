@@ -21,6 +21,7 @@
 
 class Server;
 class IEventQueue;
+class ProtocolWorker;
 
 //! Proxy for client implementing protocol version 1.6
 class ClientProxy1_6 : public ClientProxy1_5 {
@@ -33,7 +34,9 @@ public:
 
 private:
 	void				handleClipboardSendingEvent(const Event&, void*);
+	void				handleClipboardReceivedEvent(const Event&, void*);
 
 private:
 	IEventQueue*		m_events;
+	ProtocolWorker*		m_worker;
 };
@@ -0,0 +1,212 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Inc.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "server/ClientProxy1_7.h"
+
+#include "server/Server.h"
+#include "synergy/LatencyStats.h"
+#include "synergy/ProtocolUtil.h"
+#include "synergy/protocol_types.h"
+#include "arch/Arch.h"
+#include "io/IStream.h"
+#include "base/IEventQueue.h"
+#include "base/TMethodEventJob.h"
+#include "base/Log.h"
+
+//
+// ClientProxy1_7
+//
+
+ClientProxy1_7::ClientProxy1_7(const String& name, synergy::IStream* stream, Server* server, IEventQueue* events) :
+	ClientProxy1_6(name, stream, server, events),
+	m_motionQueued(false),
+	m_motionTime(0.0),
+	m_events(events)
+{
+	m_events->adoptHandler(m_events->forClientProxy().motionQueued(),
+								this,
+								new TMethodEventJob<ClientProxy1_7>(this,
+									&ClientProxy1_7::handleMotionQueued));
+}
+
+ClientProxy1_7::~ClientProxy1_7()
+{
+	m_events->removeHandler(m_events->forClientProxy().motionQueued(), this);
+}
+
+void
+ClientProxy1_7::enter(SInt32 xAbs, SInt32 yAbs,
+				UInt32 seqNum, KeyModifierMask mask, bool forScreensaver)
+{
+	flushMotion();
+	ClientProxy1_6::enter(xAbs, yAbs, seqNum, mask, forScreensaver);
+
+	// the client only sees the 16 bit position sent with the enter
+	m_motion.setPosition(static_cast<SInt16>(xAbs), static_cast<SInt16>(yAbs));
+}
+
+bool
+ClientProxy1_7::leave()
+{
+	flushMotion();
+	return ClientProxy1_6::leave();
+}
+
+void
+ClientProxy1_7::keyDown(KeyID key, KeyModifierMask mask, KeyButton button)
+{
+	flushMotion();
+	ClientProxy1_6::keyDown(key, mask, button);
+}
+
+void
+ClientProxy1_7::keyRepeat(KeyID key, KeyModifierMask mask,
+				SInt32 count, KeyButton button)
+{
+	flushMotion();
+	ClientProxy1_6::keyRepeat(key, mask, count, button);
+}
+
+void
+ClientProxy1_7::keyUp(KeyID key, KeyModifierMask mask, KeyButton button)
+{
+	flushMotion();
+	ClientProxy1_6::keyUp(key, mask, button);
+}
+
+void
+ClientProxy1_7::mouseDown(ButtonID button)
+{
+	flushMotion();
+	ClientProxy1_6::mouseDown(button);
+}
+
+void
+ClientProxy1_7::mouseUp(ButtonID button)
+{
+	flushMotion();
+	ClientProxy1_6::mouseUp(button);
+}
+
+void
+ClientProxy1_7::mouseMove(SInt32 xAbs, SInt32 yAbs)
+{
+	LOG((CLOG_DEBUG2 "queue mouse move to \"%s\" %d,%d", getName().c_str(), xAbs, yAbs));
+	queueMotion(false, xAbs, yAbs);
+}
+
+void
+ClientProxy1_7::mouseRelativeMove(SInt32 xRel, SInt32 yRel)
+{
+	LOG((CLOG_DEBUG2 "queue mouse relative move to \"%s\" %d,%d", getName().c_str(), xRel, yRel));
+	queueMotion(true, xRel, yRel);
+}
+
+void
+ClientProxy1_7::mouseWheel(SInt32 xDelta, SInt32 yDelta)
+{
+	flushMotion();
+	ClientProxy1_6::mouseWheel(xDelta, yDelta);
+}
+
+void
+ClientProxy1_7::screensaver(bool on)
+{
+	flushMotion();
+	ClientProxy1_6::screensaver(on);
+}
+
+void
+ClientProxy1_7::queueMotion(bool relative, SInt32 x, SInt32 y)
+{
+	// use the time the server's screen saw the motion, if it did
+	double time = getServer()->getInputTime();
+	if (time == 0.0) {
+		time = ARCH->monotonicTime();
+	}
+
+	UInt32 wireTime = LatencyStats::getWireTime(time);
+	if (!m_motion.add(relative, x, y, wireTime)) {
+		flushMotion();
+		m_motion.add(relative, x, y, wireTime);
+	}
+
+	// note the time of the oldest sample in the batch
+	if (m_motionTime == 0.0) {
+		m_motionTime = time;
+	}
+
+	// send the batch after whatever input is already queued has been
+	// added to it.  when idle that's right away.
+	if (!m_motionQueued) {
+		m_motionQueued = true;
+		m_events->addEvent(Event(m_events->forClientProxy().motionQueued(), this));
+	}
+}
+
+void
+ClientProxy1_7::flushMotion()
+{
+	if (m_motion.isEmpty()) {
+		return;
+	}
+
+	String data;
+	m_motion.encode(data);
+	LOG((CLOG_DEBUG2 "send mouse move batch to \"%s\" size=%d", getName().c_str(), data.size()));
+	getStream()->write(data.data(), static_cast<UInt32>(data.size()));
+
+	getServer()->getLatencyStats().record(LatencyStats::kServerSend,
+								m_motionTime);
+	m_motionTime = 0.0;
+}
+
+void
+ClientProxy1_7::handleMotionQueued(const Event&, void*)
+{
+	m_motionQueued = false;
+	flushMotion();
+}
+
+bool
+ClientProxy1_7::parseMessage(const UInt8* code)
+{
+	if (memcmp(code, kMsgDLatencyEcho, 4) == 0) {
+		latencyEcho();
+	}
+	else {
+		return ClientProxy1_6::parseMessage(code);
+	}
+
+	return true;
+}
+
+void
+ClientProxy1_7::latencyEcho()
+{
+	// parse
+	UInt32 time, hold;
+	ProtocolUtil::readf(getStream(), kMsgDLatencyEcho + 4, &time, &hold);
+
+	// the echoed time is on our clock so the difference is the whole trip
+	UInt32 now = LatencyStats::getWireTime(ARCH->monotonicTime());
+	LOG((CLOG_DEBUG2 "recv latency echo from \"%s\" %dms, held %dus", getName().c_str(), now - time, hold));
+
+	LatencyStats& stats = getServer()->getLatencyStats();
+	stats.recordInterval(LatencyStats::kRoundTrip, 1.0e-3 * (now - time));
+	stats.recordInterval(LatencyStats::kClientInject, 1.0e-6 * hold);
+}
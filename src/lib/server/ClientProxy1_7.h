@@ -0,0 +1,68 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Inc.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "server/ClientProxy1_6.h"
+#include "synergy/MotionBatch.h"
+
+class Server;
+class IEventQueue;
+
+//! Proxy for client implementing protocol version 1.7
+/*!
+Mouse motion is batched until the events already queued have been
+handled, then sent as one kMsgDMouseMoveBatch message.  Any other input
+flushes the batch first so the client sees everything in order.  Samples
+are stamped with the time the server's screen reported them, which the
+client echoes back with kMsgDLatencyEcho when asked to.
+*/
+class ClientProxy1_7 : public ClientProxy1_6 {
+public:
+	ClientProxy1_7(const String& name, synergy::IStream* adoptedStream, Server* server, IEventQueue* events);
+	~ClientProxy1_7();
+
+	// IClient overrides
+	virtual void		enter(SInt32 xAbs, SInt32 yAbs,
+							UInt32 seqNum, KeyModifierMask mask,
+							bool forScreensaver);
+	virtual bool		leave();
+	virtual void		keyDown(KeyID, KeyModifierMask, KeyButton);
+	virtual void		keyRepeat(KeyID, KeyModifierMask,
+							SInt32 count, KeyButton);
+	virtual void		keyUp(KeyID, KeyModifierMask, KeyButton);
+	virtual void		mouseDown(ButtonID);
+	virtual void		mouseUp(ButtonID);
+	virtual void		mouseMove(SInt32 xAbs, SInt32 yAbs);
+	virtual void		mouseRelativeMove(SInt32 xRel, SInt32 yRel);
+	virtual void		mouseWheel(SInt32 xDelta, SInt32 yDelta);
+	virtual void		screensaver(bool activate);
+
+	virtual bool		parseMessage(const UInt8* code);
+
+private:
+	void				queueMotion(bool relative, SInt32 x, SInt32 y);
+	void				flushMotion();
+	void				handleMotionQueued(const Event&, void*);
+	void				latencyEcho();
+
+private:
+	MotionBatch			m_motion;
+	bool				m_motionQueued;
+	double				m_motionTime;
+	IEventQueue*		m_events;
+};
@@ -0,0 +1,128 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Inc.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "server/ClientProxy1_8.h"
+
+#include "synergy/ProtocolUtil.h"
+#include "synergy/protocol_types.h"
+#include "io/IStream.h"
+#include "base/IEventQueue.h"
+#include "base/Log.h"
+
+#include <cstring>
+
+//
+// ClientProxy1_8
+//
+
+ClientProxy1_8::ClientProxy1_8(const String& name, synergy::IStream* stream, Server* server, IEventQueue* events) :
+	ClientProxy1_7(name, stream, server, events),
+	m_events(events)
+{
+	// do nothing
+}
+
+ClientProxy1_8::~ClientProxy1_8()
+{
+	// do nothing
+}
+
+bool
+ClientProxy1_8::offerClipboard(ClipboardID id, UInt32 serial,
+				const IClipboard* clipboard, UInt32 formats)
+{
+	// ignore if this clipboard is already clean
+	if (!m_clipboard[id].m_dirty) {
+		return true;
+	}
+
+	// this clipboard is now clean
+	m_clipboard[id].m_dirty = false;
+	Clipboard::copy(&m_clipboard[id].m_clipboard, clipboard);
+
+	// list the formats, with the size and hash of the ones we have
+	std::vector<UInt32> list;
+	const Clipboard& data = m_clipboard[id].m_clipboard;
+	data.open(0);
+	for (SInt32 format = 0; format != IClipboard::kNumFormats; ++format) {
+		IClipboard::EFormat eFormat = (IClipboard::EFormat)format;
+		if (data.has(eFormat)) {
+			const String formatData = data.get(eFormat);
+			list.push_back(format);
+			list.push_back(static_cast<UInt32>(formatData.size()));
+			list.push_back(Clipboard::getDataHash(formatData));
+		}
+		else if ((formats & (1u << format)) != 0) {
+			list.push_back(format);
+			list.push_back(0xffffffffu);
+			list.push_back(0);
+		}
+	}
+	data.close();
+
+	LOG((CLOG_DEBUG "send clipboard %d formats to \"%s\" serial=%d", id, getName().c_str(), serial));
+	ProtocolUtil::writef(getStream(), kMsgDClipboardFormats, id, serial, &list);
+	return true;
+}
+
+void
+ClientProxy1_8::setClipboardFormat(ClipboardID id, UInt32 serial,
+				IClipboard::EFormat format, const String& data)
+{
+	LOG((CLOG_DEBUG "send clipboard %d format %d to \"%s\" size=%d", id, format, getName().c_str(), data.size()));
+	ProtocolUtil::writef(getStream(), kMsgDClipboardFormat,
+							id, serial, format, &data);
+}
+
+bool
+ClientProxy1_8::parseMessage(const UInt8* code)
+{
+	if (memcmp(code, kMsgQClipboardFormats, 4) == 0) {
+		return recvClipboardFormatsQuery();
+	}
+	else {
+		return ClientProxy1_7::parseMessage(code);
+	}
+}
+
+bool
+ClientProxy1_8::recvClipboardFormatsQuery()
+{
+	// parse message
+	ClipboardID id;
+	UInt32 serial, formats;
+	if (!ProtocolUtil::readf(getStream(), kMsgQClipboardFormats + 4,
+								&id, &serial, &formats)) {
+		return false;
+	}
+	LOG((CLOG_DEBUG "received client \"%s\" query of clipboard %d formats 0x%x serial=%d", getName().c_str(), id, formats, serial));
+
+	// validate
+	if (id >= kClipboardEnd) {
+		return false;
+	}
+
+	// notify
+	ClipboardFormatsInfo* info = new ClipboardFormatsInfo;
+	info->m_id             = id;
+	info->m_sequenceNumber = serial;
+	info->m_formats        = formats;
+	m_events->addEvent(Event(m_events->forClipboard().clipboardFormatsRequested(),
+							getEventTarget(), info));
+	return true;
+}
@@ -0,0 +1,52 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Inc.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "server/ClientProxy1_7.h"
+
+class Server;
+class IEventQueue;
+
+//! Proxy for client implementing protocol version 1.8
+/*!
+Clipboards can be offered as a list of formats with kMsgDClipboardFormats.
+The client asks for the data of a format with kMsgQClipboardFormats when
+an application pastes it, which is reported to the server with a
+clipboardFormatsRequested event, and the data is sent back with
+setClipboardFormat().
+*/
+class ClientProxy1_8 : public ClientProxy1_7 {
+public:
+	ClientProxy1_8(const String& name, synergy::IStream* adoptedStream, Server* server, IEventQueue* events);
+	~ClientProxy1_8();
+
+	// BaseClientProxy overrides
+	virtual bool		offerClipboard(ClipboardID, UInt32 serial,
+							const IClipboard*, UInt32 formats);
+	virtual void		setClipboardFormat(ClipboardID, UInt32 serial,
+							IClipboard::EFormat, const String& data);
+
+	virtual bool		parseMessage(const UInt8* code);
+
+private:
+	bool				recvClipboardFormatsQuery();
+
+private:
+	IEventQueue*		m_events;
+};
@@ -615,6 +615,78 @@ Config::operator!=(const Config& x) const
 	return !operator==(x);
 }
 
+void
+Config::getDiff(const Config& x, Diff& diff) const
+{
+	diff = Diff();
+
+	// screens we have, their options and their links
+	for (CellMap::const_iterator index = m_map.begin();
+								index != m_map.end(); ++index) {
+		CellMap::const_iterator other = x.m_map.find(index->first);
+		if (other == x.m_map.end()) {
+			diff.m_removedScreens.insert(index->first);
+			if (index->second.begin() != index->second.end()) {
+				diff.m_links = true;
+			}
+			continue;
+		}
+		if (index->second.m_options != other->second.m_options) {
+			diff.m_changedOptions.insert(other->first);
+		}
+		if (!index->second.hasSameLinks(other->second)) {
+			diff.m_links = true;
+		}
+	}
+
+	// screens only x has
+	for (CellMap::const_iterator index = x.m_map.begin();
+								index != x.m_map.end(); ++index) {
+		if (m_map.count(index->first) == 0) {
+			diff.m_addedScreens.insert(index->first);
+			if (index->second.begin() != index->second.end()) {
+				diff.m_links = true;
+			}
+		}
+	}
+
+	diff.m_aliases       = (!hasAliasesOf(x) || !x.hasAliasesOf(*this));
+	diff.m_globalOptions = (m_globalOptions != x.m_globalOptions);
+	diff.m_inputFilter   = (m_inputFilter != x.m_inputFilter);
+	diff.m_address       = (m_synergyAddress != x.m_synergyAddress);
+}
+
+void
+Config::update(const Config& x, const Diff& diff)
+{
+	m_map                   = x.m_map;
+	m_nameToCanonicalName   = x.m_nameToCanonicalName;
+	m_synergyAddress        = x.m_synergyAddress;
+	m_globalOptions         = x.m_globalOptions;
+	m_hasLockToScreenAction = x.m_hasLockToScreenAction;
+	if (diff.m_inputFilter) {
+		m_inputFilter = x.m_inputFilter;
+	}
+}
+
+bool
+Config::hasAliasesOf(const Config& x) const
+{
+	// every alias in x must be an alias here for the same screen
+	for (NameMap::const_iterator index = x.m_nameToCanonicalName.begin();
+								index != x.m_nameToCanonicalName.end(); ++index) {
+		if (CaselessCmp::equal(index->first, index->second)) {
+			continue;
+		}
+		NameMap::const_iterator other = m_nameToCanonicalName.find(index->first);
+		if (other == m_nameToCanonicalName.end() ||
+			!CaselessCmp::equal(other->second, index->second)) {
+			return false;
+		}
+	}
+	return true;
+}
+
 void
 Config::read(ConfigReadContext& context)
 {
@@ -765,6 +837,12 @@ Config::readSectionOptions(ConfigReadContext& s)
 		else if (name == "win32KeepForeground") {
 			addOption("", kOptionWin32KeepForeground, s.parseBoolean(value));
 		}
+		else if (name == "latencyEcho") {
+			addOption("", kOptionLatencyEcho, s.parseBoolean(value));
+		}
+		else if (name == "lazyClipboard") {
+			addOption("", kOptionClipboardLazy, s.parseBoolean(value));
+		}
 		else {
 			handled = false;
 		}
@@ -1376,6 +1454,12 @@ Config::getOptionName(OptionID id)
 	if (id == kOptionScreenPreserveFocus) {
 		return "preserveFocus";
 	}
+	if (id == kOptionLatencyEcho) {
+		return "latencyEcho";
+	}
+	if (id == kOptionClipboardLazy) {
+		return "lazyClipboard";
+	}
 	return NULL;
 }
 
@@ -1392,7 +1476,9 @@ Config::getOptionValue(OptionID id, OptionValue value)
 		id == kOptionXTestXineramaUnaware ||
 		id == kOptionRelativeMouseMoves ||
 		id == kOptionWin32KeepForeground ||
-		id == kOptionScreenPreserveFocus) {
+		id == kOptionScreenPreserveFocus ||
+		id == kOptionLatencyEcho ||
+		id == kOptionClipboardLazy) {
 		return (value != 0) ? "true" : "false";
 	}
 	if (id == kOptionModifierMapForShift ||
@@ -1704,14 +1790,8 @@ Config::Cell::getLink(EDirection side, float position,
 }
 
 bool
-Config::Cell::operator==(const Cell& x) const
+Config::Cell::hasSameLinks(const Cell& x) const
 {
-	// compare options
-	if (m_options != x.m_options) {
-		return false;
-	}
-
-	// compare links
 	if (m_neighbors.size() != x.m_neighbors.size()) {
 		return false;
 	}
@@ -1736,6 +1816,12 @@ Config::Cell::operator==(const Cell& x) const
 	return true;
 }
 
+bool
+Config::Cell::operator==(const Cell& x) const
+{
+	return (m_options == x.m_options && hasSameLinks(x));
+}
+
 bool
 Config::Cell::operator!=(const Cell& x) const
 {
@@ -1755,6 +1841,73 @@ Config::Cell::end() const
 }
 
 
+//
+// Config::Diff
+//
+
+Config::Diff::Diff() :
+	m_globalOptions(false),
+	m_links(false),
+	m_aliases(false),
+	m_inputFilter(false),
+	m_address(false)
+{
+	// do nothing
+}
+
+bool
+Config::Diff::isEmpty() const
+{
+	return (m_addedScreens.empty() && m_removedScreens.empty() &&
+			m_changedOptions.empty() && !m_globalOptions && !m_links &&
+			!m_aliases && !m_inputFilter && !m_address);
+}
+
+bool
+Config::Diff::hasOptionsChanged(const String& name) const
+{
+	return (m_globalOptions || m_changedOptions.count(name) != 0);
+}
+
+String
+Config::Diff::format() const
+{
+	if (isEmpty()) {
+		return "no changes";
+	}
+
+	String result;
+	if (!m_addedScreens.empty()) {
+		result += synergy::string::sprintf(", %d %s added", (int)m_addedScreens.size(),
+							m_addedScreens.size() == 1 ? "screen" : "screens");
+	}
+	if (!m_removedScreens.empty()) {
+		result += synergy::string::sprintf(", %d %s removed", (int)m_removedScreens.size(),
+							m_removedScreens.size() == 1 ? "screen" : "screens");
+	}
+	if (!m_changedOptions.empty()) {
+		result += synergy::string::sprintf(", options of %d %s", (int)m_changedOptions.size(),
+							m_changedOptions.size() == 1 ? "screen" : "screens");
+	}
+	if (m_globalOptions) {
+		result += ", global options";
+	}
+	if (m_links) {
+		result += ", links";
+	}
+	if (m_aliases) {
+		result += ", aliases";
+	}
+	if (m_inputFilter) {
+		result += ", hotkeys";
+	}
+	if (m_address) {
+		result += ", address";
+	}
+	return result.substr(2);
+}
+
+
 //
 // Config I/O
 //
@@ -128,6 +128,9 @@ private:
 		bool			getLink(EDirection side, float position,
 							const CellEdge*& src, const CellEdge*& dst) const;
 
+		// compares links only
+		bool			hasSameLinks(const Cell&) const;
+
 		bool			operator==(const Cell&) const;
 		bool			operator!=(const Cell&) const;
 
@@ -144,6 +147,41 @@ private:
 	typedef std::map<String, String, synergy::string::CaselessCmp> NameMap;
 
 public:
+	//! Configuration differences
+	/*!
+	The structural differences between two configurations, as found by
+	getDiff().  Screens are named by their canonical names.
+	*/
+	class Diff {
+	public:
+		typedef std::set<String, synergy::string::CaselessCmp> NameSet;
+
+		Diff();
+
+		//! Test for no differences
+		bool			isEmpty() const;
+
+		//! Test for changed screen options
+		/*!
+		Returns true iff the options sent to screen \c name changed,
+		either its own or the global options.
+		*/
+		bool			hasOptionsChanged(const String& name) const;
+
+		//! Get a summary of the differences (for logging)
+		String			format() const;
+
+	public:
+		NameSet			m_addedScreens;
+		NameSet			m_removedScreens;
+		NameSet			m_changedOptions;
+		bool			m_globalOptions;
+		bool			m_links;
+		bool			m_aliases;
+		bool			m_inputFilter;
+		bool			m_address;
+	};
+
 	typedef Cell::const_iterator link_const_iterator;
 	typedef CellMap::const_iterator internal_const_iterator;
 	typedef NameMap::const_iterator all_const_iterator;
@@ -320,6 +358,15 @@ public:
 	virtual InputFilter*
 						getInputFilter();
 
+	//! Update configuration
+	/*!
+	Makes this configuration equal to \c x, where \c diff is the
+	result of getDiff(x).  The input filter is only replaced if its
+	rules changed so the hotkeys of unchanged rules stay registered
+	with its primary client.
+	*/
+	void				update(const Config& x, const Diff& diff);
+
 	//@}
 	//! @name accessors
 	//@{
@@ -408,6 +455,15 @@ public:
 	*/
 	bool					hasLockToScreenAction() const;
 
+	//! Compare configurations structurally
+	/*!
+	Fills \c diff with what differs between this configuration and
+	\c x:  added and removed screens, screens whose options changed,
+	and whether the links, aliases, global options, input filter rules
+	or server address changed.
+	*/
+	void				getDiff(const Config& x, Diff& diff) const;
+
 	//! Compare configurations
 	bool				operator==(const Config&) const;
 	//! Compare configurations
@@ -464,6 +520,7 @@ private:
 
 	void				parseScreens(ConfigReadContext&, const String&,
 							std::set<String>& screens) const;
+	bool				hasAliasesOf(const Config&) const;
 	static const char*	getOptionName(OptionID);
 	static String		getOptionValue(OptionID, OptionValue);
 
@@ -112,6 +112,20 @@ PrimaryClient::getClipboard(ClipboardID id, IClipboard* clipboard) const
 	return m_screen->getClipboard(id, clipboard);
 }
 
+bool
+PrimaryClient::getClipboardFormats(ClipboardID id,
+				UInt32& formats, IClipboard::Time& time) const
+{
+	return m_screen->getClipboardFormats(id, formats, time);
+}
+
+bool
+PrimaryClient::getClipboardFormat(ClipboardID id,
+				IClipboard::EFormat format, String& data) const
+{
+	return m_screen->getClipboardFormat(id, format, data);
+}
+
 void
 PrimaryClient::getShape(SInt32& x, SInt32& y,
 				SInt32& width, SInt32& height) const
@@ -183,6 +197,13 @@ PrimaryClient::setClipboardDirty(ClipboardID id, bool dirty)
 	m_clipboardDirty[id] = dirty;
 }
 
+bool
+PrimaryClient::offerClipboard(ClipboardID, UInt32, const IClipboard*, UInt32)
+{
+	// the primary screen is where lazy clipboard formats come from
+	return true;
+}
+
 void
 PrimaryClient::keyDown(KeyID key, KeyModifierMask mask, KeyButton button)
 {
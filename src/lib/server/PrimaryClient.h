@@ -110,6 +110,22 @@ public:
 	*/
 	bool				isLockedToScreen() const;
 
+	//! Get clipboard formats
+	/*!
+	Gets the formats on the primary screen's clipboard and the time it
+	was set without fetching the data.  Returns false if the screen
+	can't do that.
+	*/
+	bool				getClipboardFormats(ClipboardID,
+							UInt32& formats, IClipboard::Time&) const;
+
+	//! Get clipboard format
+	/*!
+	Gets the data of a single format on the primary screen's clipboard.
+	*/
+	bool				getClipboardFormat(ClipboardID,
+							IClipboard::EFormat, String& data) const;
+
 	//@}
 
 	// FIXME -- these probably belong on IScreen
@@ -131,6 +147,10 @@ public:
 	virtual void		setClipboard(ClipboardID, const IClipboard*);
 	virtual void		grabClipboard(ClipboardID);
 	virtual void		setClipboardDirty(ClipboardID, bool);
+
+	// BaseClientProxy overrides
+	virtual bool		offerClipboard(ClipboardID, UInt32 serial,
+							const IClipboard*, UInt32 formats);
 	virtual void		keyDown(KeyID, KeyModifierMask, KeyButton);
 	virtual void		keyRepeat(KeyID, KeyModifierMask,
 							SInt32 count, KeyButton);
@@ -34,6 +34,7 @@
 #include "synergy/Screen.h"
 #include "synergy/PacketStreamFilter.h"
 #include "synergy/DpiHelper.h"
+#include "synergy/LatencyStats.h"
 #include "net/TCPSocket.h"
 #include "net/IDataSocket.h"
 #include "net/IListenSocket.h"
@@ -84,6 +85,7 @@ Server::Server(
 	m_switchNeedsControl(false),
 	m_switchNeedsAlt(false),
 	m_relativeMoves(false),
+	m_lazyClipboard(false),
 	m_keyboardBroadcasting(false),
 	m_lockedToScreen(false),
 	m_screen(screen),
@@ -94,7 +96,10 @@ Server::Server(
 	m_enableDragDrop(enableDragDrop),
 	m_sendDragInfoThread(NULL),
 	m_waitDragInfoThread(true),
-	m_sendClipboardThread(NULL)
+	m_clientListener(NULL),
+	m_sendClipboardThread(NULL),
+	m_latencyStats(NULL),
+	m_inputTime(0.0)
 {
 	// must have a primary client and it must have a canonical name
 	assert(m_primaryClient != NULL);
@@ -115,6 +120,8 @@ Server::Server(
 		clipboard.m_clipboardData   = clipboard.m_clipboard.marshall();
 	}
 
+	m_latencyStats = new LatencyStats(m_events);
+
 	// install event handlers
 	m_events->adoptHandler(Event::kTimer, this,
 							new TMethodEventJob<Server>(this,
@@ -219,6 +226,8 @@ Server::~Server()
 		return;
 	}
 
+	delete m_latencyStats;
+
 	// remove event handlers and timers
 	m_events->removeHandler(m_events->forIKeyState().keyDown(),
 							m_inputFilter);
@@ -274,13 +283,69 @@ Server::setConfig(const Config& config)
 		return false;
 	}
 
+	// the c'tor passes the configuration we're using, all of which is
+	// new to us
+	if (&config == m_config) {
+		closeClients(config);
+		processOptions();
+		addLockToScreenRule(*m_config);
+		m_primaryClient->reconfigure(getActivePrimarySides());
+		for (ClientList::const_iterator index = m_clients.begin();
+									index != m_clients.end(); ++index) {
+			sendOptions(index->second);
+		}
+		return true;
+	}
+
+	// otherwise apply only what differs from the current configuration.
+	// give the new configuration the ScrollLock rule now so its input
+	// filter compares equal to ours if the user's rules are unchanged.
+	Config next(config);
+	addLockToScreenRule(next);
+	Config::Diff diff;
+	m_config->getDiff(next, diff);
+	LOG((CLOG_DEBUG "configuration changes: %s", diff.format().c_str()));
+	if (diff.isEmpty()) {
+		return true;
+	}
+
 	// close clients that are connected but being dropped from the
-	// configuration.
-	closeClients(config);
+	// configuration (or whose name is now an alias).
+	if (!diff.m_removedScreens.empty() || diff.m_aliases) {
+		closeClients(next);
+	}
+
+	// cut over.  the input filter is only replaced, and its hotkeys
+	// registered again, if its rules changed.
+	m_config->update(next, diff);
+	if (diff.m_globalOptions) {
+		processOptions();
+	}
+
+	// tell primary screen about reconfiguration
+	if (diff.m_links) {
+		m_primaryClient->reconfigure(getActivePrimarySides());
+	}
+
+	// tell (connected) clients whose options changed about them
+	for (ClientList::const_iterator index = m_clients.begin();
+								index != m_clients.end(); ++index) {
+		BaseClientProxy* client = index->second;
+		if (diff.hasOptionsChanged(getName(client))) {
+			sendOptions(client);
+		}
+	}
 
-	// cut over
-	processOptions();
+	if (diff.m_address) {
+		LOG((CLOG_WARN "the new server address takes effect when the server restarts"));
+	}
+
+	return true;
+}
 
+void
+Server::addLockToScreenRule(Config& config)
+{
 	// add ScrollLock as a hotkey to lock to the screen.  this was a
 	// built-in feature in earlier releases and is now supported via
 	// the user configurable hotkey mechanism.  if the user has already
@@ -288,25 +353,13 @@ Server::setConfig(const Config& config)
 	// we will unfortunately generate a warning.  if the user has
 	// configured a LockCursorToScreenAction then we don't add
 	// ScrollLock as a hotkey.
-	if (!m_config->hasLockToScreenAction()) {
+	if (!config.hasLockToScreenAction()) {
 		IPlatformScreen::KeyInfo* key =
 			IPlatformScreen::KeyInfo::alloc(kKeyScrollLock, 0, 0, 0);
 		InputFilter::Rule rule(new InputFilter::KeystrokeCondition(m_events, key));
 		rule.adoptAction(new InputFilter::LockCursorToScreenAction(m_events), true);
-		m_inputFilter->addFilterRule(rule);
+		config.getInputFilter()->addFilterRule(rule);
 	}
-
-	// tell primary screen about reconfiguration
-	m_primaryClient->reconfigure(getActivePrimarySides());
-
-	// tell all (connected) clients about current options
-	for (ClientList::const_iterator index = m_clients.begin();
-								index != m_clients.end(); ++index) {
-		BaseClientProxy* client = index->second;
-		sendOptions(client);
-	}
-
-	return true;
 }
 
 void
@@ -510,8 +563,14 @@ Server::switchScreen(BaseClientProxy* dst,
 		// clipboard data could be corrupted on the other side
 		if (m_sendClipboardThread != NULL) {
 			StreamChunker::interruptClipboard();
-			m_sendClipboardThread->wait();
-			m_sendClipboardThread = NULL;
+			waitForClipboardSend();
+		}
+
+		// offer lazy clipboards.  the primary screen's clipboard can
+		// only be read from this thread so fill in any data the new
+		// active screen needs before starting the send.
+		for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
+			offerClipboard(m_active, id);
 		}
 		
 		// send the clipboard data to new active screen
@@ -1144,6 +1203,7 @@ Server::processOptions()
 	m_switchNeedsShift = false;		// it seems if i don't add these
 	m_switchNeedsControl = false;	// lines, the 'reload config' option
 	m_switchNeedsAlt = false;		// doesnt' work correct.
+	m_lazyClipboard = false;
 
 	bool newRelativeMoves = m_relativeMoves;
 	for (Config::ScreenOptions::const_iterator index = options->begin();
@@ -1173,6 +1233,9 @@ Server::processOptions()
 		else if (id == kOptionScreenSwitchNeedsAlt) {
 			m_switchNeedsAlt = (value != 0);
 		}
+		else if (id == kOptionClipboardLazy) {
+			m_lazyClipboard = (value != 0);
+		}
 		else if (id == kOptionRelativeMouseMoves) {
 			newRelativeMoves = (value != 0);
 		}
@@ -1227,6 +1290,10 @@ Server::handleClipboardGrabbed(const Event& event, void* vclient)
 	const IScreen::ClipboardInfo* info =
 		reinterpret_cast<const IScreen::ClipboardInfo*>(event.getData());
 
+	// the send thread started by the last switch reads the clipboards
+	// and writes to the active screen, so let it finish first
+	waitForClipboardSend();
+
 	// ignore grab if sequence number is old.  always allow primary
 	// screen to grab.
 	ClipboardInfo& clipboard = m_clipboards[info->m_id];
@@ -1240,6 +1307,9 @@ Server::handleClipboardGrabbed(const Event& event, void* vclient)
 	LOG((CLOG_INFO "screen \"%s\" grabbed clipboard %d from \"%s\"", getName(grabber).c_str(), info->m_id, clipboard.m_clipboardOwner.c_str()));
 	clipboard.m_clipboardOwner  = getName(grabber);
 	clipboard.m_clipboardSeqNum = info->m_sequenceNumber;
+	clipboard.m_lazyFormats     = 0;
+	clipboard.m_lazyRequests.clear();
+	clipboard.m_lazyRefill      = false;
 
 	// clear the clipboard data (since it's not known at this point)
 	if (clipboard.m_clipboard.open(0)) {
@@ -1275,6 +1345,94 @@ Server::handleClipboardChanged(const Event& event, void* vclient)
 	onClipboardChanged(sender, info->m_id, info->m_sequenceNumber);
 }
 
+void
+Server::handleClipboardFormatsRequested(const Event& event, void* vclient)
+{
+	// ignore events from unknown clients
+	BaseClientProxy* client = reinterpret_cast<BaseClientProxy*>(vclient);
+	if (m_clientSet.count(client) == 0) {
+		return;
+	}
+	const IScreen::ClipboardFormatsInfo* info =
+		reinterpret_cast<const IScreen::ClipboardFormatsInfo*>(event.getData());
+
+	// don't read the clipboard while the send thread does
+	waitForClipboardSend();
+
+	// ignore requests for an old offer
+	ClipboardInfo& clipboard = m_clipboards[info->m_id];
+	if (clipboard.m_lazyFormats == 0 ||
+		info->m_sequenceNumber != clipboard.m_lazySerial) {
+		LOG((CLOG_DEBUG "ignored screen \"%s\" request for clipboard %d formats (stale)", getName(client).c_str(), info->m_id));
+		return;
+	}
+
+	// fetch what we don't have yet and send it.  the primary screen
+	// may still be fetching some formats from the clipboard owner;
+	// those are sent when it tells us it has them.
+	UInt32 pending = fillClipboard(info->m_id,
+							info->m_formats & clipboard.m_lazyFormats);
+	UInt32 formats;
+	IClipboard::Time time;
+	if (pending != 0 &&
+		m_primaryClient->getClipboardFormats(info->m_id, formats, time)) {
+		pending &= formats;
+	}
+	if (pending != 0) {
+		LOG((CLOG_DEBUG "screen \"%s\" waits for clipboard %d formats 0x%x", getName(client).c_str(), info->m_id, pending));
+		clipboard.m_lazyRequests[client] |= pending;
+	}
+	sendClipboardFormats(client, info->m_id, info->m_formats & ~pending);
+}
+
+void
+Server::sendClipboardFormats(BaseClientProxy* client,
+				ClipboardID id, UInt32 formats)
+{
+	// formats that aren't available are sent empty so the client
+	// isn't left waiting
+	ClipboardInfo& clipboard = m_clipboards[id];
+	clipboard.m_clipboard.open(0);
+	for (SInt32 format = 0; format != IClipboard::kNumFormats; ++format) {
+		if ((formats & (1u << format)) != 0) {
+			IClipboard::EFormat eFormat = (IClipboard::EFormat)format;
+			String data;
+			if (clipboard.m_clipboard.has(eFormat)) {
+				data = clipboard.m_clipboard.get(eFormat);
+			}
+			client->setClipboardFormat(id,
+								clipboard.m_lazySerial, eFormat, data);
+		}
+	}
+	clipboard.m_clipboard.close();
+}
+
+void
+Server::answerClipboardRequests(ClipboardID id)
+{
+	ClipboardInfo& clipboard = m_clipboards[id];
+	std::map<BaseClientProxy*, UInt32> requests;
+	requests.swap(clipboard.m_lazyRequests);
+	for (std::map<BaseClientProxy*, UInt32>::iterator
+							index = requests.begin();
+							index != requests.end(); ++index) {
+		// the primary screen is done so whatever is missing now is
+		// not available
+		fillClipboard(id, index->second);
+		sendClipboardFormats(index->first, id, index->second);
+	}
+
+	// the active screen needed all the data up front.  send it again.
+	if (clipboard.m_lazyRefill) {
+		clipboard.m_lazyRefill = false;
+		if (m_active != m_primaryClient) {
+			fillClipboard(id, clipboard.m_lazyFormats);
+			m_active->setClipboardDirty(id, true);
+			m_active->setClipboard(id, &clipboard.m_clipboard);
+		}
+	}
+}
+
 void
 Server::handleKeyDownEvent(const Event& event, void*)
 {
@@ -1320,7 +1478,10 @@ Server::handleMotionPrimaryEvent(const Event& event, void*)
 {
 	IPlatformScreen::MotionInfo* info =
 		reinterpret_cast<IPlatformScreen::MotionInfo*>(event.getData());
+	m_latencyStats->record(LatencyStats::kServerDispatch, info->m_time);
+	m_inputTime = info->m_time;
 	onMouseMovePrimary(info->m_x, info->m_y);
+	m_inputTime = 0.0;
 }
 
 void
@@ -1328,7 +1489,10 @@ Server::handleMotionSecondaryEvent(const Event& event, void*)
 {
 	IPlatformScreen::MotionInfo* info =
 		reinterpret_cast<IPlatformScreen::MotionInfo*>(event.getData());
+	m_latencyStats->record(LatencyStats::kServerDispatch, info->m_time);
+	m_inputTime = info->m_time;
 	onMouseMoveSecondary(info->m_x, info->m_y);
+	m_inputTime = 0.0;
 }
 
 void
@@ -1377,7 +1541,9 @@ Server::handleClientDisconnected(const Event&, void* vclient)
 	PacketStreamFilter* streamFileter = dynamic_cast<PacketStreamFilter*>(client->getStream());
 	TCPSocket* socket = dynamic_cast<TCPSocket*>(streamFileter->getStream());
 	delete client;
-	m_clientListener->deleteSocket(socket);
+	if (m_clientListener != NULL) {
+		m_clientListener->deleteSocket(socket);
+	}
 }
 
 void
@@ -1390,7 +1556,9 @@ Server::handleClientCloseTimeout(const Event&, void* vclient)
 	PacketStreamFilter* streamFileter = dynamic_cast<PacketStreamFilter*>(client->getStream());
 	TCPSocket* socket = dynamic_cast<TCPSocket*>(streamFileter->getStream());
 	delete client;
-	m_clientListener->deleteSocket(socket);
+	if (m_clientListener != NULL) {
+		m_clientListener->deleteSocket(socket);
+	}
 }
 
 void
@@ -1521,28 +1689,64 @@ Server::onClipboardChanged(BaseClientProxy* sender,
 {
 	ClipboardInfo& clipboard = m_clipboards[id];
 
+	// don't change the clipboard while the send thread reads it
+	waitForClipboardSend();
+
 	// ignore update if sequence number is old
 	if (seqNum < clipboard.m_clipboardSeqNum) {
 		LOG((CLOG_INFO "ignored screen \"%s\" update of clipboard %d (missequenced)", getName(sender).c_str(), id));
 		return;
 	}
 
-	// should be the expected client
-	assert(sender == m_clients.find(clipboard.m_clipboardOwner)->second);
+	// should be the expected client.  a screen may report data it
+	// finished reading after another screen grabbed the clipboard.
+	if (clipboard.m_clipboardOwner != getName(sender)) {
+		LOG((CLOG_DEBUG "ignored screen \"%s\" update of clipboard %d (not owner)", getName(sender).c_str(), id));
+		return;
+	}
 
-	// get data
-	sender->getClipboard(id, &clipboard.m_clipboard);
+	UInt32 formats;
+	IClipboard::Time time;
+	if (m_lazyClipboard && sender == m_primaryClient &&
+		m_primaryClient->getClipboardFormats(id, formats, time)) {
+		// only get the list of formats.  the data is fetched when a
+		// client asks for it.
+		if (formats == clipboard.m_lazyFormats &&
+			time == clipboard.m_lazyTime) {
+			// but it may have fetched data that somebody is waiting for
+			LOG((CLOG_DEBUG "ignored screen \"%s\" update of clipboard %d (unchanged)", clipboard.m_clipboardOwner.c_str(), id));
+			answerClipboardRequests(id);
+			return;
+		}
+		clipboard.m_lazyFormats = formats;
+		clipboard.m_lazyTime    = time;
+		++clipboard.m_lazySerial;
 
-	// ignore if data hasn't changed
-	String data = clipboard.m_clipboard.marshall();
-	if (data == clipboard.m_clipboardData) {
-		LOG((CLOG_DEBUG "ignored screen \"%s\" update of clipboard %d (unchanged)", clipboard.m_clipboardOwner.c_str(), id));
-		return;
+		// requests for the old offer are void.  clients ask again.
+		clipboard.m_lazyRequests.clear();
+		clipboard.m_lazyRefill  = false;
+		if (clipboard.m_clipboard.open(0)) {
+			clipboard.m_clipboard.empty();
+			clipboard.m_clipboard.close();
+		}
+		clipboard.m_clipboardData = clipboard.m_clipboard.marshall();
+	}
+	else {
+		// get data
+		clipboard.m_lazyFormats = 0;
+		sender->getClipboard(id, &clipboard.m_clipboard);
+
+		// ignore if data hasn't changed
+		String data = clipboard.m_clipboard.marshall();
+		if (data == clipboard.m_clipboardData) {
+			LOG((CLOG_DEBUG "ignored screen \"%s\" update of clipboard %d (unchanged)", clipboard.m_clipboardOwner.c_str(), id));
+			return;
+		}
+		clipboard.m_clipboardData = data;
 	}
 
 	// got new data
 	LOG((CLOG_INFO "screen \"%s\" updated clipboard %d", clipboard.m_clipboardOwner.c_str(), id));
-	clipboard.m_clipboardData = data;
 
 	// tell all clients except the sender that the clipboard is dirty
 	for (ClientList::const_iterator index = m_clients.begin();
@@ -1552,9 +1756,55 @@ Server::onClipboardChanged(BaseClientProxy* sender,
 	}
 
 	// send the new clipboard to the active screen
+	offerClipboard(m_active, id);
 	m_active->setClipboard(id, &clipboard.m_clipboard);
 }
 
+void
+Server::offerClipboard(BaseClientProxy* client, ClipboardID id)
+{
+	ClipboardInfo& clipboard = m_clipboards[id];
+	if (clipboard.m_lazyFormats == 0) {
+		return;
+	}
+
+	if (!client->offerClipboard(id, clipboard.m_lazySerial,
+							&clipboard.m_clipboard, clipboard.m_lazyFormats)) {
+		// client needs all the data up front.  if the primary screen
+		// is still fetching some then send it again when it's done.
+		if (fillClipboard(id, clipboard.m_lazyFormats) != 0) {
+			clipboard.m_lazyRefill = true;
+		}
+	}
+}
+
+UInt32
+Server::fillClipboard(ClipboardID id, UInt32 formats)
+{
+	UInt32 missing = 0;
+	ClipboardInfo& clipboard = m_clipboards[id];
+	clipboard.m_clipboard.open(0);
+	for (SInt32 format = 0; format != IClipboard::kNumFormats; ++format) {
+		IClipboard::EFormat eFormat = (IClipboard::EFormat)format;
+		if ((formats & (1u << format)) == 0 ||
+			clipboard.m_clipboard.has(eFormat)) {
+			continue;
+		}
+
+		String data;
+		if (m_primaryClient->getClipboardFormat(id, eFormat, data)) {
+			LOG((CLOG_DEBUG "fetched clipboard %d format %d, %d bytes", id, format, data.size()));
+			clipboard.m_clipboard.add(eFormat, data);
+		}
+		else {
+			missing |= (1u << format);
+		}
+	}
+	clipboard.m_clipboard.close();
+	clipboard.m_clipboardData = clipboard.m_clipboard.marshall();
+	return missing;
+}
+
 void
 Server::onScreensaver(bool activated)
 {
@@ -1867,6 +2117,16 @@ Server::sendClipboardThread(void*)
 	}
 }
 
+void
+Server::waitForClipboardSend()
+{
+	if (m_sendClipboardThread != NULL) {
+		m_sendClipboardThread->wait();
+		delete m_sendClipboardThread;
+		m_sendClipboardThread = NULL;
+	}
+}
+
 void
 Server::onMouseMoveSecondary(SInt32 dx, SInt32 dy)
 {
@@ -2110,6 +2370,10 @@ Server::addClient(BaseClientProxy* client)
 							client->getEventTarget(),
 							new TMethodEventJob<Server>(this,
 								&Server::handleClipboardChanged, client));
+	m_events->adoptHandler(m_events->forClipboard().clipboardFormatsRequested(),
+							client->getEventTarget(),
+							new TMethodEventJob<Server>(this,
+								&Server::handleClipboardFormatsRequested, client));
 
 	// add to list
 	m_clientSet.insert(client);
@@ -2142,6 +2406,13 @@ Server::removeClient(BaseClientProxy* client)
 							client->getEventTarget());
 	m_events->removeHandler(m_events->forClipboard().clipboardChanged(),
 							client->getEventTarget());
+	m_events->removeHandler(m_events->forClipboard().clipboardFormatsRequested(),
+							client->getEventTarget());
+
+	// forget its requests for clipboard formats
+	for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
+		m_clipboards[id].m_lazyRequests.erase(client);
+	}
 
 	// remove from list
 	m_clients.erase(getName(client));
@@ -2287,7 +2558,12 @@ Server::ClipboardInfo::ClipboardInfo() :
 	m_clipboard(),
 	m_clipboardData(),
 	m_clipboardOwner(),
-	m_clipboardSeqNum(0)
+	m_clipboardSeqNum(0),
+	m_lazyFormats(0),
+	m_lazyTime(0),
+	m_lazySerial(0),
+	m_lazyRequests(),
+	m_lazyRefill(false)
 {
 	// do nothing
 }
@@ -40,6 +40,7 @@ namespace synergy { class Screen; }
 class IEventQueue;
 class Thread;
 class ClientListener;
+class LatencyStats;
 
 //! Synergy server
 /*!
@@ -110,7 +111,7 @@ public:
 	~Server();
 
 #ifdef TEST_ENV
-	Server() : m_mock(true), m_config(NULL) { }
+	Server() : m_mock(true), m_config(NULL), m_latencyStats(NULL) { }
 	void setActive(BaseClientProxy* active) {	m_active = active; }
 #endif
 
@@ -121,7 +122,9 @@ public:
 	/*!
 	Change the server's configuration.  Returns true iff the new
 	configuration was accepted (it must include the server's name).
-	This will disconnect any clients no longer in the configuration.
+	Only what differs from the current configuration is applied:  this
+	will disconnect any clients no longer in the configuration and
+	sends options only to clients whose options changed.
 	*/
 	bool				setConfig(const Config&);
 
@@ -178,6 +181,17 @@ public:
 	//! Return fake drag file list
 	DragFileList		getFakeDragFileList() { return m_fakeDragFileList; }
 
+	//! Get the input latency statistics
+	LatencyStats&		getLatencyStats() { return *m_latencyStats; }
+
+	//! Get the time of the motion being handled
+	/*!
+	Returns the ARCH->monotonicTime() at which the platform reported the
+	mouse motion currently being handled, or 0 if no motion is being
+	handled.  Client proxies use this to timestamp the motion they send.
+	*/
+	double				getInputTime() const { return m_inputTime; }
+
 	//@}
 
 private:
@@ -289,10 +303,15 @@ private:
 	// process options from configuration
 	void				processOptions();
 
+	// add the ScrollLock lock to screen hotkey to \c config unless it
+	// has a lock to screen action
+	void				addLockToScreenRule(Config& config);
+
 	// event handlers
 	void				handleShapeChanged(const Event&, void*);
 	void				handleClipboardGrabbed(const Event&, void*);
 	void				handleClipboardChanged(const Event&, void*);
+	void				handleClipboardFormatsRequested(const Event&, void*);
 	void				handleKeyDownEvent(const Event&, void*);
 	void				handleKeyUpEvent(const Event&, void*);
 	void				handleKeyRepeatEvent(const Event&, void*);
@@ -318,6 +337,23 @@ private:
 	// event processing
 	void				onClipboardChanged(BaseClientProxy* sender,
 							ClipboardID id, UInt32 seqNum);
+
+	// offer the lazy formats of a clipboard to a client.  if the client
+	// can't fetch formats on request then fill in the data it needs.
+	void				offerClipboard(BaseClientProxy*, ClipboardID);
+
+	// fetch lazy clipboard formats from the primary screen.  returns
+	// the formats the primary screen doesn't have yet.
+	UInt32				fillClipboard(ClipboardID, UInt32 formats);
+
+	// send lazy clipboard formats to a client that asked for them.
+	// formats we don't have are sent empty.
+	void				sendClipboardFormats(BaseClientProxy*,
+							ClipboardID, UInt32 formats);
+
+	// answer the requests that were waiting for the primary screen to
+	// fetch lazy clipboard formats
+	void				answerClipboardRequests(ClipboardID);
 	void				onScreensaver(bool activated);
 	void				onKeyDown(KeyID, KeyModifierMask, KeyButton,
 							const char* screens);
@@ -370,6 +406,9 @@ private:
 	// thread funciton for sending clipboard
 	void				sendClipboardThread(void*);
 
+	// wait for the clipboard send thread to finish
+	void				waitForClipboardSend();
+
 public:
 	bool				m_mock;
 
@@ -383,6 +422,20 @@ private:
 		String			m_clipboardData;
 		String			m_clipboardOwner;
 		UInt32			m_clipboardSeqNum;
+
+		// formats on the primary screen's clipboard that may not have
+		// been fetched yet, the time the clipboard was set and the
+		// serial number of the last offer of them.  m_lazyFormats is 0
+		// when m_clipboard holds all the data.
+		UInt32			m_lazyFormats;
+		IClipboard::Time	m_lazyTime;
+		UInt32			m_lazySerial;
+
+		// formats clients asked for that the primary screen is still
+		// fetching and whether the active screen got incomplete data.
+		// they're answered when the primary screen's clipboard changes.
+		std::map<BaseClientProxy*, UInt32>	m_lazyRequests;
+		bool			m_lazyRefill;
 	};
 
 	// the primary screen client
@@ -453,6 +506,9 @@ private:
 	// relative mouse move option
 	bool				m_relativeMoves;
 
+	// lazy clipboard option
+	bool				m_lazyClipboard;
+
 	// flag whether or not we have broadcasting enabled and the screens to
 	// which we should send broadcasted keys.
 	bool				m_keyboardBroadcasting;
@@ -483,4 +539,8 @@ private:
 	ClientListener*		m_clientListener;
 
 	Thread*				m_sendClipboardThread;
+
+	// input latency
+	LatencyStats*		m_latencyStats;
+	double				m_inputTime;
 };
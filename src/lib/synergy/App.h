@@ -163,7 +163,11 @@ private:
 	"*     --restart            restart the server automatically if it fails.\n" \
 	"  -l  --log <file>         write log messages to file.\n" \
 	"      --no-tray            disable the system tray icon.\n" \
-	"      --enable-drag-drop   enable file drag & drop.\n"
+	"      --enable-drag-drop   enable file drag & drop.\n" \
+	"      --capture <file>     record the protocol to file on exit, for\n" \
+	"                             syntool --replay.\n" \
+	"      --capture-size <mb>  keep at most this many megabytes of the\n" \
+	"                             newest packets (default 16).\n"
 
 #define HELP_COMMON_INFO_2 \
 	"  -h, --help               display this help and exit.\n" \
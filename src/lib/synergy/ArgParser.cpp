@@ -58,6 +58,10 @@ ArgParser::parseServerArgs(ServerArgs& args, int argc, const char* const* argv)
 			// save configuration file path
 			args.m_configFile = argv[++i];
 		}
+		else if (isArg(i, argc, argv, "", "--protocol-workers", 0)) {
+			// decode and encode client messages off the event loop
+			args.m_protocolWorkers = true;
+		}
 		else if (isArg(i, argc, argv, "", "--res-w", 1)) {
 			DpiHelper::s_resolutionWidth = synergy::string::stringToSizeType(argv[++i]);
 		}
@@ -110,6 +114,10 @@ ArgParser::parseClientArgs(ClientArgs& args, int argc, const char* const* argv)
 			// define scroll 
 			args.m_yscroll = atoi(argv[++i]);
 		}
+		else if (isArg(i, argc, argv, NULL, "--headless")) {
+			// no display;  injected input goes nowhere
+			args.m_headless = true;
+		}
 		else {
 			if (i + 1 == argc) {
 				args.m_synergyAddress = argv[i];
@@ -229,6 +237,16 @@ ArgParser::parseToolArgs(ToolArgs& args, int argc, const char* const* argv)
 			args.m_notifyActivation = true;
 			return true;
 		}
+		else if (isArg(i, argc, argv, NULL, "--replay", 1)) {
+			args.m_replayFile = argv[++i];
+			if (i + 1 < argc) {
+				if (!isArg(i + 1, argc, argv, NULL, "--original-timing", 0)) {
+					return false;
+				}
+				args.m_replayOriginalTiming = true;
+			}
+			return true;
+		}
 		else {
 			return false;
 		}
@@ -334,6 +352,13 @@ ArgParser::parseGenericArgs(int argc, const char* const* argv, int& i)
 	else if (isArg(i, argc, argv, NULL, "--plugin-dir", 1)) {
 		argsBase().m_pluginDirectory = argv[++i];
 	}
+	else if (isArg(i, argc, argv, NULL, "--capture", 1)) {
+		argsBase().m_captureFile = argv[++i];
+	}
+	else if (isArg(i, argc, argv, NULL, "--capture-size", 1)) {
+		// size of the capture ring in megabytes
+		argsBase().m_captureSize = 1024 * 1024 * atoi(argv[++i]);
+	}
 	else {
 		// option not supported here
 		return false;
@@ -44,7 +44,9 @@ m_shouldExit(false),
 m_synergyAddress(),
 m_enableCrypto(false),
 m_profileDirectory(""),
-m_pluginDirectory("")
+m_pluginDirectory(""),
+m_captureFile(),
+m_captureSize(16 * 1024 * 1024)
 {
 }
 
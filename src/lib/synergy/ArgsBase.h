@@ -19,6 +19,7 @@
 #pragma once
 
 #include "base/String.h"
+#include "common/basic_types.h"
 
 class ArgsBase {
 public:
@@ -51,4 +52,6 @@ public:
 	bool				m_enableCrypto;
 	String				m_profileDirectory;
 	String				m_pluginDirectory;
+	String				m_captureFile;
+	UInt32				m_captureSize;
 };
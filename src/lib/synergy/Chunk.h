@@ -19,6 +19,10 @@
 
 #include "common/basic_types.h"
 
+// the most data to send in one chunk message.  bigger chunks are split
+// so input written meanwhile never waits long behind a message.
+#define CHUNK_MESSAGE_SIZE (16 * 1024)
+
 class Chunk {
 public:
 	Chunk(size_t size);
@@ -20,10 +20,13 @@
 
 #include "client/Client.h"
 #include "synergy/ArgParser.h"
+#include "synergy/ProtocolCapture.h"
+#include "synergy/LatencyStats.h"
 #include "synergy/protocol_types.h"
 #include "synergy/Screen.h"
 #include "synergy/XScreen.h"
 #include "synergy/ClientArgs.h"
+#include "platform/NullScreen.h"
 #include "net/NetworkAddress.h"
 #include "net/TCPSocketFactory.h"
 #include "net/SocketMultiplexer.h"
@@ -119,11 +122,11 @@ ClientApp::help()
 #  define WINAPI_INFO
 #endif
 
-	char buffer[2000];
+	char buffer[3000];
 	sprintf(
 		buffer,
 		"Usage: %s"
-		" [--yscroll <delta>]"
+		" [--yscroll <delta>] [--headless]"
 		WINAPI_ARG
 		HELP_SYS_ARGS
 		HELP_COMMON_ARGS
@@ -136,6 +139,8 @@ ClientApp::help()
 		HELP_SYS_INFO
 		"      --yscroll <delta>    defines the vertical scrolling delta, which is\n"
 		"                             120 by default.\n"
+		"      --headless           run without a display, accepting and\n"
+		"                             discarding all input.  for testing.\n"
 		HELP_COMMON_INFO_2
 		"\n"
 		"* marks defaults.\n"
@@ -172,6 +177,10 @@ ClientApp::daemonInfo() const
 synergy::Screen*
 ClientApp::createScreen()
 {
+	if (args().m_headless) {
+		return new synergy::Screen(new NullScreen(m_events, false), m_events);
+	}
+
 #if WINAPI_MSWINDOWS
 	return new synergy::Screen(new MSWindowsScreen(
 		false, args().m_noHooks, args().m_stopOnDeskSwitch, m_events), m_events);
@@ -446,6 +455,21 @@ ClientApp::stopClient()
 	m_clientScreen = NULL;
 }
 
+void
+ClientApp::logStatsSignalHandler(Arch::ESignal, void*)
+{
+	IEventQueue* events = App::instance().getEvents();
+	events->addEvent(Event(events->forClient().logStats(),
+		events->getSystemTarget()));
+}
+
+void
+ClientApp::logStats(const Event&, void*)
+{
+	if (m_client != NULL) {
+		m_client->getLatencyStats().log();
+	}
+}
 
 int
 ClientApp::mainLoop()
@@ -455,6 +479,10 @@ ClientApp::mainLoop()
 	SocketMultiplexer multiplexer;
 	setSocketMultiplexer(&multiplexer);
 
+	// record the protocol until we stop, if asked
+	ProtocolCapture capture(argsBase().m_captureFile,
+							argsBase().m_captureSize, ProtocolCapture::kClient);
+
 	// load all available plugins.
 	ARCH->plugin().load();
 	// pass log and arch into plugins.
@@ -472,6 +500,12 @@ ClientApp::mainLoop()
 	// init event for all available plugins.
 	ARCH->plugin().initEvent(m_clientScreen->getEventTarget(), m_events);
 
+	// handle user signal by logging the input latency statistics
+	ARCH->setSignalHandler(Arch::kUSER, &logStatsSignalHandler, NULL);
+	m_events->adoptHandler(m_events->forClient().logStats(),
+		m_events->getSystemTarget(),
+		new TMethodEventJob<ClientApp>(this, &ClientApp::logStats));
+
 	// run event loop.  if startClient() failed we're supposed to retry
 	// later.  the timer installed by startClient() will take care of
 	// that.
@@ -498,6 +532,9 @@ ClientApp::mainLoop()
 
 	// close down
 	LOG((CLOG_DEBUG1 "stopping client"));
+	ARCH->setSignalHandler(Arch::kUSER, NULL, NULL);
+	m_events->removeHandler(m_events->forClient().logStats(),
+		m_events->getSystemTarget());
 	stopClient();
 	updateStatus();
 	LOG((CLOG_NOTE "stopped client"));
@@ -64,6 +64,8 @@ public:
 	void handleClientConnected(const Event&, void*);
 	void handleClientFailed(const Event& e, void*);
 	void handleClientDisconnected(const Event&, void*);
+	static void logStatsSignalHandler(Arch::ESignal, void*);
+	void logStats(const Event&, void*);
 	Client* openClient(const String& name, const NetworkAddress& address, 
 				synergy::Screen* screen);
 	void closeClient(Client* client);
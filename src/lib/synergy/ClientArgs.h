@@ -27,4 +27,5 @@ public:
 
 public:
 	int					m_yscroll;
+	bool				m_headless;
 };
@@ -18,6 +18,8 @@
 
 #include "synergy/Clipboard.h"
 
+#include <algorithm>
+
 //
 // Clipboard
 //
@@ -111,8 +113,33 @@ Clipboard::unmarshall(const String& data, Time time)
 	IClipboard::unmarshall(this, data, time);
 }
 
+void
+Clipboard::swap(Clipboard& other)
+{
+	assert(!m_open && !other.m_open);
+
+	std::swap(m_time, other.m_time);
+	std::swap(m_owner, other.m_owner);
+	std::swap(m_timeOwned, other.m_timeOwned);
+	for (SInt32 index = 0; index < kNumFormats; ++index) {
+		std::swap(m_added[index], other.m_added[index]);
+		m_data[index].swap(other.m_data[index]);
+	}
+}
+
 String
 Clipboard::marshall() const
 {
 	return IClipboard::marshall(this);
 }
+
+UInt32
+Clipboard::getDataHash(const String& data)
+{
+	UInt32 hash = 2166136261u;
+	for (String::size_type i = 0; i < data.size(); ++i) {
+		hash ^= static_cast<UInt8>(data[i]);
+		hash *= 16777619u;
+	}
+	return hash;
+}
@@ -39,6 +39,13 @@ public:
 	*/
 	void				unmarshall(const String& data, Time time);
 
+	//! Swap contents
+	/*!
+	Exchanges the data and times of this clipboard and \c other without
+	copying the data.  Neither clipboard may be open.
+	*/
+	void				swap(Clipboard& other);
+
 	//@}
 	//! @name accessors
 	//@{
@@ -50,6 +57,13 @@ public:
 	*/
 	String				marshall() const;
 
+	//! Hash clipboard data
+	/*!
+	Returns the 32 bit FNV-1a hash of \c data.  Used to tell if data
+	already received for a clipboard format can be reused.
+	*/
+	static UInt32		getDataHash(const String& data);
+
 	//@}
 
 	// IClipboard overrides
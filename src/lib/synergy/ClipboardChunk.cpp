@@ -152,5 +152,14 @@ ClipboardChunk::send(synergy::IStream* stream, void* data)
 		break;
 	}
 
+	if (mark == kDataChunk && dataChunk.size() > CHUNK_MESSAGE_SIZE) {
+		for (size_t i = 0; i < dataChunk.size(); i += CHUNK_MESSAGE_SIZE) {
+			String piece(dataChunk, i, CHUNK_MESSAGE_SIZE);
+			ProtocolUtil::writef(stream, kMsgDClipboard, id, sequence,
+							mark, &piece);
+		}
+		return;
+	}
+
 	ProtocolUtil::writef(stream, kMsgDClipboard, id, sequence, mark, &dataChunk);
 }
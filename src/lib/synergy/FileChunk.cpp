@@ -152,5 +152,13 @@ FileChunk::send(synergy::IStream* stream, UInt8 mark, char* data, size_t dataSiz
 		break;
 	}
 
+	if (mark == kDataChunk && chunk.size() > CHUNK_MESSAGE_SIZE) {
+		for (size_t i = 0; i < chunk.size(); i += CHUNK_MESSAGE_SIZE) {
+			String piece(chunk, i, CHUNK_MESSAGE_SIZE);
+			ProtocolUtil::writef(stream, kMsgDFileTransfer, mark, &piece);
+		}
+		return;
+	}
+
 	ProtocolUtil::writef(stream, kMsgDFileTransfer, mark, &chunk);
 }
@@ -54,11 +54,17 @@ public:
 	\c kHTML is a text format encoded in UTF-8 and containing a valid
 	HTML fragment (but not necessarily a complete HTML document).
 	Newlines are LF.
+
+	\c kPNG is a compressed image format.  The data is a PNG file, passed
+	between platforms untouched so a screenshot isn't sent as a much
+	bigger uncompressed bitmap.  Peers that predate it ignore it (see
+	unmarshall()) so owners should also offer \c kBitmap when they can.
 	*/
 	enum EFormat {
 		kText,			//!< Text format, UTF-8, newline is LF
 		kBitmap,		//!< Bitmap format, BMP 24/32bpp, BI_RGB
 		kHTML,			//!< HTML format, HTML fragment, UTF-8, newline is LF
+		kPNG,			//!< Compressed image format, PNG file
 		kNumFormats		//!< The number of clipboard formats
 	};
 
@@ -20,14 +20,13 @@
 
 #include "synergy/DragInformation.h"
 #include "synergy/clipboard_types.h"
+#include "synergy/IClipboard.h"
 #include "synergy/IScreen.h"
 #include "synergy/IPrimaryScreen.h"
 #include "synergy/ISecondaryScreen.h"
 #include "synergy/IKeyState.h"
 #include "synergy/option_types.h"
 
-class IClipboard;
-
 //! Screen interface
 /*!
 This interface defines the methods common to all platform dependent
@@ -87,6 +86,24 @@ public:
 	*/
 	virtual void		checkClipboards() = 0;
 
+	//! Offer clipboard formats
+	/*!
+	Take ownership of the system clipboard indicated by \c id with the
+	data in \c clipboard and promise the other \c formats (a mask of
+	\c 1 << IClipboard::EFormat), to be supplied by setClipboardFormat()
+	when an application asks for them.  Returns false if the screen
+	can't promise data, in which case nothing is changed.
+	*/
+	virtual bool		offerClipboard(ClipboardID id,
+							const IClipboard* clipboard, UInt32 formats) = 0;
+
+	//! Supply promised clipboard format
+	/*!
+	Supply the data for a format promised by offerClipboard().
+	*/
+	virtual void		setClipboardFormat(ClipboardID id,
+							IClipboard::EFormat, const String& data) = 0;
+
 	//! Open screen saver
 	/*!
 	Open the screen saver.  If \c notify is true then this object must
@@ -143,6 +160,23 @@ public:
 	*/
 	virtual bool		isPrimary() const = 0;
 
+	//! Get clipboard formats
+	/*!
+	Get the formats on the clipboard indicated by \c id (as a mask of
+	\c 1 << IClipboard::EFormat) and the time it was last set without
+	fetching the data.  Returns false if the screen can't do that.
+	*/
+	virtual bool		getClipboardFormats(ClipboardID id,
+							UInt32& formats, IClipboard::Time& time) const = 0;
+
+	//! Get clipboard format
+	/*!
+	Get the data of a single \c format on the clipboard indicated by
+	\c id.  Returns false if the format isn't available.
+	*/
+	virtual bool		getClipboardFormat(ClipboardID id,
+							IClipboard::EFormat format, String& data) const = 0;
+
 	//@}
 
 	// IScreen overrides
@@ -51,6 +51,9 @@ public:
 	public:
 		SInt32			m_x;
 		SInt32			m_y;
+
+		//! ARCH->monotonicTime() when the platform reported the motion
+		double			m_time;
 	};
 	//! Wheel motion event data
 	class WheelInfo {
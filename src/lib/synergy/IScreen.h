@@ -37,6 +37,13 @@ public:
 		UInt32			m_sequenceNumber;
 	};
 
+	struct ClipboardFormatsInfo {
+	public:
+		ClipboardID		m_id;
+		UInt32			m_sequenceNumber;
+		UInt32			m_formats;
+	};
+
 	//! @name accessors
 	//@{
 
@@ -0,0 +1,132 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "synergy/LatencyStats.h"
+
+#include "arch/Arch.h"
+#include "base/IEventQueue.h"
+#include "base/TMethodEventJob.h"
+#include "base/Log.h"
+
+#include <cmath>
+
+// seconds between periodic summaries
+static const double		kLogInterval = 60.0;
+
+//
+// LatencyStats
+//
+
+LatencyStats::LatencyStats(IEventQueue* events) :
+	m_events(events),
+	m_timer(NULL),
+	m_loggedCount(0)
+{
+	m_timer = m_events->newTimer(kLogInterval, this);
+	m_events->adoptHandler(Event::kTimer, m_timer,
+							new TMethodEventJob<LatencyStats>(this,
+								&LatencyStats::handleLogTimer));
+}
+
+LatencyStats::~LatencyStats()
+{
+	m_events->removeHandler(Event::kTimer, m_timer);
+	m_events->deleteTimer(m_timer);
+}
+
+void
+LatencyStats::record(EStage stage, double start)
+{
+	recordInterval(stage, ARCH->monotonicTime() - start);
+}
+
+void
+LatencyStats::recordInterval(EStage stage, double seconds)
+{
+	// clamp to what a histogram can hold
+	if (seconds < 0.0) {
+		seconds = 0.0;
+	}
+	else if (seconds > 4000.0) {
+		seconds = 4000.0;
+	}
+	m_stages[stage].record(static_cast<UInt32>(seconds * 1.0e6));
+}
+
+void
+LatencyStats::log() const
+{
+	bool any = false;
+	for (int i = 0; i < kNumStages; ++i) {
+		if (m_stages[i].getCount() != 0) {
+			LOG((CLOG_NOTE "latency %s: %s",
+				getStageName(static_cast<EStage>(i)),
+				m_stages[i].getSummary().c_str()));
+			any = true;
+		}
+	}
+	if (!any) {
+		LOG((CLOG_NOTE "no latency samples"));
+	}
+}
+
+const LatencyHistogram&
+LatencyStats::get(EStage stage) const
+{
+	return m_stages[stage];
+}
+
+UInt32
+LatencyStats::getWireTime(double time)
+{
+	return static_cast<UInt32>(fmod(time * 1000.0, 4294967296.0));
+}
+
+void
+LatencyStats::handleLogTimer(const Event&, void*)
+{
+	// only log if something happened since last time
+	UInt32 count = 0;
+	for (int i = 0; i < kNumStages; ++i) {
+		count += m_stages[i].getCount();
+	}
+	if (count == m_loggedCount) {
+		return;
+	}
+	m_loggedCount = count;
+
+	for (int i = 0; i < kNumStages; ++i) {
+		if (m_stages[i].getCount() != 0) {
+			LOG((CLOG_DEBUG "latency %s: %s",
+				getStageName(static_cast<EStage>(i)),
+				m_stages[i].getSummary().c_str()));
+		}
+	}
+}
+
+const char*
+LatencyStats::getStageName(EStage stage)
+{
+	static const char* s_names[] = {
+		"event to dispatch",
+		"event to send",
+		"event round trip",
+		"dispatch to inject"
+	};
+	return s_names[stage];
+}
@@ -0,0 +1,100 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "base/LatencyHistogram.h"
+#include "common/basic_types.h"
+
+class Event;
+class EventQueueTimer;
+class IEventQueue;
+
+//! Input latency statistics
+/*!
+Keeps a LatencyHistogram for each stage that input passes through on its
+way from the server's screen to the client's.  Times are taken from
+ARCH->monotonicTime() so only stages measured on one host are compared
+directly;  the server measures the whole trip with the client's echo of
+the motion timestamps it sent.  A summary of every stage that has samples
+is logged periodically at DEBUG and on demand by log().
+*/
+class LatencyStats {
+public:
+	enum EStage {
+		kServerDispatch,	//!< Platform event to server event handler
+		kServerSend,		//!< Platform event to written to the client
+		kRoundTrip,			//!< Platform event to the client's echo
+		kClientInject,		//!< Message dispatch to injected on the client
+		kNumStages
+	};
+
+	LatencyStats(IEventQueue* events);
+	~LatencyStats();
+
+	//! @name manipulators
+	//@{
+
+	//! Record a sample
+	/*!
+	Records the time from \p start, an ARCH->monotonicTime(), until now
+	for \p stage.
+	*/
+	void				record(EStage stage, double start);
+
+	//! Record a sample
+	/*!
+	Records an interval of \p seconds for \p stage.
+	*/
+	void				recordInterval(EStage stage, double seconds);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Log the statistics
+	/*!
+	Logs a summary of each stage that has samples.
+	*/
+	void				log() const;
+
+	//! Get a stage's histogram
+	const LatencyHistogram&
+						get(EStage stage) const;
+
+	//! Convert a time for the wire
+	/*!
+	Returns ARCH->monotonicTime() value \p time in milliseconds, wrapped
+	to 32 bits.  Differences between two such values are correct when
+	computed as UInt32 even across the wrap.
+	*/
+	static UInt32		getWireTime(double time);
+
+	//@}
+
+private:
+	void				handleLogTimer(const Event&, void*);
+
+	static const char*	getStageName(EStage stage);
+
+private:
+	IEventQueue*		m_events;
+	EventQueueTimer*	m_timer;
+	LatencyHistogram	m_stages[kNumStages];
+	UInt32				m_loggedCount;
+};
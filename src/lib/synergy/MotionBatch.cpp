@@ -0,0 +1,156 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/MotionBatch.h"
+
+#include "synergy/protocol_types.h"
+
+//
+// MotionBatch
+//
+
+MotionBatch::MotionBatch() :
+	m_count(0),
+	m_relative(false),
+	m_x(0),
+	m_y(0),
+	m_time(0)
+{
+	// do nothing
+}
+
+void
+MotionBatch::setPosition(SInt32 x, SInt32 y)
+{
+	m_x = x;
+	m_y = y;
+}
+
+bool
+MotionBatch::add(bool relative, SInt32 x, SInt32 y, UInt32 time)
+{
+	if (m_count == kMaxSamples || (m_count != 0 && relative != m_relative)) {
+		return false;
+	}
+
+	// unsigned difference so the clock can wrap
+	writeVarint(m_data, static_cast<SInt32>(time - m_time));
+	m_time = time;
+
+	if (relative) {
+		writeVarint(m_data, x);
+		writeVarint(m_data, y);
+	}
+	else {
+		writeVarint(m_data, x - m_x);
+		writeVarint(m_data, y - m_y);
+		m_x = x;
+		m_y = y;
+	}
+
+	m_relative = relative;
+	++m_count;
+	return true;
+}
+
+void
+MotionBatch::encode(String& data)
+{
+	data.assign(kMsgDMouseMoveBatch, 4);
+	data.push_back(static_cast<char>(m_count | (m_relative ? kRelative : 0)));
+	data.append(m_data);
+
+	m_data.clear();
+	m_count = 0;
+}
+
+bool
+MotionBatch::decode(UInt8 header, const String& data,
+				bool& relative, Samples& samples)
+{
+	relative = ((header & kRelative) != 0);
+	UInt32 count = (header & kMaxSamples);
+
+	samples.clear();
+	samples.reserve(count);
+
+	String::size_type index = 0;
+	for (UInt32 i = 0; i < count; ++i) {
+		SInt32 dt, dx, dy;
+		if (!readVarint(data, index, dt) ||
+			!readVarint(data, index, dx) ||
+			!readVarint(data, index, dy)) {
+			return false;
+		}
+
+		Sample sample;
+		m_time += static_cast<UInt32>(dt);
+		sample.m_time = m_time;
+		if (relative) {
+			sample.m_x = dx;
+			sample.m_y = dy;
+		}
+		else {
+			m_x += dx;
+			m_y += dy;
+			sample.m_x = m_x;
+			sample.m_y = m_y;
+		}
+		samples.push_back(sample);
+	}
+
+	return (index == data.size());
+}
+
+bool
+MotionBatch::isEmpty() const
+{
+	return (m_count == 0);
+}
+
+void
+MotionBatch::writeVarint(String& data, SInt32 value)
+{
+	// zig-zag so small negative values stay short, then 7 bits per byte
+	// with the high bit set on all but the last byte.
+	UInt32 v = (static_cast<UInt32>(value) << 1) ^
+				static_cast<UInt32>(value >> 31);
+	while (v >= 0x80) {
+		data.push_back(static_cast<char>((v & 0x7f) | 0x80));
+		v >>= 7;
+	}
+	data.push_back(static_cast<char>(v));
+}
+
+bool
+MotionBatch::readVarint(const String& data,
+				String::size_type& index, SInt32& value)
+{
+	UInt32 v = 0;
+	for (int shift = 0; shift < 35; shift += 7) {
+		if (index == data.size()) {
+			return false;
+		}
+		UInt8 byte = static_cast<UInt8>(data[index++]);
+		v |= static_cast<UInt32>(byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0) {
+			value = static_cast<SInt32>((v >> 1) ^ (~(v & 1) + 1));
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,114 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/String.h"
+#include "common/basic_types.h"
+#include "common/stdvector.h"
+
+//! Batched mouse motion encoder/decoder
+/*!
+Packs a run of mouse motion samples into one kMsgDMouseMoveBatch message.
+Each sample is three zig-zag varints (milliseconds since the previous
+sample, dx, dy) so a small move costs three bytes instead of a whole
+kMsgDMouseMove or kMsgDMouseRelMove packet.  Absolute moves are stored
+relative to the previous absolute position and times relative to the
+previous sample, so one MotionBatch must encode (or decode) every batch
+on a connection, in order.
+*/
+class MotionBatch {
+public:
+	//! A decoded motion sample
+	class Sample {
+	public:
+		//! Absolute position, or the motion delta for relative moves
+		SInt32			m_x, m_y;
+
+		//! Time on the sender's clock, in milliseconds
+		UInt32			m_time;
+	};
+	typedef std::vector<Sample> Samples;
+
+	enum {
+		kMaxSamples = 0x7f,		//!< Most samples in one message
+		kRelative = 0x80		//!< Header bit for relative moves
+	};
+
+	MotionBatch();
+
+	//! @name manipulators
+	//@{
+
+	//! Set the absolute position
+	/*!
+	Sets the position that the next absolute sample is relative to.  Both
+	ends call this on enter, since the position then changes without a
+	motion message.
+	*/
+	void				setPosition(SInt32 x, SInt32 y);
+
+	//! Add a sample
+	/*!
+	Adds a move to \p x,\p y (or by \p x,\p y if \p relative) at \p time
+	milliseconds.  Returns false without adding the sample if the batch is
+	full or holds the other kind of move;  the caller should \c encode()
+	the batch and try again.
+	*/
+	bool				add(bool relative, SInt32 x, SInt32 y, UInt32 time);
+
+	//! Encode the batch
+	/*!
+	Replaces \p data with the batched samples as a complete
+	kMsgDMouseMoveBatch message, including the message code, and empties
+	the batch.
+	*/
+	void				encode(String& data);
+
+	//! Decode a message
+	/*!
+	Decodes the body of a kMsgDMouseMoveBatch message (\p header and the
+	sample bytes in \p data that follow it), replacing \p samples and
+	setting \p relative.  Returns false if the message is malformed.
+	*/
+	bool				decode(UInt8 header, const String& data,
+							bool& relative, Samples& samples);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Check for samples
+	/*!
+	Returns true if there are no samples waiting to be encoded.
+	*/
+	bool				isEmpty() const;
+
+	//@}
+
+private:
+	static void			writeVarint(String& data, SInt32 value);
+	static bool			readVarint(const String& data,
+							String::size_type& index, SInt32& value);
+
+private:
+	String				m_data;
+	UInt32				m_count;
+	bool				m_relative;
+	SInt32				m_x, m_y;
+	UInt32				m_time;
+};
@@ -17,6 +17,9 @@
  */
 
 #include "synergy/PacketStreamFilter.h"
+#include "synergy/ProtocolCapture.h"
+#include "synergy/protocol_types.h"
+#include "net/TCPSocket.h"
 #include "base/IEventQueue.h"
 #include "mt/Lock.h"
 #include "base/TMethodEventJob.h"
@@ -24,6 +27,19 @@
 #include <cstring>
 #include <memory>
 
+static bool
+isBulkPacket(const void* buffer, UInt32 count)
+{
+	// clipboard and file data.  drag info stays in order with the
+	// input that starts the drag.
+	if (count < 4) {
+		return false;
+	}
+	return (memcmp(buffer, kMsgDClipboard, 4) == 0 ||
+			memcmp(buffer, kMsgDClipboardFormat, 4) == 0 ||
+			memcmp(buffer, kMsgDFileTransfer, 4) == 0);
+}
+
 //
 // PacketStreamFilter
 //
@@ -32,7 +48,10 @@ PacketStreamFilter::PacketStreamFilter(IEventQueue* events, synergy::IStream* st
 	StreamFilter(events, stream, adoptStream),
 	m_size(0),
 	m_inputShutdown(false),
-	m_events(events)
+	m_events(events),
+	m_connection(ProtocolCapture::newConnection()),
+	m_captured(false),
+	m_bulkSocket(dynamic_cast<TCPSocket*>(stream))
 {
 	// do nothing
 }
@@ -92,16 +111,34 @@ PacketStreamFilter::read(void* buffer, UInt32 n)
 void
 PacketStreamFilter::write(const void* buffer, UInt32 count)
 {
+	ProtocolCapture::record(m_connection, ProtocolCapture::kOutput,
+							buffer, count);
+
 	// write the length of the payload
 	UInt8 length[4];
 	length[0] = (UInt8)((count >> 24) & 0xff);
 	length[1] = (UInt8)((count >> 16) & 0xff);
 	length[2] = (UInt8)((count >>  8) & 0xff);
 	length[3] = (UInt8)( count        & 0xff);
-	getStream()->write(length, sizeof(length));
 
-	// write the payload
-	getStream()->write(buffer, count);
+	// without a bulk socket nothing can come between the two writes
+	if (m_bulkSocket == NULL) {
+		getStream()->write(length, sizeof(length));
+		getStream()->write(buffer, count);
+		return;
+	}
+
+	// otherwise bulk data can go out between any two writes, so write
+	// the whole packet at once.  bulk packets are queued behind others.
+	m_packet.assign(reinterpret_cast<const char*>(length), sizeof(length));
+	m_packet.append(reinterpret_cast<const char*>(buffer), count);
+	const UInt32 size = static_cast<UInt32>(m_packet.size());
+	if (isBulkPacket(buffer, count)) {
+		m_bulkSocket->writeBulk(m_packet.data(), size);
+	}
+	else {
+		m_bulkSocket->write(m_packet.data(), size);
+	}
 }
 
 void
@@ -146,6 +183,28 @@ PacketStreamFilter::readPacketSize()
 				 ((UInt32)buffer[1] << 16) |
 				 ((UInt32)buffer[2] <<  8) |
 				  (UInt32)buffer[3];
+		m_captured = false;
+	}
+	captureInput();
+}
+
+void
+PacketStreamFilter::readInput()
+{
+	Lock lock(&m_mutex);
+	readMore();
+}
+
+void
+PacketStreamFilter::captureInput()
+{
+	// note -- m_mutex must be locked on entry
+
+	// capture each packet once, when all of it has arrived
+	if (!m_captured && isReadyNoLock() && ProtocolCapture::isCapturing()) {
+		ProtocolCapture::record(m_connection, ProtocolCapture::kInput,
+							m_buffer.peek(m_size), m_size);
+		m_captured = true;
 	}
 }
 
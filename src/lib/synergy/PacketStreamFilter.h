@@ -21,12 +21,16 @@
 #include "io/StreamFilter.h"
 #include "io/StreamBuffer.h"
 #include "mt/Mutex.h"
+#include "base/String.h"
 
 class IEventQueue;
+class TCPSocket;
 
 //! Packetizing stream filter 
 /*!
-Filters a stream to read and write packets.
+Filters a stream to read and write packets.  When the filtered stream
+is a TCPSocket, clipboard and file transfer packets are written as bulk
+data so input messages written after them go out first.
 */
 class PacketStreamFilter : public StreamFilter {
 public:
@@ -45,10 +49,18 @@ protected:
 	// StreamFilter overrides
 	virtual void		filterEvent(const Event&);
 
+	//! Read from the filtered stream
+	/*!
+	Moves whatever the filtered stream has buffered into our buffer,
+	for subclasses that read outside of filterEvent().
+	*/
+	void				readInput();
+
 private:
 	bool				isReadyNoLock() const;
 	void				readPacketSize();
 	bool				readMore();
+	void				captureInput();
 
 private:
 	Mutex				m_mutex;
@@ -56,4 +68,8 @@ private:
 	StreamBuffer		m_buffer;
 	bool				m_inputShutdown;
 	IEventQueue*		m_events;
+	UInt32				m_connection;
+	bool				m_captured;
+	TCPSocket*			m_bulkSocket;
+	String				m_packet;
 };
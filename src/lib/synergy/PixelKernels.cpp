@@ -0,0 +1,495 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/PixelKernels.h"
+
+// the vector kernels are compiled for their instruction set without
+// changing the flags for the whole build, and only run if the cpu
+// supports them.
+#if (defined(__GNUC__) || defined(__clang__)) && \
+	(defined(__x86_64__) || defined(__i386__))
+#	define PIXEL_KERNELS_X86 1
+#	define TARGET_SSSE3 __attribute__((target("ssse3")))
+#	define TARGET_AVX2 __attribute__((target("avx2")))
+#	include <cpuid.h>
+#	include <immintrin.h>
+#elif defined(_MSC_VER) && _MSC_VER >= 1700 && \
+	(defined(_M_X64) || defined(_M_IX86))
+#	define PIXEL_KERNELS_X86 1
+#	define TARGET_SSSE3
+#	define TARGET_AVX2
+#	include <intrin.h>
+#	include <immintrin.h>
+#endif
+
+// a set of kernel implementations
+class PixelKernelSet {
+public:
+	void			(*bgrToBGRA)(UInt8*, const UInt8*, UInt32, UInt8);
+	void			(*bgraToBGR)(UInt8*, const UInt8*, UInt32);
+	void			(*fillAlpha)(UInt8*, UInt32, UInt8);
+	void			(*swapRows)(UInt8*, UInt8*, UInt32);
+};
+
+//
+// scalar kernels
+//
+
+static
+void
+scalarBGRToBGRA(UInt8* dst, const UInt8* src, UInt32 pixels, UInt8 alpha)
+{
+	for (; pixels > 0; --pixels) {
+		dst[0] = src[0];
+		dst[1] = src[1];
+		dst[2] = src[2];
+		dst[3] = alpha;
+		dst   += 4;
+		src   += 3;
+	}
+}
+
+static
+void
+scalarBGRAToBGR(UInt8* dst, const UInt8* src, UInt32 pixels)
+{
+	for (; pixels > 0; --pixels) {
+		dst[0] = src[0];
+		dst[1] = src[1];
+		dst[2] = src[2];
+		dst   += 3;
+		src   += 4;
+	}
+}
+
+static
+void
+scalarFillAlpha(UInt8* bgra, UInt32 pixels, UInt8 alpha)
+{
+	for (; pixels > 0; --pixels) {
+		bgra[3] = alpha;
+		bgra   += 4;
+	}
+}
+
+static
+void
+scalarSwapRows(UInt8* a, UInt8* b, UInt32 bytes)
+{
+	for (; bytes > 0; --bytes) {
+		UInt8 tmp = *a;
+		*a++      = *b;
+		*b++      = tmp;
+	}
+}
+
+#if PIXEL_KERNELS_X86
+
+//
+// SSSE3 kernels
+//
+// a 16 byte load of 4 BGR pixels reads 4 bytes past them and a 16
+// byte store of 4 BGR pixels writes 4 bytes past them, so the loops
+// stop while there are at least 2 more pixels and leave the rest to
+// the scalar kernels.
+//
+
+static
+TARGET_SSSE3
+void
+ssse3BGRToBGRA(UInt8* dst, const UInt8* src, UInt32 pixels, UInt8 alpha)
+{
+	const __m128i shuffle = _mm_setr_epi8(
+								0, 1, 2, -1, 3, 4, 5, -1,
+								6, 7, 8, -1, 9, 10, 11, -1);
+	const __m128i alphas  = _mm_set1_epi32(
+								static_cast<int>(static_cast<UInt32>(alpha) << 24));
+	for (; pixels >= 6; pixels -= 4) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+		v = _mm_or_si128(_mm_shuffle_epi8(v, shuffle), alphas);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), v);
+		dst += 16;
+		src += 12;
+	}
+	scalarBGRToBGRA(dst, src, pixels, alpha);
+}
+
+static
+TARGET_SSSE3
+void
+ssse3BGRAToBGR(UInt8* dst, const UInt8* src, UInt32 pixels)
+{
+	const __m128i shuffle = _mm_setr_epi8(
+								0, 1, 2, 4, 5, 6, 8, 9,
+								10, 12, 13, 14, -1, -1, -1, -1);
+	for (; pixels >= 6; pixels -= 4) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+								_mm_shuffle_epi8(v, shuffle));
+		dst += 12;
+		src += 16;
+	}
+	scalarBGRAToBGR(dst, src, pixels);
+}
+
+static
+TARGET_SSSE3
+void
+ssse3FillAlpha(UInt8* bgra, UInt32 pixels, UInt8 alpha)
+{
+	const __m128i colors = _mm_set1_epi32(0x00ffffff);
+	const __m128i alphas = _mm_set1_epi32(
+								static_cast<int>(static_cast<UInt32>(alpha) << 24));
+	for (; pixels >= 4; pixels -= 4) {
+		__m128i* p = reinterpret_cast<__m128i*>(bgra);
+		__m128i v  = _mm_loadu_si128(p);
+		_mm_storeu_si128(p, _mm_or_si128(_mm_and_si128(v, colors), alphas));
+		bgra += 16;
+	}
+	scalarFillAlpha(bgra, pixels, alpha);
+}
+
+static
+TARGET_SSSE3
+void
+ssse3SwapRows(UInt8* a, UInt8* b, UInt32 bytes)
+{
+	for (; bytes >= 16; bytes -= 16) {
+		__m128i* pa = reinterpret_cast<__m128i*>(a);
+		__m128i* pb = reinterpret_cast<__m128i*>(b);
+		__m128i va  = _mm_loadu_si128(pa);
+		__m128i vb  = _mm_loadu_si128(pb);
+		_mm_storeu_si128(pa, vb);
+		_mm_storeu_si128(pb, va);
+		a += 16;
+		b += 16;
+	}
+	scalarSwapRows(a, b, bytes);
+}
+
+//
+// AVX2 kernels
+//
+// the byte shuffle works within each 16 byte half so 8 BGR pixels are
+// loaded as two overlapping halves of 4.  the tails are done by the
+// SSSE3 kernels.
+//
+
+static
+TARGET_AVX2
+void
+avx2BGRToBGRA(UInt8* dst, const UInt8* src, UInt32 pixels, UInt8 alpha)
+{
+	const __m256i shuffle = _mm256_setr_epi8(
+								0, 1, 2, -1, 3, 4, 5, -1,
+								6, 7, 8, -1, 9, 10, 11, -1,
+								0, 1, 2, -1, 3, 4, 5, -1,
+								6, 7, 8, -1, 9, 10, 11, -1);
+	const __m256i alphas  = _mm256_set1_epi32(
+								static_cast<int>(static_cast<UInt32>(alpha) << 24));
+	for (; pixels >= 10; pixels -= 8) {
+		__m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+		__m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 12));
+		__m256i v  = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+		v = _mm256_or_si256(_mm256_shuffle_epi8(v, shuffle), alphas);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), v);
+		dst += 32;
+		src += 24;
+	}
+	ssse3BGRToBGRA(dst, src, pixels, alpha);
+}
+
+static
+TARGET_AVX2
+void
+avx2BGRAToBGR(UInt8* dst, const UInt8* src, UInt32 pixels)
+{
+	const __m256i shuffle = _mm256_setr_epi8(
+								0, 1, 2, 4, 5, 6, 8, 9,
+								10, 12, 13, 14, -1, -1, -1, -1,
+								0, 1, 2, 4, 5, 6, 8, 9,
+								10, 12, 13, 14, -1, -1, -1, -1);
+	for (; pixels >= 10; pixels -= 8) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+		v = _mm256_shuffle_epi8(v, shuffle);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+								_mm256_castsi256_si128(v));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 12),
+								_mm256_extracti128_si256(v, 1));
+		dst += 24;
+		src += 32;
+	}
+	ssse3BGRAToBGR(dst, src, pixels);
+}
+
+static
+TARGET_AVX2
+void
+avx2FillAlpha(UInt8* bgra, UInt32 pixels, UInt8 alpha)
+{
+	const __m256i colors = _mm256_set1_epi32(0x00ffffff);
+	const __m256i alphas = _mm256_set1_epi32(
+								static_cast<int>(static_cast<UInt32>(alpha) << 24));
+	for (; pixels >= 8; pixels -= 8) {
+		__m256i* p = reinterpret_cast<__m256i*>(bgra);
+		__m256i v  = _mm256_loadu_si256(p);
+		_mm256_storeu_si256(p,
+								_mm256_or_si256(_mm256_and_si256(v, colors), alphas));
+		bgra += 32;
+	}
+	ssse3FillAlpha(bgra, pixels, alpha);
+}
+
+static
+TARGET_AVX2
+void
+avx2SwapRows(UInt8* a, UInt8* b, UInt32 bytes)
+{
+	for (; bytes >= 32; bytes -= 32) {
+		__m256i* pa = reinterpret_cast<__m256i*>(a);
+		__m256i* pb = reinterpret_cast<__m256i*>(b);
+		__m256i va  = _mm256_loadu_si256(pa);
+		__m256i vb  = _mm256_loadu_si256(pb);
+		_mm256_storeu_si256(pa, vb);
+		_mm256_storeu_si256(pb, va);
+		a += 32;
+		b += 32;
+	}
+	ssse3SwapRows(a, b, bytes);
+}
+
+static
+void
+cpuid(int leaf, int subleaf, UInt32 regs[4])
+{
+#if defined(_MSC_VER)
+	int r[4];
+	__cpuidex(r, leaf, subleaf);
+	for (int i = 0; i < 4; ++i) {
+		regs[i] = static_cast<UInt32>(r[i]);
+	}
+#else
+	__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// the OS must save the AVX registers on a context switch too
+static
+bool
+osSavesAVX()
+{
+#if defined(_MSC_VER)
+	return ((_xgetbv(0) & 6) == 6);
+#else
+	UInt32 eax, edx;
+	__asm__ __volatile__(".byte 0x0f, 0x01, 0xd0"	// xgetbv
+								: "=a" (eax), "=d" (edx) : "c" (0));
+	return ((eax & 6) == 6);
+#endif
+}
+
+#endif
+
+static const PixelKernelSet s_kernels[PixelKernels::kNumInstructionSets] = {
+	{ &scalarBGRToBGRA, &scalarBGRAToBGR, &scalarFillAlpha, &scalarSwapRows },
+#if PIXEL_KERNELS_X86
+	{ &ssse3BGRToBGRA, &ssse3BGRAToBGR, &ssse3FillAlpha, &ssse3SwapRows },
+	{ &avx2BGRToBGRA, &avx2BGRAToBGR, &avx2FillAlpha, &avx2SwapRows }
+#else
+	{ &scalarBGRToBGRA, &scalarBGRAToBGR, &scalarFillAlpha, &scalarSwapRows },
+	{ &scalarBGRToBGRA, &scalarBGRAToBGR, &scalarFillAlpha, &scalarSwapRows }
+#endif
+};
+
+// the kernels in use, chosen on first use.  racing to choose is
+// harmless since every thread chooses the same kernels.
+static const PixelKernelSet* s_current = NULL;
+static PixelKernels::EInstructionSet s_currentSet = PixelKernels::kScalar;
+
+static
+const PixelKernelSet&
+getKernels()
+{
+	if (s_current == NULL) {
+		PixelKernels::setInstructionSet(PixelKernels::kAVX2);
+	}
+	return *s_current;
+}
+
+// BMP is little-endian
+static
+inline
+SInt32
+fromLES32(const UInt8* data)
+{
+	return static_cast<SInt32>(static_cast<UInt32>(data[0]) |
+			(static_cast<UInt32>(data[1]) <<  8) |
+			(static_cast<UInt32>(data[2]) << 16) |
+			(static_cast<UInt32>(data[3]) << 24));
+}
+
+static
+inline
+void
+toLE(UInt8* dst, SInt32 src)
+{
+	dst[0] = static_cast<UInt8>(src & 0xffu);
+	dst[1] = static_cast<UInt8>((src >>  8) & 0xffu);
+	dst[2] = static_cast<UInt8>((src >> 16) & 0xffu);
+	dst[3] = static_cast<UInt8>((src >> 24) & 0xffu);
+}
+
+
+//
+// PixelKernels
+//
+
+void
+PixelKernels::bgrToBGRA(UInt8* dst, const UInt8* src,
+				UInt32 pixels, UInt8 alpha)
+{
+	getKernels().bgrToBGRA(dst, src, pixels, alpha);
+}
+
+void
+PixelKernels::bgraToBGR(UInt8* dst, const UInt8* src, UInt32 pixels)
+{
+	getKernels().bgraToBGR(dst, src, pixels);
+}
+
+void
+PixelKernels::fillAlpha(UInt8* bgra, UInt32 pixels, UInt8 alpha)
+{
+	getKernels().fillAlpha(bgra, pixels, alpha);
+}
+
+void
+PixelKernels::flipRows(UInt8* data, UInt32 rowBytes, UInt32 rows)
+{
+	const PixelKernelSet& kernels = getKernels();
+	UInt8* top    = data;
+	UInt8* bottom = data + rowBytes * (rows == 0 ? 0 : rows - 1);
+	for (; top < bottom; top += rowBytes, bottom -= rowBytes) {
+		kernels.swapRows(top, bottom, rowBytes);
+	}
+}
+
+bool
+PixelKernels::makeBottomUp(String& dib)
+{
+	// check the BITMAPINFOHEADER
+	if (dib.size() < 40) {
+		return false;
+	}
+	UInt8* header = reinterpret_cast<UInt8*>(&dib[0]);
+	const SInt32 size        = fromLES32(header +  0);
+	const SInt32 width       = fromLES32(header +  4);
+	const SInt32 height      = fromLES32(header +  8);
+	const UInt32 bitCount    = header[14] | (header[15] << 8);
+	const SInt32 compression = fromLES32(header + 16);
+	if (size != 40 || width <= 0 || height == 0 || compression != 0 ||
+		(bitCount != 24 && bitCount != 32)) {
+		return false;
+	}
+	if (height > 0) {
+		return true;
+	}
+
+	// rows are padded to 4 bytes
+	const UInt32 rows     = static_cast<UInt32>(-height);
+	const UInt32 rowBytes = ((static_cast<UInt32>(width) * bitCount / 8) + 3) & ~3u;
+	if (rowBytes / (bitCount / 8) < static_cast<UInt32>(width) ||
+		(dib.size() - 40) / rowBytes < rows) {
+		return false;
+	}
+
+	flipRows(header + 40, rowBytes, rows);
+	toLE(header + 8, static_cast<SInt32>(rows));
+	return true;
+}
+
+void
+PixelKernels::setInstructionSet(EInstructionSet set)
+{
+	while (!isSupported(set)) {
+		set = static_cast<EInstructionSet>(set - 1);
+	}
+	s_currentSet = set;
+	s_current    = &s_kernels[set];
+}
+
+PixelKernels::EInstructionSet
+PixelKernels::getInstructionSet()
+{
+	getKernels();
+	return s_currentSet;
+}
+
+bool
+PixelKernels::isSupported(EInstructionSet set)
+{
+	switch (set) {
+	case kScalar:
+		return true;
+
+#if PIXEL_KERNELS_X86
+	case kSSSE3: {
+		UInt32 regs[4];
+		cpuid(1, 0, regs);
+		return ((regs[2] & (1u << 9)) != 0);
+	}
+
+	case kAVX2: {
+		// needs OSXSAVE and AVX, an OS that saves the registers
+		// and AVX2
+		UInt32 regs[4];
+		cpuid(0, 0, regs);
+		if (regs[0] < 7) {
+			return false;
+		}
+		cpuid(1, 0, regs);
+		const UInt32 avx = (1u << 27) | (1u << 28);
+		if ((regs[2] & avx) != avx || !osSavesAVX()) {
+			return false;
+		}
+		cpuid(7, 0, regs);
+		return ((regs[1] & (1u << 5)) != 0);
+	}
+#endif
+
+	default:
+		return false;
+	}
+}
+
+const char*
+PixelKernels::getName(EInstructionSet set)
+{
+	switch (set) {
+	case kScalar:
+		return "scalar";
+
+	case kSSSE3:
+		return "SSSE3";
+
+	case kAVX2:
+		return "AVX2";
+
+	default:
+		return "unknown";
+	}
+}
@@ -0,0 +1,108 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/String.h"
+#include "common/basic_types.h"
+
+//! Bitmap pixel conversion kernels
+/*!
+Pixel loops shared by the platform bitmap clipboard converters.  Each
+kernel has a scalar version and, on x86, SSSE3 and AVX2 versions;  the
+best one the CPU supports is picked the first time a kernel is used.
+Pixels are in BMP byte order (blue, green, red and, for 32 bit pixels,
+alpha).  Source and destination buffers must not overlap.
+*/
+class PixelKernels {
+public:
+	//! Kernel implementations, slowest first
+	enum EInstructionSet {
+		kScalar,
+		kSSSE3,
+		kAVX2,
+		kNumInstructionSets
+	};
+
+	//! @name manipulators
+	//@{
+
+	//! Expand 24 bit pixels to 32 bit
+	/*!
+	Converts \p pixels BGR pixels from \p src to BGRA pixels in \p dst,
+	setting each alpha to \p alpha.
+	*/
+	static void			bgrToBGRA(UInt8* dst, const UInt8* src,
+							UInt32 pixels, UInt8 alpha);
+
+	//! Pack 32 bit pixels to 24 bit
+	/*!
+	Converts \p pixels BGRA pixels from \p src to BGR pixels in \p dst,
+	dropping the alpha.
+	*/
+	static void			bgraToBGR(UInt8* dst, const UInt8* src,
+							UInt32 pixels);
+
+	//! Set alpha
+	/*!
+	Sets the alpha of \p pixels BGRA pixels in \p bgra to \p alpha.
+	*/
+	static void			fillAlpha(UInt8* bgra, UInt32 pixels, UInt8 alpha);
+
+	//! Flip rows
+	/*!
+	Reverses the order of the \p rows rows of \p rowBytes bytes each in
+	\p data, converting between top-down and bottom-up images.
+	*/
+	static void			flipRows(UInt8* data, UInt32 rowBytes, UInt32 rows);
+
+	//! Make a DIB bottom-up
+	/*!
+	If \p dib, a BITMAPINFOHEADER followed by uncompressed 24 or 32 bit
+	pixels, is stored top-down (i.e. has a negative height) then flips
+	its rows and makes the height positive, which is how bitmaps are
+	kept on the clipboard.  Returns false if \p dib isn't such a DIB or
+	is truncated, leaving it unchanged.
+	*/
+	static bool			makeBottomUp(String& dib);
+
+	//! Force an implementation
+	/*!
+	Makes the kernels use \p set, or the best supported set if it isn't
+	supported.  This is for tests and benchmarks.
+	*/
+	static void			setInstructionSet(EInstructionSet set);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get the implementation in use
+	static EInstructionSet
+						getInstructionSet();
+
+	//! Test for CPU support
+	/*!
+	Returns true iff the CPU (and the build) supports \p set.
+	*/
+	static bool			isSupported(EInstructionSet set);
+
+	//! Get an implementation's name
+	static const char*	getName(EInstructionSet set);
+
+	//@}
+};
@@ -19,6 +19,7 @@
 #include "synergy/PlatformScreen.h"
 #include "synergy/App.h"
 #include "synergy/ArgsBase.h"
+#include "synergy/Clipboard.h"
 
 PlatformScreen::PlatformScreen(IEventQueue* events) :
 	IPlatformScreen(events),
@@ -121,3 +122,41 @@ PlatformScreen::isDraggingStarted()
 	}
 	return false;
 }
+
+bool
+PlatformScreen::offerClipboard(ClipboardID, const IClipboard*, UInt32)
+{
+	// can't promise data by default
+	return false;
+}
+
+void
+PlatformScreen::setClipboardFormat(ClipboardID,
+				IClipboard::EFormat, const String&)
+{
+	// do nothing
+}
+
+bool
+PlatformScreen::getClipboardFormats(ClipboardID,
+				UInt32&, IClipboard::Time&) const
+{
+	// can't list the formats without fetching them by default
+	return false;
+}
+
+bool
+PlatformScreen::getClipboardFormat(ClipboardID id,
+				IClipboard::EFormat format, String& data) const
+{
+	Clipboard clipboard;
+	if (!getClipboard(id, &clipboard) || !clipboard.open(0)) {
+		return false;
+	}
+	bool result = clipboard.has(format);
+	if (result) {
+		data = clipboard.get(format);
+	}
+	clipboard.close();
+	return result;
+}
@@ -0,0 +1,256 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "synergy/ProtocolCapture.h"
+
+#include "mt/Atomic.h"
+#include "mt/Lock.h"
+#include "arch/Arch.h"
+#include "base/Log.h"
+#include "common/stdfstream.h"
+
+#include <cmath>
+#include <cstring>
+
+static const char		kMagic[]  = "SYNCAP";
+static const UInt8		kVersion  = 1;
+
+// the size of a packet in the file, less its payload
+static const UInt32		kRecordHeaderSize = 17;
+
+static volatile long	s_connections = 0;
+
+static void
+putUInt8(String& buffer, UInt8 value)
+{
+	buffer += static_cast<char>(value);
+}
+
+static void
+putUInt32(String& buffer, UInt32 value)
+{
+	buffer += static_cast<char>((value >> 24) & 0xff);
+	buffer += static_cast<char>((value >> 16) & 0xff);
+	buffer += static_cast<char>((value >>  8) & 0xff);
+	buffer += static_cast<char>( value        & 0xff);
+}
+
+static void
+putTime(String& buffer, double time)
+{
+	double seconds = floor(time);
+	putUInt32(buffer, static_cast<UInt32>(seconds));
+	putUInt32(buffer, static_cast<UInt32>(1.0e+6 * (time - seconds)));
+}
+
+static bool
+getBytes(std::istream& stream, UInt8* buffer, UInt32 n)
+{
+	stream.read(reinterpret_cast<char*>(buffer), n);
+	return (static_cast<UInt32>(stream.gcount()) == n);
+}
+
+static bool
+getUInt32(std::istream& stream, UInt32& value)
+{
+	UInt8 buffer[4];
+	if (!getBytes(stream, buffer, sizeof(buffer))) {
+		return false;
+	}
+	value = ((UInt32)buffer[0] << 24) |
+			((UInt32)buffer[1] << 16) |
+			((UInt32)buffer[2] <<  8) |
+			 (UInt32)buffer[3];
+	return true;
+}
+
+static bool
+getTime(std::istream& stream, double& time)
+{
+	UInt32 seconds, usec;
+	if (!getUInt32(stream, seconds) || !getUInt32(stream, usec)) {
+		return false;
+	}
+	time = seconds + 1.0e-6 * usec;
+	return true;
+}
+
+//
+// ProtocolCapture
+//
+
+ProtocolCapture*		ProtocolCapture::s_instance = NULL;
+
+ProtocolCapture::ProtocolCapture(const String& path,
+				UInt32 maxBytes, ESide side) :
+	m_path(path),
+	m_maxBytes(maxBytes),
+	m_side(side),
+	m_start(ARCH->monotonicTime()),
+	m_startTime(ARCH->time()),
+	m_bytes(0),
+	m_dropped(0)
+{
+	if (m_path.empty()) {
+		return;
+	}
+
+	assert(s_instance == NULL);
+	LOG((CLOG_NOTE "capturing protocol to %s", m_path.c_str()));
+	Atomic::store(&s_instance, this);
+}
+
+ProtocolCapture::~ProtocolCapture()
+{
+	if (m_path.empty()) {
+		return;
+	}
+
+	Atomic::store(&s_instance, static_cast<ProtocolCapture*>(NULL));
+	save();
+}
+
+bool
+ProtocolCapture::save()
+{
+	Lock lock(&m_mutex);
+
+	std::ofstream stream(m_path.c_str(), std::ios::out |
+							std::ios::binary | std::ios::trunc);
+	if (!stream.is_open()) {
+		LOG((CLOG_ERR "cannot write protocol capture %s", m_path.c_str()));
+		return false;
+	}
+
+	String buffer(kMagic, sizeof(kMagic) - 1);
+	putUInt8(buffer, kVersion);
+	putUInt8(buffer, static_cast<UInt8>(m_side));
+	putTime(buffer, m_startTime);
+	stream.write(buffer.data(), buffer.size());
+
+	for (RecordList::const_iterator i = m_records.begin();
+							i != m_records.end(); ++i) {
+		buffer.clear();
+		putTime(buffer, i->m_time);
+		putUInt32(buffer, i->m_connection);
+		putUInt8(buffer, static_cast<UInt8>(i->m_direction));
+		putUInt32(buffer, static_cast<UInt32>(i->m_data.size()));
+		stream.write(buffer.data(), buffer.size());
+		stream.write(i->m_data.data(), i->m_data.size());
+	}
+
+	stream.close();
+	if (stream.fail()) {
+		LOG((CLOG_ERR "cannot write protocol capture %s", m_path.c_str()));
+		return false;
+	}
+	LOG((CLOG_NOTE "wrote %u packets to %s, %u older packets dropped", static_cast<UInt32>(m_records.size()), m_path.c_str(), m_dropped));
+	return true;
+}
+
+void
+ProtocolCapture::record(UInt32 connection, EDirection direction,
+				const void* data, UInt32 size)
+{
+	ProtocolCapture* capture = Atomic::load(&s_instance);
+	if (capture != NULL) {
+		capture->add(connection, direction, data, size);
+	}
+}
+
+UInt32
+ProtocolCapture::newConnection()
+{
+	return static_cast<UInt32>(Atomic::add(&s_connections, 1));
+}
+
+bool
+ProtocolCapture::isCapturing()
+{
+	return (Atomic::load(&s_instance) != NULL);
+}
+
+bool
+ProtocolCapture::load(const String& path, ESide& side, RecordList& records)
+{
+	std::ifstream stream(path.c_str(), std::ios::in | std::ios::binary);
+	if (!stream.is_open()) {
+		return false;
+	}
+
+	// check the header
+	UInt8 header[sizeof(kMagic) + 1];
+	double startTime;
+	if (!getBytes(stream, header, sizeof(header)) ||
+		memcmp(header, kMagic, sizeof(kMagic) - 1) != 0 ||
+		header[sizeof(kMagic) - 1] != kVersion ||
+		header[sizeof(kMagic)] > kServer ||
+		!getTime(stream, startTime)) {
+		return false;
+	}
+	side = static_cast<ESide>(header[sizeof(kMagic)]);
+
+	// read until the end.  a truncated packet ends the capture.
+	records.clear();
+	for (;;) {
+		Record record;
+		UInt8 direction;
+		UInt32 size;
+		if (!getTime(stream, record.m_time)) {
+			break;
+		}
+		if (!getUInt32(stream, record.m_connection) ||
+			!getBytes(stream, &direction, 1) || direction > kOutput ||
+			!getUInt32(stream, size)) {
+			return false;
+		}
+		record.m_direction = static_cast<EDirection>(direction);
+		record.m_data.resize(size);
+		if (size > 0 && !getBytes(stream,
+							reinterpret_cast<UInt8*>(&record.m_data[0]),
+							size)) {
+			return false;
+		}
+		records.push_back(record);
+	}
+	return true;
+}
+
+void
+ProtocolCapture::add(UInt32 connection, EDirection direction,
+				const void* data, UInt32 size)
+{
+	Record record;
+	record.m_time       = ARCH->monotonicTime() - m_start;
+	record.m_connection = connection;
+	record.m_direction  = direction;
+	record.m_data.assign(static_cast<const char*>(data), size);
+
+	Lock lock(&m_mutex);
+	m_records.push_back(record);
+	m_bytes += kRecordHeaderSize + size;
+
+	// drop the oldest packets to stay in bounds, but always keep the
+	// newest one
+	while (m_bytes > m_maxBytes && m_records.size() > 1) {
+		m_bytes -= kRecordHeaderSize +
+							static_cast<UInt32>(m_records.front().m_data.size());
+		m_records.pop_front();
+		++m_dropped;
+	}
+}
@@ -0,0 +1,134 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "mt/Mutex.h"
+#include "base/String.h"
+#include "common/basic_types.h"
+#include "common/stddeque.h"
+
+//! Protocol capture
+/*!
+Records every packet that each PacketStreamFilter in this process reads
+or writes, with the time and the connection, for replaying later with
+<tt>syntool --replay</tt>.  Only the most recent packets are kept, in a
+ring of at most a given size, and they're written to the capture file
+when the ProtocolCapture is destroyed or saved.
+
+Capture files start with the magic \c SYNCAP, a version byte, a byte
+saying which end captured the packets and the time the capture started.
+Each packet follows as its time since the start, its connection (4
+bytes), its direction (1 byte), its size (4 bytes) and its payload.
+Times are 4 bytes of seconds and 4 of microseconds.  All integers are
+big-endian.
+*/
+class ProtocolCapture {
+public:
+	//! The end of the connections that captured the packets
+	enum ESide {
+		kClient,
+		kServer
+	};
+
+	//! Packet direction
+	enum EDirection {
+		kInput,
+		kOutput
+	};
+
+	//! A captured packet
+	class Record {
+	public:
+		double			m_time;
+		UInt32			m_connection;
+		EDirection		m_direction;
+		String			m_data;
+	};
+	typedef std::deque<Record> RecordList;
+
+	//! Start capturing
+	/*!
+	Captures to \p path, keeping at most \p maxBytes of packets.  If
+	\p path is empty then nothing is captured.  Only one capture may be
+	in progress at a time and it must outlive the connections it
+	captures.
+	*/
+	ProtocolCapture(const String& path, UInt32 maxBytes, ESide side);
+	~ProtocolCapture();
+
+	//! @name manipulators
+	//@{
+
+	//! Write the capture file
+	/*!
+	Writes the packets captured so far to the capture file, replacing
+	it.  Returns false if it couldn't be written.
+	*/
+	bool				save();
+
+	//! Capture a packet
+	/*!
+	Records a packet's payload if a capture is in progress.
+	*/
+	static void			record(UInt32 connection, EDirection direction,
+							const void* data, UInt32 size);
+
+	//! Get a connection id
+	/*!
+	Returns a number that identifies a connection in captures.
+	*/
+	static UInt32		newConnection();
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Test for a capture in progress
+	static bool			isCapturing();
+
+	//! Read a capture file
+	/*!
+	Reads the packets in the capture file \p path into \p records and
+	which end captured them into \p side.  Returns false if the file
+	can't be read or isn't a capture file.
+	*/
+	static bool			load(const String& path, ESide& side,
+							RecordList& records);
+
+	//@}
+
+private:
+	void				add(UInt32 connection, EDirection direction,
+							const void* data, UInt32 size);
+
+private:
+	static ProtocolCapture*	s_instance;
+
+	String				m_path;
+	UInt32				m_maxBytes;
+	ESide				m_side;
+	double				m_start;
+	double				m_startTime;
+
+	// the ring, guarded by m_mutex
+	Mutex				m_mutex;
+	RecordList			m_records;
+	UInt32				m_bytes;
+	UInt32				m_dropped;
+};
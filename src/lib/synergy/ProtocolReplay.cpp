@@ -0,0 +1,399 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "synergy/ProtocolReplay.h"
+
+#include "synergy/ReplayStream.h"
+#include "synergy/PacketStreamFilter.h"
+#include "synergy/Screen.h"
+#include "synergy/protocol_types.h"
+#include "client/Client.h"
+#include "client/ServerProxy.h"
+#include "server/ClientProxy.h"
+#include "server/ClientProxyUnknown.h"
+#include "server/Config.h"
+#include "server/PrimaryClient.h"
+#include "server/Server.h"
+#include "platform/NullScreen.h"
+#include "net/NetworkAddress.h"
+#include "net/TCPSocketFactory.h"
+#include "arch/Arch.h"
+#include "base/IEventQueue.h"
+#include "base/TMethodEventJob.h"
+#include "base/Log.h"
+
+#include <cstring>
+
+// the name of the server's own screen
+static const char*		kPrimaryName    = "replay-server";
+
+// the hello's "Synergy" and its length with the protocol version
+static const UInt32		kHelloMagicSize = 7;
+static const UInt32		kHelloSize      = 11;
+
+//
+// ProtocolReplay
+//
+
+ProtocolReplay::ProtocolReplay(IEventQueue* events) :
+	m_events(events),
+	m_side(ProtocolCapture::kServer),
+	m_records(NULL),
+	m_originalTiming(false),
+	m_quit(false),
+	m_config(NULL),
+	m_screen(NULL),
+	m_primaryClient(NULL),
+	m_server(NULL),
+	m_packets(0),
+	m_bytes(0.0),
+	m_seconds(0.0)
+{
+	m_clientArgs.m_enableDragDrop = false;
+	m_clientArgs.m_enableCrypto   = false;
+}
+
+ProtocolReplay::~ProtocolReplay()
+{
+	close();
+}
+
+void
+ProtocolReplay::run(ProtocolCapture::ESide side,
+				const ProtocolCapture::RecordList& records,
+				bool originalTiming)
+{
+	close();
+	m_side           = side;
+	m_records        = &records;
+	m_originalTiming = originalTiming;
+	m_quit           = false;
+	m_packets        = 0;
+	m_bytes          = 0.0;
+	m_seconds        = 0.0;
+	m_latency.reset();
+
+	// replay from inside the event loop, which readies the queue
+	EventQueueTimer* timer = m_events->newOneShotTimer(0.001, NULL);
+	m_events->adoptHandler(Event::kTimer, timer,
+							new TMethodEventJob<ProtocolReplay>(this,
+								&ProtocolReplay::handleReplay));
+	m_events->loop();
+	m_events->removeHandler(Event::kTimer, timer);
+	m_events->deleteTimer(timer);
+	m_records = NULL;
+}
+
+UInt32
+ProtocolReplay::getPackets() const
+{
+	return m_packets;
+}
+
+double
+ProtocolReplay::getBytes() const
+{
+	return m_bytes;
+}
+
+double
+ProtocolReplay::getSeconds() const
+{
+	return m_seconds;
+}
+
+const LatencyHistogram&
+ProtocolReplay::getLatency() const
+{
+	return m_latency;
+}
+
+void
+ProtocolReplay::openServer(const NameList& names)
+{
+	// every screen stands alone;  only the messages matter
+	m_config = new Config(m_events);
+	m_config->addScreen(kPrimaryName);
+	for (NameList::const_iterator i = names.begin(); i != names.end(); ++i) {
+		if (!m_config->isScreen(*i)) {
+			m_config->addScreen(*i);
+		}
+	}
+
+	m_screen        = new synergy::Screen(
+							new NullScreen(m_events, true), m_events);
+	m_primaryClient = new PrimaryClient(kPrimaryName, m_screen);
+	m_server        = new Server(*m_config, m_primaryClient,
+							m_screen, m_events, false);
+}
+
+void
+ProtocolReplay::close()
+{
+	// clients still shaking hands
+	for (std::set<ClientProxyUnknown*>::iterator
+							i = m_unknownClients.begin();
+							i != m_unknownClients.end(); ++i) {
+		m_events->removeHandler(
+							m_events->forClientProxyUnknown().success(), *i);
+		m_events->removeHandler(
+							m_events->forClientProxyUnknown().failure(), *i);
+		delete *i;
+	}
+	m_unknownClients.clear();
+
+	// the server deletes its clients, and with them their filters
+	delete m_server;
+	delete m_primaryClient;
+	delete m_screen;
+	delete m_config;
+	m_server        = NULL;
+	m_primaryClient = NULL;
+	m_screen        = NULL;
+	m_config        = NULL;
+
+	// the streams outlive everything that reads them
+	for (ConnectionMap::iterator i = m_connections.begin();
+							i != m_connections.end(); ++i) {
+		closeConnection(i->second);
+		delete i->second.m_stream;
+	}
+	m_connections.clear();
+
+	// discard whatever is left
+	dispatchEvents(0.0);
+}
+
+ProtocolReplay::Connection&
+ProtocolReplay::getConnection(UInt32 id)
+{
+	ConnectionMap::iterator index = m_connections.find(id);
+	if (index != m_connections.end()) {
+		return index->second;
+	}
+
+	Connection& connection   = m_connections[id];
+	connection.m_stream      = new ReplayStream(m_events);
+	connection.m_screen      = NULL;
+	connection.m_client      = NULL;
+	connection.m_filter      = NULL;
+	connection.m_serverProxy = NULL;
+
+	PacketStreamFilter* filter =
+		new PacketStreamFilter(m_events, connection.m_stream, false);
+	if (m_side == ProtocolCapture::kServer) {
+		// the proxy, and after the handshake the server, owns the filter
+		ClientProxyUnknown* unknownClient =
+			new ClientProxyUnknown(filter, 30.0, m_server, m_events);
+		m_unknownClients.insert(unknownClient);
+		m_events->adoptHandler(m_events->forClientProxyUnknown().success(),
+							unknownClient,
+							new TMethodEventJob<ProtocolReplay>(this,
+								&ProtocolReplay::handleUnknownClient,
+								unknownClient));
+		m_events->adoptHandler(m_events->forClientProxyUnknown().failure(),
+							unknownClient,
+							new TMethodEventJob<ProtocolReplay>(this,
+								&ProtocolReplay::handleUnknownClient,
+								unknownClient));
+	}
+	else {
+		// the socket factory is never used
+		connection.m_filter = filter;
+		connection.m_screen = new synergy::Screen(
+							new NullScreen(m_events, false), m_events);
+		connection.m_client = new Client(m_events, "replay",
+							NetworkAddress(),
+							new TCPSocketFactory(m_events, NULL),
+							connection.m_screen, m_clientArgs);
+	}
+	return connection;
+}
+
+void
+ProtocolReplay::replay(Connection& connection, const String& data)
+{
+	// a client answers the server's hello itself and only then starts
+	// its proxy
+	if (m_side == ProtocolCapture::kClient &&
+		connection.m_serverProxy == NULL) {
+		connection.m_serverProxy = new ServerProxy(connection.m_client,
+							connection.m_filter, m_events);
+		if (isHello(data)) {
+			return;
+		}
+	}
+
+	// frame the packet as it arrived
+	const UInt32 size = static_cast<UInt32>(data.size());
+	String packet;
+	packet.reserve(4 + data.size());
+	packet += static_cast<char>((size >> 24) & 0xff);
+	packet += static_cast<char>((size >> 16) & 0xff);
+	packet += static_cast<char>((size >>  8) & 0xff);
+	packet += static_cast<char>( size        & 0xff);
+	packet += data;
+	connection.m_stream->push(packet.data(), static_cast<UInt32>(packet.size()));
+}
+
+void
+ProtocolReplay::closeConnection(Connection& connection)
+{
+	if (m_side == ProtocolCapture::kServer) {
+		// the client proxy disconnects itself
+		connection.m_stream->shutdownInput();
+		return;
+	}
+
+	delete connection.m_serverProxy;
+	delete connection.m_client;
+	delete connection.m_screen;
+	delete connection.m_filter;
+	connection.m_serverProxy = NULL;
+	connection.m_client      = NULL;
+	connection.m_screen      = NULL;
+	connection.m_filter      = NULL;
+}
+
+void
+ProtocolReplay::dispatchEvents(double timeout)
+{
+	Event event;
+	while (m_events->getEvent(event, timeout)) {
+		if (event.getType() == Event::kQuit) {
+			m_quit = true;
+		}
+		else {
+			m_events->dispatchEvent(event);
+		}
+		Event::deleteData(event);
+		timeout = 0.0;
+	}
+}
+
+void
+ProtocolReplay::handleUnknownClient(const Event&, void* vclient)
+{
+	ClientProxyUnknown* unknownClient =
+		reinterpret_cast<ClientProxyUnknown*>(vclient);
+
+	ClientProxy* client = unknownClient->orphanClientProxy();
+	if (client != NULL) {
+		m_server->adoptClient(client);
+	}
+
+	m_events->removeHandler(
+						m_events->forClientProxyUnknown().success(), vclient);
+	m_events->removeHandler(
+						m_events->forClientProxyUnknown().failure(), vclient);
+	m_unknownClients.erase(unknownClient);
+	delete unknownClient;
+}
+
+void
+ProtocolReplay::handleReplay(const Event&, void*)
+{
+	const ProtocolCapture::RecordList& records = *m_records;
+
+	// find the last packet of each connection, so it can be closed
+	// after it, and the names of the clients the server must accept
+	std::map<UInt32, size_t> last;
+	NameList names;
+	for (size_t i = 0; i < records.size(); ++i) {
+		const ProtocolCapture::Record& record = records[i];
+		if (record.m_direction != ProtocolCapture::kInput) {
+			continue;
+		}
+		String name;
+		if (last.count(record.m_connection) == 0 &&
+			getClientName(record.m_data, name)) {
+			names.push_back(name);
+		}
+		last[record.m_connection] = i;
+	}
+	if (m_side == ProtocolCapture::kServer) {
+		openServer(names);
+	}
+
+	const double start = ARCH->monotonicTime();
+	double firstTime   = -1.0;
+	for (size_t i = 0; i < records.size() && !m_quit; ++i) {
+		const ProtocolCapture::Record& record = records[i];
+		if (record.m_direction != ProtocolCapture::kInput) {
+			continue;
+		}
+
+		// wait for the packet's time, handling timers meanwhile
+		if (firstTime < 0.0) {
+			firstTime = record.m_time;
+		}
+		if (m_originalTiming) {
+			const double due = start + (record.m_time - firstTime);
+			for (double now = ARCH->monotonicTime(); now < due && !m_quit;
+							now = ARCH->monotonicTime()) {
+				dispatchEvents(due - now);
+			}
+		}
+
+		// replay the packet and everything it causes
+		Connection& connection = getConnection(record.m_connection);
+		const double begin = ARCH->monotonicTime();
+		replay(connection, record.m_data);
+		dispatchEvents(0.0);
+		m_latency.record(static_cast<UInt32>(
+							1.0e+6 * (ARCH->monotonicTime() - begin)));
+		++m_packets;
+		m_bytes += record.m_data.size();
+
+		if (last[record.m_connection] == i) {
+			closeConnection(connection);
+			dispatchEvents(0.0);
+		}
+	}
+	m_seconds = ARCH->monotonicTime() - start;
+
+	close();
+	m_events->addEvent(Event(Event::kQuit));
+}
+
+bool
+ProtocolReplay::getClientName(const String& data, String& name)
+{
+	// the hello back is the hello followed by the name's length and name
+	if (!isHello(data) || data.size() < kHelloSize + 4) {
+		return false;
+	}
+	const UInt8* length =
+		reinterpret_cast<const UInt8*>(data.data() + kHelloSize);
+	const UInt32 size = ((UInt32)length[0] << 24) |
+						((UInt32)length[1] << 16) |
+						((UInt32)length[2] <<  8) |
+						 (UInt32)length[3];
+	if (data.size() != kHelloSize + 4 + size) {
+		return false;
+	}
+	name = data.substr(kHelloSize + 4);
+	return true;
+}
+
+bool
+ProtocolReplay::isHello(const String& data)
+{
+	return (data.size() >= kHelloSize &&
+			memcmp(data.data(), kMsgHello, kHelloMagicSize) == 0);
+}
@@ -0,0 +1,147 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "synergy/ProtocolCapture.h"
+#include "synergy/ClientArgs.h"
+#include "base/LatencyHistogram.h"
+#include "base/Event.h"
+#include "common/stdmap.h"
+#include "common/stdset.h"
+#include "common/stdvector.h"
+
+class Client;
+class ClientProxyUnknown;
+class Config;
+class IEventQueue;
+class PacketStreamFilter;
+class PrimaryClient;
+class ReplayStream;
+class Server;
+class ServerProxy;
+namespace synergy { class Screen; }
+
+//! Protocol replay
+/*!
+Feeds the packets that a client or server received, as read from a
+ProtocolCapture file, back through the ServerProxy or ClientProxy that
+parsed them, with a NullScreen in place of the real screen.  This times
+the message path on real traffic without a display or a network.
+
+Packets are replayed in order, as fast as possible or at the pace they
+were captured, and the events each one causes are handled before the
+next is replayed.  A connection is closed after its last packet.  A
+connection whose handshake was dropped from the capture's ring is
+rejected just as it would have been live.
+*/
+class ProtocolReplay {
+public:
+	ProtocolReplay(IEventQueue* events);
+	~ProtocolReplay();
+
+	//! @name manipulators
+	//@{
+
+	//! Replay packets
+	/*!
+	Replays the packets received in \p records, which were captured by
+	\p side.  If \p originalTiming is true then each packet is replayed
+	as long after the first as it arrived, otherwise without waiting.
+	This runs the event loop until the replay is done or a \c kQuit
+	event arrives.
+	*/
+	void				run(ProtocolCapture::ESide side,
+							const ProtocolCapture::RecordList& records,
+							bool originalTiming);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get the number of packets replayed
+	UInt32				getPackets() const;
+
+	//! Get the number of payload bytes replayed
+	double				getBytes() const;
+
+	//! Get the time the replay took, in seconds
+	double				getSeconds() const;
+
+	//! Get the time taken by each packet
+	/*!
+	Returns the time, in microseconds, from replaying each packet to
+	having handled every event it caused.
+	*/
+	const LatencyHistogram&
+						getLatency() const;
+
+	//@}
+
+private:
+	class Connection {
+	public:
+		ReplayStream*	m_stream;
+
+		// a client of its own for each connection to a server
+		synergy::Screen*	m_screen;
+		Client*			m_client;
+		PacketStreamFilter*	m_filter;
+		ServerProxy*	m_serverProxy;
+	};
+	typedef std::map<UInt32, Connection> ConnectionMap;
+	typedef std::vector<String> NameList;
+
+	void				openServer(const NameList& names);
+	void				close();
+
+	Connection&			getConnection(UInt32 id);
+	void				replay(Connection&, const String& data);
+	void				closeConnection(Connection&);
+
+	void				dispatchEvents(double timeout);
+
+	void				handleReplay(const Event&, void*);
+	void				handleUnknownClient(const Event&, void*);
+
+	static bool			getClientName(const String& data, String& name);
+	static bool			isHello(const String& data);
+
+private:
+	IEventQueue*		m_events;
+	ProtocolCapture::ESide	m_side;
+	const ProtocolCapture::RecordList*	m_records;
+	bool				m_originalTiming;
+	bool				m_quit;
+	ConnectionMap		m_connections;
+	std::set<ClientProxyUnknown*>	m_unknownClients;
+
+	// the server, when replaying a server's capture
+	Config*				m_config;
+	synergy::Screen*	m_screen;
+	PrimaryClient*		m_primaryClient;
+	Server*				m_server;
+
+	// the clients' arguments, when replaying a client's capture
+	ClientArgs			m_clientArgs;
+
+	UInt32				m_packets;
+	double				m_bytes;
+	double				m_seconds;
+	LatencyHistogram	m_latency;
+};
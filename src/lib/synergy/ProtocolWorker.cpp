@@ -0,0 +1,534 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/ProtocolWorker.h"
+
+#include "synergy/protocol_types.h"
+#include "mt/Atomic.h"
+#include "mt/Lock.h"
+#include "mt/Thread.h"
+#include "base/IEventQueue.h"
+#include "base/TMethodEventJob.h"
+#include "base/TMethodJob.h"
+#include "base/Log.h"
+
+#include <cstring>
+
+// clipboards are sent in chunks of this many bytes.  a message written
+// while a clipboard is being sent waits for at most one chunk.
+#define CLIPBOARD_CHUNK_SIZE (64 * 1024)
+
+// DCLP, id, sequence number, mark and the data length
+#define CLIPBOARD_CHUNK_HEADER_SIZE 14
+
+// seconds to wait for the protocol thread to finish writing on close
+#define STOP_TIMEOUT 1.0
+
+static void
+appendUInt32(String& buffer, UInt32 value)
+{
+	buffer.push_back(static_cast<char>((value >> 24) & 0xff));
+	buffer.push_back(static_cast<char>((value >> 16) & 0xff));
+	buffer.push_back(static_cast<char>((value >>  8) & 0xff));
+	buffer.push_back(static_cast<char>( value        & 0xff));
+}
+
+static UInt32
+readUInt32(const UInt8* buffer)
+{
+	return ((UInt32)buffer[0] << 24) |
+		   ((UInt32)buffer[1] << 16) |
+		   ((UInt32)buffer[2] <<  8) |
+			(UInt32)buffer[3];
+}
+
+//
+// ProtocolWorker
+//
+
+ProtocolWorker::ProtocolWorker(IEventQueue* events, synergy::IStream* stream, bool adoptStream) :
+	PacketStreamFilter(events, stream, adoptStream),
+	m_events(events),
+	m_thread(NULL),
+	m_inputPending(true),
+	m_shutdownPending(false),
+	m_stopping(false),
+	m_decodeClipboards(false),
+	m_wakePosted(false),
+	m_wake(&m_wakeMutex),
+	m_sleeping(false),
+	m_woken(false),
+	m_offset(0),
+	m_sending(NULL),
+	m_sent(0),
+	m_expectedSize(0)
+{
+	// the protocol thread tells us it has something for us with an
+	// event only we handle
+	m_events->adoptHandler(m_events->forIStream().inputReady(), &m_in,
+							new TMethodEventJob<ProtocolWorker>(this,
+								&ProtocolWorker::handleCommands));
+
+	// start off by reading whatever the stream already has
+	m_thread = new Thread(new TMethodJob<ProtocolWorker>(
+								this, &ProtocolWorker::workerThread));
+}
+
+ProtocolWorker::~ProtocolWorker()
+{
+	stop();
+	m_events->removeHandler(m_events->forIStream().inputReady(), &m_in);
+
+	deleteCommands(m_out);
+	deleteCommands(m_in);
+	for (CommandList::iterator i = m_clipboards.begin();
+								i != m_clipboards.end(); ++i) {
+		delete *i;
+	}
+	delete m_sending;
+}
+
+void
+ProtocolWorker::setDecodeClipboards(bool enable)
+{
+	Atomic::store(&m_decodeClipboards, enable);
+}
+
+void
+ProtocolWorker::sendClipboard(ClipboardID id, UInt32 sequence,
+				const String& data)
+{
+	Command* command    = new Command(Command::kClipboard);
+	command->m_id       = id;
+	command->m_sequence = sequence;
+	command->m_data     = data;
+	m_out.push(command);
+	wake();
+}
+
+void
+ProtocolWorker::close()
+{
+	stop();
+	m_packets.clear();
+	m_offset = 0;
+	PacketStreamFilter::close();
+}
+
+UInt32
+ProtocolWorker::read(void* buffer, UInt32 n)
+{
+	if (n == 0 || m_packets.empty()) {
+		return 0;
+	}
+
+	// read no more than what's left of the packet
+	const String& packet = m_packets.front();
+	UInt32 size = static_cast<UInt32>(packet.size()) - m_offset;
+	if (n > size) {
+		n = size;
+	}
+	if (buffer != NULL) {
+		memcpy(buffer, packet.data() + m_offset, n);
+	}
+
+	m_offset += n;
+	if (m_offset == packet.size()) {
+		m_packets.pop_front();
+		m_offset = 0;
+	}
+	return n;
+}
+
+void
+ProtocolWorker::write(const void* buffer, UInt32 n)
+{
+	// once the protocol thread is gone we write directly
+	if (m_thread == NULL) {
+		PacketStreamFilter::write(buffer, n);
+		return;
+	}
+
+	Command* command = new Command(Command::kPacket);
+	command->m_data.assign(static_cast<const char*>(buffer), n);
+	m_out.push(command);
+	wake();
+}
+
+void
+ProtocolWorker::shutdownInput()
+{
+	m_packets.clear();
+	m_offset = 0;
+	PacketStreamFilter::shutdownInput();
+}
+
+bool
+ProtocolWorker::isReady() const
+{
+	return !m_packets.empty();
+}
+
+UInt32
+ProtocolWorker::getSize() const
+{
+	if (m_packets.empty()) {
+		return 0;
+	}
+	return static_cast<UInt32>(m_packets.front().size()) - m_offset;
+}
+
+void
+ProtocolWorker::filterEvent(const Event& event)
+{
+	if (event.getType() == m_events->forIStream().inputReady()) {
+		Atomic::store(&m_inputPending, true);
+		wake();
+	}
+	else if (event.getType() == m_events->forIStream().inputShutdown()) {
+		// the protocol thread passes this on after the last packet
+		Atomic::store(&m_shutdownPending, true);
+		wake();
+	}
+	else {
+		StreamFilter::filterEvent(event);
+	}
+}
+
+void
+ProtocolWorker::stop()
+{
+	if (m_thread == NULL) {
+		return;
+	}
+
+	// the thread writes out what's queued before it exits
+	Atomic::store(&m_stopping, true);
+	wake();
+	if (!m_thread->wait(STOP_TIMEOUT)) {
+		// it's waiting for the peer to take a clipboard chunk
+		LOG((CLOG_WARN "protocol thread not responding, closing stream"));
+		getStream()->close();
+		m_thread->wait();
+	}
+	delete m_thread;
+	m_thread = NULL;
+}
+
+void
+ProtocolWorker::wake()
+{
+	// note -- pairs with the fence in sleep().  either we see that the
+	// thread is sleeping or it sees the work we just queued.
+	Atomic::fence();
+	if (Atomic::load(&m_sleeping)) {
+		Lock lock(&m_wakeMutex);
+		m_woken = true;
+		m_wake.signal();
+	}
+}
+
+void
+ProtocolWorker::handleCommands(const Event&, void*)
+{
+	// note -- pairs with the fence in post()
+	Atomic::store(&m_wakePosted, false);
+	Atomic::fence();
+
+	Command* command;
+	while (m_in.pop(command)) {
+		switch (command->m_type) {
+		case Command::kPacket:
+			m_packets.push_back(String());
+			m_packets.back().swap(command->m_data);
+			delete command;
+			break;
+
+		case Command::kClipboard:
+			// deliver the packets that came before the clipboard first
+			dispatchPackets();
+			m_events->dispatchEvent(Event(
+								m_events->forClipboard().clipboardReceived(),
+								getEventTarget(), command->m_clipboard,
+								Event::kDontFreeData));
+			delete command->m_clipboard;
+			delete command;
+			break;
+
+		case Command::kShutdown:
+			delete command;
+			dispatchPackets();
+			m_events->dispatchEvent(Event(
+								m_events->forIStream().inputShutdown(),
+								getEventTarget(), NULL));
+			return;
+		}
+	}
+
+	dispatchPackets();
+}
+
+void
+ProtocolWorker::dispatchPackets()
+{
+	if (!m_packets.empty()) {
+		m_events->dispatchEvent(Event(m_events->forIStream().inputReady(),
+								getEventTarget(), NULL));
+	}
+}
+
+void
+ProtocolWorker::workerThread(void*)
+{
+	for (;;) {
+		const bool stopping = Atomic::load(&m_stopping);
+		decodeInput();
+		encodeOutput(stopping);
+		if (stopping) {
+			return;
+		}
+
+		// keep going while there's a clipboard to send
+		if (m_sending == NULL && m_clipboards.empty()) {
+			sleep();
+		}
+	}
+}
+
+bool
+ProtocolWorker::hasWork()
+{
+	return (Atomic::load(&m_inputPending) ||
+			Atomic::load(&m_shutdownPending) ||
+			Atomic::load(&m_stopping) ||
+			!m_out.isEmpty());
+}
+
+void
+ProtocolWorker::sleep()
+{
+	Lock lock(&m_wakeMutex);
+	Atomic::store(&m_sleeping, true);
+	Atomic::fence();
+	if (!hasWork()) {
+		while (!m_woken) {
+			m_wake.wait();
+		}
+	}
+	m_woken = false;
+	Atomic::store(&m_sleeping, false);
+}
+
+void
+ProtocolWorker::decodeInput()
+{
+	// note if the stream has shutdown before reading so we don't miss
+	// anything that arrived before the shutdown
+	const bool shutdown = Atomic::load(&m_shutdownPending);
+	if (!shutdown && !Atomic::load(&m_inputPending)) {
+		return;
+	}
+	Atomic::store(&m_inputPending, false);
+	Atomic::fence();
+
+	readInput();
+	for (UInt32 size = PacketStreamFilter::getSize(); size != 0;
+								size = PacketStreamFilter::getSize()) {
+		String packet(size, '\0');
+		PacketStreamFilter::read(&packet[0], size);
+
+		if (Atomic::load(&m_decodeClipboards) && size >= 4 &&
+				memcmp(packet.data(), kMsgDClipboard, 4) == 0) {
+			decodeClipboard(packet);
+		}
+		else {
+			Command* command = new Command(Command::kPacket);
+			command->m_data.swap(packet);
+			post(command);
+		}
+	}
+
+	if (shutdown) {
+		Atomic::store(&m_shutdownPending, false);
+		post(new Command(Command::kShutdown));
+	}
+}
+
+void
+ProtocolWorker::decodeClipboard(const String& packet)
+{
+	// same layout as kMsgDClipboard
+	if (packet.size() < CLIPBOARD_CHUNK_HEADER_SIZE) {
+		LOG((CLOG_ERR "incomplete clipboard chunk: %d bytes", (int)packet.size()));
+		return;
+	}
+	const UInt8* header = reinterpret_cast<const UInt8*>(packet.data());
+	const ClipboardID id = header[4];
+	const UInt32 sequence = readUInt32(header + 5);
+	const UInt8 mark = header[9];
+	const UInt32 size = readUInt32(header + 10);
+	if (size != packet.size() - CLIPBOARD_CHUNK_HEADER_SIZE) {
+		LOG((CLOG_ERR "bad clipboard chunk size: %d", size));
+		return;
+	}
+	const char* data = packet.data() + CLIPBOARD_CHUNK_HEADER_SIZE;
+
+	switch (mark) {
+	case kDataStart:
+		m_expectedSize = synergy::string::stringToSizeType(String(data, size));
+		m_received.clear();
+		LOG((CLOG_DEBUG "receiving clipboard %d size=%d", id, (int)m_expectedSize));
+		break;
+
+	case kDataChunk:
+		m_received.append(data, size);
+		break;
+
+	case kDataEnd: {
+		if (id >= kClipboardEnd) {
+			LOG((CLOG_ERR "bad clipboard id: %d", id));
+			return;
+		}
+		if (m_expectedSize != m_received.size()) {
+			LOG((CLOG_ERR "corrupted clipboard data, expected size=%d actual size=%d", (int)m_expectedSize, (int)m_received.size()));
+			return;
+		}
+
+		ClipboardInfo* info    = new ClipboardInfo;
+		info->m_id             = id;
+		info->m_sequenceNumber = sequence;
+		info->m_clipboard.unmarshall(m_received, 0);
+		String().swap(m_received);
+
+		Command* command     = new Command(Command::kClipboard);
+		command->m_clipboard = info;
+		post(command);
+		break;
+	}
+
+	default:
+		LOG((CLOG_ERR "clipboard transmission failed: unknown mark %d", mark));
+		break;
+	}
+}
+
+void
+ProtocolWorker::encodeOutput(bool stopping)
+{
+	// write everything queued.  clipboards are put aside to be sent a
+	// chunk at a time.
+	Command* command;
+	while (m_out.pop(command)) {
+		if (command->m_type == Command::kPacket) {
+			PacketStreamFilter::write(command->m_data.data(),
+							static_cast<UInt32>(command->m_data.size()));
+			delete command;
+			continue;
+		}
+
+		// a clipboard that hasn't started yet is replaced by a newer one
+		for (CommandList::iterator i = m_clipboards.begin();
+								i != m_clipboards.end(); ++i) {
+			if ((*i)->m_id == command->m_id) {
+				delete *i;
+				m_clipboards.erase(i);
+				break;
+			}
+		}
+		m_clipboards.push_back(command);
+	}
+
+	// the remaining clipboard chunks are dropped on close
+	if (stopping) {
+		return;
+	}
+
+	if (m_sending == NULL) {
+		if (m_clipboards.empty()) {
+			return;
+		}
+		m_sending = m_clipboards.front();
+		m_clipboards.pop_front();
+		m_sent    = 0;
+
+		LOG((CLOG_DEBUG "sending clipboard %d size=%d", m_sending->m_id, (int)m_sending->m_data.size()));
+		String size = synergy::string::sizeTypeToString(m_sending->m_data.size());
+		writeClipboardChunk(*m_sending, kDataStart, size.data(),
+							static_cast<UInt32>(size.size()));
+	}
+	else if (m_sent < m_sending->m_data.size()) {
+		size_t n = m_sending->m_data.size() - m_sent;
+		if (n > CLIPBOARD_CHUNK_SIZE) {
+			n = CLIPBOARD_CHUNK_SIZE;
+		}
+		writeClipboardChunk(*m_sending, kDataChunk,
+							m_sending->m_data.data() + m_sent,
+							static_cast<UInt32>(n));
+		m_sent += n;
+	}
+	else {
+		writeClipboardChunk(*m_sending, kDataEnd, NULL, 0);
+		LOG((CLOG_DEBUG "sent clipboard size=%d", (int)m_sending->m_data.size()));
+		delete m_sending;
+		m_sending = NULL;
+	}
+
+	// wait for the chunk to go before queueing the next one, otherwise
+	// the whole clipboard would be buffered ahead of later messages
+	getStream()->flush();
+}
+
+void
+ProtocolWorker::writeClipboardChunk(const Command& clipboard, UInt8 mark,
+				const char* data, UInt32 size)
+{
+	String packet;
+	packet.reserve(CLIPBOARD_CHUNK_HEADER_SIZE + size);
+	packet.append(kMsgDClipboard, 4);
+	packet.push_back(static_cast<char>(clipboard.m_id));
+	appendUInt32(packet, clipboard.m_sequence);
+	packet.push_back(static_cast<char>(mark));
+	appendUInt32(packet, size);
+	if (size != 0) {
+		packet.append(data, size);
+	}
+	PacketStreamFilter::write(packet.data(),
+							static_cast<UInt32>(packet.size()));
+}
+
+void
+ProtocolWorker::post(Command* command)
+{
+	// note -- pairs with the fence in handleCommands().  only post an
+	// event if the main thread hasn't got one pending already.
+	m_in.push(command);
+	Atomic::fence();
+	if (!Atomic::load(&m_wakePosted)) {
+		Atomic::store(&m_wakePosted, true);
+		m_events->addEvent(Event(m_events->forIStream().inputReady(), &m_in));
+	}
+}
+
+void
+ProtocolWorker::deleteCommands(CommandQueue& queue)
+{
+	Command* command;
+	while (queue.pop(command)) {
+		delete command->m_clipboard;
+		delete command;
+	}
+}
@@ -0,0 +1,167 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "synergy/PacketStreamFilter.h"
+#include "synergy/Clipboard.h"
+#include "synergy/clipboard_types.h"
+#include "mt/CondVar.h"
+#include "mt/LockFreeQueue.h"
+#include "mt/Mutex.h"
+#include "base/String.h"
+#include "common/stddeque.h"
+
+class Thread;
+
+//! Packetizing stream filter with a protocol thread
+/*!
+A PacketStreamFilter that moves protocol work off the event loop onto
+a thread of its own.  The thread splits the filtered stream into
+packets and writes queued packets to it, so the main thread only ever
+copies whole packets in and out.  When clipboard decoding is enabled
+the thread also reassembles and unmarshalls clipboard chunks, and it
+chunks clipboards passed to sendClipboard() itself, sending a chunk
+only once the previous one has gone so other messages aren't stuck
+behind a large clipboard.
+
+The main thread and the protocol thread exchange work through
+lock-free queues.  Packets are read on the main thread as usual, in
+response to an \\c inputReady event.  Decoded clipboards arrive as a
+\\c clipboardReceived event instead of as packets.
+*/
+class ProtocolWorker : public PacketStreamFilter {
+public:
+	//! Clipboard received event data
+	class ClipboardInfo {
+	public:
+		ClipboardID		m_id;
+		UInt32			m_sequenceNumber;
+		Clipboard		m_clipboard;
+	};
+
+	ProtocolWorker(IEventQueue* events, synergy::IStream* stream, bool adoptStream = true);
+	~ProtocolWorker();
+
+	//! @name manipulators
+	//@{
+
+	//! Decode clipboards
+	/*!
+	If \\c enable is true then clipboard chunks read from the stream are
+	reassembled on the protocol thread and sent as a \\c clipboardReceived
+	event rather than being passed on as packets.
+	*/
+	void				setDecodeClipboards(bool enable);
+
+	//! Send a clipboard
+	/*!
+	Queues the marshalled clipboard \\c data to be sent in chunks as
+	clipboard \\c id.  This may be called from any thread.
+	*/
+	void				sendClipboard(ClipboardID id, UInt32 sequence,
+							const String& data);
+
+	//@}
+
+	// IStream overrides
+	virtual void		close();
+	virtual UInt32		read(void* buffer, UInt32 n);
+	virtual void		write(const void* buffer, UInt32 n);
+	virtual void		shutdownInput();
+	virtual bool		isReady() const;
+	virtual UInt32		getSize() const;
+
+protected:
+	// StreamFilter overrides
+	virtual void		filterEvent(const Event&);
+
+private:
+	class Command {
+	public:
+		enum EType {
+			kPacket,
+			kClipboard,
+			kShutdown
+		};
+
+		Command(EType type) : m_type(type), m_id(0), m_sequence(0),
+							m_clipboard(NULL) { }
+
+	public:
+		EType			m_type;
+		ClipboardID		m_id;
+		UInt32			m_sequence;
+		String			m_data;
+		ClipboardInfo*	m_clipboard;
+	};
+
+	typedef LockFreeQueue<Command*> CommandQueue;
+	typedef std::deque<Command*> CommandList;
+	typedef std::deque<String> PacketList;
+
+	// main thread
+	void				stop();
+	void				wake();
+	void				handleCommands(const Event&, void*);
+	void				dispatchPackets();
+
+	// protocol thread
+	void				workerThread(void*);
+	bool				hasWork();
+	void				sleep();
+	void				decodeInput();
+	void				decodeClipboard(const String& packet);
+	void				encodeOutput(bool stopping);
+	void				writeClipboardChunk(const Command&, UInt8 mark,
+							const char* data, UInt32 size);
+	void				post(Command*);
+
+	static void			deleteCommands(CommandQueue&);
+
+private:
+	IEventQueue*		m_events;
+	Thread*				m_thread;
+
+	// requests to the protocol thread
+	CommandQueue		m_out;
+	volatile bool		m_inputPending;
+	volatile bool		m_shutdownPending;
+	volatile bool		m_stopping;
+	volatile bool		m_decodeClipboards;
+
+	// results from the protocol thread
+	CommandQueue		m_in;
+	volatile bool		m_wakePosted;
+
+	// protocol thread sleeps on this when there's nothing to do
+	Mutex				m_wakeMutex;
+	CondVarBase			m_wake;
+	volatile bool		m_sleeping;
+	bool				m_woken;
+
+	// main thread only
+	PacketList			m_packets;
+	UInt32				m_offset;
+
+	// protocol thread only
+	CommandList			m_clipboards;
+	Command*			m_sending;
+	size_t				m_sent;
+	String				m_received;
+	size_t				m_expectedSize;
+};
@@ -0,0 +1,127 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "synergy/ReplayStream.h"
+
+#include "base/IEventQueue.h"
+
+#include <cstring>
+
+//
+// ReplayStream
+//
+
+ReplayStream::ReplayStream(IEventQueue* events) :
+	m_events(events),
+	m_written(0),
+	m_readable(true)
+{
+	// do nothing
+}
+
+ReplayStream::~ReplayStream()
+{
+	// do nothing
+}
+
+void
+ReplayStream::push(const void* data, UInt32 n)
+{
+	if (m_readable && n > 0) {
+		m_input.write(data, n);
+		sendEvent(m_events->forIStream().inputReady());
+	}
+}
+
+UInt32
+ReplayStream::getWritten() const
+{
+	return m_written;
+}
+
+void
+ReplayStream::close()
+{
+	shutdownInput();
+}
+
+UInt32
+ReplayStream::read(void* buffer, UInt32 n)
+{
+	UInt32 size = m_input.getSize();
+	if (n > size) {
+		n = size;
+	}
+	if (buffer != NULL && n != 0) {
+		memcpy(buffer, m_input.peek(n), n);
+	}
+	m_input.pop(n);
+	return n;
+}
+
+void
+ReplayStream::write(const void*, UInt32 n)
+{
+	m_written += n;
+}
+
+void
+ReplayStream::flush()
+{
+	// do nothing
+}
+
+void
+ReplayStream::shutdownInput()
+{
+	if (m_readable) {
+		m_readable = false;
+		m_input.pop(m_input.getSize());
+		sendEvent(m_events->forIStream().inputShutdown());
+	}
+}
+
+void
+ReplayStream::shutdownOutput()
+{
+	// do nothing
+}
+
+void*
+ReplayStream::getEventTarget() const
+{
+	return const_cast<void*>(reinterpret_cast<const void*>(this));
+}
+
+bool
+ReplayStream::isReady() const
+{
+	return (m_input.getSize() > 0);
+}
+
+UInt32
+ReplayStream::getSize() const
+{
+	return m_input.getSize();
+}
+
+void
+ReplayStream::sendEvent(Event::Type type)
+{
+	m_events->addEvent(Event(type, getEventTarget(), NULL));
+}
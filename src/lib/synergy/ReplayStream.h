@@ -0,0 +1,72 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "io/IStream.h"
+#include "io/StreamBuffer.h"
+
+//! Replayed stream
+/*!
+A stream whose input is handed to it with push() rather than read from
+the network, for replaying captured packets.  Anything written to it is
+counted and discarded.
+*/
+class ReplayStream : public synergy::IStream {
+public:
+	ReplayStream(IEventQueue* events);
+	~ReplayStream();
+
+	//! @name manipulators
+	//@{
+
+	//! Add input
+	/*!
+	Appends \p n bytes to the input and sends an \c inputReady event.
+	*/
+	void				push(const void* data, UInt32 n);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get the number of bytes written
+	UInt32				getWritten() const;
+
+	//@}
+
+	// IStream overrides
+	virtual void		close();
+	virtual UInt32		read(void* buffer, UInt32 n);
+	virtual void		write(const void* buffer, UInt32 n);
+	virtual void		flush();
+	virtual void		shutdownInput();
+	virtual void		shutdownOutput();
+	virtual void*		getEventTarget() const;
+	virtual bool		isReady() const;
+	virtual UInt32		getSize() const;
+
+private:
+	void				sendEvent(Event::Type);
+
+private:
+	IEventQueue*		m_events;
+	StreamBuffer		m_input;
+	UInt32				m_written;
+	bool				m_readable;
+};
@@ -175,6 +175,20 @@ Screen::grabClipboard(ClipboardID id)
 	m_screen->setClipboard(id, NULL);
 }
 
+bool
+Screen::offerClipboard(ClipboardID id,
+				const IClipboard* clipboard, UInt32 formats)
+{
+	return m_screen->offerClipboard(id, clipboard, formats);
+}
+
+void
+Screen::setClipboardFormat(ClipboardID id,
+				IClipboard::EFormat format, const String& data)
+{
+	m_screen->setClipboardFormat(id, format, data);
+}
+
 void
 Screen::screensaver(bool activate)
 {
@@ -466,6 +480,20 @@ Screen::getDropTarget() const
 	return m_screen->getDropTarget();
 }
 
+bool
+Screen::getClipboardFormats(ClipboardID id,
+				UInt32& formats, IClipboard::Time& time) const
+{
+	return m_screen->getClipboardFormats(id, formats, time);
+}
+
+bool
+Screen::getClipboardFormat(ClipboardID id,
+				IClipboard::EFormat format, String& data) const
+{
+	return m_screen->getClipboardFormat(id, format, data);
+}
+
 void*
 Screen::getEventTarget() const
 {
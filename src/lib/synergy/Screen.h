@@ -20,13 +20,13 @@
 
 #include "synergy/DragInformation.h"
 #include "synergy/clipboard_types.h"
+#include "synergy/IClipboard.h"
 #include "synergy/IScreen.h"
 #include "synergy/key_types.h"
 #include "synergy/mouse_types.h"
 #include "synergy/option_types.h"
 #include "base/String.h"
 
-class IClipboard;
 class IPlatformScreen;
 class IEventQueue;
 
@@ -106,6 +106,22 @@ public:
 	*/
 	void				grabClipboard(ClipboardID);
 
+	//! Offer clipboard formats
+	/*!
+	Takes ownership of the system clipboard with the data in
+	\c clipboard and promises the other \c formats.  Returns false if
+	the platform can't promise data.  See IPlatformScreen::offerClipboard().
+	*/
+	bool				offerClipboard(ClipboardID,
+							const IClipboard* clipboard, UInt32 formats);
+
+	//! Supply promised clipboard format
+	/*!
+	Supplies the data for a format promised by offerClipboard().
+	*/
+	void				setClipboardFormat(ClipboardID,
+							IClipboard::EFormat, const String& data);
+
 	//! Activate/deactivate screen saver
 	/*!
 	Forcibly activates the screen saver if \c activate is true otherwise
@@ -291,6 +307,21 @@ public:
 	//! Get the drop target directory
 	const String&		getDropTarget() const;
 
+	//! Get clipboard formats
+	/*!
+	Gets the formats on the clipboard and the time it was set without
+	fetching the data.  See IPlatformScreen::getClipboardFormats().
+	*/
+	bool				getClipboardFormats(ClipboardID,
+							UInt32& formats, IClipboard::Time&) const;
+
+	//! Get clipboard format
+	/*!
+	Gets the data of a single clipboard format.
+	*/
+	bool				getClipboardFormat(ClipboardID,
+							IClipboard::EFormat, String& data) const;
+
 	//@}
 
 	// IScreen overrides
@@ -23,6 +23,8 @@
 #include "server/ClientProxy.h"
 #include "server/PrimaryClient.h"
 #include "synergy/ArgParser.h"
+#include "synergy/ProtocolCapture.h"
+#include "synergy/LatencyStats.h"
 #include "synergy/Screen.h"
 #include "synergy/XScreen.h"
 #include "synergy/ServerTaskBarReceiver.h"
@@ -120,12 +122,13 @@ ServerApp::help()
 #  define WINAPI_INFO
 #endif
 
-	char buffer[2000];
+	char buffer[3000];
 	sprintf(
 		buffer,
 		"Usage: %s"
 		" [--address <address>]"
 		" [--config <pathname>]"
+		" [--protocol-workers]"
 		WINAPI_ARGS
 		HELP_SYS_ARGS
 		HELP_COMMON_ARGS
@@ -134,6 +137,7 @@ ServerApp::help()
 		"\n"
 		"  -a, --address <address>  listen for clients on the given address.\n"
 		"  -c, --config <pathname>  use the named configuration file instead.\n"
+		"      --protocol-workers   handle each client's messages on its own thread.\n"
 		HELP_COMMON_INFO_1
 		WINAPI_INFO
 		HELP_SYS_INFO
@@ -166,16 +170,43 @@ ServerApp::reloadSignalHandler(Arch::ESignal, void*)
 		events->getSystemTarget()));
 }
 
+void
+ServerApp::logStatsSignalHandler(Arch::ESignal, void*)
+{
+	IEventQueue* events = App::instance().getEvents();
+	events->addEvent(Event(events->forServerApp().logStats(),
+		events->getSystemTarget()));
+}
+
 void
 ServerApp::reloadConfig(const Event&, void*)
 {
 	LOG((CLOG_DEBUG "reload configuration"));
-	if (loadConfig(args().m_configFile)) {
-		if (m_server != NULL) {
-			m_server->setConfig(*args().m_config);
-		}
-		LOG((CLOG_NOTE "reloaded configuration"));
+	const double start = ARCH->monotonicTime();
+
+	// read into a new configuration so the server can see what changed
+	Config config(m_events);
+	if (!readConfig(args().m_configFile, config)) {
+		return;
+	}
+
+	// the address given on the command line wins as it does at startup.
+	// otherwise keep the address we're using if the file has none.
+	if (m_synergyAddress != NULL && m_synergyAddress->isValid()) {
+		config.setSynergyAddress(*m_synergyAddress);
+	}
+	else if (!config.getSynergyAddress().isValid()) {
+		config.setSynergyAddress(args().m_config->getSynergyAddress());
+	}
+
+	if (m_server == NULL) {
+		*args().m_config = config;
+	}
+	else if (!m_server->setConfig(config)) {
+		LOG((CLOG_ERR "cannot reload configuration: it doesn't include this screen"));
+		return;
 	}
+	LOG((CLOG_NOTE "reloaded configuration in %.1fms", 1000.0 * (ARCH->monotonicTime() - start)));
 }
 
 void
@@ -223,6 +254,12 @@ ServerApp::loadConfig()
 
 bool
 ServerApp::loadConfig(const String& pathname)
+{
+	return readConfig(pathname, *args().m_config);
+}
+
+bool
+ServerApp::readConfig(const String& pathname, Config& config)
 {
 	try {
 		// load configuration
@@ -236,7 +273,7 @@ ServerApp::loadConfig(const String& pathname)
 				pathname.c_str()));
 			return false;
 		}
-		configStream >> *args().m_config;
+		configStream >> config;
 		LOG((CLOG_DEBUG "configuration read successfully"));
 		return true;
 	}
@@ -256,6 +293,14 @@ ServerApp::forceReconnect(const Event&, void*)
 	}
 }
 
+void
+ServerApp::logStats(const Event&, void*)
+{
+	if (m_server != NULL) {
+		m_server->getLatencyStats().log();
+	}
+}
+
 void 
 ServerApp::handleClientConnected(const Event&, void* vlistener)
 {
@@ -635,6 +680,7 @@ ServerApp::openClientListener(const NetworkAddress& address)
 		new TCPSocketFactory(m_events, getSocketMultiplexer()),
 		m_events,
 		args().m_enableCrypto);
+	listen->setProtocolWorkers(args().m_protocolWorkers);
 	
 	m_events->adoptHandler(
 		m_events->forClientListener().connected(), listen,
@@ -684,6 +730,10 @@ ServerApp::mainLoop()
 	SocketMultiplexer multiplexer;
 	setSocketMultiplexer(&multiplexer);
 
+	// record the protocol until we stop, if asked
+	ProtocolCapture capture(argsBase().m_captureFile,
+							argsBase().m_captureSize, ProtocolCapture::kServer);
+
 	// if configuration has no screens then add this system
 	// as the default
 	if (args().m_config->begin() == args().m_config->end()) {
@@ -742,6 +792,12 @@ ServerApp::mainLoop()
 		m_events->getSystemTarget(),
 		new TMethodEventJob<ServerApp>(this, &ServerApp::resetServer));
 
+	// handle user signal by logging the input latency statistics
+	ARCH->setSignalHandler(Arch::kUSER, &logStatsSignalHandler, NULL);
+	m_events->adoptHandler(m_events->forServerApp().logStats(),
+		m_events->getSystemTarget(),
+		new TMethodEventJob<ServerApp>(this, &ServerApp::logStats));
+
 	// run event loop.  if startServer() failed we're supposed to retry
 	// later.  the timer installed by startServer() will take care of
 	// that.
@@ -768,6 +824,9 @@ ServerApp::mainLoop()
 
 	// close down
 	LOG((CLOG_DEBUG1 "stopping server"));
+	ARCH->setSignalHandler(Arch::kUSER, NULL, NULL);
+	m_events->removeHandler(m_events->forServerApp().logStats(),
+		m_events->getSystemTarget());
 	m_events->removeHandler(m_events->forServerApp().forceReconnect(),
 		m_events->getSystemTarget());
 	m_events->removeHandler(m_events->forServerApp().reloadConfig(),
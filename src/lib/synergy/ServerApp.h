@@ -66,12 +66,15 @@ public:
 
 	// TODO: Document these functions.
 	static void reloadSignalHandler(Arch::ESignal, void*);
+	static void logStatsSignalHandler(Arch::ESignal, void*);
 
 	void reloadConfig(const Event&, void*);
 	void loadConfig();
 	bool loadConfig(const String& pathname);
+	bool readConfig(const String& pathname, Config& config);
 	void forceReconnect(const Event&, void*);
 	void resetServer(const Event&, void*);
+	void logStats(const Event&, void*);
 	void handleClientConnected(const Event&, void* vlistener);
 	void handleClientsDisconnected(const Event&, void*);
 	void closeServer(Server* server);
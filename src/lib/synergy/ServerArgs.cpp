@@ -19,7 +19,8 @@
 
 ServerArgs::ServerArgs() :
 	m_configFile(),
-	m_config(NULL)
+	m_config(NULL),
+	m_protocolWorkers(false)
 {
 }
 
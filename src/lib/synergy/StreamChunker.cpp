@@ -20,6 +20,7 @@
 #include "synergy/FileChunk.h"
 #include "synergy/ClipboardChunk.h"
 #include "synergy/protocol_types.h"
+#include "arch/Arch.h"
 #include "base/EventTypes.h"
 #include "base/Event.h"
 #include "base/IEventQueue.h"
@@ -36,7 +37,7 @@
 using namespace std;
 
 #define SOCKET_CHUNK_SIZE 512 * 1024; // 512kb
-#define SECURE_SOCKET_CHUNK_SIZE 2 * 1024; // 2kb
+#define SECURE_SOCKET_CHUNK_SIZE 16 * 1024; // 16kb, a full tls record
 
 size_t StreamChunker::s_chunkSize = SOCKET_CHUNK_SIZE;
 bool StreamChunker::s_isChunkingClipboard = false;
@@ -108,6 +109,11 @@ StreamChunker::sendFile(
 
 			sendStopwatch.reset();
 		}
+		else {
+			// wait for the next chunk without spinning;  the event loop
+			// that sends the chunks (and the input) needs the cpu.
+			ARCH->sleep(SEND_THRESHOLD - sendStopwatch.getTime());
+		}
 	}
 
 	// send last message
@@ -170,6 +176,11 @@ StreamChunker::sendClipboard(
 
 			sendStopwatch.reset();
 		}
+		else {
+			// wait for the next chunk without spinning;  the event loop
+			// that sends the chunks (and the input) needs the cpu.
+			ARCH->sleep(SEND_THRESHOLD - sendStopwatch.getTime());
+		}
 	}
 
 	// send last message
@@ -19,6 +19,7 @@
 
 #include "synergy/ArgParser.h"
 #include "synergy/SubscriptionManager.h"
+#include "synergy/ProtocolReplay.h"
 #include "arch/Arch.h"
 #include "base/Log.h"
 #include "base/String.h"
@@ -120,6 +121,11 @@ ToolApp::run(int argc, char** argv)
 		else if (m_args.m_notifyActivation) {
 			notifyActivation();
 		}
+		else if (!m_args.m_replayFile.empty()) {
+			if (!replay()) {
+				return kExitFailed;
+			}
+		}
 		else {
 			throw XSynergy("Nothing to do");
 		}
@@ -233,3 +239,33 @@ ToolApp::notifyActivation()
 		LOG((CLOG_NOTE "notification failed"));
 	}
 }
+
+bool
+ToolApp::replay()
+{
+	ProtocolCapture::ESide side;
+	ProtocolCapture::RecordList records;
+	if (!ProtocolCapture::load(m_args.m_replayFile, side, records)) {
+		LOG((CLOG_CRIT "cannot read protocol capture %s", m_args.m_replayFile.c_str()));
+		return false;
+	}
+
+	ProtocolReplay replay(getEvents());
+	replay.run(side, records, m_args.m_replayOriginalTiming);
+
+	const LatencyHistogram& latency = replay.getLatency();
+	const double seconds = replay.getSeconds();
+	std::cout << "{\"side\":\""
+		<< (side == ProtocolCapture::kServer ? "server" : "client")
+		<< "\",\"packets\":" << replay.getPackets()
+		<< ",\"bytes\":" << replay.getBytes()
+		<< ",\"seconds\":" << seconds
+		<< ",\"packetsPerSecond\":"
+		<< (seconds > 0.0 ? replay.getPackets() / seconds : 0.0)
+		<< ",\"usecMean\":" << latency.getMean()
+		<< ",\"usecP50\":" << latency.getPercentile(50.0)
+		<< ",\"usecP99\":" << latency.getPercentile(99.0)
+		<< ",\"usecMax\":" << latency.getMax()
+		<< "}" << std::endl;
+	return true;
+}
@@ -31,6 +31,7 @@ private:
 	void				loginAuth();
 	void				getPluginList();
 	void				notifyActivation();
+	bool				replay();
 
 private:
 	ToolArgs			m_args;
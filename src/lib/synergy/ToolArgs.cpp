@@ -28,6 +28,8 @@ ToolArgs::ToolArgs() :
 	m_getSubscriptionFilename(false),
 	m_checkSubscription(false),
 	m_notifyActivation(false),
-	m_subscriptionSerial()
+	m_subscriptionSerial(),
+	m_replayFile(),
+	m_replayOriginalTiming(false)
 {
 }
@@ -35,4 +35,6 @@ public:
 	bool				m_checkSubscription;
 	bool				m_notifyActivation;
 	String				m_subscriptionSerial;
+	String				m_replayFile;
+	bool				m_replayOriginalTiming;
 };
@@ -67,6 +67,8 @@ static const OptionID	kOptionXTestXineramaUnaware   = OPTION_CODE("XTXU");
 static const OptionID	kOptionScreenPreserveFocus    = OPTION_CODE("SFOC");
 static const OptionID	kOptionRelativeMouseMoves     = OPTION_CODE("MDLT");
 static const OptionID	kOptionWin32KeepForeground    = OPTION_CODE("_KFW");
+static const OptionID	kOptionLatencyEcho            = OPTION_CODE("LECH");
+static const OptionID	kOptionClipboardLazy          = OPTION_CODE("CLZY");
 //@}
 
 //! @name Screen switch corner enumeration
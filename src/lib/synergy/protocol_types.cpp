@@ -39,14 +39,19 @@ const char*				kMsgDMouseDown		= "DMDN%1i";
 const char*				kMsgDMouseUp		= "DMUP%1i";
 const char*				kMsgDMouseMove		= "DMMV%2i%2i";
 const char*				kMsgDMouseRelMove	= "DMRM%2i%2i";
+const char*				kMsgDMouseMoveBatch	= "DMMB%1i";
+const char*				kMsgDLatencyEcho	= "DLEC%4i%4i";
 const char*				kMsgDMouseWheel		= "DMWM%2i%2i";
 const char*				kMsgDMouseWheel1_0	= "DMWM%2i";
 const char*				kMsgDClipboard		= "DCLP%1i%4i%1i%s";
+const char*				kMsgDClipboardFormats	= "DCLF%1i%4i%4I";
+const char*				kMsgDClipboardFormat	= "DCFD%1i%4i%1i%s";
 const char*				kMsgDInfo			= "DINF%2i%2i%2i%2i%2i%2i%2i";
 const char*				kMsgDSetOptions		= "DSOP%4I";
 const char*				kMsgDFileTransfer	= "DFTR%1i%s";
 const char*				kMsgDDragInfo		= "DDRG%2i%s";
 const char*				kMsgQInfo			= "QINF";
+const char*				kMsgQClipboardFormats	= "QCLF%1i%4i%4i";
 const char*				kMsgEIncompatible	= "EICV%2i%2i";
 const char*				kMsgEBusy 			= "EBSY";
 const char*				kMsgEUnknown		= "EUNK";
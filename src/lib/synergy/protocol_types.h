@@ -29,9 +29,16 @@
 // 1.4:  adds crypto support
 // 1.5:  adds file transfer and removes home brew crypto
 // 1.6:  adds clipboard streaming
+// 1.7:  adds batched, delta encoded mouse motion and latency echo
+// 1.8:  adds lazy clipboard formats
 // NOTE: with new version, synergy minor version should increment
 static const SInt16		kProtocolMajorVersion = 1;
-static const SInt16		kProtocolMinorVersion = 6;
+static const SInt16		kProtocolMinorVersion = 8;
+
+// oldest server minor version the client will still talk to.  the client
+// says hello back with the server's version and the server picks the
+// matching message encoding.
+static const SInt16		kProtocolMinorVersionMin = 6;
 
 // default contact port number
 static const UInt16		kDefaultPort = 24800;
@@ -222,6 +229,23 @@ extern const char*		kMsgDMouseMove;
 // $1 = dx, $2 = dy.  dx,dy are motion deltas.
 extern const char*		kMsgDMouseRelMove;
 
+// batched mouse move:  primary -> secondary
+// $1 = header;  bits 0-6 are the number of samples and bit 7 is set when
+// the samples are relative moves.  the samples follow to the end of the
+// packet, each as three zig-zag varints:  milliseconds since the previous
+// sample, dx and dy.  for absolute moves dx,dy are relative to the
+// previous absolute position (from kMsgCEnter or the previous sample).
+// see MotionBatch.  protocol 1.7 and later;  older clients get
+// kMsgDMouseMove and kMsgDMouseRelMove.
+extern const char*		kMsgDMouseMoveBatch;
+
+// latency echo:  secondary -> primary
+// $1 = time of the last sample in a kMsgDMouseMoveBatch, $2 = microseconds
+// from reading that message until its motion was injected.  sent for each
+// batch whose motion is injected while the kOptionLatencyEcho option is
+// on.  protocol 1.7 and later.
+extern const char*		kMsgDLatencyEcho;
+
 // mouse scroll:  primary -> secondary
 // $1 = xDelta, $2 = yDelta.  the delta should be +120 for one tick forward
 // (away from the user) or right and -120 for one tick backward (toward
@@ -239,6 +263,24 @@ extern const char*		kMsgDMouseWheel1_0;
 // identifier.
 extern const char*		kMsgDClipboard;
 
+// clipboard formats:  primary -> secondary
+// $1 = clipboard identifier, $2 = offer serial, $3 = format list.  the
+// list holds a (format, size, hash) triple for each format on the
+// clipboard.  size is 0xffffffff and hash is 0 when the primary hasn't
+// fetched the data yet, otherwise hash is the FNV-1a hash of the data
+// (see Clipboard::getDataHash()).  the secondary takes ownership of the
+// clipboard and asks for the data of a format with kMsgQClipboardFormats
+// when it's needed.  sent instead of kMsgDClipboard for clipboards owned
+// by the primary while the kOptionClipboardLazy option is on.  protocol
+// 1.8 and later.
+extern const char*		kMsgDClipboardFormats;
+
+// clipboard format data:  primary -> secondary
+// $1 = clipboard identifier, $2 = offer serial, $3 = format,
+// $4 = data.  sent in response to kMsgQClipboardFormats.  protocol 1.8
+// and later.
+extern const char*		kMsgDClipboardFormat;
+
 // client data:  secondary -> primary
 // $1 = coordinate of leftmost pixel on secondary screen,
 // $2 = coordinate of topmost pixel on secondary screen,
@@ -281,6 +323,12 @@ extern const char*		kMsgDDragInfo;
 // client should reply with a kMsgDInfo.
 extern const char*		kMsgQInfo;
 
+// query clipboard formats:  secondary -> primary
+// $1 = clipboard identifier, $2 = offer serial from kMsgDClipboardFormats,
+// $3 = formats (as a mask of 1 << format).  primary should reply with a
+// kMsgDClipboardFormat for each format.  protocol 1.8 and later.
+extern const char*		kMsgQClipboardFormats;
+
 
 //
 // error codes
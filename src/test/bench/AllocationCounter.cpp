@@ -0,0 +1,138 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "test/bench/AllocationCounter.h"
+
+#include "mt/Atomic.h"
+
+#include <cstdlib>
+#include <new>
+
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+// the heap's size of each block, which may be a little more than was
+// asked for
+#if SYSAPI_WIN32
+#define BLOCK_SIZE(p) _msize(p)
+#elif defined(__APPLE__)
+#define BLOCK_SIZE(p) malloc_size(p)
+#else
+#define BLOCK_SIZE(p) malloc_usable_size(p)
+#endif
+
+static volatile long	s_allocations = 0;
+static volatile long	s_bytes       = 0;
+
+static void*
+allocate(size_t size)
+{
+	Atomic::add(&s_allocations, 1);
+	void* p = malloc(size != 0 ? size : 1);
+	if (p == NULL) {
+		throw std::bad_alloc();
+	}
+	Atomic::add(&s_bytes, static_cast<long>(BLOCK_SIZE(p)));
+	return p;
+}
+
+static void
+deallocate(void* p)
+{
+	if (p != NULL) {
+		Atomic::add(&s_bytes, -static_cast<long>(BLOCK_SIZE(p)));
+		free(p);
+	}
+}
+
+void*
+operator new(size_t size) throw(std::bad_alloc)
+{
+	return allocate(size);
+}
+
+void*
+operator new[](size_t size) throw(std::bad_alloc)
+{
+	return allocate(size);
+}
+
+void*
+operator new(size_t size, const std::nothrow_t&) throw()
+{
+	try {
+		return allocate(size);
+	}
+	catch (std::bad_alloc&) {
+		return NULL;
+	}
+}
+
+void*
+operator new[](size_t size, const std::nothrow_t&) throw()
+{
+	try {
+		return allocate(size);
+	}
+	catch (std::bad_alloc&) {
+		return NULL;
+	}
+}
+
+void
+operator delete(void* p) throw()
+{
+	deallocate(p);
+}
+
+void
+operator delete[](void* p) throw()
+{
+	deallocate(p);
+}
+
+void
+operator delete(void* p, const std::nothrow_t&) throw()
+{
+	deallocate(p);
+}
+
+void
+operator delete[](void* p, const std::nothrow_t&) throw()
+{
+	deallocate(p);
+}
+
+//
+// AllocationCounter
+//
+
+UInt32
+AllocationCounter::get()
+{
+	return static_cast<UInt32>(Atomic::load(&s_allocations));
+}
+
+double
+AllocationCounter::getBytes()
+{
+	return static_cast<double>(Atomic::load(&s_bytes));
+}
@@ -0,0 +1,40 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "common/basic_types.h"
+
+//! Heap allocation counter
+/*!
+The benchmark replaces the global \c operator \c new to count every
+allocation made with it, on any thread.  Memory from \c malloc(), such
+as event data, isn't counted.
+*/
+class AllocationCounter {
+public:
+	//! Get the number of allocations so far
+	static UInt32		get();
+
+	//! Get the bytes allocated and not yet deleted
+	/*!
+	Some event data is allocated with \c new and freed with \c free(),
+	which isn't seen, so this is only approximate.
+	*/
+	static double		getBytes();
+};
@@ -0,0 +1,94 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "test/bench/BenchScreen.h"
+
+#include "test/bench/InputBench.h"
+
+//
+// BenchScreen
+//
+
+BenchScreen::BenchScreen(IEventQueue* events, InputBench* bench,
+				bool isPrimary, UInt32 index) :
+	NullScreen(events, isPrimary),
+	m_bench(bench),
+	m_index(index)
+{
+	// do nothing
+}
+
+BenchScreen::~BenchScreen()
+{
+	// do nothing
+}
+
+bool
+BenchScreen::getClipboard(ClipboardID, IClipboard* clipboard) const
+{
+	m_bench->getClipboard(clipboard);
+	return true;
+}
+
+void
+BenchScreen::fakeMouseMove(SInt32 x, SInt32 y)
+{
+	NullScreen::fakeMouseMove(x, y);
+
+	// the client warps the cursor before entering;  that isn't input
+	if (isEntered() && !isPrimary()) {
+		m_bench->onMotion(m_index, x, y);
+	}
+}
+
+void
+BenchScreen::fakeMouseWheel(SInt32 xDelta, SInt32) const
+{
+	m_bench->onWheel(m_index, xDelta);
+}
+
+void
+BenchScreen::fakeKeyDown(KeyID, KeyModifierMask, KeyButton button)
+{
+	m_bench->onKey(m_index, button);
+}
+
+bool
+BenchScreen::fakeKeyRepeat(KeyID, KeyModifierMask, SInt32, KeyButton button)
+{
+	m_bench->onKey(m_index, button);
+	return true;
+}
+
+bool
+BenchScreen::fakeKeyUp(KeyButton button)
+{
+	m_bench->onKey(m_index, button);
+	return true;
+}
+
+bool
+BenchScreen::setClipboard(ClipboardID, const IClipboard* clipboard)
+{
+	// the benchmark checks the clipboard;  there's no need to keep it
+	if (clipboard != NULL && !isPrimary()) {
+		m_bench->onClipboard(m_index, clipboard);
+	}
+	return true;
+}
@@ -0,0 +1,58 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#pragma once
+
+#include "platform/NullScreen.h"
+
+class InputBench;
+
+//! Headless screen for the benchmark
+/*!
+A NullScreen that reports to the benchmark.  The primary one hands the
+benchmark's clipboard to the server;  the secondary ones tell the
+benchmark about every event the client injects so it can time it.
+*/
+class BenchScreen : public NullScreen {
+public:
+	BenchScreen(IEventQueue* events, InputBench* bench,
+							bool isPrimary, UInt32 index);
+	virtual ~BenchScreen();
+
+	// IScreen overrides
+	virtual bool		getClipboard(ClipboardID id, IClipboard*) const;
+
+	// ISecondaryScreen overrides
+	virtual void		fakeMouseMove(SInt32 x, SInt32 y);
+	virtual void		fakeMouseWheel(SInt32 xDelta, SInt32 yDelta) const;
+
+	// IKeyState overrides
+	virtual void		fakeKeyDown(KeyID id, KeyModifierMask mask,
+							KeyButton button);
+	virtual bool		fakeKeyRepeat(KeyID id, KeyModifierMask mask,
+							SInt32 count, KeyButton button);
+	virtual bool		fakeKeyUp(KeyButton button);
+
+	// IPlatformScreen overrides
+	virtual bool		setClipboard(ClipboardID, const IClipboard*);
+
+private:
+	InputBench*			m_bench;
+	UInt32				m_index;
+};
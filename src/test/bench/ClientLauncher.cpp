@@ -0,0 +1,198 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "test/bench/ClientLauncher.h"
+
+#include "platform/NullScreen.h"
+#include "client/Client.h"
+#include "synergy/ClientArgs.h"
+#include "synergy/Screen.h"
+#include "synergy/protocol_types.h"
+#include "net/NetworkAddress.h"
+#include "net/SocketMultiplexer.h"
+#include "net/TCPSocketFactory.h"
+#include "arch/Arch.h"
+#include "base/Log.h"
+#include "base/TMethodEventJob.h"
+
+#include <cstdio>
+
+//
+// ClientLauncher::Options
+//
+
+ClientLauncher::Options::Options() :
+	m_clients(1),
+	m_server("localhost"),
+	m_prefix("client"),
+	m_tls(false)
+{
+	// do nothing
+}
+
+//
+// ClientLauncher
+//
+
+ClientLauncher::ClientLauncher(const Options& options) :
+	m_options(options),
+	m_multiplexer(NULL),
+	m_next(0),
+	m_connected(0),
+	m_done(0)
+{
+	// do nothing
+}
+
+ClientLauncher::~ClientLauncher()
+{
+	cleanup();
+}
+
+UInt32
+ClientLauncher::run()
+{
+	setup();
+
+	// connect the clients one at a time;  the server's listen backlog
+	// is small
+	connectNext();
+	if (m_done < m_clients.size()) {
+		m_events.loop();
+	}
+	UInt32 connected = m_connected;
+
+	cleanup();
+	return connected;
+}
+
+void
+ClientLauncher::setup()
+{
+	NetworkAddress address(m_options.m_server, kDefaultPort);
+	address.resolve();
+
+	if (m_options.m_tls) {
+		ARCH->plugin().load();
+		ARCH->plugin().init(Log::getInstance(), Arch::getInstance());
+	}
+
+	m_multiplexer = new SocketMultiplexer;
+
+	ClientArgs args;
+	args.m_headless       = true;
+	args.m_enableDragDrop = false;
+	args.m_enableCrypto   = m_options.m_tls;
+	for (UInt32 i = 0; i < m_options.m_clients; ++i) {
+		char name[32];
+		sprintf(name, "%u", i);
+
+		LaunchedClient client;
+		client.m_platformScreen = new NullScreen(&m_events, false);
+		client.m_screen         = new synergy::Screen(
+									client.m_platformScreen, &m_events);
+		client.m_client         = new Client(&m_events,
+									m_options.m_prefix + name, address,
+									new TCPSocketFactory(&m_events,
+										m_multiplexer),
+									client.m_screen, args);
+		m_clients.push_back(client);
+
+		void* target = client.m_client->getEventTarget();
+		m_events.adoptHandler(m_events.forClient().connected(), target,
+							new TMethodEventJob<ClientLauncher>(this,
+								&ClientLauncher::handleConnected));
+		m_events.adoptHandler(m_events.forClient().connectionFailed(),
+							target,
+							new TMethodEventJob<ClientLauncher>(this,
+								&ClientLauncher::handleConnectionFailed));
+		m_events.adoptHandler(m_events.forClient().disconnected(), target,
+							new TMethodEventJob<ClientLauncher>(this,
+								&ClientLauncher::handleDisconnected));
+	}
+}
+
+void
+ClientLauncher::cleanup()
+{
+	for (ClientList::iterator i = m_clients.begin();
+							i != m_clients.end(); ++i) {
+		void* target = i->m_client->getEventTarget();
+		m_events.removeHandler(m_events.forClient().connected(), target);
+		m_events.removeHandler(m_events.forClient().connectionFailed(),
+							target);
+		m_events.removeHandler(m_events.forClient().disconnected(), target);
+		delete i->m_client;
+		delete i->m_screen;
+	}
+	m_clients.clear();
+
+	delete m_multiplexer;
+	m_multiplexer = NULL;
+
+	if (m_options.m_tls) {
+		ARCH->plugin().unload();
+		m_options.m_tls = false;
+	}
+}
+
+void
+ClientLauncher::connectNext()
+{
+	if (m_next < m_clients.size()) {
+		LOG((CLOG_DEBUG "connecting %s%u", m_options.m_prefix.c_str(), m_next));
+		m_clients[m_next++].m_client->connect();
+	}
+	else {
+		LOG((CLOG_NOTE "%u of %u clients connected", m_connected, static_cast<UInt32>(m_clients.size())));
+	}
+}
+
+void
+ClientLauncher::checkDone()
+{
+	++m_done;
+	if (m_done == m_clients.size()) {
+		m_events.addEvent(Event(Event::kQuit));
+	}
+}
+
+void
+ClientLauncher::handleConnected(const Event&, void*)
+{
+	++m_connected;
+	connectNext();
+}
+
+void
+ClientLauncher::handleConnectionFailed(const Event& event, void*)
+{
+	Client::FailInfo* info =
+		reinterpret_cast<Client::FailInfo*>(event.getData());
+	LOG((CLOG_WARN "client failed to connect: %s", info->m_what.c_str()));
+	delete info;
+
+	connectNext();
+	checkDone();
+}
+
+void
+ClientLauncher::handleDisconnected(const Event&, void*)
+{
+	checkDone();
+}
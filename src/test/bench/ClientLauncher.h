@@ -0,0 +1,96 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "base/EventQueue.h"
+#include "base/String.h"
+#include "common/stdvector.h"
+
+class Client;
+class NullScreen;
+class SocketMultiplexer;
+class Event;
+namespace synergy { class Screen; }
+
+//! Runs many headless clients in one process
+/*!
+Connects a number of clients with NullScreens to a server, one at a
+time, all sharing one SocketMultiplexer.  The clients are named with a
+prefix and their index, e.g. \c client0, \c client1 and so on, so the
+server's configuration must have screens with those names.
+*/
+class ClientLauncher {
+public:
+	//! Launcher options
+	class Options {
+	public:
+		Options();
+
+	public:
+		UInt32			m_clients;
+		String			m_server;
+		String			m_prefix;
+		bool			m_tls;
+	};
+
+	ClientLauncher(const Options& options);
+	~ClientLauncher();
+
+	//! @name manipulators
+	//@{
+
+	//! Run the clients
+	/*!
+	Connects the clients and returns once every one of them has either
+	failed to connect or been disconnected by the server.  Returns the
+	number that connected.
+	*/
+	UInt32				run();
+
+	//@}
+
+private:
+	class LaunchedClient {
+	public:
+		NullScreen*		m_platformScreen;
+		synergy::Screen*
+						m_screen;
+		Client*			m_client;
+	};
+	typedef std::vector<LaunchedClient> ClientList;
+
+	void				setup();
+	void				cleanup();
+	void				connectNext();
+	void				checkDone();
+
+	// event handlers
+	void				handleConnected(const Event&, void*);
+	void				handleConnectionFailed(const Event&, void*);
+	void				handleDisconnected(const Event&, void*);
+
+private:
+	Options				m_options;
+	EventQueue			m_events;
+	SocketMultiplexer*	m_multiplexer;
+	ClientList			m_clients;
+	UInt32				m_next;
+	UInt32				m_connected;
+	UInt32				m_done;
+};
@@ -0,0 +1,777 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "test/bench/InputBench.h"
+
+#include "test/bench/AllocationCounter.h"
+#include "test/bench/BenchScreen.h"
+#include "test/bench/CPUTime.h"
+#include "server/Server.h"
+#include "server/ClientListener.h"
+#include "server/ClientProxy.h"
+#include "server/Config.h"
+#include "server/PrimaryClient.h"
+#include "client/Client.h"
+#include "synergy/ClientArgs.h"
+#include "synergy/IClipboard.h"
+#include "synergy/IKeyState.h"
+#include "synergy/IPrimaryScreen.h"
+#include "synergy/Screen.h"
+#include "net/NetworkAddress.h"
+#include "net/SocketMultiplexer.h"
+#include "net/TCPSocketFactory.h"
+#include "mt/Lock.h"
+#include "mt/Thread.h"
+#include "arch/Arch.h"
+#include "base/Log.h"
+#include "base/TMethodEventJob.h"
+#include "base/TMethodJob.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+// motion and wheel events go to one client at a time, switching to the
+// next after this many.  motion starts each burst by moving to the top
+// left of the client's screen, then down to a row that identifies the
+// burst and then one pixel right per event, so this must be less than
+// the screen width.
+#define BURST 1000
+#define BURST_ROWS 1000
+
+// how far to move to be sure of hitting the top left of a screen
+#define RESET_MOTION -100000
+
+// keys carry their sequence number in their button and wheel events
+// in their horizontal delta, modulo this
+#define WRAP 0x7fff
+
+// give up waiting for deliveries after this long without any
+#define IDLE_TIMEOUT 5.0
+
+// give up if the clients haven't all connected after this long
+#define CONNECT_TIMEOUT 30.0
+
+// give up waiting for a file transfer to finish after this long
+#define BULK_TIMEOUT 600.0
+
+// the file sent to the client, in the working directory
+#define BULK_FILE "synergy-bench-bulk.tmp"
+
+static const KeyID kBenchKey = 'a';
+
+//
+// InputBench::Options
+//
+
+InputBench::Options::Options() :
+	m_clients(1),
+	m_events(10000),
+	m_rate(1000.0),
+	m_clipboards(20),
+	m_clipboardSize(1024 * 1024),
+	m_bulkSize(0),
+	m_port(24900),
+	m_tls(false)
+{
+	for (int i = 0; i < kNumWorkloads; ++i) {
+		m_workloads[i] = true;
+	}
+}
+
+//
+// InputBench::Result
+//
+
+InputBench::Result::Result() :
+	m_workload(kMotion),
+	m_sent(0),
+	m_delivered(0),
+	m_expected(0),
+	m_seconds(0.0),
+	m_cpuSeconds(0.0),
+	m_allocations(0),
+	m_bytes(0.0),
+	m_bulkBytes(0.0),
+	m_bulkSeconds(0.0)
+{
+	// do nothing
+}
+
+//
+// InputBench
+//
+
+InputBench::InputBench(const Options& options) :
+	m_options(options),
+	m_serverMultiplexer(NULL),
+	m_clientMultiplexer(NULL),
+	m_config(NULL),
+	m_primaryPlatformScreen(NULL),
+	m_primaryScreen(NULL),
+	m_primaryClient(NULL),
+	m_server(NULL),
+	m_listener(NULL),
+	m_connected(0),
+	m_connectFailed(false),
+	m_timer(NULL),
+	m_driver(NULL),
+	m_delivered(&m_mutex, 0),
+	m_workload(kMotion),
+	m_fanOut(1),
+	m_sent(0),
+	m_active(0),
+	m_lastDelivery(0.0),
+	m_latency(NULL),
+	m_clipboardSeqNum(0),
+	m_bulkDone(false),
+	m_bulkStart(0.0),
+	m_bulkEnd(0.0)
+{
+	if (m_options.m_clients == 0) {
+		m_options.m_clients = 1;
+	}
+}
+
+InputBench::~InputBench()
+{
+	cleanup();
+}
+
+bool
+InputBench::run(ResultList& results)
+{
+	setup();
+
+	// connect the clients one at a time;  the listen backlog is small.
+	// the driver thread starts when the last one is connected.
+	m_events.adoptHandler(m_events.forClientListener().connected(),
+							m_listener,
+							new TMethodEventJob<InputBench>(this,
+								&InputBench::handleAccepted));
+	m_events.adoptHandler(m_events.forServer().connected(),
+							m_primaryPlatformScreen->getEventTarget(),
+							new TMethodEventJob<InputBench>(this,
+								&InputBench::handleConnected));
+	m_timer = m_events.newOneShotTimer(CONNECT_TIMEOUT, NULL);
+	m_events.adoptHandler(Event::kTimer, m_timer,
+							new TMethodEventJob<InputBench>(this,
+								&InputBench::handleTimeout));
+	connectNext();
+
+	m_events.loop();
+
+	if (m_driver != NULL) {
+		m_driver->wait();
+		delete m_driver;
+		m_driver = NULL;
+	}
+	m_events.removeHandler(m_events.forClientListener().connected(),
+							m_listener);
+	m_events.removeHandler(m_events.forServer().connected(),
+							m_primaryPlatformScreen->getEventTarget());
+	if (m_timer != NULL) {
+		m_events.removeHandler(Event::kTimer, m_timer);
+		m_events.deleteTimer(m_timer);
+		m_timer = NULL;
+	}
+
+	results.insert(results.end(), m_results.begin(), m_results.end());
+	m_results.clear();
+	return !m_connectFailed;
+}
+
+void
+InputBench::onMotion(UInt32, SInt32 x, SInt32 y)
+{
+	Lock lock(&m_mutex);
+	if (m_workload != kMotion || m_sent == 0 ||
+		x <= 0 || x >= BURST || y <= 0 || y > BURST_ROWS) {
+		return;
+	}
+
+	// find the latest burst that used this row
+	UInt32 last  = (m_sent - 1) / BURST;
+	UInt32 row   = static_cast<UInt32>(y - 1);
+	UInt32 burst = last - (last + BURST_ROWS - row) % BURST_ROWS;
+	delivered(burst * BURST + static_cast<UInt32>(x));
+}
+
+void
+InputBench::onKey(UInt32, KeyButton button)
+{
+	Lock lock(&m_mutex);
+	if (m_workload != kKey || button == 0) {
+		return;
+	}
+	delivered(unwrap(button - 1));
+}
+
+void
+InputBench::onWheel(UInt32, SInt32 xDelta)
+{
+	Lock lock(&m_mutex);
+	if (m_workload != kWheel || xDelta <= 0) {
+		return;
+	}
+	delivered(unwrap(static_cast<UInt32>(xDelta - 1)));
+}
+
+void
+InputBench::onClipboard(UInt32, const IClipboard* clipboard)
+{
+	// the clipboard text starts with its sequence number
+	String text;
+	if (clipboard->open(0)) {
+		if (clipboard->has(IClipboard::kText)) {
+			text = clipboard->get(IClipboard::kText);
+		}
+		clipboard->close();
+	}
+	if (text.empty()) {
+		return;
+	}
+	char* end;
+	unsigned long seq = strtoul(text.c_str(), &end, 10);
+	if (*end != ':') {
+		return;
+	}
+
+	Lock lock(&m_mutex);
+	if (m_workload != kClipboard) {
+		return;
+	}
+	delivered(static_cast<UInt32>(seq));
+}
+
+void
+InputBench::getClipboard(IClipboard* clipboard) const
+{
+	String data;
+	{
+		Lock lock(&m_mutex);
+		data = m_clipboardData;
+	}
+	clipboard->open(0);
+	clipboard->empty();
+	clipboard->add(IClipboard::kText, data);
+	clipboard->close();
+}
+
+const char*
+InputBench::getName(EWorkload workload)
+{
+	static const char* s_names[] = {
+		"motion",
+		"key",
+		"wheel",
+		"clipboard"
+	};
+	return s_names[workload];
+}
+
+void
+InputBench::setup()
+{
+	m_serverMultiplexer = new SocketMultiplexer;
+	m_clientMultiplexer = new SocketMultiplexer;
+
+	// every screen stands alone;  the driver switches between them
+	m_config = new Config(&m_events);
+	m_config->addScreen("server");
+	for (UInt32 i = 0; i < m_options.m_clients; ++i) {
+		char name[32];
+		sprintf(name, "client%u", i);
+		m_config->addScreen(name);
+
+		BenchClient client;
+		client.m_name           = name;
+		client.m_platformScreen = NULL;
+		client.m_screen         = NULL;
+		client.m_client         = NULL;
+		m_clients.push_back(client);
+	}
+
+	m_primaryPlatformScreen = new BenchScreen(&m_events, this, true, 0);
+	m_primaryScreen = new synergy::Screen(m_primaryPlatformScreen, &m_events);
+	m_primaryClient = new PrimaryClient("server", m_primaryScreen);
+
+	if (m_options.m_tls) {
+		ARCH->plugin().load();
+		ARCH->plugin().init(Log::getInstance(), Arch::getInstance());
+		ARCH->plugin().initEvent(m_primaryPlatformScreen->getEventTarget(),
+							&m_events);
+	}
+
+	NetworkAddress address("127.0.0.1", m_options.m_port);
+	address.resolve();
+	m_listener = new ClientListener(address,
+							new TCPSocketFactory(&m_events, m_serverMultiplexer),
+							&m_events, m_options.m_tls);
+	// file transfers are drag and drop
+	m_server = new Server(*m_config, m_primaryClient,
+							m_primaryScreen, &m_events,
+							m_options.m_bulkSize > 0);
+	m_listener->setServer(m_server);
+
+	if (m_options.m_bulkSize > 0) {
+		// a sparse file will do;  nothing looks at the contents
+		m_bulkFile = BULK_FILE;
+		std::ofstream file(m_bulkFile.c_str(), std::ios::binary);
+		file.seekp(m_options.m_bulkSize - 1);
+		file.put('\0');
+	}
+
+	ClientArgs args;
+	args.m_enableDragDrop = false;
+	args.m_enableCrypto   = m_options.m_tls;
+	for (UInt32 i = 0; i < m_options.m_clients; ++i) {
+		BenchClient& client     = m_clients[i];
+		client.m_platformScreen = new BenchScreen(&m_events, this, false, i);
+		client.m_screen         = new synergy::Screen(
+									client.m_platformScreen, &m_events);
+		client.m_client         = new Client(&m_events, client.m_name,
+									address,
+									new TCPSocketFactory(&m_events,
+										m_clientMultiplexer),
+									client.m_screen, args);
+		m_events.adoptHandler(m_events.forClient().connectionFailed(),
+							client.m_client->getEventTarget(),
+							new TMethodEventJob<InputBench>(this,
+								&InputBench::handleConnectionFailed));
+	}
+
+	// drag and drop is off on the client, which leaves us the event
+	// it sends itself when a file has arrived
+	if (m_options.m_bulkSize > 0) {
+		m_events.adoptHandler(m_events.forFile().fileRecieveCompleted(),
+							m_clients[0].m_client,
+							new TMethodEventJob<InputBench>(this,
+								&InputBench::handleBulkReceived));
+	}
+}
+
+void
+InputBench::cleanup()
+{
+	if (!m_bulkFile.empty()) {
+		m_events.removeHandler(m_events.forFile().fileRecieveCompleted(),
+							m_clients[0].m_client);
+		remove(m_bulkFile.c_str());
+		m_bulkFile.clear();
+	}
+
+	for (ClientList::iterator i = m_clients.begin();
+							i != m_clients.end(); ++i) {
+		if (i->m_client != NULL) {
+			m_events.removeHandler(m_events.forClient().connectionFailed(),
+							i->m_client->getEventTarget());
+			i->m_client->disconnect(NULL);
+			delete i->m_client;
+		}
+		delete i->m_screen;
+	}
+	m_clients.clear();
+
+	delete m_server;
+	delete m_listener;
+	delete m_primaryClient;
+	delete m_primaryScreen;
+	delete m_config;
+	delete m_clientMultiplexer;
+	delete m_serverMultiplexer;
+	m_server            = NULL;
+	m_listener          = NULL;
+	m_primaryClient     = NULL;
+	m_primaryScreen     = NULL;
+	m_config            = NULL;
+	m_clientMultiplexer = NULL;
+	m_serverMultiplexer = NULL;
+
+	if (m_options.m_tls) {
+		ARCH->plugin().unload();
+		m_options.m_tls = false;
+	}
+}
+
+void
+InputBench::connectNext()
+{
+	LOG((CLOG_DEBUG "connecting %s", m_clients[m_connected].m_name.c_str()));
+	m_clients[m_connected].m_client->connect();
+}
+
+void
+InputBench::driveThread(void*)
+{
+	for (int i = 0; i < kNumWorkloads; ++i) {
+		if (m_options.m_workloads[i]) {
+			m_results.push_back(Result());
+			runWorkload(static_cast<EWorkload>(i), m_results.back());
+		}
+	}
+	m_events.addEvent(Event(Event::kQuit));
+}
+
+void
+InputBench::runWorkload(EWorkload workload, Result& result)
+{
+	UInt32 count = m_options.m_events;
+	if (workload == kClipboard) {
+		count = m_options.m_clipboards;
+	}
+
+	result.m_workload = workload;
+	{
+		Lock lock(&m_mutex);
+		m_workload     = workload;
+		m_fanOut       = (workload == kKey) ? m_options.m_clients : 1;
+		m_sendTimes.assign(count, 0.0);
+		m_deliveries.assign(count, 0);
+		m_sent         = 0;
+		m_delivered    = 0;
+		m_latency      = &result.m_latency;
+	}
+
+	LOG((CLOG_INFO "running %s workload, %u events", getName(workload), count));
+	UInt32 allocations = AllocationCounter::get();
+	double cpu         = CPUTime::get();
+	double start       = ARCH->monotonicTime();
+
+	for (UInt32 seq = 0; seq < count; ++seq) {
+		// pace everything but clipboards, which go one at a time
+		if (m_options.m_rate > 0.0 && workload != kClipboard) {
+			double wait = start + seq / m_options.m_rate -
+							ARCH->monotonicTime();
+			if (wait > 0.0) {
+				ARCH->sleep(wait);
+			}
+		}
+
+		switch (workload) {
+		case kMotion:
+			sendMotion(seq);
+			break;
+
+		case kKey:
+			sendKey(seq);
+			break;
+
+		case kWheel:
+			sendWheel(seq);
+			break;
+
+		case kClipboard:
+			sendClipboard(seq);
+			if (!waitForDelivery(seq, IDLE_TIMEOUT)) {
+				LOG((CLOG_WARN "clipboard %u not delivered", seq));
+			}
+			break;
+
+		default:
+			break;
+		}
+
+		// the first event switched to the client, so the file goes there
+		if (seq == 0 && !m_bulkFile.empty() && workload != kClipboard) {
+			startBulk();
+		}
+	}
+
+	// events to a client arrive in order and the last motion isn't
+	// coalesced, so once the last event is in everything is
+	if (count > 0 && !waitForDelivery(count - 1, IDLE_TIMEOUT)) {
+		LOG((CLOG_WARN "%s workload: only %u of %u events delivered", getName(workload), static_cast<UInt32>(m_delivered), count * m_fanOut));
+	}
+
+	// finish the file transfer before the next workload
+	if (count > 0 && !m_bulkFile.empty() && workload != kClipboard) {
+		if (waitForBulk(BULK_TIMEOUT)) {
+			result.m_bulkBytes   = m_options.m_bulkSize;
+			result.m_bulkSeconds = m_bulkEnd - m_bulkStart;
+		}
+		else {
+			LOG((CLOG_WARN "%s workload: file not delivered", getName(workload)));
+		}
+	}
+
+	Lock lock(&m_mutex);
+	result.m_sent        = m_sent;
+	result.m_delivered   = m_delivered;
+	result.m_expected    = count * m_fanOut;
+	result.m_seconds     = (m_lastDelivery > start) ? m_lastDelivery - start : 0.0;
+	result.m_cpuSeconds  = CPUTime::get() - cpu;
+	result.m_allocations = AllocationCounter::get() - allocations;
+	if (workload == kClipboard) {
+		result.m_bytes   = static_cast<double>(m_delivered) *
+							m_options.m_clipboardSize;
+	}
+	m_latency            = NULL;
+	m_workload           = kNumWorkloads;
+}
+
+void
+InputBench::sendMotion(UInt32 seq)
+{
+	SInt32 dx = 1;
+	SInt32 dy = 0;
+	if (seq % BURST == 0) {
+		// start a burst at the top left corner of the next client.  the
+		// first move after that goes down to the burst's row.
+		switchTo((seq / BURST) % m_options.m_clients);
+		dx = RESET_MOTION;
+		dy = RESET_MOTION;
+	}
+	else if (seq % BURST == 1) {
+		dy = static_cast<SInt32>((seq / BURST) % BURST_ROWS + 1);
+	}
+	sent(seq);
+	m_events.addEvent(Event(m_events.forIPrimaryScreen().motionOnSecondary(),
+							m_primaryPlatformScreen->getEventTarget(),
+							IPrimaryScreen::MotionInfo::alloc(dx, dy)));
+}
+
+void
+InputBench::sendKey(UInt32 seq)
+{
+	// alternate presses and releases of one key, sent to every client
+	if (seq == 0) {
+		switchTo(0);
+	}
+	std::set<String> destinations;
+	destinations.insert("*");
+	KeyButton button = static_cast<KeyButton>(seq % WRAP + 1);
+	sent(seq);
+	m_events.addEvent(Event((seq & 1) == 0 ?
+							m_events.forIKeyState().keyDown() :
+							m_events.forIKeyState().keyUp(),
+							m_primaryPlatformScreen->getEventTarget(),
+							IKeyState::KeyInfo::alloc(kBenchKey, 0, button, 1,
+								destinations)));
+}
+
+void
+InputBench::sendWheel(UInt32 seq)
+{
+	if (seq % BURST == 0) {
+		switchTo((seq / BURST) % m_options.m_clients);
+	}
+	sent(seq);
+	m_events.addEvent(Event(m_events.forIPrimaryScreen().wheel(),
+							m_primaryPlatformScreen->getEventTarget(),
+							IPrimaryScreen::WheelInfo::alloc(
+								static_cast<SInt32>(seq % WRAP + 1), 0)));
+}
+
+void
+InputBench::sendClipboard(UInt32 seq)
+{
+	if (seq == 0) {
+		switchTo(0);
+	}
+
+	// the text is the sequence number padded to the clipboard size
+	char prefix[16];
+	sprintf(prefix, "%u:", seq);
+	String data(prefix);
+	if (data.size() < m_options.m_clipboardSize) {
+		data.resize(m_options.m_clipboardSize, 'x');
+	}
+	UInt32 seqNum;
+	{
+		Lock lock(&m_mutex);
+		m_clipboardData.swap(data);
+		seqNum = ++m_clipboardSeqNum;
+	}
+
+	// the primary screen grabs the clipboard and then reports the change
+	IScreen::ClipboardInfo* info =
+		(IScreen::ClipboardInfo*)malloc(sizeof(IScreen::ClipboardInfo));
+	info->m_id             = kClipboardClipboard;
+	info->m_sequenceNumber = seqNum;
+	sent(seq);
+	m_events.addEvent(Event(m_events.forClipboard().clipboardGrabbed(),
+							m_primaryPlatformScreen->getEventTarget(), info));
+
+	info = (IScreen::ClipboardInfo*)malloc(sizeof(IScreen::ClipboardInfo));
+	info->m_id             = kClipboardClipboard;
+	info->m_sequenceNumber = seqNum;
+	m_events.addEvent(Event(m_events.forClipboard().clipboardChanged(),
+							m_primaryPlatformScreen->getEventTarget(), info));
+}
+
+void
+InputBench::switchTo(UInt32 client)
+{
+	{
+		Lock lock(&m_mutex);
+		if (client == m_active && m_sent > 0) {
+			return;
+		}
+		m_active = client;
+	}
+	m_events.addEvent(Event(m_events.forServer().switchToScreen(),
+							m_config->getInputFilter(),
+							Server::SwitchToScreenInfo::alloc(
+								m_clients[client].m_name)));
+}
+
+void
+InputBench::sent(UInt32 seq)
+{
+	Lock lock(&m_mutex);
+	m_sendTimes[seq] = ARCH->monotonicTime();
+	m_sent           = seq + 1;
+}
+
+bool
+InputBench::waitForDelivery(UInt32 seq, double timeout)
+{
+	// wait until seq is delivered to every client it went to, giving
+	// up when nothing has been delivered for timeout seconds
+	Lock lock(&m_mutex);
+	UInt32 before = m_delivered;
+	double start  = ARCH->monotonicTime();
+	while (m_deliveries[seq] < m_fanOut) {
+		m_delivered.wait(timeout);
+		if (m_delivered != before) {
+			before = m_delivered;
+			start  = ARCH->monotonicTime();
+		}
+		else if (ARCH->monotonicTime() - start >= timeout) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void
+InputBench::startBulk()
+{
+	{
+		Lock lock(&m_mutex);
+		m_bulkDone  = false;
+		m_bulkStart = ARCH->monotonicTime();
+	}
+
+	// the server sends the file from a thread of its own
+	m_server->sendFileToClient(m_bulkFile.c_str());
+}
+
+bool
+InputBench::waitForBulk(double timeout)
+{
+	Lock lock(&m_mutex);
+	double start = ARCH->monotonicTime();
+	while (!m_bulkDone && !m_connectFailed) {
+		double wait = start + timeout - ARCH->monotonicTime();
+		if (wait <= 0.0) {
+			return false;
+		}
+		m_delivered.wait(wait);
+	}
+	return m_bulkDone;
+}
+
+void
+InputBench::delivered(UInt32 seq)
+{
+	if (seq >= m_sent || m_latency == NULL) {
+		return;
+	}
+
+	if (m_deliveries[seq] >= m_fanOut) {
+		return;
+	}
+	++m_deliveries[seq];
+
+	m_lastDelivery = ARCH->monotonicTime();
+	m_latency->record(static_cast<UInt32>(
+							1.0e+6 * (m_lastDelivery - m_sendTimes[seq])));
+	m_delivered    = m_delivered + 1;
+	m_delivered.broadcast();
+}
+
+UInt32
+InputBench::unwrap(UInt32 residue) const
+{
+	// find the latest sequence number sent with this residue
+	if (m_sent == 0) {
+		return 0;
+	}
+	UInt32 last = m_sent - 1;
+	return last - (last + WRAP - residue % WRAP) % WRAP;
+}
+
+void
+InputBench::handleAccepted(const Event&, void*)
+{
+	ClientProxy* client = m_listener->getNextClient();
+	if (client != NULL) {
+		m_server->adoptClient(client);
+	}
+}
+
+void
+InputBench::handleConnected(const Event&, void*)
+{
+	if (++m_connected < m_options.m_clients) {
+		connectNext();
+		return;
+	}
+
+	LOG((CLOG_INFO "%u clients connected", m_connected));
+	m_events.removeHandler(Event::kTimer, m_timer);
+	m_events.deleteTimer(m_timer);
+	m_timer  = NULL;
+	m_driver = new Thread(new TMethodJob<InputBench>(
+							this, &InputBench::driveThread));
+}
+
+void
+InputBench::handleConnectionFailed(const Event& event, void*)
+{
+	Client::FailInfo* info =
+		reinterpret_cast<Client::FailInfo*>(event.getData());
+	LOG((CLOG_ERR "client failed to connect: %s", info->m_what.c_str()));
+	delete info;
+	{
+		// stop waiting for a file that won't arrive
+		Lock lock(&m_mutex);
+		m_connectFailed = true;
+		m_delivered.broadcast();
+	}
+	m_events.addEvent(Event(Event::kQuit));
+}
+
+void
+InputBench::handleBulkReceived(const Event&, void*)
+{
+	Lock lock(&m_mutex);
+	m_bulkDone = true;
+	m_bulkEnd  = ARCH->monotonicTime();
+	m_delivered.broadcast();
+}
+
+void
+InputBench::handleTimeout(const Event&, void*)
+{
+	LOG((CLOG_ERR "timed out connecting clients"));
+	m_connectFailed = true;
+	m_events.addEvent(Event(Event::kQuit));
+}
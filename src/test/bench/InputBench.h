@@ -0,0 +1,216 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "synergy/key_types.h"
+#include "synergy/clipboard_types.h"
+#include "base/EventQueue.h"
+#include "base/LatencyHistogram.h"
+#include "base/String.h"
+#include "mt/CondVar.h"
+#include "mt/Mutex.h"
+#include "common/stdvector.h"
+
+class BenchScreen;
+class Client;
+class ClientListener;
+class Config;
+class IClipboard;
+class PrimaryClient;
+class Server;
+class SocketMultiplexer;
+class Thread;
+namespace synergy { class Screen; }
+
+//! Loopback input forwarding benchmark
+/*!
+Runs a server and a number of clients in this process, connected over
+loopback TCP, all with headless screens.  Workloads of motion, key,
+wheel and clipboard events are posted to the primary screen as if the
+user had made them and each one is timed until a client injects it.
+
+Every event carries its sequence number to the client:  motion in its
+position, keys in their button, wheel events in their horizontal delta
+and clipboards in their text.  Motion that the client coalesces is
+counted as sent but not delivered.
+
+Optionally a file is sent to the client while each motion, key and
+wheel workload runs, to see how much a bulk transfer delays input.
+*/
+class InputBench {
+public:
+	enum EWorkload {
+		kMotion,
+		kKey,
+		kWheel,
+		kClipboard,
+		kNumWorkloads
+	};
+
+	//! Benchmark options
+	class Options {
+	public:
+		Options();
+
+	public:
+		UInt32			m_clients;
+		UInt32			m_events;
+		double			m_rate;
+		UInt32			m_clipboards;
+		UInt32			m_clipboardSize;
+		UInt32			m_bulkSize;
+		int				m_port;
+		bool			m_tls;
+		bool			m_workloads[kNumWorkloads];
+	};
+
+	//! Workload result
+	class Result {
+	public:
+		Result();
+
+	public:
+		EWorkload		m_workload;
+		UInt32			m_sent;
+		UInt32			m_delivered;
+		UInt32			m_expected;
+		double			m_seconds;
+		double			m_cpuSeconds;
+		UInt32			m_allocations;
+		double			m_bytes;
+		double			m_bulkBytes;
+		double			m_bulkSeconds;
+		LatencyHistogram
+						m_latency;
+	};
+	typedef std::vector<Result> ResultList;
+
+	InputBench(const Options& options);
+	~InputBench();
+
+	//! @name manipulators
+	//@{
+
+	//! Run the benchmark
+	/*!
+	Connects the clients, runs each selected workload in turn and
+	appends a result for each to \p results.  Returns false if the
+	clients could not all connect.
+	*/
+	bool				run(ResultList& results);
+
+	//! Note injected motion
+	void				onMotion(UInt32 client, SInt32 x, SInt32 y);
+
+	//! Note an injected key
+	void				onKey(UInt32 client, KeyButton button);
+
+	//! Note an injected wheel event
+	void				onWheel(UInt32 client, SInt32 xDelta);
+
+	//! Note an injected clipboard
+	void				onClipboard(UInt32 client, const IClipboard*);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get the primary screen's clipboard
+	void				getClipboard(IClipboard*) const;
+
+	//! Get a workload's name
+	static const char*	getName(EWorkload);
+
+	//@}
+
+private:
+	class BenchClient {
+	public:
+		String			m_name;
+		BenchScreen*	m_platformScreen;
+		synergy::Screen*
+						m_screen;
+		Client*			m_client;
+	};
+	typedef std::vector<BenchClient> ClientList;
+
+	void				setup();
+	void				cleanup();
+	void				connectNext();
+
+	// workload driver
+	void				driveThread(void*);
+	void				runWorkload(EWorkload, Result&);
+	void				sendMotion(UInt32 seq);
+	void				sendKey(UInt32 seq);
+	void				sendWheel(UInt32 seq);
+	void				sendClipboard(UInt32 seq);
+	void				switchTo(UInt32 client);
+	void				sent(UInt32 seq);
+	bool				waitForDelivery(UInt32 seq, double timeout);
+	void				startBulk();
+	bool				waitForBulk(double timeout);
+
+	// called with the mutex locked
+	void				delivered(UInt32 seq);
+	UInt32				unwrap(UInt32 residue) const;
+
+	// event handlers
+	void				handleAccepted(const Event&, void*);
+	void				handleConnected(const Event&, void*);
+	void				handleConnectionFailed(const Event&, void*);
+	void				handleTimeout(const Event&, void*);
+	void				handleBulkReceived(const Event&, void*);
+
+private:
+	Options				m_options;
+	EventQueue			m_events;
+	SocketMultiplexer*	m_serverMultiplexer;
+	SocketMultiplexer*	m_clientMultiplexer;
+	Config*				m_config;
+	BenchScreen*		m_primaryPlatformScreen;
+	synergy::Screen*	m_primaryScreen;
+	PrimaryClient*		m_primaryClient;
+	Server*				m_server;
+	ClientListener*		m_listener;
+	ClientList			m_clients;
+	UInt32				m_connected;
+	bool				m_connectFailed;
+	EventQueueTimer*	m_timer;
+	Thread*				m_driver;
+	ResultList			m_results;
+
+	// delivery state, shared by the driver and the main thread
+	Mutex				m_mutex;
+	CondVar<UInt32>		m_delivered;
+	EWorkload			m_workload;
+	UInt32				m_fanOut;
+	std::vector<double>	m_sendTimes;
+	std::vector<UInt32>	m_deliveries;
+	UInt32				m_sent;
+	UInt32				m_active;
+	double				m_lastDelivery;
+	LatencyHistogram*	m_latency;
+	String				m_clipboardData;
+	UInt32				m_clipboardSeqNum;
+	String				m_bulkFile;
+	bool				m_bulkDone;
+	double				m_bulkStart;
+	double				m_bulkEnd;
+};
@@ -0,0 +1,460 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "test/bench/ClientLauncher.h"
+#include "test/bench/InputBench.h"
+#include "test/bench/ScaleBench.h"
+#include "arch/Arch.h"
+#include "base/Log.h"
+#include "base/XBase.h"
+#include "common/Version.h"
+
+#if SYSAPI_WIN32
+#include "arch/win32/ArchMiscWindows.h"
+#endif
+
+#include "common/stdvector.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static const char* kUsage =
+"Usage: synergy-bench [options]\n"
+"       synergy-bench --scale <n>[,<n>...] [options]\n"
+"       synergy-bench --launch <n> --connect <address> [options]\n"
+"\n"
+"Runs a server and clients connected over loopback in this process, all\n"
+"with headless screens, replays input through them and writes the\n"
+"results as JSON.\n"
+"\n"
+"With --scale, runs a server here and each number of headless clients\n"
+"in another process, and measures the server's CPU time and heap per\n"
+"client while idle and while broadcasting key presses.\n"
+"\n"
+"With --launch, runs headless clients connected to a server until it\n"
+"disconnects them.  The server must have screens named <name>0,\n"
+"<name>1 and so on.\n"
+"\n"
+"Options:\n"
+"      --clients <n>          number of clients (default 1).\n"
+"      --events <n>           motion, key and wheel events per workload\n"
+"                             (default 10000).\n"
+"      --rate <hz>            events per second, 0 for as fast as\n"
+"                             possible (default 1000).\n"
+"      --clipboards <n>       clipboards to send (default 20).\n"
+"      --clipboard-size <n>   bytes per clipboard (default 1048576).\n"
+"      --bulk <n>             send a file of this many bytes to the client\n"
+"                             during each motion, key and wheel workload.\n"
+"                             needs a single client.\n"
+"      --workload <name>      run only this workload:  motion, key, wheel\n"
+"                             or clipboard.  may be repeated.\n"
+"      --port <n>             loopback port (default 24900).\n"
+"      --tls                  encrypt the connections.\n"
+"      --seconds <s>          how long --scale idles and broadcasts\n"
+"                             (default 10).\n"
+"      --broadcast-rate <hz>  key presses per second --scale broadcasts\n"
+"                             (default 10).\n"
+"      --name <name>          prefix of the --launch client names\n"
+"                             (default client).\n"
+"      --output <file>        write the results to a file instead of\n"
+"                             standard output.\n"
+"      --log <level>          log level (default WARNING).\n";
+
+static bool
+parseNumber(const char* arg, double& value)
+{
+	char* end;
+	value = strtod(arg, &end);
+	return (end != arg && *end == '\0' && value >= 0.0);
+}
+
+enum EMode {
+	kInputMode,
+	kScaleMode,
+	kLaunchMode
+};
+
+class BenchArgs {
+public:
+	BenchArgs() :
+		m_mode(kInputMode),
+		m_output(NULL),
+		m_logLevel("WARNING") { }
+
+public:
+	EMode				m_mode;
+	InputBench::Options	m_input;
+	ScaleBench::Options	m_scale;
+	std::vector<UInt32>	m_steps;
+	ClientLauncher::Options
+						m_launch;
+	const char*			m_output;
+	const char*			m_logLevel;
+};
+
+static bool
+parseSteps(const char* arg, std::vector<UInt32>& steps)
+{
+	// a comma separated list of client counts
+	while (*arg != '\0') {
+		char* end;
+		unsigned long clients = strtoul(arg, &end, 10);
+		if (end == arg || clients == 0 || (*end != ',' && *end != '\0')) {
+			return false;
+		}
+		steps.push_back(static_cast<UInt32>(clients));
+		arg = (*end == ',') ? end + 1 : end;
+	}
+	return !steps.empty();
+}
+
+static bool
+parseArgs(int argc, char** argv, BenchArgs& args)
+{
+	InputBench::Options& options = args.m_input;
+	bool anyWorkload = false;
+	for (int i = 1; i < argc; ++i) {
+		const char* arg   = argv[i];
+		const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+		double number     = 0.0;
+
+		if (strcmp(arg, "--tls") == 0) {
+			options.m_tls       = true;
+			args.m_launch.m_tls = true;
+			continue;
+		}
+		if (value == NULL) {
+			return false;
+		}
+		++i;
+
+		if (strcmp(arg, "--workload") == 0) {
+			if (!anyWorkload) {
+				for (int j = 0; j < InputBench::kNumWorkloads; ++j) {
+					options.m_workloads[j] = false;
+				}
+				anyWorkload = true;
+			}
+			bool found = false;
+			for (int j = 0; j < InputBench::kNumWorkloads; ++j) {
+				InputBench::EWorkload workload =
+					static_cast<InputBench::EWorkload>(j);
+				if (strcmp(value, InputBench::getName(workload)) == 0) {
+					options.m_workloads[j] = true;
+					found = true;
+				}
+			}
+			if (!found) {
+				return false;
+			}
+		}
+		else if (strcmp(arg, "--scale") == 0) {
+			args.m_mode = kScaleMode;
+			if (!parseSteps(value, args.m_steps)) {
+				return false;
+			}
+		}
+		else if (strcmp(arg, "--connect") == 0) {
+			args.m_launch.m_server = value;
+		}
+		else if (strcmp(arg, "--name") == 0) {
+			args.m_launch.m_prefix = value;
+		}
+		else if (strcmp(arg, "--output") == 0) {
+			args.m_output = value;
+		}
+		else if (strcmp(arg, "--log") == 0) {
+			args.m_logLevel = value;
+		}
+		else if (!parseNumber(value, number)) {
+			return false;
+		}
+		else if (strcmp(arg, "--clients") == 0 && number >= 1.0) {
+			options.m_clients = static_cast<UInt32>(number);
+		}
+		else if (strcmp(arg, "--launch") == 0 && number >= 1.0) {
+			args.m_mode             = kLaunchMode;
+			args.m_launch.m_clients = static_cast<UInt32>(number);
+		}
+		else if (strcmp(arg, "--events") == 0) {
+			options.m_events = static_cast<UInt32>(number);
+		}
+		else if (strcmp(arg, "--rate") == 0) {
+			options.m_rate = number;
+		}
+		else if (strcmp(arg, "--clipboards") == 0) {
+			options.m_clipboards = static_cast<UInt32>(number);
+		}
+		else if (strcmp(arg, "--clipboard-size") == 0) {
+			options.m_clipboardSize = static_cast<UInt32>(number);
+		}
+		else if (strcmp(arg, "--bulk") == 0 && number < 4294967296.0) {
+			options.m_bulkSize = static_cast<UInt32>(number);
+		}
+		else if (strcmp(arg, "--seconds") == 0 && number > 0.0) {
+			args.m_scale.m_seconds = number;
+		}
+		else if (strcmp(arg, "--broadcast-rate") == 0) {
+			args.m_scale.m_rate = number;
+		}
+		else if (strcmp(arg, "--port") == 0 && number >= 1.0) {
+			options.m_port      = static_cast<int>(number);
+			args.m_scale.m_port = static_cast<int>(number);
+		}
+		else {
+			return false;
+		}
+	}
+
+	// the file goes to whichever client is active
+	if (options.m_bulkSize > 0 && options.m_clients != 1) {
+		return false;
+	}
+
+	args.m_scale.m_launcher = argv[0];
+	args.m_scale.m_logLevel = args.m_logLevel;
+	return true;
+}
+
+static void
+writeResult(FILE* file, const InputBench::Result& result, bool last)
+{
+	const LatencyHistogram& latency = result.m_latency;
+	const double sent = (result.m_sent > 0) ? result.m_sent : 1.0;
+	const double rate = (result.m_seconds > 0.0) ?
+							result.m_sent / result.m_seconds : 0.0;
+
+	fprintf(file, "    {\n");
+	fprintf(file, "      \"workload\": \"%s\",\n",
+							InputBench::getName(result.m_workload));
+	fprintf(file, "      \"sent\": %u,\n", result.m_sent);
+	fprintf(file, "      \"delivered\": %u,\n", result.m_delivered);
+	fprintf(file, "      \"expected\": %u,\n", result.m_expected);
+	fprintf(file, "      \"seconds\": %.6f,\n", result.m_seconds);
+	fprintf(file, "      \"events_per_second\": %.1f,\n", rate);
+	if (result.m_bytes > 0.0 && result.m_seconds > 0.0) {
+		fprintf(file, "      \"bytes_per_second\": %.0f,\n",
+							result.m_bytes / result.m_seconds);
+	}
+	if (result.m_bulkBytes > 0.0 && result.m_bulkSeconds > 0.0) {
+		fprintf(file, "      \"bulk_seconds\": %.3f,\n",
+							result.m_bulkSeconds);
+		fprintf(file, "      \"bulk_bytes_per_second\": %.0f,\n",
+							result.m_bulkBytes / result.m_bulkSeconds);
+	}
+	fprintf(file, "      \"latency_us\": {\n");
+	fprintf(file, "        \"count\": %u,\n", latency.getCount());
+	fprintf(file, "        \"mean\": %.1f,\n", latency.getMean());
+	fprintf(file, "        \"p50\": %u,\n", latency.getPercentile(50.0));
+	fprintf(file, "        \"p99\": %u,\n", latency.getPercentile(99.0));
+	fprintf(file, "        \"p999\": %u,\n", latency.getPercentile(99.9));
+	fprintf(file, "        \"max\": %u\n", latency.getMax());
+	fprintf(file, "      },\n");
+	fprintf(file, "      \"cpu_seconds\": %.6f,\n", result.m_cpuSeconds);
+	fprintf(file, "      \"cpu_us_per_event\": %.3f,\n",
+							1.0e+6 * result.m_cpuSeconds / sent);
+	fprintf(file, "      \"allocations_per_event\": %.3f\n",
+							result.m_allocations / sent);
+	fprintf(file, "    }%s\n", last ? "" : ",");
+}
+
+static void
+writeResults(FILE* file, const InputBench::Options& options,
+				const InputBench::ResultList& results)
+{
+	fprintf(file, "{\n");
+	fprintf(file, "  \"version\": \"%s\",\n", kVersion);
+	fprintf(file, "  \"clients\": %u,\n", options.m_clients);
+	fprintf(file, "  \"rate\": %.1f,\n", options.m_rate);
+	fprintf(file, "  \"clipboard_size\": %u,\n", options.m_clipboardSize);
+	fprintf(file, "  \"bulk_size\": %u,\n", options.m_bulkSize);
+	fprintf(file, "  \"tls\": %s,\n", options.m_tls ? "true" : "false");
+	fprintf(file, "  \"results\": [\n");
+	for (size_t i = 0; i < results.size(); ++i) {
+		writeResult(file, results[i], i + 1 == results.size());
+	}
+	fprintf(file, "  ]\n");
+	fprintf(file, "}\n");
+}
+
+static void
+writeScaleResult(FILE* file, const ScaleBench::Result& result, bool last)
+{
+	const double clients   = (result.m_connected > 0) ? result.m_connected : 1.0;
+	const double idle      = (result.m_idleSeconds > 0.0) ?
+							result.m_idleSeconds : 1.0;
+	const double broadcast = (result.m_broadcastSeconds > 0.0) ?
+							result.m_broadcastSeconds : 1.0;
+	const double events    = (result.m_broadcasts > 0) ?
+							result.m_broadcasts * clients : 1.0;
+
+	fprintf(file, "    {\n");
+	fprintf(file, "      \"clients\": %u,\n", result.m_clients);
+	fprintf(file, "      \"connected\": %u,\n", result.m_connected);
+	fprintf(file, "      \"connect_seconds\": %.3f,\n", result.m_connectSeconds);
+	fprintf(file, "      \"heap_bytes\": %.0f,\n", result.m_heapBytes);
+	fprintf(file, "      \"heap_bytes_per_client\": %.0f,\n",
+							result.m_heapBytes / clients);
+	fprintf(file, "      \"idle\": {\n");
+	fprintf(file, "        \"seconds\": %.3f,\n", result.m_idleSeconds);
+	fprintf(file, "        \"cpu_seconds\": %.6f,\n", result.m_idleCPUSeconds);
+	fprintf(file, "        \"cpu_percent\": %.3f,\n",
+							100.0 * result.m_idleCPUSeconds / idle);
+	fprintf(file, "        \"cpu_us_per_client_second\": %.3f\n",
+							1.0e+6 * result.m_idleCPUSeconds / idle / clients);
+	fprintf(file, "      },\n");
+	fprintf(file, "      \"broadcast\": {\n");
+	fprintf(file, "        \"seconds\": %.3f,\n", result.m_broadcastSeconds);
+	fprintf(file, "        \"events\": %u,\n", result.m_broadcasts);
+	fprintf(file, "        \"cpu_seconds\": %.6f,\n",
+							result.m_broadcastCPUSeconds);
+	fprintf(file, "        \"cpu_percent\": %.3f,\n",
+							100.0 * result.m_broadcastCPUSeconds / broadcast);
+	fprintf(file, "        \"cpu_us_per_client_event\": %.3f\n",
+							1.0e+6 * result.m_broadcastCPUSeconds / events);
+	fprintf(file, "      }\n");
+	fprintf(file, "    }%s\n", last ? "" : ",");
+}
+
+static void
+writeScaleResults(FILE* file, const ScaleBench::Options& options,
+				const std::vector<ScaleBench::Result>& results)
+{
+	fprintf(file, "{\n");
+	fprintf(file, "  \"version\": \"%s\",\n", kVersion);
+	fprintf(file, "  \"scenario\": \"scale\",\n");
+	fprintf(file, "  \"seconds\": %.1f,\n", options.m_seconds);
+	fprintf(file, "  \"broadcast_rate\": %.1f,\n", options.m_rate);
+	fprintf(file, "  \"results\": [\n");
+	for (size_t i = 0; i < results.size(); ++i) {
+		writeScaleResult(file, results[i], i + 1 == results.size());
+	}
+	fprintf(file, "  ]\n");
+	fprintf(file, "}\n");
+}
+
+static FILE*
+openOutput(const char* output)
+{
+	if (output == NULL) {
+		return stdout;
+	}
+	FILE* file = fopen(output, "w");
+	if (file == NULL) {
+		fprintf(stderr, "synergy-bench: cannot write %s\n", output);
+	}
+	return file;
+}
+
+static int
+runInput(const BenchArgs& args)
+{
+	InputBench::ResultList results;
+	bool connected;
+	{
+		InputBench bench(args.m_input);
+		connected = bench.run(results);
+	}
+	if (!connected) {
+		fprintf(stderr, "synergy-bench: clients failed to connect\n");
+		return 1;
+	}
+
+	FILE* file = openOutput(args.m_output);
+	if (file == NULL) {
+		return 1;
+	}
+	writeResults(file, args.m_input, results);
+	if (file != stdout) {
+		fclose(file);
+	}
+	return 0;
+}
+
+static int
+runScale(const BenchArgs& args)
+{
+	std::vector<ScaleBench::Result> results;
+	bool connected = true;
+	for (size_t i = 0; i < args.m_steps.size(); ++i) {
+		ScaleBench::Result result;
+		ScaleBench bench(args.m_scale, args.m_steps[i]);
+		if (!bench.run(result)) {
+			fprintf(stderr, "synergy-bench: %u clients failed to connect\n",
+							args.m_steps[i]);
+			connected = false;
+		}
+		results.push_back(result);
+	}
+
+	// write what was measured even if some clients didn't connect
+	FILE* file = openOutput(args.m_output);
+	if (file == NULL) {
+		return 1;
+	}
+	writeScaleResults(file, args.m_scale, results);
+	if (file != stdout) {
+		fclose(file);
+	}
+	return connected ? 0 : 1;
+}
+
+static int
+runLaunch(const BenchArgs& args)
+{
+	try {
+		ClientLauncher launcher(args.m_launch);
+		return (launcher.run() > 0) ? 0 : 1;
+	}
+	catch (XBase& e) {
+		fprintf(stderr, "synergy-bench: %s\n", e.what());
+		return 1;
+	}
+}
+
+int
+main(int argc, char** argv)
+{
+#if SYSAPI_WIN32
+	// record window instance for tray icon, etc
+	ArchMiscWindows::setInstanceWin32(GetModuleHandle(NULL));
+#endif
+
+	Arch arch;
+	arch.init();
+
+	Log log;
+
+	BenchArgs args;
+	if (!parseArgs(argc, argv, args) || !log.setFilter(args.m_logLevel)) {
+		fprintf(stderr, "%s", kUsage);
+		return 2;
+	}
+
+	switch (args.m_mode) {
+	case kScaleMode:
+		return runScale(args);
+
+	case kLaunchMode:
+		return runLaunch(args);
+
+	default:
+		return runInput(args);
+	}
+}
@@ -0,0 +1,437 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "test/bench/ScaleBench.h"
+
+#include "test/bench/AllocationCounter.h"
+#include "test/bench/CPUTime.h"
+#include "platform/NullScreen.h"
+#include "server/Server.h"
+#include "server/ClientListener.h"
+#include "server/ClientProxy.h"
+#include "server/Config.h"
+#include "server/PrimaryClient.h"
+#include "synergy/IKeyState.h"
+#include "synergy/Screen.h"
+#include "net/NetworkAddress.h"
+#include "net/SocketMultiplexer.h"
+#include "net/TCPSocketFactory.h"
+#include "arch/Arch.h"
+#include "base/Log.h"
+#include "base/TMethodEventJob.h"
+#include "common/stdset.h"
+#include "common/stdvector.h"
+
+#include <cstdio>
+
+#if SYSAPI_WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+// give up if the clients haven't all connected after this long, plus
+// a little for each client
+#define CONNECT_TIMEOUT 30.0
+#define CONNECT_TIMEOUT_PER_CLIENT 0.1
+
+// how long the launcher gets to exit once the server has gone
+#define EXIT_TIMEOUT 10.0
+
+static const KeyID kBenchKey = 'a';
+
+//
+// launcher process
+//
+
+#if SYSAPI_WIN32
+typedef HANDLE LauncherProcess;
+#else
+typedef pid_t LauncherProcess;
+#endif
+
+static bool
+startLauncher(const std::vector<String>& args, LauncherProcess& process)
+{
+#if SYSAPI_WIN32
+	String commandLine;
+	for (size_t i = 0; i < args.size(); ++i) {
+		if (i > 0) {
+			commandLine += " ";
+		}
+		commandLine += "\"" + args[i] + "\"";
+	}
+
+	STARTUPINFOA si;
+	PROCESS_INFORMATION pi;
+	ZeroMemory(&si, sizeof(si));
+	si.cb = sizeof(si);
+	std::vector<char> buffer(commandLine.begin(), commandLine.end());
+	buffer.push_back('\0');
+	if (!CreateProcessA(NULL, &buffer[0], NULL, NULL, FALSE, 0,
+							NULL, NULL, &si, &pi)) {
+		return false;
+	}
+	CloseHandle(pi.hThread);
+	process = pi.hProcess;
+	return true;
+#else
+	std::vector<char*> argv;
+	for (size_t i = 0; i < args.size(); ++i) {
+		argv.push_back(const_cast<char*>(args[i].c_str()));
+	}
+	argv.push_back(NULL);
+
+	process = fork();
+	if (process == 0) {
+		// don't let the launcher hold the server's sockets open
+		for (int fd = 3; fd < sysconf(_SC_OPEN_MAX); ++fd) {
+			close(fd);
+		}
+		execvp(argv[0], &argv[0]);
+		_exit(127);
+	}
+	return (process > 0);
+#endif
+}
+
+static void
+stopLauncher(LauncherProcess process)
+{
+	// the launcher exits once the server disconnects its clients
+#if SYSAPI_WIN32
+	if (WaitForSingleObject(process,
+			static_cast<DWORD>(1000.0 * EXIT_TIMEOUT)) != WAIT_OBJECT_0) {
+		LOG((CLOG_WARN "launcher didn't exit, terminating it"));
+		TerminateProcess(process, 1);
+	}
+	CloseHandle(process);
+#else
+	double timeout = ARCH->monotonicTime() + EXIT_TIMEOUT;
+	while (waitpid(process, NULL, WNOHANG) == 0) {
+		if (ARCH->monotonicTime() > timeout) {
+			LOG((CLOG_WARN "launcher didn't exit, killing it"));
+			kill(process, SIGKILL);
+			waitpid(process, NULL, 0);
+			break;
+		}
+		ARCH->sleep(0.05);
+	}
+#endif
+}
+
+//
+// ScaleBench::Options
+//
+
+ScaleBench::Options::Options() :
+	m_launcher("synergy-bench"),
+	m_logLevel("WARNING"),
+	m_seconds(10.0),
+	m_rate(10.0),
+	m_port(24900)
+{
+	// do nothing
+}
+
+//
+// ScaleBench::Result
+//
+
+ScaleBench::Result::Result() :
+	m_clients(0),
+	m_connected(0),
+	m_connectSeconds(0.0),
+	m_heapBytes(0.0),
+	m_idleSeconds(0.0),
+	m_idleCPUSeconds(0.0),
+	m_broadcastSeconds(0.0),
+	m_broadcastCPUSeconds(0.0),
+	m_broadcasts(0)
+{
+	// do nothing
+}
+
+//
+// ScaleBench
+//
+
+ScaleBench::ScaleBench(const Options& options, UInt32 clients) :
+	m_options(options),
+	m_clients(clients),
+	m_multiplexer(NULL),
+	m_config(NULL),
+	m_primaryPlatformScreen(NULL),
+	m_primaryScreen(NULL),
+	m_primaryClient(NULL),
+	m_server(NULL),
+	m_listener(NULL),
+	m_phaseTimer(NULL),
+	m_broadcastTimer(NULL),
+	m_phase(kConnecting),
+	m_phaseStart(0.0),
+	m_phaseCPU(0.0),
+	m_baseBytes(0.0)
+{
+	m_result.m_clients = m_clients;
+}
+
+ScaleBench::~ScaleBench()
+{
+	cleanup();
+}
+
+bool
+ScaleBench::run(Result& result)
+{
+	setup();
+	m_baseBytes = AllocationCounter::getBytes();
+
+	char clients[32], address[32];
+	sprintf(clients, "%u", m_clients);
+	sprintf(address, "127.0.0.1:%d", m_options.m_port);
+	std::vector<String> args;
+	args.push_back(m_options.m_launcher);
+	args.push_back("--launch");
+	args.push_back(clients);
+	args.push_back("--connect");
+	args.push_back(address);
+	args.push_back("--log");
+	args.push_back(m_options.m_logLevel);
+
+	LauncherProcess launcher;
+	if (!startLauncher(args, launcher)) {
+		LOG((CLOG_ERR "cannot run %s", m_options.m_launcher.c_str()));
+		cleanup();
+		return false;
+	}
+
+	startPhase(kConnecting);
+	m_events.loop();
+
+	// deleting the server disconnects the clients, which ends the
+	// launcher
+	cleanup();
+	stopLauncher(launcher);
+
+	result = m_result;
+	return (m_result.m_connected == m_clients);
+}
+
+void
+ScaleBench::setup()
+{
+	m_multiplexer = new SocketMultiplexer;
+
+	// the clients don't need to be linked;  key presses are broadcast
+	m_config = new Config(&m_events);
+	m_config->addScreen("server");
+	for (UInt32 i = 0; i < m_clients; ++i) {
+		char name[32];
+		sprintf(name, "client%u", i);
+		m_config->addScreen(name);
+	}
+
+	m_primaryPlatformScreen = new NullScreen(&m_events, true);
+	m_primaryScreen = new synergy::Screen(m_primaryPlatformScreen, &m_events);
+	m_primaryClient = new PrimaryClient("server", m_primaryScreen);
+
+	NetworkAddress address("127.0.0.1", m_options.m_port);
+	address.resolve();
+	m_listener = new ClientListener(address,
+							new TCPSocketFactory(&m_events, m_multiplexer),
+							&m_events, false);
+	m_server = new Server(*m_config, m_primaryClient,
+							m_primaryScreen, &m_events, false);
+	m_listener->setServer(m_server);
+
+	m_events.adoptHandler(m_events.forClientListener().connected(),
+							m_listener,
+							new TMethodEventJob<ScaleBench>(this,
+								&ScaleBench::handleAccepted));
+	m_events.adoptHandler(m_events.forServer().connected(),
+							m_primaryPlatformScreen->getEventTarget(),
+							new TMethodEventJob<ScaleBench>(this,
+								&ScaleBench::handleConnected));
+}
+
+void
+ScaleBench::cleanup()
+{
+	if (m_phaseTimer != NULL) {
+		m_events.removeHandler(Event::kTimer, m_phaseTimer);
+		m_events.deleteTimer(m_phaseTimer);
+		m_phaseTimer = NULL;
+	}
+	if (m_broadcastTimer != NULL) {
+		m_events.removeHandler(Event::kTimer, m_broadcastTimer);
+		m_events.deleteTimer(m_broadcastTimer);
+		m_broadcastTimer = NULL;
+	}
+	if (m_listener != NULL) {
+		m_events.removeHandler(m_events.forClientListener().connected(),
+							m_listener);
+		m_events.removeHandler(m_events.forServer().connected(),
+							m_primaryPlatformScreen->getEventTarget());
+	}
+
+	delete m_server;
+	delete m_listener;
+	delete m_primaryClient;
+	delete m_primaryScreen;
+	delete m_config;
+	delete m_multiplexer;
+	m_server        = NULL;
+	m_listener      = NULL;
+	m_primaryClient = NULL;
+	m_primaryScreen = NULL;
+	m_config        = NULL;
+	m_multiplexer   = NULL;
+}
+
+void
+ScaleBench::startPhase(EPhase phase)
+{
+	m_phase      = phase;
+	m_phaseStart = ARCH->monotonicTime();
+	m_phaseCPU   = CPUTime::get();
+
+	double duration = m_options.m_seconds;
+	switch (phase) {
+	case kConnecting:
+		duration = CONNECT_TIMEOUT + CONNECT_TIMEOUT_PER_CLIENT * m_clients;
+		break;
+
+	case kIdle:
+		LOG((CLOG_NOTE "%u clients connected, idling", m_clients));
+		break;
+
+	case kBroadcast:
+		LOG((CLOG_NOTE "broadcasting keys"));
+		if (m_options.m_rate > 0.0) {
+			m_broadcastTimer = m_events.newTimer(1.0 / m_options.m_rate, NULL);
+			m_events.adoptHandler(Event::kTimer, m_broadcastTimer,
+							new TMethodEventJob<ScaleBench>(this,
+								&ScaleBench::handleBroadcastTimer));
+		}
+		break;
+
+	case kDone:
+		m_events.addEvent(Event(Event::kQuit));
+		return;
+	}
+
+	m_phaseTimer = m_events.newOneShotTimer(duration, NULL);
+	m_events.adoptHandler(Event::kTimer, m_phaseTimer,
+							new TMethodEventJob<ScaleBench>(this,
+								&ScaleBench::handlePhaseTimer));
+}
+
+void
+ScaleBench::endPhase()
+{
+	double seconds = ARCH->monotonicTime() - m_phaseStart;
+	double cpu     = CPUTime::get() - m_phaseCPU;
+
+	m_events.removeHandler(Event::kTimer, m_phaseTimer);
+	m_events.deleteTimer(m_phaseTimer);
+	m_phaseTimer = NULL;
+	if (m_broadcastTimer != NULL) {
+		m_events.removeHandler(Event::kTimer, m_broadcastTimer);
+		m_events.deleteTimer(m_broadcastTimer);
+		m_broadcastTimer = NULL;
+	}
+
+	switch (m_phase) {
+	case kConnecting:
+		m_result.m_connectSeconds = seconds;
+		m_result.m_heapBytes      = AllocationCounter::getBytes() - m_baseBytes;
+		break;
+
+	case kIdle:
+		m_result.m_idleSeconds    = seconds;
+		m_result.m_idleCPUSeconds = cpu;
+		break;
+
+	case kBroadcast:
+		m_result.m_broadcastSeconds    = seconds;
+		m_result.m_broadcastCPUSeconds = cpu;
+		break;
+
+	case kDone:
+		break;
+	}
+}
+
+void
+ScaleBench::handleAccepted(const Event&, void*)
+{
+	ClientProxy* client = m_listener->getNextClient();
+	if (client != NULL) {
+		m_server->adoptClient(client);
+	}
+}
+
+void
+ScaleBench::handleConnected(const Event&, void*)
+{
+	if (m_phase == kConnecting && ++m_result.m_connected == m_clients) {
+		endPhase();
+		startPhase(kIdle);
+	}
+}
+
+void
+ScaleBench::handlePhaseTimer(const Event&, void*)
+{
+	EPhase phase = m_phase;
+	endPhase();
+	switch (phase) {
+	case kConnecting:
+		LOG((CLOG_ERR "timed out with %u of %u clients connected", m_result.m_connected, m_clients));
+		startPhase(kDone);
+		break;
+
+	case kIdle:
+		startPhase(kBroadcast);
+		break;
+
+	default:
+		startPhase(kDone);
+		break;
+	}
+}
+
+void
+ScaleBench::handleBroadcastTimer(const Event&, void*)
+{
+	// alternate presses and releases of one key, sent to every client
+	std::set<String> destinations;
+	destinations.insert("*");
+	KeyButton button = 1;
+	m_events.addEvent(Event((m_result.m_broadcasts & 1) == 0 ?
+							m_events.forIKeyState().keyDown() :
+							m_events.forIKeyState().keyUp(),
+							m_primaryPlatformScreen->getEventTarget(),
+							IKeyState::KeyInfo::alloc(kBenchKey, 0, button, 1,
+								destinations)));
+	++m_result.m_broadcasts;
+}
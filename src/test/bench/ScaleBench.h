@@ -0,0 +1,129 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "base/EventQueue.h"
+#include "base/String.h"
+
+class ClientListener;
+class Config;
+class NullScreen;
+class PrimaryClient;
+class Server;
+class SocketMultiplexer;
+namespace synergy { class Screen; }
+
+//! Server scaling benchmark
+/*!
+Runs a server in this process and a ClientLauncher with a number of
+headless clients in a child process, so the CPU time and heap used by
+this process are the server's.  Once every client has connected the
+server idles for a while, which measures the cost of keeping the
+connections alive, and then broadcasts key presses to every client for
+as long again.
+*/
+class ScaleBench {
+public:
+	//! Benchmark options
+	class Options {
+	public:
+		Options();
+
+	public:
+		//! Path to synergy-bench, to run the launcher
+		String			m_launcher;
+		String			m_logLevel;
+		double			m_seconds;
+		double			m_rate;
+		int				m_port;
+	};
+
+	//! Benchmark result
+	class Result {
+	public:
+		Result();
+
+	public:
+		UInt32			m_clients;
+		UInt32			m_connected;
+		double			m_connectSeconds;
+		double			m_heapBytes;
+		double			m_idleSeconds;
+		double			m_idleCPUSeconds;
+		double			m_broadcastSeconds;
+		double			m_broadcastCPUSeconds;
+		UInt32			m_broadcasts;
+	};
+
+	ScaleBench(const Options& options, UInt32 clients);
+	~ScaleBench();
+
+	//! @name manipulators
+	//@{
+
+	//! Run the benchmark
+	/*!
+	Starts the server and the launcher and measures the server.
+	Returns false if the launcher couldn't be started or the clients
+	didn't all connect;  \p result has what was measured anyway.
+	*/
+	bool				run(Result& result);
+
+	//@}
+
+private:
+	enum EPhase {
+		kConnecting,
+		kIdle,
+		kBroadcast,
+		kDone
+	};
+
+	void				setup();
+	void				cleanup();
+	void				startPhase(EPhase);
+	void				endPhase();
+
+	// event handlers
+	void				handleAccepted(const Event&, void*);
+	void				handleConnected(const Event&, void*);
+	void				handlePhaseTimer(const Event&, void*);
+	void				handleBroadcastTimer(const Event&, void*);
+
+private:
+	Options				m_options;
+	UInt32				m_clients;
+	EventQueue			m_events;
+	SocketMultiplexer*	m_multiplexer;
+	Config*				m_config;
+	NullScreen*			m_primaryPlatformScreen;
+	synergy::Screen*	m_primaryScreen;
+	PrimaryClient*		m_primaryClient;
+	Server*				m_server;
+	ClientListener*		m_listener;
+	EventQueueTimer*	m_phaseTimer;
+	EventQueueTimer*	m_broadcastTimer;
+
+	// measurements
+	Result				m_result;
+	EPhase				m_phase;
+	double				m_phaseStart;
+	double				m_phaseCPU;
+	double				m_baseBytes;
+};
@@ -27,6 +27,7 @@
 #include "ipc/IpcServerProxy.h"
 #include "ipc/IpcMessage.h"
 #include "ipc/IpcClientProxy.h"
+#include "ipc/IpcLogOutputter.h"
 #include "ipc/Ipc.h"
 #include "net/SocketMultiplexer.h"
 #include "mt/Thread.h"
@@ -36,10 +37,15 @@
 #include "base/Log.h"
 #include "base/EventQueue.h"
 #include "base/TMethodEventJob.h"
+#include "base/Stopwatch.h"
 
 #include "test/global/gtest.h"
 
+#include <algorithm>
+
 #define TEST_IPC_PORT 24802
+#define TEST_IPC_SOCKET_PATH "IpcTests.ipc"
+#define TEST_IPC_LOG_LINES 50000
 
 class IpcTests : public ::testing::Test
 {
@@ -51,6 +57,11 @@ public:
 	void				sendMessageToServer_serverHandleMessageReceived(const Event&, void*);
 	void				sendMessageToClient_serverHandleClientConnected(const Event&, void*);
 	void				sendMessageToClient_clientHandleMessageReceived(const Event&, void*);
+	void				sendLogLines_serverHandleMessageReceived(const Event&, void*);
+	void				sendLogLines_clientHandleMessageReceived(const Event&, void*);
+
+protected:
+	double				sendLogLines(IpcServer& server, IpcClient& client);
 
 public:
 	SocketMultiplexer	m_multiplexer;
@@ -61,6 +72,9 @@ public:
 	String				m_sendMessageToClient_receivedString;
 	IpcClient*			m_sendMessageToServer_client;
 	IpcServer*			m_sendMessageToClient_server;
+	IpcLogOutputter*	m_sendLogLines_outputter;
+	Stopwatch			m_sendLogLines_stopwatch;
+	int					m_sendLogLines_received;
 	TestEventQueue		m_events;
 
 };
@@ -143,12 +157,43 @@ TEST_F(IpcTests, sendMessageToClient)
 	EXPECT_EQ("test", m_sendMessageToClient_receivedString);
 }
 
+TEST_F(IpcTests, sendLogLines_tcp_allReceived)
+{
+	SocketMultiplexer socketMultiplexer;
+	IpcServer server(&m_events, &socketMultiplexer, TEST_IPC_PORT);
+	IpcClient client(&m_events, &socketMultiplexer, TEST_IPC_PORT);
+
+	double rate = sendLogLines(server, client);
+	LOG((CLOG_INFO "ipc over tcp: %.0f log lines/sec", rate));
+
+	EXPECT_EQ(TEST_IPC_LOG_LINES, m_sendLogLines_received);
+}
+
+#if SYSAPI_UNIX
+
+TEST_F(IpcTests, sendLogLines_localSocket_allReceived)
+{
+	SocketMultiplexer socketMultiplexer;
+	IpcServer server(&m_events, &socketMultiplexer, TEST_IPC_SOCKET_PATH);
+	IpcClient client(&m_events, &socketMultiplexer, TEST_IPC_SOCKET_PATH);
+
+	double rate = sendLogLines(server, client);
+	LOG((CLOG_INFO "ipc over local socket: %.0f log lines/sec", rate));
+
+	EXPECT_EQ(TEST_IPC_LOG_LINES, m_sendLogLines_received);
+}
+
+#endif
+
 IpcTests::IpcTests() :
 m_connectToServer_helloMessageReceived(false),
 m_connectToServer_hasClientNode(false),
 m_connectToServer_server(nullptr),
 m_sendMessageToClient_server(nullptr),
-m_sendMessageToServer_client(nullptr)
+m_sendMessageToServer_client(nullptr),
+m_sendLogLines_outputter(nullptr),
+m_sendLogLines_stopwatch(true),
+m_sendLogLines_received(0)
 {
 }
 
@@ -208,4 +253,73 @@ IpcTests::sendMessageToClient_clientHandleMessageReceived(const Event& e, void*)
 	}
 }
 
+double
+IpcTests::sendLogLines(IpcServer& server, IpcClient& client)
+{
+	server.listen();
+
+	// queue every line up front so that only the transport is timed.
+	IpcLogOutputter outputter(server, kIpcClientNode, true);
+	outputter.bufferMaxSize(TEST_IPC_LOG_LINES);
+	outputter.bufferRateLimit(TEST_IPC_LOG_LINES, 60);
+	for (int i = 0; i < TEST_IPC_LOG_LINES; i++) {
+		outputter.write(kDEBUG, "DEBUG: ipc log line throughput test");
+	}
+	m_sendLogLines_outputter = &outputter;
+
+	m_events.adoptHandler(
+		m_events.forIpcServer().messageReceived(), &server,
+		new TMethodEventJob<IpcTests>(
+		this, &IpcTests::sendLogLines_serverHandleMessageReceived));
+
+	client.connect();
+
+	m_events.adoptHandler(
+		m_events.forIpcClient().messageReceived(), &client,
+		new TMethodEventJob<IpcTests>(
+		this, &IpcTests::sendLogLines_clientHandleMessageReceived));
+
+	m_events.initQuitTimeout(30);
+	m_events.loop();
+	double elapsed = m_sendLogLines_stopwatch.getTime();
+	m_events.removeHandler(m_events.forIpcServer().messageReceived(), &server);
+	m_events.removeHandler(m_events.forIpcClient().messageReceived(), &client);
+	m_events.cleanupQuitTimeout();
+
+	client.disconnect();
+	outputter.close();
+	m_sendLogLines_outputter = nullptr;
+
+	return m_sendLogLines_received / elapsed;
+}
+
+void
+IpcTests::sendLogLines_serverHandleMessageReceived(const Event& e, void*)
+{
+	IpcMessage* m = static_cast<IpcMessage*>(e.getDataObject());
+	if (m->type() == kIpcHello) {
+		// the buffer thread waits until a client of its type connects.
+		m_sendLogLines_stopwatch.reset();
+		m_sendLogLines_stopwatch.start();
+		m_sendLogLines_outputter->notifyBuffer();
+	}
+}
+
+void
+IpcTests::sendLogLines_clientHandleMessageReceived(const Event& e, void*)
+{
+	IpcMessage* m = static_cast<IpcMessage*>(e.getDataObject());
+	if (m->type() == kIpcLogLine) {
+		// each message carries a batch of newline terminated lines.
+		const String& lines = static_cast<IpcLogLineMessage*>(m)->logLine();
+		m_sendLogLines_received += static_cast<int>(
+			std::count(lines.begin(), lines.end(), '\n'));
+
+		if (m_sendLogLines_received >= TEST_IPC_LOG_LINES) {
+			m_sendLogLines_stopwatch.stop();
+			m_events.raiseQuitEvent();
+		}
+	}
+}
+
 #endif // WINAPI_CARBON
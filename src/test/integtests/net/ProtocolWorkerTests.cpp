@@ -0,0 +1,529 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// TODO: fix, tests failing intermittently on mac.
+#ifndef WINAPI_CARBON
+
+#define TEST_ENV
+
+#include "test/global/TestEventQueue.h"
+#include "synergy/ProtocolWorker.h"
+#include "synergy/PacketStreamFilter.h"
+#include "synergy/ClipboardChunk.h"
+#include "synergy/Clipboard.h"
+#include "synergy/protocol_types.h"
+#include "net/IDataSocket.h"
+#include "net/IListenSocket.h"
+#include "net/NetworkAddress.h"
+#include "net/SocketMultiplexer.h"
+#include "net/TCPSocketFactory.h"
+#include "mt/CondVar.h"
+#include "mt/Lock.h"
+#include "mt/Mutex.h"
+#include "mt/Thread.h"
+#include "arch/Arch.h"
+#include "base/LatencyHistogram.h"
+#include "base/TMethodEventJob.h"
+#include "base/TMethodJob.h"
+#include "base/Log.h"
+#include "common/stdvector.h"
+
+#include "test/global/gtest.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#define TEST_PORT 24805
+#define TEST_HOST "localhost"
+
+// one client sends the clipboard, the others only receive input
+#define CLIENTS 32
+#define CLIPBOARD_SIZE (100 * 1024 * 1024)
+
+// the clipboard is sent in chunks of the same size StreamChunker uses
+#define CLIPBOARD_CHUNK_SIZE (512 * 1024)
+
+// seconds between input events
+#define INPUT_INTERVAL 0.001
+
+// seconds a client waits on its socket before giving up
+#define POLL_TIMEOUT 30.0
+
+static void
+appendUInt32(String& buffer, UInt32 value)
+{
+	buffer.push_back(static_cast<char>((value >> 24) & 0xff));
+	buffer.push_back(static_cast<char>((value >> 16) & 0xff));
+	buffer.push_back(static_cast<char>((value >>  8) & 0xff));
+	buffer.push_back(static_cast<char>( value        & 0xff));
+}
+
+static UInt32
+readUInt32(const char* buffer)
+{
+	const UInt8* bytes = reinterpret_cast<const UInt8*>(buffer);
+	return ((UInt32)bytes[0] << 24) |
+		   ((UInt32)bytes[1] << 16) |
+		   ((UInt32)bytes[2] <<  8) |
+			(UInt32)bytes[3];
+}
+
+static String
+clipboardChunk(UInt8 mark, const char* data, UInt32 size)
+{
+	String chunk(kMsgDClipboard, 4);
+	chunk.push_back(static_cast<char>(kClipboardClipboard));
+	appendUInt32(chunk, 0);
+	chunk.push_back(static_cast<char>(mark));
+	appendUInt32(chunk, size);
+	if (size != 0) {
+		chunk.append(data, size);
+	}
+	return chunk;
+}
+
+//! A client speaking the packet protocol on a plain blocking socket
+class BenchClient {
+public:
+	BenchClient(int index) : m_index(index), m_socket(NULL) { }
+	~BenchClient()
+	{
+		if (m_socket != NULL) {
+			ARCH->closeSocket(m_socket);
+		}
+	}
+
+	int
+	getIndex() const
+	{
+		return m_index;
+	}
+
+	void
+	connect(const NetworkAddress& address)
+	{
+		m_socket = ARCH->newSocket(IArchNetwork::kINET, IArchNetwork::kSTREAM);
+		ARCH->setNoDelayOnSocket(m_socket, true);
+		if (!ARCH->connectSocket(m_socket, address.getAddress())) {
+			wait(IArchNetwork::kPOLLOUT);
+			ARCH->throwErrorOnSocket(m_socket);
+		}
+	}
+
+	void
+	write(const String& payload)
+	{
+		String packet;
+		appendUInt32(packet, static_cast<UInt32>(payload.size()));
+		packet += payload;
+
+		size_t sent = 0;
+		while (sent < packet.size()) {
+			size_t n = ARCH->writeSocket(m_socket, packet.data() + sent,
+							packet.size() - sent);
+			if (n == 0 && !wait(IArchNetwork::kPOLLOUT)) {
+				return;
+			}
+			sent += n;
+		}
+	}
+
+	bool
+	read(String& packet)
+	{
+		for (;;) {
+			if (m_buffer.size() >= 4) {
+				const UInt32 size = readUInt32(m_buffer.data());
+				if (m_buffer.size() >= 4 + size) {
+					packet = m_buffer.substr(4, size);
+					m_buffer.erase(0, 4 + size);
+					return true;
+				}
+			}
+
+			if (!wait(IArchNetwork::kPOLLIN)) {
+				return false;
+			}
+			char buffer[4096];
+			size_t n = ARCH->readSocket(m_socket, buffer, sizeof(buffer));
+			if (n == 0) {
+				return false;
+			}
+			m_buffer.append(buffer, n);
+		}
+	}
+
+private:
+	bool
+	wait(unsigned short events)
+	{
+		IArchNetwork::PollEntry entry;
+		entry.m_socket  = m_socket;
+		entry.m_events  = events;
+		entry.m_revents = 0;
+		return (ARCH->pollSocket(&entry, 1, POLL_TIMEOUT) == 1);
+	}
+
+private:
+	int					m_index;
+	ArchSocket			m_socket;
+	String				m_buffer;
+};
+
+typedef std::vector<synergy::IStream*> StreamList;
+
+class ProtocolWorkerTests : public ::testing::Test {
+public:
+	ProtocolWorkerTests() :
+		m_address(TEST_HOST, TEST_PORT),
+		m_listen(NULL),
+		m_useWorkers(false),
+		m_inputType(Event::kUnknown),
+		m_inputThread(NULL),
+		m_accepted(&m_mutex, 0),
+		m_go(&m_mutex, false),
+		m_stopInput(false),
+		m_epoch(0.0),
+		m_start(0.0),
+		m_clipboardTime(0.0),
+		m_clipboardOk(false),
+		m_inputSent(0)
+	{
+		m_address.resolve();
+	}
+
+	void				run(bool useWorkers);
+
+	// main thread
+	void				handleConnecting(const Event&, void*);
+	void				handleData(const Event&, void* vstream);
+	void				handleClipboardReceived(const Event&, void*);
+	void				handleInput(const Event&, void*);
+	void				clipboardDone();
+
+	// other threads
+	void				inputThread(void*);
+	void				senderThread(void* vclient);
+	void				receiverThread(void* vclient);
+	void				connect(BenchClient*);
+
+	UInt32				getStamp() const;
+
+public:
+	TestEventQueue		m_events;
+	NetworkAddress		m_address;
+	IListenSocket*		m_listen;
+	bool				m_useWorkers;
+	Event::Type			m_inputType;
+	Thread*				m_inputThread;
+	StreamList			m_streams;
+
+	Mutex				m_mutex;
+	CondVar<int>		m_accepted;
+	CondVar<bool>		m_go;
+	bool				m_stopInput;
+	LatencyHistogram	m_latency;
+
+	double				m_epoch;
+	double				m_start;
+	double				m_clipboardTime;
+	bool				m_clipboardOk;
+	String				m_received;
+	Clipboard			m_clipboard;
+	UInt32				m_inputSent;
+};
+
+// not a correctness test:  logs the latency of input sent to 31 clients
+// while another sends a 100MB clipboard, with and without protocol threads
+TEST_F(ProtocolWorkerTests, benchmark_largeClipboard_logsInputLatency)
+{
+	const char* modes[] = { "packet stream filter", "protocol worker" };
+	for (int i = 0; i < 2; ++i) {
+		run(i == 1);
+		EXPECT_TRUE(m_clipboardOk);
+		LOG((CLOG_INFO "%s: clipboard took %.0fms, %d input events, latency %s", modes[i], 1000.0 * m_clipboardTime, m_inputSent, m_latency.getSummary().c_str()));
+	}
+}
+
+void
+ProtocolWorkerTests::run(bool useWorkers)
+{
+	m_useWorkers    = useWorkers;
+	m_accepted      = 0;
+	m_go            = false;
+	m_stopInput     = false;
+	m_clipboardOk   = false;
+	m_inputSent     = 0;
+	m_epoch         = ARCH->monotonicTime();
+	m_latency.reset();
+
+	// a new type each run so input left over from the last run is dropped
+	m_inputType = Event::kUnknown;
+	m_events.registerTypeOnce(m_inputType, "ProtocolWorkerTests::input");
+
+	SocketMultiplexer multiplexer;
+	TCPSocketFactory factory(&m_events, &multiplexer);
+	m_listen = factory.createListen(false);
+	m_listen->bind(m_address);
+	m_events.adoptHandler(m_events.forIListenSocket().connecting(),
+							m_listen->getEventTarget(),
+							new TMethodEventJob<ProtocolWorkerTests>(this,
+								&ProtocolWorkerTests::handleConnecting));
+	m_events.adoptHandler(m_inputType, this,
+							new TMethodEventJob<ProtocolWorkerTests>(this,
+								&ProtocolWorkerTests::handleInput));
+
+	std::vector<BenchClient*> clients;
+	std::vector<Thread*> threads;
+	for (int i = 0; i < CLIENTS; ++i) {
+		BenchClient* client = new BenchClient(i);
+		clients.push_back(client);
+		threads.push_back(new Thread(new TMethodJob<ProtocolWorkerTests>(
+							this, (i == 0) ?
+								&ProtocolWorkerTests::senderThread :
+								&ProtocolWorkerTests::receiverThread,
+							client)));
+	}
+
+	m_events.initQuitTimeout(120);
+	m_events.loop();
+	m_events.cleanupQuitTimeout();
+
+	if (m_inputThread != NULL) {
+		m_inputThread->wait();
+		delete m_inputThread;
+		m_inputThread = NULL;
+	}
+	for (size_t i = 0; i < threads.size(); ++i) {
+		threads[i]->wait();
+		delete threads[i];
+		delete clients[i];
+	}
+
+	m_events.removeHandler(m_inputType, this);
+	m_events.removeHandler(m_events.forIListenSocket().connecting(),
+							m_listen->getEventTarget());
+	for (StreamList::iterator i = m_streams.begin(); i != m_streams.end(); ++i) {
+		m_events.removeHandler(m_events.forIStream().inputReady(),
+							(*i)->getEventTarget());
+		m_events.removeHandler(m_events.forClipboard().clipboardReceived(),
+							(*i)->getEventTarget());
+		delete *i;
+	}
+	m_streams.clear();
+	delete m_listen;
+	m_listen = NULL;
+}
+
+void
+ProtocolWorkerTests::handleConnecting(const Event&, void*)
+{
+	IDataSocket* socket = m_listen->accept();
+	if (socket == NULL) {
+		return;
+	}
+
+	synergy::IStream* stream;
+	if (m_useWorkers) {
+		ProtocolWorker* worker = new ProtocolWorker(&m_events, socket);
+		worker->setDecodeClipboards(true);
+		m_events.adoptHandler(m_events.forClipboard().clipboardReceived(),
+							worker->getEventTarget(),
+							new TMethodEventJob<ProtocolWorkerTests>(this,
+								&ProtocolWorkerTests::handleClipboardReceived));
+		stream = worker;
+	}
+	else {
+		stream = new PacketStreamFilter(&m_events, socket);
+	}
+	m_events.adoptHandler(m_events.forIStream().inputReady(),
+							stream->getEventTarget(),
+							new TMethodEventJob<ProtocolWorkerTests>(this,
+								&ProtocolWorkerTests::handleData, stream));
+	m_streams.push_back(stream);
+
+	// start once everyone's here
+	Lock lock(&m_mutex);
+	m_accepted = static_cast<int>(m_streams.size());
+	m_accepted.broadcast();
+	if (m_streams.size() == CLIENTS) {
+		m_start       = ARCH->monotonicTime();
+		m_inputThread = new Thread(new TMethodJob<ProtocolWorkerTests>(
+							this, &ProtocolWorkerTests::inputThread));
+		m_go = true;
+		m_go.broadcast();
+	}
+}
+
+void
+ProtocolWorkerTests::handleData(const Event&, void* vstream)
+{
+	// what ClientProxy1_6 does without a protocol worker
+	synergy::IStream* stream = static_cast<synergy::IStream*>(vstream);
+	UInt8 code[4];
+	while (stream->read(code, 4) == 4) {
+		if (memcmp(code, kMsgDClipboard, 4) != 0) {
+			stream->read(NULL, stream->getSize());
+			continue;
+		}
+
+		ClipboardID id;
+		UInt32 seq;
+		if (ClipboardChunk::assemble(stream, m_received, id, seq) == kFinish) {
+			m_clipboard.unmarshall(m_received, 0);
+			String().swap(m_received);
+			clipboardDone();
+		}
+	}
+}
+
+void
+ProtocolWorkerTests::handleClipboardReceived(const Event& event, void*)
+{
+	ProtocolWorker::ClipboardInfo* info =
+		static_cast<ProtocolWorker::ClipboardInfo*>(event.getData());
+	m_clipboard.swap(info->m_clipboard);
+	clipboardDone();
+}
+
+void
+ProtocolWorkerTests::handleInput(const Event& event, void*)
+{
+	// input without a stamp comes after the last real input
+	if (event.getData() == NULL) {
+		for (StreamList::iterator i = m_streams.begin(); i != m_streams.end(); ++i) {
+			(*i)->write(kMsgCClose, 4);
+		}
+		m_events.raiseQuitEvent();
+		return;
+	}
+
+	String packet("DMMV");
+	appendUInt32(packet, *static_cast<UInt32*>(event.getData()));
+	for (StreamList::iterator i = m_streams.begin(); i != m_streams.end(); ++i) {
+		(*i)->write(packet.data(), static_cast<UInt32>(packet.size()));
+	}
+	++m_inputSent;
+}
+
+void
+ProtocolWorkerTests::clipboardDone()
+{
+	m_clipboardTime = ARCH->monotonicTime() - m_start;
+	m_clipboard.open(0);
+	m_clipboardOk = (m_clipboard.get(IClipboard::kText).size() == CLIPBOARD_SIZE);
+	m_clipboard.close();
+
+	// finish after the input that queued up while we were busy
+	{
+		Lock lock(&m_mutex);
+		m_stopInput = true;
+	}
+	m_events.addEvent(Event(m_inputType, this, NULL));
+}
+
+void
+ProtocolWorkerTests::inputThread(void*)
+{
+	for (;;) {
+		{
+			Lock lock(&m_mutex);
+			if (m_stopInput) {
+				break;
+			}
+		}
+
+		// event data is freed with free()
+		UInt32* stamp = static_cast<UInt32*>(malloc(sizeof(UInt32)));
+		*stamp = getStamp();
+		m_events.addEvent(Event(m_inputType, this, stamp));
+		ARCH->sleep(INPUT_INTERVAL);
+	}
+}
+
+void
+ProtocolWorkerTests::senderThread(void* vclient)
+{
+	BenchClient* client = static_cast<BenchClient*>(vclient);
+	connect(client);
+
+	Clipboard clipboard;
+	clipboard.open(0);
+	clipboard.add(IClipboard::kText, String(CLIPBOARD_SIZE, 'x'));
+	clipboard.close();
+	const String data = clipboard.marshall();
+	const String size = synergy::string::sizeTypeToString(data.size());
+
+	{
+		Lock lock(&m_mutex);
+		while (!m_go) {
+			m_go.wait();
+		}
+	}
+
+	client->write(clipboardChunk(kDataStart, size.data(),
+							static_cast<UInt32>(size.size())));
+	for (size_t sent = 0; sent < data.size(); sent += CLIPBOARD_CHUNK_SIZE) {
+		size_t n = data.size() - sent;
+		if (n > CLIPBOARD_CHUNK_SIZE) {
+			n = CLIPBOARD_CHUNK_SIZE;
+		}
+		client->write(clipboardChunk(kDataChunk, data.data() + sent,
+							static_cast<UInt32>(n)));
+	}
+	client->write(clipboardChunk(kDataEnd, NULL, 0));
+}
+
+void
+ProtocolWorkerTests::receiverThread(void* vclient)
+{
+	BenchClient* client = static_cast<BenchClient*>(vclient);
+	connect(client);
+
+	String packet;
+	while (client->read(packet)) {
+		if (packet.size() == 8 && memcmp(packet.data(), "DMMV", 4) == 0) {
+			const UInt32 latency = getStamp() - readUInt32(packet.data() + 4);
+			Lock lock(&m_mutex);
+			m_latency.record(latency);
+		}
+		else if (packet == kMsgCClose) {
+			break;
+		}
+	}
+}
+
+void
+ProtocolWorkerTests::connect(BenchClient* client)
+{
+	// the listen backlog is tiny so connect one at a time
+	{
+		Lock lock(&m_mutex);
+		while (m_accepted < client->getIndex()) {
+			m_accepted.wait();
+		}
+	}
+	client->connect(m_address);
+}
+
+UInt32
+ProtocolWorkerTests::getStamp() const
+{
+	return static_cast<UInt32>(1.0e6 * (ARCH->monotonicTime() - m_epoch));
+}
+
+#endif // WINAPI_CARBON
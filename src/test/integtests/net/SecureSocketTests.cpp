@@ -0,0 +1,458 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// the ns plugin is only linked into the tests on linux.
+#if WINAPI_XWINDOWS
+
+#include "test/global/TestEventQueue.h"
+#include "plugin/ns/ns.h"
+#include "plugin/ns/SecureSocket.h"
+#include "plugin/ns/SecureListenSocket.h"
+#include "net/SocketMultiplexer.h"
+#include "net/NetworkAddress.h"
+#include "arch/Arch.h"
+#include "base/TMethodEventJob.h"
+#include "base/Log.h"
+#include "base/String.h"
+
+#include "test/global/gtest.h"
+
+#include <openssl/pem.h>
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <vector>
+
+#define TEST_PORT 24804
+#define TEST_HOST "localhost"
+
+const int kClientCount = 50;
+const int kReconnectCount = 20;
+const UInt32 kClipboardSize = 1024 * 1024 * 16; // 16MB
+const UInt32 kClipboardChunkSize = 1024 * 16; // same as StreamChunker
+const char* kProfileDir = "SecureSocketTests.profile";
+
+class SecureSocketTests : public ::testing::Test
+{
+public:
+	SecureSocketTests() :
+		m_expected(kClientCount),
+		m_serverReady(0),
+		m_clientReady(0),
+		m_failed(0),
+		m_listen(NULL),
+		m_clipboard(NULL),
+		m_written(0),
+		m_received(0)
+	{
+	}
+
+	virtual void		SetUp();
+	virtual void		TearDown();
+
+	void				handleClientConnecting(const Event&, void*);
+	void				handleConnected(const Event&, void* vsocket);
+	void				handleServerReady(const Event&, void*);
+	void				handleClientReady(const Event&, void*);
+	void				handleDisconnected(const Event&, void*);
+	void				handleWriteNext(const Event&, void* vsocket);
+	void				handleInputReady(const Event&, void* vsocket);
+
+protected:
+	void				listen(SocketMultiplexer*, NetworkAddress&);
+	void				deleteListen();
+	SecureSocket*		newClient(SocketMultiplexer*, NetworkAddress&);
+	void				deleteSockets(std::vector<SecureSocket*>&);
+
+private:
+	void				createCertificate();
+	void				checkDone();
+
+public:
+	TestEventQueue		m_events;
+	int					m_expected;
+	int					m_serverReady;
+	int					m_clientReady;
+	int					m_failed;
+	SecureListenSocket*	m_listen;
+	std::vector<IDataSocket*>
+						m_serverSockets;
+	UInt8*				m_clipboard;
+	UInt32				m_written;
+	UInt32				m_received;
+};
+
+TEST_F(SecureSocketTests, connect_manyClients_allReady)
+{
+	NetworkAddress address(TEST_HOST, TEST_PORT);
+	address.resolve();
+
+	SocketMultiplexer multiplexer;
+	listen(&multiplexer, address);
+
+	double start = ARCH->time();
+
+	std::vector<SecureSocket*> clients;
+	for (int i = 0; i < kClientCount; i++) {
+		clients.push_back(newClient(&multiplexer, address));
+	}
+
+	m_events.initQuitTimeout(30);
+	m_events.loop();
+	m_events.cleanupQuitTimeout();
+
+	double elapsed = ARCH->time() - start;
+	LOG((CLOG_INFO "%d secure clients ready in %.3f sec (%.2f ms per client)",
+		kClientCount, elapsed, elapsed * 1000.0 / kClientCount));
+
+	deleteSockets(clients);
+	deleteListen();
+
+	EXPECT_EQ(0, m_failed);
+	EXPECT_EQ(kClientCount, m_serverReady);
+	EXPECT_EQ(kClientCount, m_clientReady);
+}
+
+TEST_F(SecureSocketTests, reconnect_sameServer_sessionResumed)
+{
+	NetworkAddress address(TEST_HOST, TEST_PORT + 1);
+	address.resolve();
+
+	SocketMultiplexer multiplexer;
+	listen(&multiplexer, address);
+
+	double fullHandshake = 0;
+	double resumedHandshakes = 0;
+	int resumed = 0;
+
+	m_events.initQuitTimeout(30);
+	for (int i = 0; i < kReconnectCount; i++) {
+		m_expected = 1;
+		m_serverReady = 0;
+		m_clientReady = 0;
+
+		double start = ARCH->time();
+
+		std::vector<SecureSocket*> clients;
+		clients.push_back(newClient(&multiplexer, address));
+		m_events.loop();
+
+		double elapsed = ARCH->time() - start;
+		if (i == 0) {
+			fullHandshake = elapsed;
+		}
+		else {
+			resumedHandshakes += elapsed;
+			if (clients[0]->isSessionReused()) {
+				resumed++;
+			}
+		}
+
+		deleteSockets(clients);
+	}
+	m_events.cleanupQuitTimeout();
+	deleteListen();
+
+	LOG((CLOG_INFO "secure reconnect: full handshake %.2f ms, "
+		"resumed handshake %.2f ms (%d of %d resumed)",
+		fullHandshake * 1000.0,
+		resumedHandshakes * 1000.0 / (kReconnectCount - 1),
+		resumed, kReconnectCount - 1));
+
+	EXPECT_EQ(0, m_failed);
+	EXPECT_EQ(kReconnectCount - 1, resumed);
+}
+
+TEST_F(SecureSocketTests, write_clipboardData_allReceived)
+{
+	NetworkAddress address(TEST_HOST, TEST_PORT + 2);
+	address.resolve();
+
+	SocketMultiplexer multiplexer;
+	listen(&multiplexer, address);
+
+	m_clipboard = new UInt8[kClipboardSize];
+	for (UInt32 i = 0; i < kClipboardSize; i++) {
+		m_clipboard[i] = static_cast<UInt8>(i);
+	}
+
+	// wait for the handshake before timing the transfer
+	m_expected = 1;
+	std::vector<SecureSocket*> clients;
+	clients.push_back(newClient(&multiplexer, address));
+
+	m_events.initQuitTimeout(30);
+	m_events.loop();
+
+	IDataSocket* server = m_serverSockets[0];
+	SecureSocket* client = clients[0];
+	m_events.adoptHandler(m_events.forIStream().inputReady(),
+		server->getEventTarget(),
+		new TMethodEventJob<SecureSocketTests>(
+			this, &SecureSocketTests::handleInputReady, server));
+	m_events.adoptHandler(m_events.forIStream().outputFlushed(),
+		client->getEventTarget(),
+		new TMethodEventJob<SecureSocketTests>(
+			this, &SecureSocketTests::handleWriteNext, client));
+
+	// write chunk by chunk, like the clipboard chunker does
+	double start = ARCH->time();
+	handleWriteNext(Event(), client);
+	m_events.loop();
+	double elapsed = ARCH->time() - start;
+	m_events.cleanupQuitTimeout();
+
+	LOG((CLOG_INFO "secure clipboard transfer: %u bytes in %.3f sec (%.1f MB/s)",
+		kClipboardSize, elapsed,
+		kClipboardSize / elapsed / (1024.0 * 1024.0)));
+
+	deleteSockets(clients);
+	deleteListen();
+	delete[] m_clipboard;
+
+	EXPECT_EQ(0, m_failed);
+	EXPECT_EQ(kClipboardSize, m_received);
+}
+
+void
+SecureSocketTests::SetUp()
+{
+	// the plugin has its own copy of the arch and log singletons
+	init(CLOG, ARCH);
+
+	ARCH->setProfileDirectory(kProfileDir);
+	createCertificate();
+}
+
+void
+SecureSocketTests::TearDown()
+{
+
+	String sslDir = String(kProfileDir) + "/SSL";
+	remove((sslDir + "/Fingerprints/TrustedServers.txt").c_str());
+	remove((sslDir + "/Synergy.pem").c_str());
+	rmdir((sslDir + "/Fingerprints").c_str());
+	rmdir(sslDir.c_str());
+	rmdir(kProfileDir);
+	ARCH->setProfileDirectory("");
+}
+
+void
+SecureSocketTests::listen(SocketMultiplexer* multiplexer, NetworkAddress& address)
+{
+	m_listen = new SecureListenSocket(&m_events, multiplexer);
+	m_listen->bind(address);
+	m_events.adoptHandler(m_events.forIListenSocket().connecting(), m_listen,
+		new TMethodEventJob<SecureSocketTests>(
+			this, &SecureSocketTests::handleClientConnecting));
+}
+
+void
+SecureSocketTests::deleteListen()
+{
+	m_events.removeHandler(m_events.forIListenSocket().connecting(), m_listen);
+	delete m_listen;
+	m_listen = NULL;
+}
+
+SecureSocket*
+SecureSocketTests::newClient(SocketMultiplexer* multiplexer, NetworkAddress& address)
+{
+	SecureSocket* socket = new SecureSocket(&m_events, multiplexer);
+	socket->initSsl(false);
+
+	m_events.adoptHandler(m_events.forIDataSocket().connected(),
+		socket->getEventTarget(),
+		new TMethodEventJob<SecureSocketTests>(
+			this, &SecureSocketTests::handleConnected, socket));
+	m_events.adoptHandler(m_events.forIDataSocket().secureConnected(),
+		socket->getEventTarget(),
+		new TMethodEventJob<SecureSocketTests>(
+			this, &SecureSocketTests::handleClientReady));
+	m_events.adoptHandler(m_events.forISocket().disconnected(),
+		socket->getEventTarget(),
+		new TMethodEventJob<SecureSocketTests>(
+			this, &SecureSocketTests::handleDisconnected));
+
+	socket->connect(address);
+	return socket;
+}
+
+void
+SecureSocketTests::deleteSockets(std::vector<SecureSocket*>& clients)
+{
+	for (size_t i = 0; i < clients.size(); i++) {
+		m_events.removeHandlers(clients[i]->getEventTarget());
+		delete clients[i];
+	}
+	clients.clear();
+
+	for (size_t i = 0; i < m_serverSockets.size(); i++) {
+		m_events.removeHandlers(m_serverSockets[i]->getEventTarget());
+		m_listen->deleteSocket(m_serverSockets[i]);
+	}
+	m_serverSockets.clear();
+}
+
+void
+SecureSocketTests::handleClientConnecting(const Event&, void*)
+{
+	IDataSocket* socket = m_listen->accept();
+	if (socket == NULL) {
+		m_failed++;
+		checkDone();
+		return;
+	}
+
+	m_serverSockets.push_back(socket);
+	m_events.adoptHandler(m_events.forIDataSocket().secureConnected(),
+		socket->getEventTarget(),
+		new TMethodEventJob<SecureSocketTests>(
+			this, &SecureSocketTests::handleServerReady));
+	m_events.adoptHandler(m_events.forISocket().disconnected(),
+		socket->getEventTarget(),
+		new TMethodEventJob<SecureSocketTests>(
+			this, &SecureSocketTests::handleDisconnected));
+}
+
+void
+SecureSocketTests::handleConnected(const Event&, void* vsocket)
+{
+	reinterpret_cast<SecureSocket*>(vsocket)->secureConnect();
+}
+
+void
+SecureSocketTests::handleServerReady(const Event&, void*)
+{
+	m_serverReady++;
+	checkDone();
+}
+
+void
+SecureSocketTests::handleClientReady(const Event&, void*)
+{
+	m_clientReady++;
+	checkDone();
+}
+
+void
+SecureSocketTests::handleDisconnected(const Event&, void*)
+{
+	m_failed++;
+	checkDone();
+}
+
+void
+SecureSocketTests::handleWriteNext(const Event&, void* vsocket)
+{
+	if (m_written == kClipboardSize) {
+		return;
+	}
+
+	UInt32 size = kClipboardSize - m_written;
+	if (size > kClipboardChunkSize) {
+		size = kClipboardChunkSize;
+	}
+
+	reinterpret_cast<SecureSocket*>(vsocket)->write(m_clipboard + m_written, size);
+	m_written += size;
+}
+
+void
+SecureSocketTests::handleInputReady(const Event&, void* vsocket)
+{
+	IDataSocket* socket = reinterpret_cast<IDataSocket*>(vsocket);
+
+	UInt8 buffer[kClipboardChunkSize];
+	UInt32 n;
+	while ((n = socket->read(buffer, sizeof(buffer))) > 0) {
+		if (memcmp(buffer, m_clipboard + m_received, n) != 0) {
+			m_failed++;
+		}
+		m_received += n;
+	}
+
+	if (m_received == kClipboardSize || m_failed > 0) {
+		m_events.raiseQuitEvent();
+	}
+}
+
+void
+SecureSocketTests::checkDone()
+{
+	if (m_failed > 0 ||
+		(m_serverReady == m_expected && m_clientReady == m_expected)) {
+		m_events.raiseQuitEvent();
+	}
+}
+
+void
+SecureSocketTests::createCertificate()
+{
+	String sslDir = String(kProfileDir) + "/SSL";
+	mkdir(kProfileDir, 0700);
+	mkdir(sslDir.c_str(), 0700);
+	mkdir((sslDir + "/Fingerprints").c_str(), 0700);
+
+	// self signed certificate, same as the one the gui generates
+	EVP_PKEY* key = NULL;
+	EVP_PKEY_CTX* context = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, NULL);
+	EVP_PKEY_keygen_init(context);
+	EVP_PKEY_CTX_set_rsa_keygen_bits(context, 2048);
+	EVP_PKEY_keygen(context, &key);
+	EVP_PKEY_CTX_free(context);
+
+	X509* cert = X509_new();
+	ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+	X509_gmtime_adj(X509_get_notBefore(cert), 0);
+	X509_gmtime_adj(X509_get_notAfter(cert), 60 * 60);
+	X509_set_pubkey(cert, key);
+	X509_NAME* name = X509_get_subject_name(cert);
+	X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+		reinterpret_cast<const unsigned char*>("Synergy"), -1, -1, 0);
+	X509_set_issuer_name(cert, name);
+	X509_sign(cert, key, EVP_sha256());
+
+	FILE* file = fopen((sslDir + "/Synergy.pem").c_str(), "w");
+	PEM_write_PrivateKey(file, key, NULL, NULL, 0, NULL, NULL);
+	PEM_write_X509(file, cert);
+	fclose(file);
+
+	// trust the certificate on the client side
+	unsigned char digest[EVP_MAX_MD_SIZE];
+	unsigned int digestLength = 0;
+	X509_digest(cert, EVP_sha1(), digest, &digestLength);
+
+	String fingerprint;
+	for (unsigned int i = 0; i < digestLength; i++) {
+		if (i != 0) {
+			fingerprint.append(":");
+		}
+		fingerprint.append(synergy::string::sprintf("%02X", digest[i]));
+	}
+
+	file = fopen((sslDir + "/Fingerprints/TrustedServers.txt").c_str(), "w");
+	fprintf(file, "%s\n", fingerprint.c_str());
+	fclose(file);
+
+	X509_free(cert);
+	EVP_PKEY_free(key);
+}
+
+#endif // WINAPI_XWINDOWS
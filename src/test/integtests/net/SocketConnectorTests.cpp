@@ -0,0 +1,210 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// TODO: fix, tests failing intermittently on mac.
+#ifndef WINAPI_CARBON
+
+#define TEST_ENV
+
+#include "test/global/TestEventQueue.h"
+#include "net/SocketConnector.h"
+#include "net/NameResolver.h"
+#include "net/IDataSocket.h"
+#include "net/IListenSocket.h"
+#include "net/NetworkAddress.h"
+#include "net/SocketMultiplexer.h"
+#include "net/TCPSocketFactory.h"
+#include "arch/Arch.h"
+#include "base/TMethodEventJob.h"
+#include "base/Log.h"
+
+#include "test/global/gtest.h"
+
+#define TEST_PORT 24806
+#define TEST_HOST "127.0.0.1"
+
+// nothing listens on this port
+#define REFUSED_PORT 24807
+
+// how long the stub resolver takes to answer, in seconds
+#define LOOKUP_DELAY 0.3
+
+// a stub resolver standing in for a slow DNS server
+static void
+slowLookup(const String& hostname, std::vector<ArchNetAddress>& addresses)
+{
+	ARCH->sleep(LOOKUP_DELAY);
+	ARCH->nameToAddrs(TEST_HOST, addresses);
+}
+
+class SocketConnectorTests : public ::testing::Test {
+public:
+	SocketConnectorTests() :
+		m_socketFactory(&m_events, &m_multiplexer),
+		m_listener(NULL),
+		m_connector(NULL),
+		m_connected(false),
+		m_failed(false)
+	{
+		NetworkAddress address(TEST_HOST, TEST_PORT);
+		address.resolve();
+		m_listener = m_socketFactory.createListen(false);
+		m_listener->bind(address);
+	}
+
+	~SocketConnectorTests()
+	{
+		delete m_connector;
+		delete m_listener;
+	}
+
+	// resolves \c address if needed then connects to it
+	void
+	connect(NameResolver& resolver, const NetworkAddress& address)
+	{
+		NameResolver::AddressList addresses;
+		if (resolver.getCached(address, addresses)) {
+			connect(addresses);
+			return;
+		}
+
+		m_events.adoptHandler(m_events.forNameResolver().resolved(), this,
+							new TMethodEventJob<SocketConnectorTests>(this,
+								&SocketConnectorTests::handleResolved));
+		resolver.resolve(address, this);
+		m_events.initQuitTimeout(5);
+		m_events.loop();
+		m_events.cleanupQuitTimeout();
+		m_events.removeHandler(m_events.forNameResolver().resolved(), this);
+		ASSERT_FALSE(m_addresses.empty());
+		connect(m_addresses);
+	}
+
+	void
+	connect(const NameResolver::AddressList& addresses)
+	{
+		delete m_connector;
+		m_connector = new SocketConnector(&m_events, &m_socketFactory, false);
+		m_connected = false;
+		m_failed    = false;
+		m_events.adoptHandler(m_events.forIDataSocket().connected(),
+							m_connector->getEventTarget(),
+							new TMethodEventJob<SocketConnectorTests>(this,
+								&SocketConnectorTests::handleConnected));
+		m_events.adoptHandler(m_events.forIDataSocket().connectionFailed(),
+							m_connector->getEventTarget(),
+							new TMethodEventJob<SocketConnectorTests>(this,
+								&SocketConnectorTests::handleConnectionFailed));
+		m_connector->connect(addresses);
+		m_events.initQuitTimeout(5);
+		m_events.loop();
+		m_events.cleanupQuitTimeout();
+		m_events.removeHandlers(m_connector->getEventTarget());
+	}
+
+	void
+	handleResolved(const Event& event, void*)
+	{
+		NameResolver::Result* result =
+			reinterpret_cast<NameResolver::Result*>(event.getData());
+		m_addresses = result->m_addresses;
+		delete result;
+		m_events.raiseQuitEvent();
+	}
+
+	void
+	handleConnected(const Event&, void*)
+	{
+		m_connected = true;
+		m_events.raiseQuitEvent();
+	}
+
+	void
+	handleConnectionFailed(const Event& event, void*)
+	{
+		delete reinterpret_cast<IDataSocket::ConnectionFailedInfo*>(
+							event.getData());
+		m_failed = true;
+		m_events.raiseQuitEvent();
+	}
+
+public:
+	TestEventQueue		m_events;
+	SocketMultiplexer	m_multiplexer;
+	TCPSocketFactory	m_socketFactory;
+	IListenSocket*		m_listener;
+	SocketConnector*	m_connector;
+	NameResolver::AddressList	m_addresses;
+	bool				m_connected;
+	bool				m_failed;
+};
+
+TEST_F(SocketConnectorTests, connect_firstRefused_connectsToSecond)
+{
+	NameResolver::AddressList addresses;
+	addresses.push_back(NetworkAddress(TEST_HOST, REFUSED_PORT));
+	addresses.push_back(NetworkAddress(TEST_HOST, TEST_PORT));
+	addresses[0].resolve();
+	addresses[1].resolve();
+
+	connect(addresses);
+
+	EXPECT_TRUE(m_connected);
+	EXPECT_EQ(TEST_PORT, m_connector->getAddress().getPort());
+	IDataSocket* socket = m_connector->orphanSocket();
+	EXPECT_TRUE(socket != NULL);
+	EXPECT_TRUE(m_connector->orphanSocket() == NULL);
+	delete socket;
+}
+
+TEST_F(SocketConnectorTests, connect_allRefused_fails)
+{
+	NameResolver::AddressList addresses;
+	addresses.push_back(NetworkAddress(TEST_HOST, REFUSED_PORT));
+	addresses[0].resolve();
+
+	connect(addresses);
+
+	EXPECT_TRUE(m_failed);
+	EXPECT_FALSE(m_connected);
+	EXPECT_TRUE(m_connector->orphanSocket() == NULL);
+}
+
+// the first connect waits for the (slow) resolver, reconnects use the
+// cached addresses
+TEST_F(SocketConnectorTests, reconnect_slowResolver_usesCache)
+{
+	NameResolver resolver(&m_events, 300.0, &slowLookup);
+	NetworkAddress address("synergy.example.com", TEST_PORT);
+
+	double start = ARCH->monotonicTime();
+	connect(resolver, address);
+	const double first = ARCH->monotonicTime() - start;
+	ASSERT_TRUE(m_connected);
+
+	start = ARCH->monotonicTime();
+	connect(resolver, address);
+	const double reconnect = ARCH->monotonicTime() - start;
+	ASSERT_TRUE(m_connected);
+
+	LOG((CLOG_INFO "connect %.2fms, reconnect %.2fms", 1000.0 * first, 1000.0 * reconnect));
+	EXPECT_GE(first, LOOKUP_DELAY);
+	EXPECT_LT(reconnect, LOOKUP_DELAY / 2);
+}
+
+#endif // WINAPI_CARBON
@@ -0,0 +1,329 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// these tests need an X server, e.g. run them with xvfb-run.  they're
+// skipped if DISPLAY can't be opened.
+
+// gtest must come before X11, which defines None
+#include "test/global/gtest.h"
+
+#include "platform/XWindowsClipboard.h"
+#include "platform/XWindowsUtil.h"
+#include "mt/Thread.h"
+#include "arch/Arch.h"
+#include "base/LatencyHistogram.h"
+#include "base/Log.h"
+#include "base/TMethodJob.h"
+
+#include <cstring>
+#include <X11/Xatom.h>
+
+// how long the selection owner takes to answer each request
+static const double kOwnerDelay = 0.5;
+static const char* kOwnerText   = "synergy from a slow owner";
+
+class XWindowsClipboardFetchTests : public ::testing::Test
+{
+protected:
+	virtual void
+	SetUp()
+	{
+		XInitThreads();
+		m_display      = XOpenDisplay(NULL);
+		m_ownerDisplay = XOpenDisplay(NULL);
+		m_inputDisplay = XOpenDisplay(NULL);
+		m_stop         = false;
+		if (m_display == NULL || m_ownerDisplay == NULL ||
+			m_inputDisplay == NULL) {
+			return;
+		}
+
+		m_window      = createWindow(m_display);
+		m_ownerWindow = createWindow(m_ownerDisplay);
+		m_atomInput   = XInternAtom(m_display, "SYNERGY_TEST_INPUT", False);
+	}
+
+	virtual void
+	TearDown()
+	{
+		if (m_display != NULL) {
+			XDestroyWindow(m_display, m_window);
+			XCloseDisplay(m_display);
+		}
+		if (m_ownerDisplay != NULL) {
+			XDestroyWindow(m_ownerDisplay, m_ownerWindow);
+			XCloseDisplay(m_ownerDisplay);
+		}
+		if (m_inputDisplay != NULL) {
+			XCloseDisplay(m_inputDisplay);
+		}
+	}
+
+	bool
+	haveDisplay() const
+	{
+		return (m_display != NULL && m_ownerDisplay != NULL &&
+				m_inputDisplay != NULL);
+	}
+
+	static Window
+	createWindow(Display* display)
+	{
+		XSetWindowAttributes attr;
+		attr.override_redirect = True;
+		return XCreateWindow(display, DefaultRootWindow(display),
+							0, 0, 1, 1, 0, 0, InputOnly, CopyFromParent,
+							CWOverrideRedirect, &attr);
+	}
+
+public:
+	// take the CLIPBOARD selection and answer requests for it, slowly
+	void
+	ownerThread(void*)
+	{
+		Display* display  = m_ownerDisplay;
+		Atom selection    = XInternAtom(display, "CLIPBOARD", False);
+		Atom atomTargets  = XInternAtom(display, "TARGETS", False);
+		Atom atomTime     = XInternAtom(display, "TIMESTAMP", False);
+		Atom atomUTF8     = XInternAtom(display, "UTF8_STRING", False);
+		Time owned        = XWindowsUtil::getCurrentTime(display, m_ownerWindow);
+		XSetSelectionOwner(display, selection, m_ownerWindow, owned);
+		XSync(display, False);
+
+		while (!m_stop) {
+			if (XPending(display) == 0) {
+				ARCH->sleep(0.01);
+				continue;
+			}
+
+			XEvent xevent;
+			XNextEvent(display, &xevent);
+			if (xevent.type != SelectionRequest) {
+				continue;
+			}
+
+			// be slow about it
+			ARCH->sleep(kOwnerDelay);
+
+			const XSelectionRequestEvent& request = xevent.xselectionrequest;
+			Atom property = request.property;
+			if (request.target == atomTargets) {
+				Atom targets[] = { atomTargets, atomTime, atomUTF8 };
+				XChangeProperty(display, request.requestor, property,
+							XA_ATOM, 32, PropModeReplace,
+							reinterpret_cast<unsigned char*>(targets), 3);
+			}
+			else if (request.target == atomTime) {
+				long time = static_cast<long>(owned);
+				XChangeProperty(display, request.requestor, property,
+							XA_INTEGER, 32, PropModeReplace,
+							reinterpret_cast<unsigned char*>(&time), 1);
+			}
+			else if (request.target == atomUTF8) {
+				XChangeProperty(display, request.requestor, property,
+							atomUTF8, 8, PropModeReplace,
+							reinterpret_cast<const unsigned char*>(kOwnerText),
+							(int)strlen(kOwnerText));
+			}
+			else {
+				property = None;
+			}
+
+			XEvent reply;
+			reply.xselection.type      = SelectionNotify;
+			reply.xselection.display   = display;
+			reply.xselection.requestor = request.requestor;
+			reply.xselection.selection = request.selection;
+			reply.xselection.target    = request.target;
+			reply.xselection.property  = property;
+			reply.xselection.time      = request.time;
+			XSendEvent(display, request.requestor, False, 0, &reply);
+			XFlush(display);
+		}
+	}
+
+protected:
+	// stand-in for a key press:  a client message from another client
+	void
+	sendInput()
+	{
+		XEvent xevent;
+		xevent.xclient.type         = ClientMessage;
+		xevent.xclient.display      = m_inputDisplay;
+		xevent.xclient.window       = m_window;
+		xevent.xclient.message_type = m_atomInput;
+		xevent.xclient.format       = 32;
+		for (int i = 0; i < 5; ++i) {
+			xevent.xclient.data.l[i] = 0;
+		}
+		XSendEvent(m_inputDisplay, m_window, False, 0, &xevent);
+		XFlush(m_inputDisplay);
+	}
+
+	Display*		m_display;
+	Display*		m_ownerDisplay;
+	Display*		m_inputDisplay;
+	Window			m_window;
+	Window			m_ownerWindow;
+	Atom			m_atomInput;
+	volatile bool	m_stop;
+};
+
+TEST_F(XWindowsClipboardFetchTests, fetch_slowOwner_inputKeepsFlowing)
+{
+	if (!haveDisplay()) {
+		LOG((CLOG_WARN "no X display, skipping test"));
+		return;
+	}
+
+	Thread owner(new TMethodJob<XWindowsClipboardFetchTests>(
+							this, &XWindowsClipboardFetchTests::ownerThread));
+
+	// wait for the owner to take the selection
+	Atom selection = XInternAtom(m_display, "CLIPBOARD", False);
+	double start   = ARCH->monotonicTime();
+	while (XGetSelectionOwner(m_display, selection) != m_ownerWindow &&
+			ARCH->monotonicTime() - start < 5.0) {
+		ARCH->sleep(0.01);
+	}
+	const bool owned = (XGetSelectionOwner(m_display, selection) == m_ownerWindow);
+
+	// fetch while input arrives every 10ms.  the loop dispatches events
+	// the way the screen does with events from its event queue buffer.
+	XWindowsClipboard clipboard(m_display, m_window, kClipboardClipboard);
+	LatencyHistogram latency;
+	start = ARCH->monotonicTime();
+	if (owned) {
+		clipboard.fetch(XWindowsUtil::getCurrentTime(m_display, m_window),
+							(1u << IClipboard::kNumFormats) - 1);
+	}
+	while (clipboard.isFetching() && ARCH->monotonicTime() - start < 10.0) {
+		const double sent = ARCH->monotonicTime();
+		sendInput();
+		for (bool gotInput = false; !gotInput; ) {
+			XEvent xevent;
+			XNextEvent(m_display, &xevent);
+			if (xevent.type == ClientMessage &&
+				xevent.xclient.message_type == m_atomInput) {
+				gotInput = true;
+			}
+			else {
+				clipboard.processFetchEvent(&xevent);
+			}
+		}
+		latency.record((UInt32)((ARCH->monotonicTime() - sent) * 1.0e6));
+		clipboard.checkFetch();
+		ARCH->sleep(0.01);
+	}
+	const double elapsed = ARCH->monotonicTime() - start;
+	m_stop = true;
+	owner.wait();
+	LOG((CLOG_INFO "fetch took %.3fs, input latency %s", elapsed, latency.getSummary().c_str()));
+	ASSERT_TRUE(owned);
+
+	// the owner answers three requests (TIMESTAMP, TARGETS and the text)
+	ASSERT_FALSE(clipboard.isFetching());
+	EXPECT_GE(elapsed, 3 * kOwnerDelay);
+	EXPECT_TRUE(clipboard.takeFetched());
+	ASSERT_TRUE(clipboard.open(0));
+	EXPECT_TRUE(clipboard.has(IClipboard::kText));
+	EXPECT_EQ(kOwnerText, clipboard.get(IClipboard::kText));
+	clipboard.close();
+
+	// input was never held up waiting for the owner
+	EXPECT_GT(latency.getCount(), 10u);
+	EXPECT_LT(latency.getMax(), (UInt32)(kOwnerDelay * 1.0e6 / 5));
+}
+
+TEST_F(XWindowsClipboardFetchTests, reply_severalRequestors_convertsOnce)
+{
+	if (!haveDisplay()) {
+		LOG((CLOG_WARN "no X display, skipping test"));
+		return;
+	}
+
+	// own the clipboard with text too big for one property so it's
+	// sent with INCR
+	XWindowsClipboard owner(m_ownerDisplay, m_ownerWindow, kClipboardClipboard);
+	const String text(XWindowsUtil::getMaxPropertySize(m_ownerDisplay) + 1000, 'x');
+	ASSERT_TRUE(owner.open(XWindowsUtil::getCurrentTime(m_ownerDisplay, m_ownerWindow)));
+	ASSERT_TRUE(owner.empty());
+	owner.add(IClipboard::kText, text);
+	owner.close();
+
+	// several requestors read it at once
+	const int kNumRequestors = 3;
+	Window windows[kNumRequestors];
+	XWindowsClipboard* requestors[kNumRequestors];
+	for (int i = 0; i < kNumRequestors; ++i) {
+		windows[i]    = createWindow(m_display);
+		requestors[i] = new XWindowsClipboard(m_display, windows[i], kClipboardClipboard);
+		requestors[i]->fetch(XWindowsUtil::getCurrentTime(m_display, windows[i]),
+								1u << IClipboard::kText);
+	}
+
+	// dispatch events for the owner and the requestors the way the
+	// screen does
+	const double start = ARCH->monotonicTime();
+	bool fetching = true;
+	while (fetching && ARCH->monotonicTime() - start < 30.0) {
+		while (XPending(m_ownerDisplay) > 0) {
+			XEvent xevent;
+			XNextEvent(m_ownerDisplay, &xevent);
+			if (xevent.type == SelectionRequest) {
+				owner.addRequest(xevent.xselectionrequest.owner,
+								xevent.xselectionrequest.requestor,
+								xevent.xselectionrequest.target,
+								xevent.xselectionrequest.time,
+								xevent.xselectionrequest.property);
+			}
+			else if (xevent.type == PropertyNotify &&
+					xevent.xproperty.state == PropertyDelete) {
+				owner.processRequest(xevent.xproperty.window,
+								xevent.xproperty.time,
+								xevent.xproperty.atom);
+			}
+		}
+		while (XPending(m_display) > 0) {
+			XEvent xevent;
+			XNextEvent(m_display, &xevent);
+			for (int i = 0; i < kNumRequestors; ++i) {
+				if (requestors[i]->processFetchEvent(&xevent)) {
+					break;
+				}
+			}
+		}
+
+		fetching = false;
+		for (int i = 0; i < kNumRequestors; ++i) {
+			requestors[i]->checkFetch();
+			fetching = (fetching || requestors[i]->isFetching());
+		}
+		ARCH->sleep(0.001);
+	}
+
+	// every requestor got the text but it was only converted once
+	for (int i = 0; i < kNumRequestors; ++i) {
+		EXPECT_FALSE(requestors[i]->isFetching());
+		EXPECT_TRUE(requestors[i]->open(0));
+		EXPECT_TRUE(text == requestors[i]->get(IClipboard::kText));
+		requestors[i]->close();
+		delete requestors[i];
+		XDestroyWindow(m_display, windows[i]);
+	}
+	EXPECT_EQ((UInt32)(kNumRequestors - 1), owner.getConversionHits());
+}
@@ -52,6 +52,7 @@ public:
 	MOCK_METHOD0(forIDataSocket, IDataSocketEvents&());
 	MOCK_METHOD0(forIListenSocket, IListenSocketEvents&());
 	MOCK_METHOD0(forISocket, ISocketEvents&());
+	MOCK_METHOD0(forNameResolver, NameResolverEvents&());
 	MOCK_METHOD0(forOSXScreen, OSXScreenEvents&());
 	MOCK_METHOD0(forClientListener, ClientListenerEvents&());
 	MOCK_METHOD0(forClientProxy, ClientProxyEvents&());
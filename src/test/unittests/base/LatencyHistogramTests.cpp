@@ -0,0 +1,83 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "base/LatencyHistogram.h"
+
+#include "test/global/gtest.h"
+
+TEST(LatencyHistogramTests, getPercentile_noSamples_zero)
+{
+	LatencyHistogram histogram;
+
+	EXPECT_EQ(0, histogram.getCount());
+	EXPECT_EQ(0, histogram.getPercentile(50.0));
+	EXPECT_EQ(0.0, histogram.getMean());
+}
+
+TEST(LatencyHistogramTests, getPercentile_smallSamples_exact)
+{
+	LatencyHistogram histogram;
+
+	for (UInt32 i = 1; i <= 50; ++i) {
+		histogram.record(i);
+	}
+
+	EXPECT_EQ(50, histogram.getCount());
+	EXPECT_EQ(25, histogram.getPercentile(50.0));
+	EXPECT_EQ(45, histogram.getPercentile(90.0));
+	EXPECT_EQ(50, histogram.getPercentile(100.0));
+	EXPECT_EQ(50, histogram.getMax());
+	EXPECT_DOUBLE_EQ(25.5, histogram.getMean());
+}
+
+TEST(LatencyHistogramTests, getPercentile_largeSamples_withinBucketError)
+{
+	LatencyHistogram histogram;
+
+	for (UInt32 i = 0; i < 99; ++i) {
+		histogram.record(12345);
+	}
+	histogram.record(3000000);
+
+	UInt32 median = histogram.getPercentile(50.0);
+	EXPECT_LE(12345, median);
+	EXPECT_GE(12345 * 1.04, median);
+	EXPECT_EQ(median, histogram.getPercentile(99.0));
+	EXPECT_EQ(3000000, histogram.getPercentile(99.9));
+}
+
+TEST(LatencyHistogramTests, record_largestValue_counted)
+{
+	LatencyHistogram histogram;
+
+	histogram.record(0xffffffff);
+
+	EXPECT_EQ(1, histogram.getCount());
+	EXPECT_EQ(0xffffffff, histogram.getPercentile(50.0));
+}
+
+TEST(LatencyHistogramTests, reset_afterSamples_empty)
+{
+	LatencyHistogram histogram;
+	histogram.record(1000);
+
+	histogram.reset();
+
+	EXPECT_EQ(0, histogram.getCount());
+	EXPECT_EQ(0, histogram.getMax());
+	EXPECT_EQ(0, histogram.getPercentile(100.0));
+}
@@ -0,0 +1,105 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mt/LockFreeQueue.h"
+#include "mt/Thread.h"
+#include "base/TMethodJob.h"
+#include "common/basic_types.h"
+#include "common/stdvector.h"
+
+#include "test/global/gtest.h"
+
+#define PRODUCERS 4
+#define ITEMS_PER_PRODUCER 100000
+
+class LockFreeQueueTests : public ::testing::Test {
+public:
+	void
+	produce(void* vproducer)
+	{
+		// producer in the top bits, sequence in the rest
+		const UInt32 producer = static_cast<UInt32>(reinterpret_cast<size_t>(vproducer));
+		for (UInt32 i = 0; i < ITEMS_PER_PRODUCER; ++i) {
+			m_queue.push((producer << 24) | i);
+		}
+	}
+
+public:
+	LockFreeQueue<UInt32> m_queue;
+};
+
+TEST_F(LockFreeQueueTests, pop_empty_returnsFalse)
+{
+	UInt32 value = 1;
+
+	EXPECT_TRUE(m_queue.isEmpty());
+	EXPECT_FALSE(m_queue.pop(value));
+	EXPECT_EQ(1u, value);
+}
+
+TEST_F(LockFreeQueueTests, pop_afterPush_firstInFirstOut)
+{
+	m_queue.push(1);
+	m_queue.push(2);
+	m_queue.push(3);
+
+	UInt32 value;
+	EXPECT_FALSE(m_queue.isEmpty());
+	ASSERT_TRUE(m_queue.pop(value));
+	EXPECT_EQ(1u, value);
+	ASSERT_TRUE(m_queue.pop(value));
+	EXPECT_EQ(2u, value);
+	ASSERT_TRUE(m_queue.pop(value));
+	EXPECT_EQ(3u, value);
+	EXPECT_TRUE(m_queue.isEmpty());
+}
+
+TEST_F(LockFreeQueueTests, pop_concurrentProducers_eachInOrderNoneLost)
+{
+	std::vector<Thread*> threads;
+	for (size_t i = 0; i < PRODUCERS; ++i) {
+		threads.push_back(new Thread(new TMethodJob<LockFreeQueueTests>(
+							this, &LockFreeQueueTests::produce,
+							reinterpret_cast<void*>(i))));
+	}
+
+	// consume while the producers run
+	std::vector<UInt32> next(PRODUCERS, 0);
+	UInt32 count = 0;
+	bool ordered = true;
+	while (count < PRODUCERS * ITEMS_PER_PRODUCER) {
+		UInt32 value;
+		if (!m_queue.pop(value)) {
+			continue;
+		}
+		const UInt32 producer = value >> 24;
+		if (producer >= PRODUCERS) {
+			ADD_FAILURE() << "bad value " << value;
+			break;
+		}
+		ordered = ordered && ((value & 0xffffff) == next[producer]);
+		next[producer] = (value & 0xffffff) + 1;
+		++count;
+	}
+
+	for (size_t i = 0; i < threads.size(); ++i) {
+		threads[i]->wait();
+		delete threads[i];
+	}
+	EXPECT_TRUE(ordered);
+	EXPECT_TRUE(m_queue.isEmpty());
+}
@@ -0,0 +1,205 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "net/NameResolver.h"
+#include "test/global/TestEventQueue.h"
+#include "arch/Arch.h"
+#include "arch/XArch.h"
+#include "base/TMethodEventJob.h"
+#include "base/Log.h"
+
+#include "test/global/gtest.h"
+
+#define TEST_PORT 24800
+
+// how long the stub resolver takes to answer, in seconds
+#define LOOKUP_DELAY 0.3
+
+// a stub resolver standing in for a slow DNS server
+static void
+slowLookup(const String& hostname, std::vector<ArchNetAddress>& addresses)
+{
+	ARCH->sleep(LOOKUP_DELAY);
+	if (hostname == "unknown.example.com") {
+		throw XArchNetworkNameUnknown("not found");
+	}
+	addresses.push_back(ARCH->newAnyAddr(IArchNetwork::kINET));
+	addresses.push_back(ARCH->newAnyAddr(IArchNetwork::kINET6));
+}
+
+class NameResolverTests : public ::testing::Test {
+public:
+	NameResolverTests() :
+		m_result(NULL),
+		m_resolvedTime(0.0),
+		m_tickTime(0.0)
+	{
+		m_events.adoptHandler(m_events.forNameResolver().resolved(), this,
+							new TMethodEventJob<NameResolverTests>(this,
+								&NameResolverTests::handleResolved));
+	}
+
+	~NameResolverTests()
+	{
+		m_events.removeHandler(m_events.forNameResolver().resolved(), this);
+		delete m_result;
+	}
+
+	void
+	handleResolved(const Event& event, void*)
+	{
+		m_resolvedTime = ARCH->monotonicTime();
+		m_result = reinterpret_cast<NameResolver::Result*>(event.getData());
+		m_events.raiseQuitEvent();
+	}
+
+	void
+	handleTick(const Event&, void*)
+	{
+		m_tickTime = ARCH->monotonicTime();
+	}
+
+	void
+	handleQuit(const Event&, void*)
+	{
+		m_events.raiseQuitEvent();
+	}
+
+	void
+	resolve(NameResolver& resolver, const NetworkAddress& address)
+	{
+		resolver.resolve(address, this);
+		m_events.initQuitTimeout(5);
+		m_events.loop();
+		m_events.cleanupQuitTimeout();
+	}
+
+public:
+	TestEventQueue			m_events;
+	NameResolver::Result*	m_result;
+	double					m_resolvedTime;
+	double					m_tickTime;
+};
+
+TEST_F(NameResolverTests, resolve_slowLookup_eventLoopNotBlocked)
+{
+	NameResolver resolver(&m_events, 300.0, &slowLookup);
+	EventQueueTimer* timer = m_events.newOneShotTimer(0.01, NULL);
+	m_events.adoptHandler(Event::kTimer, timer,
+							new TMethodEventJob<NameResolverTests>(this,
+								&NameResolverTests::handleTick));
+	double start = ARCH->monotonicTime();
+
+	resolve(resolver, NetworkAddress("synergy.example.com", TEST_PORT));
+
+	m_events.removeHandler(Event::kTimer, timer);
+	m_events.deleteTimer(timer);
+	ASSERT_TRUE(m_result != NULL);
+	EXPECT_TRUE(m_result->m_error.empty());
+	ASSERT_EQ(2u, m_result->m_addresses.size());
+	EXPECT_EQ(TEST_PORT, m_result->m_addresses[0].getPort());
+	EXPECT_EQ(IArchNetwork::kINET6,
+		ARCH->getAddrFamily(m_result->m_addresses[1].getAddress()));
+	EXPECT_EQ("synergy.example.com", m_result->m_addresses[1].getHostname());
+
+	// the timer fired while the lookup was still running
+	EXPECT_LT(m_tickTime - start, LOOKUP_DELAY / 2);
+	EXPECT_GE(m_resolvedTime - start, LOOKUP_DELAY);
+}
+
+TEST_F(NameResolverTests, getCached_afterResolve_returnsAddresses)
+{
+	NameResolver resolver(&m_events, 300.0, &slowLookup);
+	NetworkAddress address("synergy.example.com", TEST_PORT);
+	NameResolver::AddressList addresses;
+	EXPECT_FALSE(resolver.getCached(address, addresses));
+
+	resolve(resolver, address);
+
+	EXPECT_TRUE(resolver.getCached(address, addresses));
+	EXPECT_EQ(2u, addresses.size());
+	EXPECT_FALSE(resolver.getCached(
+		NetworkAddress("synergy.example.com", TEST_PORT + 1), addresses));
+}
+
+TEST_F(NameResolverTests, getCached_expired_returnsFalse)
+{
+	NameResolver resolver(&m_events, 0.1, &slowLookup);
+	NetworkAddress address("synergy.example.com", TEST_PORT);
+	resolve(resolver, address);
+
+	ARCH->sleep(0.2);
+
+	NameResolver::AddressList addresses;
+	EXPECT_FALSE(resolver.getCached(address, addresses));
+}
+
+TEST_F(NameResolverTests, forget_cached_returnsFalse)
+{
+	NameResolver resolver(&m_events, 300.0, &slowLookup);
+	NetworkAddress address("synergy.example.com", TEST_PORT);
+	resolve(resolver, address);
+
+	resolver.forget(address);
+
+	NameResolver::AddressList addresses;
+	EXPECT_FALSE(resolver.getCached(address, addresses));
+}
+
+TEST_F(NameResolverTests, resolve_unknownName_reportsErrorAndCachesNothing)
+{
+	NameResolver resolver(&m_events, 300.0, &slowLookup);
+	NetworkAddress address("unknown.example.com", TEST_PORT);
+
+	resolve(resolver, address);
+
+	ASSERT_TRUE(m_result != NULL);
+	EXPECT_TRUE(m_result->m_addresses.empty());
+	EXPECT_FALSE(m_result->m_error.empty());
+	NameResolver::AddressList addresses;
+	EXPECT_FALSE(resolver.getCached(address, addresses));
+}
+
+TEST_F(NameResolverTests, cancel_pendingLookup_noEvent)
+{
+	NameResolver resolver(&m_events, 300.0, &slowLookup);
+	resolver.resolve(NetworkAddress("synergy.example.com", TEST_PORT), this);
+	resolver.cancel(this);
+
+	// run until well after the lookup has finished
+	EventQueueTimer* timer = m_events.newOneShotTimer(2 * LOOKUP_DELAY, NULL);
+	m_events.adoptHandler(Event::kTimer, timer,
+							new TMethodEventJob<NameResolverTests>(this,
+								&NameResolverTests::handleQuit));
+	m_events.loop();
+	m_events.removeHandler(Event::kTimer, timer);
+	m_events.deleteTimer(timer);
+
+	EXPECT_TRUE(m_result == NULL);
+}
+
+TEST_F(NameResolverTests, destroy_pendingLookup_workerCleansUp)
+{
+	NameResolver* resolver = new NameResolver(&m_events, 300.0, &slowLookup);
+	resolver->resolve(NetworkAddress("synergy.example.com", TEST_PORT), this);
+	delete resolver;
+
+	// the orphaned lookup must neither crash nor report back
+	ARCH->sleep(2 * LOOKUP_DELAY);
+	EXPECT_TRUE(m_result == NULL);
+}
@@ -0,0 +1,161 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "server/Config.h"
+
+#include "test/global/gtest.h"
+
+#include <sstream>
+
+static const char* kBaseConfig =
+	"section: screens\n"
+	"	server:\n"
+	"	left:\n"
+	"		switchCorners = none\n"
+	"	right:\n"
+	"end\n"
+	"section: links\n"
+	"	server:\n"
+	"		left = left\n"
+	"		right = right\n"
+	"	left:\n"
+	"		right = server\n"
+	"	right:\n"
+	"		left = server\n"
+	"end\n"
+	"section: aliases\n"
+	"	left:\n"
+	"		left.example.com\n"
+	"end\n";
+
+static void
+readConfig(Config& config, const String& text)
+{
+	std::istringstream stream(text);
+	stream >> config;
+}
+
+static void
+diffConfig(const String& text, Config::Diff& diff)
+{
+	Config base(NULL);
+	Config changed(NULL);
+	readConfig(base, kBaseConfig);
+	readConfig(changed, text);
+	base.getDiff(changed, diff);
+}
+
+TEST(ConfigTests, getDiff_sameConfig_isEmpty)
+{
+	Config::Diff diff;
+	diffConfig(kBaseConfig, diff);
+
+	EXPECT_TRUE(diff.isEmpty());
+}
+
+TEST(ConfigTests, getDiff_screenOption_onlyThatScreenChanged)
+{
+	String text(kBaseConfig);
+	text.replace(text.find("switchCorners = none"), 20, "switchCorners = all");
+
+	Config::Diff diff;
+	diffConfig(text, diff);
+
+	EXPECT_FALSE(diff.isEmpty());
+	EXPECT_TRUE(diff.hasOptionsChanged("left"));
+	EXPECT_FALSE(diff.hasOptionsChanged("right"));
+	EXPECT_FALSE(diff.hasOptionsChanged("server"));
+	EXPECT_FALSE(diff.m_links);
+	EXPECT_FALSE(diff.m_aliases);
+	EXPECT_TRUE(diff.m_addedScreens.empty());
+	EXPECT_TRUE(diff.m_removedScreens.empty());
+}
+
+TEST(ConfigTests, getDiff_globalOption_everyScreenChanged)
+{
+	String text(kBaseConfig);
+	text += "section: options\n"
+			"	switchDelay = 250\n"
+			"end\n";
+
+	Config::Diff diff;
+	diffConfig(text, diff);
+
+	EXPECT_TRUE(diff.m_globalOptions);
+	EXPECT_TRUE(diff.hasOptionsChanged("right"));
+	EXPECT_TRUE(diff.m_changedOptions.empty());
+	EXPECT_FALSE(diff.m_links);
+}
+
+TEST(ConfigTests, getDiff_link_onlyLinksChanged)
+{
+	String text(kBaseConfig);
+	text.replace(text.find("		left = server"), 15, "		left = left");
+
+	Config::Diff diff;
+	diffConfig(text, diff);
+
+	EXPECT_TRUE(diff.m_links);
+	EXPECT_TRUE(diff.m_changedOptions.empty());
+	EXPECT_FALSE(diff.m_globalOptions);
+	EXPECT_FALSE(diff.m_aliases);
+}
+
+TEST(ConfigTests, getDiff_screenAdded_addedAndLinked)
+{
+	String text(kBaseConfig);
+	text.replace(text.find("	right:\n"), 8, "	right:\n	laptop:\n");
+	text.replace(text.find("		left = server"), 15, "		left = server\n		right = laptop");
+
+	Config::Diff diff;
+	diffConfig(text, diff);
+
+	ASSERT_EQ(1u, diff.m_addedScreens.size());
+	EXPECT_EQ("laptop", *diff.m_addedScreens.begin());
+	EXPECT_TRUE(diff.m_removedScreens.empty());
+	EXPECT_TRUE(diff.m_links);
+	EXPECT_FALSE(diff.m_aliases);
+}
+
+TEST(ConfigTests, getDiff_aliasRemoved_aliasesChanged)
+{
+	String text(kBaseConfig);
+	text.replace(text.find("		left.example.com\n"), 19, "");
+
+	Config::Diff diff;
+	diffConfig(text, diff);
+
+	EXPECT_TRUE(diff.m_aliases);
+	EXPECT_FALSE(diff.m_links);
+	EXPECT_TRUE(diff.m_changedOptions.empty());
+}
+
+TEST(ConfigTests, update_optionChanged_equalsNewConfig)
+{
+	String text(kBaseConfig);
+	text.replace(text.find("switchCorners = none"), 20, "switchCorners = all");
+	Config base(NULL);
+	Config changed(NULL);
+	readConfig(base, kBaseConfig);
+	readConfig(changed, text);
+
+	Config::Diff diff;
+	base.getDiff(changed, diff);
+	base.update(changed, diff);
+
+	EXPECT_TRUE(base == changed);
+}
@@ -51,6 +51,21 @@ TEST(ClientArgsParsingTests, parseClientArgs_yScrollArg_setYScroll)
 	EXPECT_EQ(1, clientArgs.m_yscroll);
 }
 
+TEST(ClientArgsParsingTests, parseClientArgs_headlessArg_setHeadless)
+{
+	NiceMock<MockArgParser> argParser;
+	ON_CALL(argParser, parseGenericArgs(_, _, _)).WillByDefault(Invoke(client_stubParseGenericArgs));
+	ON_CALL(argParser, checkUnexpectedArgs()).WillByDefault(Invoke(client_stubCheckUnexpectedArgs));
+	ClientArgs clientArgs;
+	const int argc = 3;
+	const char* kHeadlessCmd[argc] = { "stub", "--headless", "mock_address" };
+
+	argParser.parseClientArgs(clientArgs, argc, kHeadlessCmd);
+
+	EXPECT_TRUE(clientArgs.m_headless);
+	EXPECT_EQ("mock_address", clientArgs.m_synergyAddress);
+}
+
 TEST(ClientArgsParsingTests, parseClientArgs_addressArg_setSynergyAddress)
 {
 	NiceMock<MockArgParser> argParser;
@@ -0,0 +1,410 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/Clipboard.h"
+#include "base/Log.h"
+
+#include "test/global/gtest.h"
+
+// a 640x400 screenshot of a window of text on a desktop, the kind of
+// image that's copied most.  it's drawn by drawScreenshot() below.
+static const UInt8 s_screenshotPNG[] = {
+	0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d,
+	0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x02, 0x80, 0x00, 0x00, 0x01, 0x90,
+	0x08, 0x02, 0x00, 0x00, 0x00, 0xb1, 0x91, 0x46, 0x72, 0x00, 0x00, 0x0d,
+	0x41, 0x49, 0x44, 0x41, 0x54, 0x78, 0xda, 0xed, 0xdd, 0xd1, 0x8d, 0xdc,
+	0x30, 0xb2, 0x86, 0x51, 0x87, 0x32, 0x71, 0x38, 0x28, 0x67, 0xe5, 0xb0,
+	0x1c, 0x8b, 0xfc, 0x3c, 0x80, 0xc7, 0xa0, 0x28, 0x0e, 0x55, 0x7f, 0xf1,
+	0x1c, 0xd4, 0xc3, 0xe2, 0xa2, 0x5e, 0x76, 0xe5, 0xd6, 0x67, 0xba, 0x75,
+	0x5b, 0x3f, 0x7e, 0xfe, 0xfa, 0x6d, 0x8c, 0x31, 0xc6, 0x98, 0xcd, 0xf3,
+	0xc3, 0xff, 0x04, 0xc6, 0x18, 0x63, 0x8c, 0x00, 0x1b, 0x63, 0x8c, 0x31,
+	0x02, 0x6c, 0x8c, 0x31, 0xc6, 0x18, 0x01, 0x36, 0xc6, 0x18, 0x63, 0x04,
+	0xd8, 0x18, 0x63, 0x8c, 0x31, 0x02, 0x6c, 0x8c, 0x31, 0xc6, 0x08, 0xb0,
+	0x31, 0xc6, 0x18, 0x63, 0x04, 0xd8, 0x18, 0x63, 0x8c, 0x11, 0x60, 0x63,
+	0x8c, 0x31, 0xc6, 0x08, 0xb0, 0x31, 0xc6, 0x18, 0x23, 0xc0, 0xc6, 0x18,
+	0x63, 0x8c, 0x00, 0x1b, 0x63, 0x8c, 0x31, 0x46, 0x80, 0x8d, 0x31, 0xc6,
+	0x18, 0x01, 0x36, 0xc6, 0x18, 0x63, 0x8c, 0x00, 0x1b, 0x63, 0x8c, 0x31,
+	0x02, 0x6c, 0x8c, 0x31, 0xc6, 0x18, 0x01, 0x36, 0xc6, 0x18, 0x63, 0x04,
+	0xd8, 0x18, 0x63, 0x8c, 0x31, 0x02, 0x6c, 0x8c, 0x31, 0xc6, 0x08, 0xb0,
+	0x31, 0xc6, 0x18, 0x23, 0xc0, 0xc6, 0x18, 0x63, 0x8c, 0x11, 0x60, 0x63,
+	0x8c, 0x31, 0x46, 0x80, 0x8d, 0x31, 0xc6, 0x18, 0x53, 0x3e, 0xc0, 0x7f,
+	0x00, 0xa0, 0x30, 0x01, 0x06, 0x00, 0x01, 0x16, 0x60, 0x00, 0x04, 0x58,
+	0x80, 0x01, 0x40, 0x80, 0x05, 0x18, 0x00, 0x01, 0x16, 0x60, 0x00, 0x10,
+	0x60, 0x01, 0x06, 0x40, 0x80, 0x05, 0x18, 0x00, 0x04, 0x18, 0x00, 0x04,
+	0x58, 0x80, 0x01, 0x40, 0x80, 0x01, 0x40, 0x80, 0x05, 0x18, 0x00, 0x01,
+	0x16, 0x60, 0x00, 0x10, 0x60, 0x01, 0x06, 0x40, 0x80, 0x05, 0x18, 0x00,
+	0x04, 0x58, 0x80, 0x01, 0x10, 0x60, 0x01, 0x06, 0x00, 0x01, 0x06, 0x00,
+	0x01, 0x16, 0x60, 0x00, 0x10, 0x60, 0x00, 0x10, 0x60, 0x01, 0x06, 0x40,
+	0x80, 0x05, 0x18, 0x00, 0x04, 0x58, 0x80, 0x01, 0x10, 0x60, 0x01, 0x06,
+	0x00, 0x01, 0xfe, 0x6a, 0x2e, 0x00, 0x28, 0x4c, 0x80, 0x01, 0x40, 0x80,
+	0x05, 0x18, 0x00, 0x01, 0x16, 0x60, 0x00, 0x10, 0x60, 0x01, 0x06, 0x40,
+	0x80, 0x05, 0x18, 0x00, 0x04, 0x58, 0x80, 0x01, 0x10, 0x60, 0x01, 0x06,
+	0x00, 0x01, 0x06, 0x00, 0x01, 0x16, 0x60, 0x00, 0x10, 0x60, 0x00, 0x10,
+	0x60, 0x01, 0x06, 0x40, 0x80, 0x05, 0x18, 0x00, 0x04, 0x58, 0x80, 0x01,
+	0x10, 0x60, 0x01, 0x06, 0x00, 0x01, 0x16, 0x60, 0x00, 0x04, 0x38, 0x38,
+	0xc0, 0x1f, 0x1f, 0x1f, 0xff, 0xfc, 0x0f, 0x5f, 0xfd, 0xdf, 0x8f, 0x5d,
+	0x00, 0x40, 0x80, 0x17, 0x9f, 0x80, 0x15, 0x77, 0x70, 0x01, 0x00, 0x01,
+	0x5e, 0x1f, 0x60, 0xc5, 0x75, 0x08, 0x06, 0x10, 0xe0, 0x4d, 0x01, 0x56,
+	0x5c, 0x87, 0x60, 0x00, 0x01, 0x7e, 0x3f, 0xc0, 0x8a, 0xeb, 0x10, 0x0c,
+	0x20, 0xc0, 0xef, 0x3c, 0x84, 0xa5, 0xb8, 0x5f, 0x2d, 0x00, 0x20, 0xc0,
+	0x3b, 0x9e, 0x82, 0x56, 0x5c, 0x0d, 0x06, 0x10, 0xe0, 0xad, 0x0f, 0x61,
+	0x29, 0xae, 0x43, 0x30, 0x80, 0x00, 0xef, 0xf8, 0x0e, 0x58, 0x71, 0x1d,
+	0x82, 0x01, 0x04, 0xb8, 0xc4, 0x43, 0x58, 0x8a, 0xeb, 0x10, 0x0c, 0x20,
+	0xc0, 0x7e, 0x8a, 0x12, 0x00, 0x01, 0x16, 0x60, 0x00, 0x10, 0x60, 0x01,
+	0x06, 0x40, 0x80, 0x05, 0x18, 0x00, 0x04, 0x18, 0x00, 0x04, 0x58, 0x80,
+	0x01, 0x40, 0x80, 0x01, 0x40, 0x80, 0x05, 0x18, 0x00, 0x01, 0x16, 0x60,
+	0x00, 0x10, 0x60, 0x01, 0x06, 0x40, 0x80, 0x4f, 0x7a, 0x1b, 0x92, 0x5f,
+	0xa3, 0xb4, 0x30, 0xb8, 0x00, 0x20, 0xc0, 0x8f, 0xde, 0x86, 0x24, 0x24,
+	0x16, 0xe6, 0x16, 0x00, 0x04, 0x78, 0xcd, 0xeb, 0x08, 0x95, 0xc6, 0xc2,
+	0xe0, 0x02, 0x80, 0x00, 0xaf, 0x79, 0x1b, 0x92, 0xd2, 0x58, 0xb8, 0xb5,
+	0x00, 0x20, 0xc0, 0x8b, 0x5f, 0x47, 0xa8, 0x34, 0x16, 0x1c, 0x82, 0x01,
+	0x01, 0xde, 0xfa, 0x10, 0x96, 0xd2, 0x58, 0x70, 0x08, 0x06, 0x04, 0xf8,
+	0xcd, 0xa7, 0xa0, 0x95, 0xc6, 0x82, 0x43, 0x30, 0x20, 0xc0, 0x5b, 0x1f,
+	0xc2, 0x52, 0x1a, 0x0b, 0x83, 0x0b, 0x00, 0x02, 0xfc, 0xe8, 0x3b, 0x60,
+	0x21, 0xb1, 0x30, 0xb7, 0x00, 0x20, 0xc0, 0x8b, 0x1f, 0xc2, 0x52, 0x1a,
+	0x0b, 0x0e, 0xc1, 0x80, 0x00, 0xfb, 0x29, 0x4a, 0x00, 0x04, 0x58, 0x80,
+	0x01, 0x40, 0x80, 0x05, 0x18, 0x00, 0x01, 0x16, 0x60, 0x00, 0x10, 0x60,
+	0x00, 0x10, 0x60, 0x01, 0x06, 0x00, 0x01, 0x06, 0x00, 0x01, 0x16, 0x60,
+	0x00, 0x04, 0x58, 0x80, 0x01, 0x40, 0x80, 0x05, 0x18, 0x00, 0x01, 0x3e,
+	0xe9, 0x6d, 0x48, 0x7e, 0x64, 0xd1, 0xc2, 0xe0, 0x42, 0x1d, 0xae, 0x85,
+	0x1f, 0x0c, 0x47, 0x80, 0x23, 0xdf, 0x86, 0xe4, 0xc6, 0x61, 0xa1, 0xc1,
+	0x1d, 0xd6, 0xc5, 0xf2, 0x57, 0x34, 0x04, 0x38, 0xf8, 0x75, 0x84, 0x6e,
+	0x1c, 0x16, 0x06, 0x17, 0xea, 0x07, 0xd8, 0xc5, 0xf2, 0x57, 0x34, 0x04,
+	0x38, 0xe3, 0x6d, 0x48, 0x6e, 0x1c, 0x16, 0x6e, 0x2d, 0x44, 0x34, 0xd8,
+	0xc5, 0xf2, 0x57, 0x34, 0x04, 0x38, 0xe9, 0x75, 0x84, 0x6e, 0x1c, 0x16,
+	0x12, 0xef, 0xb0, 0x2e, 0x96, 0xbf, 0xa2, 0x21, 0xc0, 0xc1, 0x0f, 0x61,
+	0xb9, 0x71, 0x58, 0xc8, 0xbd, 0xc3, 0xba, 0x58, 0xfe, 0x8a, 0x86, 0x00,
+	0x77, 0x78, 0x0a, 0xda, 0x8d, 0xc3, 0x82, 0x43, 0xb0, 0x05, 0x87, 0x60,
+	0x04, 0x78, 0xeb, 0x43, 0x58, 0x6e, 0x1c, 0x16, 0x06, 0x17, 0xca, 0x06,
+	0xd8, 0xc5, 0xf2, 0x57, 0x34, 0x04, 0x38, 0xe3, 0x3b, 0x60, 0x37, 0x0e,
+	0x0b, 0x73, 0x0b, 0x95, 0x1b, 0xec, 0x62, 0xf9, 0x2b, 0x1a, 0x02, 0x1c,
+	0xf9, 0x10, 0x96, 0x1b, 0x87, 0x05, 0x87, 0x60, 0x0b, 0xfe, 0x1f, 0x90,
+	0x10, 0x60, 0x3f, 0x45, 0x09, 0x80, 0x00, 0x0b, 0x30, 0x00, 0x08, 0xb0,
+	0x00, 0x03, 0x20, 0xc0, 0x02, 0x0c, 0x00, 0x02, 0x0c, 0x00, 0x02, 0x2c,
+	0xc0, 0x00, 0x20, 0xc0, 0x00, 0x20, 0xc0, 0x02, 0x0c, 0x80, 0x00, 0x0b,
+	0x30, 0x00, 0x08, 0xb0, 0x00, 0x03, 0x20, 0xc0, 0x27, 0xbd, 0x0d, 0xc9,
+	0x8f, 0xea, 0x59, 0x18, 0x5c, 0xa8, 0xc3, 0xb5, 0xb0, 0xf0, 0x70, 0xa1,
+	0xe0, 0x9f, 0xe7, 0x7e, 0x1f, 0x5e, 0x01, 0xde, 0x7d, 0x99, 0x2d, 0x34,
+	0x5e, 0xa8, 0xdc, 0x60, 0x17, 0xcb, 0xc2, 0xad, 0x85, 0x88, 0xbf, 0x50,
+	0xa6, 0x7f, 0x78, 0x05, 0xd8, 0x21, 0xd8, 0x42, 0xcf, 0xd7, 0xcc, 0xb9,
+	0x58, 0x16, 0x1c, 0x82, 0x8b, 0xff, 0xd7, 0x14, 0x60, 0xc7, 0x05, 0x0b,
+	0x6d, 0xdf, 0xb5, 0xee, 0x62, 0x59, 0xb8, 0xbc, 0xda, 0xab, 0xf0, 0x87,
+	0x57, 0x80, 0x1d, 0x17, 0x2c, 0x38, 0x2e, 0x58, 0xb0, 0x70, 0xf4, 0xfb,
+	0xad, 0x05, 0xb8, 0xdc, 0x43, 0x58, 0x3e, 0x93, 0x16, 0x7c, 0x67, 0x66,
+	0xc1, 0x21, 0xd8, 0x21, 0x58, 0x80, 0xdf, 0x7c, 0x0a, 0xda, 0x67, 0xd2,
+	0x82, 0x43, 0xb0, 0x05, 0x87, 0xe0, 0xde, 0x5f, 0xa6, 0x08, 0x70, 0xb9,
+	0x87, 0xb0, 0x7c, 0x26, 0x2d, 0x38, 0x2e, 0x58, 0xf0, 0xa7, 0xba, 0xec,
+	0x1f, 0xe6, 0xf4, 0xff, 0x9a, 0x02, 0xec, 0xb8, 0x60, 0xc1, 0x77, 0x66,
+	0x16, 0x2c, 0x9c, 0x7b, 0x08, 0x16, 0xe0, 0xba, 0x0f, 0x61, 0xf9, 0x4c,
+	0x5a, 0x70, 0x08, 0xb6, 0xe0, 0xcb, 0x14, 0x87, 0x60, 0x01, 0xf6, 0x53,
+	0x94, 0x00, 0x34, 0x21, 0xc0, 0x00, 0x20, 0xc0, 0x02, 0x0c, 0x80, 0x00,
+	0x0b, 0x30, 0x00, 0x08, 0xb0, 0x00, 0x03, 0x20, 0xc0, 0x02, 0x0c, 0x00,
+	0x02, 0x2c, 0xc0, 0x00, 0x08, 0xb0, 0x00, 0x03, 0x80, 0x00, 0x03, 0x80,
+	0x00, 0x0b, 0x30, 0x00, 0x08, 0xf0, 0x27, 0x7e, 0x8e, 0xce, 0xc2, 0xd5,
+	0xee, 0xd7, 0x28, 0x01, 0x01, 0x4e, 0x7a, 0x1b, 0x92, 0x90, 0x58, 0x98,
+	0x5b, 0x00, 0x10, 0xe0, 0x35, 0xaf, 0x23, 0x54, 0x1a, 0x0b, 0x83, 0x0b,
+	0x00, 0x02, 0xbc, 0xe6, 0x6d, 0x48, 0x4a, 0x63, 0xe1, 0xd6, 0x02, 0x80,
+	0x00, 0x2f, 0x7e, 0x1d, 0xa1, 0xd2, 0x58, 0x70, 0x08, 0x06, 0x04, 0x78,
+	0xeb, 0x43, 0x58, 0x4a, 0x63, 0xc1, 0x21, 0x18, 0x10, 0xe0, 0x37, 0x9f,
+	0x82, 0x56, 0x1a, 0x0b, 0x0e, 0xc1, 0x80, 0x00, 0x6f, 0x7d, 0x08, 0x4b,
+	0x69, 0x2c, 0x0c, 0x2e, 0x00, 0x08, 0xf0, 0xa3, 0xef, 0x80, 0x85, 0xc4,
+	0xc2, 0xdc, 0x02, 0x80, 0x00, 0x2f, 0x7e, 0x08, 0x4b, 0x69, 0x2c, 0x38,
+	0x04, 0x03, 0x02, 0xec, 0xa7, 0x28, 0x01, 0x10, 0x60, 0x01, 0x06, 0x00,
+	0x01, 0x16, 0x60, 0x00, 0x04, 0x58, 0x80, 0x01, 0x40, 0x80, 0x01, 0x40,
+	0x80, 0x05, 0x18, 0x00, 0x04, 0x18, 0x00, 0x04, 0x58, 0x80, 0x01, 0x10,
+	0x60, 0x01, 0x06, 0x00, 0x01, 0x16, 0x60, 0x00, 0x04, 0xf8, 0xa4, 0xb7,
+	0x21, 0xf9, 0x91, 0x45, 0x0b, 0x83, 0x0b, 0x75, 0xb8, 0x16, 0x5e, 0x8a,
+	0x85, 0x00, 0x47, 0xbe, 0x0d, 0xc9, 0x9d, 0xc5, 0xc2, 0xdc, 0x42, 0xe5,
+	0x06, 0xbb, 0x58, 0x7e, 0x0f, 0x1c, 0x01, 0x4e, 0x7a, 0x1d, 0xa1, 0x3b,
+	0x8b, 0x85, 0xdc, 0x43, 0x8f, 0x8b, 0xe5, 0xa5, 0x58, 0x08, 0x70, 0xe4,
+	0xdb, 0x90, 0xdc, 0x59, 0x2c, 0xdc, 0x5a, 0x88, 0x68, 0xb0, 0x8b, 0xe5,
+	0x10, 0x8c, 0x00, 0x27, 0xbd, 0x8e, 0xd0, 0x9d, 0xc5, 0x42, 0xe2, 0x21,
+	0xd8, 0xc5, 0x72, 0x08, 0x46, 0x80, 0x83, 0x1f, 0xc2, 0x72, 0x67, 0xb1,
+	0x90, 0x7b, 0x08, 0x76, 0xb1, 0x1c, 0x82, 0x11, 0xe0, 0x0e, 0x4f, 0x41,
+	0xbb, 0xb3, 0x58, 0x70, 0x08, 0xb6, 0xe0, 0x10, 0x8c, 0x00, 0x6f, 0x7d,
+	0x08, 0xcb, 0x9d, 0xc5, 0x42, 0xee, 0xa1, 0xc7, 0xc5, 0x3a, 0xfc, 0x6f,
+	0x60, 0x08, 0x70, 0xd8, 0x77, 0xc0, 0xee, 0x2c, 0x16, 0x3a, 0x1d, 0x7a,
+	0x5c, 0xac, 0x93, 0xbf, 0x86, 0x40, 0x80, 0xe3, 0x1f, 0xc2, 0x72, 0x67,
+	0xb1, 0xe0, 0x10, 0x6c, 0xc1, 0x21, 0x18, 0x01, 0xf6, 0x53, 0x94, 0x00,
+	0x08, 0xb0, 0x00, 0x03, 0x80, 0x00, 0x0b, 0x30, 0x00, 0x02, 0x2c, 0xc0,
+	0x00, 0x20, 0xc0, 0x00, 0x20, 0xc0, 0x02, 0x0c, 0x00, 0x02, 0x0c, 0x00,
+	0x02, 0x2c, 0xc0, 0x00, 0x08, 0xb0, 0x00, 0x03, 0x80, 0x00, 0x0b, 0x30,
+	0x00, 0x02, 0x7c, 0xd2, 0xdb, 0x90, 0xfc, 0xea, 0x9e, 0x85, 0xc1, 0x85,
+	0x3a, 0x5c, 0x0b, 0x0b, 0x0f, 0x17, 0x0a, 0xfe, 0x79, 0xee, 0xf7, 0x8e,
+	0x48, 0x01, 0x5e, 0x7c, 0x99, 0x2d, 0x9c, 0xbc, 0x50, 0xb9, 0xc1, 0x2e,
+	0x96, 0x85, 0x5b, 0x0b, 0x11, 0x7f, 0xa1, 0x4c, 0x7f, 0x5d, 0x8a, 0x00,
+	0x3b, 0x04, 0x5b, 0xe8, 0xf9, 0x13, 0xfc, 0x2e, 0x96, 0x05, 0x87, 0xe0,
+	0xe2, 0x1f, 0x52, 0x01, 0x76, 0x5c, 0xb0, 0xd0, 0xf6, 0x3d, 0x74, 0x2e,
+	0x96, 0x85, 0xcb, 0xab, 0xbd, 0x04, 0x38, 0xf7, 0x75, 0x84, 0x3e, 0x93,
+	0x16, 0xce, 0x3c, 0x2e, 0x58, 0xf0, 0x65, 0x8a, 0x43, 0xb0, 0x00, 0xbf,
+	0xf6, 0x10, 0x96, 0xcf, 0xa4, 0x85, 0x93, 0xbf, 0x33, 0xb3, 0xe0, 0x10,
+	0xec, 0x10, 0x2c, 0xc0, 0xef, 0x3f, 0x05, 0xed, 0x33, 0x69, 0xc1, 0x21,
+	0xd8, 0x82, 0x43, 0x70, 0xf4, 0x97, 0x29, 0x02, 0x9c, 0xf7, 0x10, 0x96,
+	0xcf, 0xa4, 0x85, 0x93, 0x8f, 0x0b, 0x16, 0xfc, 0xa9, 0x2e, 0xfe, 0x87,
+	0xf9, 0x0a, 0x7f, 0x4a, 0x43, 0x80, 0x1d, 0x17, 0x2c, 0xf8, 0xce, 0xcc,
+	0x82, 0x05, 0x87, 0x60, 0x01, 0xae, 0xf7, 0x10, 0x96, 0xcf, 0xa4, 0x05,
+	0x87, 0x60, 0x0b, 0xbe, 0x4c, 0x71, 0x08, 0x16, 0x60, 0x3f, 0x45, 0x09,
+	0x40, 0x13, 0x02, 0x0c, 0x00, 0x02, 0x2c, 0xc0, 0x00, 0x08, 0xb0, 0x00,
+	0x03, 0x80, 0x00, 0x0b, 0x30, 0x00, 0x02, 0x2c, 0xc0, 0x00, 0x20, 0xc0,
+	0x02, 0x0c, 0x80, 0x00, 0x0b, 0x30, 0x00, 0x08, 0x30, 0x00, 0x08, 0xb0,
+	0x00, 0x03, 0x80, 0x00, 0x7f, 0xe2, 0xe7, 0xe8, 0x2c, 0x5c, 0xed, 0x7e,
+	0x8d, 0x12, 0x10, 0xe0, 0xa4, 0xb7, 0x21, 0x09, 0x89, 0x85, 0xb9, 0x05,
+	0x00, 0x01, 0x5e, 0xf3, 0x3a, 0x42, 0xa5, 0xb1, 0x30, 0xb8, 0x00, 0x20,
+	0xc0, 0x6b, 0xde, 0x86, 0xa4, 0x34, 0x16, 0x6e, 0x2d, 0x00, 0x08, 0xf0,
+	0xe2, 0xd7, 0x11, 0x2a, 0x8d, 0x05, 0x87, 0x60, 0x40, 0x80, 0xb7, 0x3e,
+	0x84, 0xa5, 0x34, 0x16, 0x1c, 0x82, 0x01, 0x01, 0x7e, 0xf3, 0x29, 0x68,
+	0xa5, 0xb1, 0xe0, 0x10, 0x0c, 0x08, 0xf0, 0xd6, 0x87, 0xb0, 0x94, 0xc6,
+	0xc2, 0xe0, 0x02, 0x80, 0x00, 0x3f, 0xfa, 0x0e, 0x58, 0x48, 0x2c, 0xcc,
+	0x2d, 0x00, 0x08, 0xf0, 0xe2, 0x87, 0xb0, 0x94, 0xc6, 0x82, 0x43, 0x30,
+	0x20, 0xc0, 0x7e, 0x8a, 0x12, 0x00, 0x01, 0x16, 0x60, 0x00, 0x10, 0x60,
+	0x01, 0x06, 0x40, 0x80, 0x05, 0x18, 0x00, 0x04, 0x18, 0x00, 0x04, 0x58,
+	0x80, 0x01, 0x40, 0x80, 0x01, 0x40, 0x80, 0x05, 0x18, 0x00, 0x01, 0x16,
+	0x60, 0x00, 0x10, 0x60, 0x01, 0x06, 0x40, 0x80, 0x4f, 0x7a, 0x1b, 0x92,
+	0x1f, 0x59, 0xb4, 0x30, 0xb8, 0x50, 0x87, 0x6b, 0xe1, 0x9d, 0x57, 0x08,
+	0x70, 0xe4, 0xdb, 0x90, 0xdc, 0x7a, 0x2c, 0xcc, 0x2d, 0x54, 0x6e, 0xb0,
+	0x8b, 0xe5, 0xc5, 0xcf, 0x08, 0x70, 0xd2, 0xeb, 0x08, 0xdd, 0x7a, 0x2c,
+	0xe4, 0x9e, 0x8a, 0x5c, 0x2c, 0x87, 0x60, 0x04, 0x38, 0xf2, 0x6d, 0x48,
+	0x6e, 0x3d, 0x16, 0x1a, 0x9c, 0x8a, 0x5c, 0x2c, 0x87, 0x60, 0x04, 0x38,
+	0xf8, 0x75, 0x84, 0x6e, 0x3d, 0x16, 0x12, 0x4f, 0x45, 0x2e, 0x96, 0x43,
+	0x30, 0x02, 0x1c, 0xfc, 0x10, 0x96, 0x5b, 0x8f, 0x85, 0xdc, 0x53, 0x91,
+	0x8b, 0xf5, 0x7d, 0x0b, 0x20, 0xc0, 0xfb, 0x9e, 0x82, 0x76, 0xeb, 0xb1,
+	0xe0, 0x10, 0x6c, 0x41, 0x80, 0x11, 0xe0, 0xad, 0x0f, 0x61, 0xb9, 0xf5,
+	0x58, 0xc8, 0x3d, 0x15, 0xb9, 0x58, 0x0e, 0xc1, 0x08, 0x70, 0xd2, 0x77,
+	0xc0, 0xee, 0x2c, 0x16, 0x3a, 0x9d, 0x8a, 0x5c, 0x2c, 0x87, 0x60, 0x04,
+	0x38, 0xf8, 0x21, 0x2c, 0xb7, 0x1e, 0x0b, 0x0e, 0xc1, 0x16, 0x1c, 0x82,
+	0x11, 0x60, 0x3f, 0x45, 0x09, 0x80, 0x00, 0x0b, 0x30, 0x00, 0x08, 0xb0,
+	0x00, 0x03, 0x20, 0xc0, 0x02, 0x0c, 0x00, 0x02, 0x0c, 0x00, 0x02, 0x2c,
+	0xc0, 0x00, 0x20, 0xc0, 0x00, 0x20, 0xc0, 0x02, 0x0c, 0x80, 0x00, 0x0b,
+	0x30, 0x00, 0x08, 0xb0, 0x00, 0x03, 0x20, 0xc0, 0x27, 0xbd, 0x0d, 0xc9,
+	0xaf, 0xee, 0x59, 0x18, 0x5c, 0xa8, 0xc3, 0xb5, 0xb0, 0xf0, 0x70, 0xa1,
+	0xe0, 0x9f, 0xe7, 0xac, 0x57, 0x82, 0x0a, 0xf0, 0x77, 0x5d, 0x66, 0x0b,
+	0x16, 0xfe, 0xb9, 0x50, 0xb9, 0xc1, 0x2e, 0x96, 0x85, 0xdc, 0x98, 0x85,
+	0xfe, 0xbd, 0x41, 0x80, 0x1d, 0x82, 0x2d, 0x1c, 0x77, 0x5c, 0x70, 0x08,
+	0xb6, 0xe0, 0x10, 0x2c, 0xc0, 0xc1, 0x6f, 0x43, 0xf2, 0x99, 0xb4, 0xd0,
+	0xe0, 0x63, 0xef, 0x62, 0x59, 0xb8, 0xce, 0x7b, 0xb5, 0x97, 0x00, 0xf7,
+	0x79, 0x1d, 0xa1, 0xcf, 0xa4, 0x85, 0xc6, 0xc7, 0x05, 0x0b, 0x16, 0xea,
+	0x7f, 0x99, 0x32, 0xfe, 0xa7, 0x5a, 0x80, 0xfb, 0x3c, 0x84, 0xe5, 0x33,
+	0x69, 0xe1, 0x84, 0xef, 0xcc, 0x2c, 0x58, 0x68, 0x73, 0x08, 0x16, 0xe0,
+	0x86, 0x4f, 0x41, 0xfb, 0x4c, 0x5a, 0x70, 0x08, 0xb6, 0xe0, 0x10, 0x1c,
+	0xf1, 0x65, 0x8a, 0x00, 0xf7, 0x79, 0x08, 0xcb, 0x67, 0xd2, 0xc2, 0x09,
+	0xdf, 0x99, 0x59, 0xb0, 0x10, 0xfa, 0x2f, 0x3a, 0xe9, 0x87, 0x60, 0x01,
+	0x76, 0x5c, 0xb0, 0x70, 0xee, 0x77, 0x66, 0x16, 0x2c, 0x38, 0x04, 0x0b,
+	0x70, 0xdd, 0x87, 0xb0, 0x7c, 0x26, 0x2d, 0x38, 0x04, 0x5b, 0xf0, 0x65,
+	0x8a, 0x43, 0xb0, 0x00, 0xfb, 0x29, 0x4a, 0x00, 0x9a, 0x10, 0x60, 0x00,
+	0x10, 0x60, 0x01, 0x06, 0x40, 0x80, 0x05, 0x18, 0x00, 0x04, 0x58, 0x80,
+	0x01, 0x10, 0x60, 0x01, 0x06, 0x00, 0x01, 0x16, 0x60, 0x00, 0x04, 0x58,
+	0x80, 0x01, 0x40, 0x80, 0x01, 0x40, 0x80, 0x05, 0x18, 0x00, 0x04, 0xf8,
+	0x13, 0x3f, 0x47, 0x67, 0xe1, 0x6a, 0xf7, 0x6b, 0x94, 0x80, 0x00, 0x27,
+	0xbd, 0x0d, 0x49, 0x48, 0x2c, 0xcc, 0x2d, 0x00, 0x08, 0xf0, 0x9a, 0xd7,
+	0x11, 0x2a, 0x8d, 0x85, 0xc1, 0x05, 0x00, 0x01, 0x5e, 0xf3, 0x36, 0x24,
+	0xa5, 0xb1, 0x70, 0x6b, 0x01, 0x40, 0x80, 0x17, 0xbf, 0x8e, 0x50, 0x69,
+	0x2c, 0x38, 0x04, 0x03, 0x02, 0xbc, 0xf5, 0x21, 0x2c, 0xa5, 0xb1, 0xe0,
+	0x10, 0x0c, 0x08, 0xf0, 0x9b, 0x4f, 0x41, 0x2b, 0x8d, 0x05, 0x87, 0x60,
+	0x40, 0x80, 0xb7, 0x3e, 0x84, 0xa5, 0x34, 0x16, 0x06, 0x17, 0x00, 0x04,
+	0xf8, 0xd1, 0x77, 0xc0, 0x42, 0x62, 0x61, 0x6e, 0x01, 0x40, 0x80, 0x17,
+	0x3f, 0x84, 0xa5, 0x34, 0x16, 0x1c, 0x82, 0x01, 0x01, 0xf6, 0x53, 0x94,
+	0x00, 0x08, 0xb0, 0x00, 0x03, 0x80, 0x00, 0x0b, 0x30, 0x00, 0x02, 0x2c,
+	0xc0, 0x00, 0x20, 0xc0, 0x00, 0x20, 0xc0, 0x02, 0x0c, 0x00, 0x02, 0x0c,
+	0x00, 0x02, 0x2c, 0xc0, 0x00, 0x08, 0xb0, 0x00, 0x03, 0x80, 0x00, 0x0b,
+	0x30, 0x00, 0x02, 0x7c, 0xd2, 0xdb, 0x90, 0xfc, 0xc8, 0xa2, 0x85, 0xc1,
+	0x85, 0x3a, 0x5c, 0x0b, 0xbf, 0x2d, 0x8a, 0x00, 0x47, 0xbe, 0x0d, 0xc9,
+	0xad, 0xc7, 0xc2, 0xdc, 0x42, 0xe5, 0x06, 0xbb, 0x58, 0x5e, 0xb0, 0x81,
+	0x00, 0x27, 0xbd, 0x8e, 0xd0, 0xbd, 0xc9, 0xc2, 0xe0, 0x42, 0xfd, 0x00,
+	0xbb, 0x58, 0x0e, 0xc1, 0x08, 0x70, 0xc6, 0xdb, 0x90, 0xdc, 0x7a, 0x2c,
+	0xdc, 0x5a, 0x88, 0x68, 0xb0, 0x8b, 0xe5, 0x10, 0x8c, 0x00, 0x27, 0xbd,
+	0x8e, 0xd0, 0xbd, 0xc9, 0x42, 0xe2, 0x21, 0xd8, 0xc5, 0xea, 0xf7, 0x4f,
+	0x1a, 0x08, 0xf0, 0x41, 0x0f, 0x61, 0xb9, 0x37, 0x59, 0xc8, 0x3d, 0x04,
+	0xbb, 0x58, 0x2d, 0xff, 0x49, 0x03, 0x01, 0x3e, 0xee, 0x29, 0x68, 0xf7,
+	0x26, 0x0b, 0x0e, 0xc1, 0xae, 0x26, 0x08, 0xf0, 0xd6, 0x87, 0xb0, 0xdc,
+	0x9b, 0x2c, 0x0c, 0x2e, 0x94, 0x0d, 0xb0, 0x8b, 0xe5, 0x10, 0x8c, 0x00,
+	0x67, 0x7c, 0x07, 0xec, 0xd6, 0x63, 0x61, 0x6e, 0xa1, 0x72, 0x83, 0x5d,
+	0x2c, 0x87, 0x60, 0x04, 0x38, 0xf2, 0x21, 0x2c, 0xf7, 0x26, 0x0b, 0x0e,
+	0xc1, 0xae, 0x26, 0x08, 0xb0, 0x9f, 0xa2, 0x04, 0x40, 0x80, 0x05, 0x18,
+	0x00, 0x04, 0x58, 0x80, 0x01, 0x10, 0x60, 0x01, 0x06, 0x00, 0x01, 0x06,
+	0x00, 0x01, 0x16, 0x60, 0x00, 0x10, 0x60, 0x00, 0x10, 0x60, 0x01, 0x06,
+	0x40, 0x80, 0x05, 0x18, 0x00, 0x04, 0x58, 0x80, 0x01, 0x10, 0xe0, 0x93,
+	0xde, 0x86, 0xe4, 0x67, 0xf9, 0x2c, 0x0c, 0x2e, 0xd4, 0xe1, 0x5a, 0x58,
+	0x78, 0xb8, 0x50, 0xf0, 0xcf, 0x73, 0xbf, 0x1f, 0x0a, 0x15, 0xe0, 0xff,
+	0x5d, 0x66, 0x9f, 0x49, 0x0b, 0x57, 0xec, 0x2b, 0x19, 0x5c, 0x2c, 0x0b,
+	0x57, 0xdf, 0xf7, 0x5b, 0x0b, 0x70, 0xff, 0xd7, 0x11, 0xfa, 0x4c, 0x5a,
+	0x48, 0x3c, 0x2e, 0x38, 0x04, 0x5b, 0x70, 0x08, 0x16, 0xe0, 0xe0, 0xb7,
+	0x21, 0xf9, 0x4c, 0x5a, 0xc8, 0x3d, 0x2e, 0xf8, 0x53, 0x6d, 0xe1, 0xea,
+	0xfb, 0x6a, 0x2f, 0x01, 0x3e, 0xe8, 0x75, 0x84, 0x3e, 0x93, 0x16, 0x1a,
+	0x1c, 0x17, 0x5c, 0x2c, 0x0b, 0x57, 0x97, 0xf7, 0x5b, 0x0b, 0xf0, 0x11,
+	0x0f, 0x61, 0xf9, 0x4c, 0x5a, 0xe8, 0xf4, 0x9d, 0x99, 0x8b, 0x65, 0xc1,
+	0x21, 0x58, 0x80, 0xf3, 0x9e, 0x82, 0xf6, 0x99, 0xb4, 0xe0, 0x10, 0x6c,
+	0xc1, 0x21, 0xb8, 0xd4, 0x5f, 0x28, 0x05, 0xb8, 0xff, 0x43, 0x58, 0x3e,
+	0x93, 0x16, 0x1a, 0x1c, 0x17, 0x5c, 0x2c, 0x0b, 0xe9, 0x7f, 0xaa, 0x05,
+	0xf8, 0x88, 0xef, 0x80, 0x7d, 0xe4, 0x2c, 0xf4, 0xfb, 0xce, 0xcc, 0xc5,
+	0xb2, 0xd0, 0xe9, 0x10, 0x2c, 0xc0, 0x07, 0x3d, 0x84, 0xe5, 0x33, 0x69,
+	0xc1, 0x21, 0xd8, 0x82, 0x2f, 0x53, 0x04, 0x58, 0x80, 0xfd, 0x14, 0x25,
+	0x00, 0x02, 0x2c, 0xc0, 0x00, 0x20, 0xc0, 0x02, 0x0c, 0x80, 0x00, 0x0b,
+	0x30, 0x00, 0x08, 0x30, 0x00, 0x08, 0xb0, 0x00, 0x03, 0x80, 0x00, 0x03,
+	0x80, 0x00, 0x0b, 0x30, 0x00, 0x02, 0x2c, 0xc0, 0x00, 0x20, 0xc0, 0x02,
+	0x0c, 0x80, 0x00, 0x9f, 0xf4, 0x36, 0x24, 0xbf, 0x57, 0x67, 0x61, 0x70,
+	0x01, 0x40, 0x80, 0x1f, 0xbd, 0x0d, 0x49, 0x48, 0x2c, 0xcc, 0x2d, 0x00,
+	0x08, 0xf0, 0x9a, 0xd7, 0x11, 0x2a, 0x8d, 0x85, 0xc1, 0x05, 0x00, 0x01,
+	0x5e, 0xf3, 0x36, 0x24, 0xa5, 0xb1, 0x70, 0x6b, 0x01, 0x40, 0x80, 0x17,
+	0xbf, 0x8e, 0x50, 0x69, 0x2c, 0x38, 0x04, 0x03, 0x02, 0xbc, 0xf5, 0x21,
+	0x2c, 0xa5, 0xb1, 0xe0, 0x10, 0x0c, 0x08, 0xf0, 0x9b, 0x4f, 0x41, 0x2b,
+	0x8d, 0x05, 0x87, 0x60, 0x40, 0x80, 0xb7, 0x3e, 0x84, 0xa5, 0x34, 0x16,
+	0x06, 0x17, 0x00, 0x04, 0xf8, 0xd1, 0x77, 0xc0, 0x42, 0x62, 0x61, 0x6e,
+	0x01, 0x40, 0x80, 0x17, 0x3f, 0x84, 0xa5, 0x34, 0x16, 0x1c, 0x82, 0x01,
+	0x01, 0xf6, 0x53, 0x94, 0x00, 0x08, 0xb0, 0x00, 0x03, 0x80, 0x00, 0x0b,
+	0x30, 0x00, 0x02, 0x2c, 0xc0, 0x00, 0x20, 0xc0, 0x00, 0x20, 0xc0, 0x02,
+	0x0c, 0x00, 0x02, 0x0c, 0x00, 0x02, 0x2c, 0xc0, 0x00, 0x08, 0xb0, 0x00,
+	0x03, 0x80, 0x00, 0x0b, 0x30, 0x00, 0x02, 0x7c, 0xd2, 0xdb, 0x90, 0xfc,
+	0xc8, 0xa2, 0x85, 0xc1, 0x85, 0x3a, 0x5c, 0x0b, 0x2f, 0x91, 0x44, 0x80,
+	0x23, 0xdf, 0x86, 0xe4, 0xde, 0x64, 0x61, 0x6e, 0xa1, 0x72, 0x83, 0x5d,
+	0x2c, 0x2f, 0x91, 0x44, 0x80, 0x93, 0x5e, 0x47, 0xe8, 0xde, 0x64, 0x21,
+	0xf7, 0x26, 0xee, 0x62, 0x79, 0x7f, 0x06, 0x02, 0x1c, 0xf9, 0x36, 0x24,
+	0xf7, 0x26, 0x0b, 0x0d, 0xfe, 0x25, 0xd3, 0xc5, 0x0a, 0xfa, 0x17, 0x0b,
+	0x04, 0x58, 0x80, 0xdd, 0x9b, 0x2c, 0x74, 0x38, 0x04, 0xbb, 0x58, 0x0e,
+	0xc1, 0x08, 0x70, 0xf0, 0x43, 0x58, 0xee, 0x4d, 0x16, 0x72, 0x0f, 0xc1,
+	0x2e, 0x96, 0x43, 0x30, 0x02, 0xdc, 0xe1, 0x29, 0x68, 0x37, 0x2f, 0x0b,
+	0x0e, 0xc1, 0x0e, 0xc1, 0x20, 0xc0, 0x5b, 0x1f, 0xc2, 0x72, 0x6f, 0xb2,
+	0x90, 0x7b, 0x13, 0x77, 0xb1, 0x1c, 0x82, 0x11, 0xe0, 0xa4, 0xef, 0x80,
+	0xdd, 0x9b, 0x2c, 0x74, 0xba, 0x89, 0xbb, 0x58, 0x41, 0xff, 0x62, 0x81,
+	0x00, 0x7b, 0x08, 0xcb, 0xbd, 0xc9, 0x82, 0x43, 0xb0, 0xaf, 0xed, 0x41,
+	0x80, 0xfd, 0x14, 0x25, 0x00, 0x02, 0x2c, 0xc0, 0x00, 0x20, 0xc0, 0x02,
+	0x0c, 0x80, 0x00, 0x0b, 0x30, 0x00, 0x08, 0xb0, 0x00, 0x03, 0x20, 0xc0,
+	0x02, 0x0c, 0x00, 0x02, 0x0c, 0x00, 0x02, 0x2c, 0xc0, 0x00, 0x08, 0xb0,
+	0x00, 0x03, 0x80, 0x00, 0x0b, 0x30, 0x00, 0x02, 0x7c, 0xf2, 0xdb, 0x90,
+	0xfc, 0x6e, 0x9f, 0x85, 0xc1, 0x85, 0x3a, 0x5c, 0x0b, 0x0b, 0x0f, 0x17,
+	0x10, 0xe0, 0x77, 0xde, 0x86, 0xe4, 0x33, 0x69, 0x61, 0x6e, 0xa1, 0x72,
+	0x83, 0x5d, 0x2c, 0x0b, 0xb7, 0x16, 0x10, 0xe0, 0x97, 0x5f, 0x47, 0xe8,
+	0x33, 0x69, 0x21, 0xf7, 0xb8, 0xe0, 0x62, 0x59, 0x70, 0x08, 0x16, 0xe0,
+	0xc8, 0xb7, 0x21, 0xf9, 0x4c, 0x5a, 0x68, 0x70, 0x5c, 0x70, 0xb1, 0x2c,
+	0x5c, 0x5d, 0x5e, 0xed, 0x25, 0xc0, 0x27, 0xbe, 0x8e, 0xd0, 0x67, 0xd2,
+	0x42, 0xe2, 0x71, 0xc1, 0xc5, 0xb2, 0x70, 0xb5, 0x7b, 0xbf, 0xb5, 0x00,
+	0x1f, 0xf4, 0x10, 0x96, 0xcf, 0xa4, 0x85, 0xdc, 0x43, 0xb0, 0x8b, 0x65,
+	0xc1, 0x21, 0x58, 0x80, 0x3b, 0x3c, 0x05, 0xed, 0x33, 0x69, 0xc1, 0x21,
+	0xd8, 0x82, 0x43, 0x30, 0x02, 0xbc, 0xf5, 0x21, 0x2c, 0x9f, 0x49, 0x0b,
+	0xb9, 0xc7, 0x05, 0x17, 0xcb, 0x82, 0x43, 0xb0, 0x00, 0x27, 0x7d, 0x07,
+	0xec, 0x23, 0x67, 0xa1, 0xd3, 0x71, 0xc1, 0xc5, 0xb2, 0xe0, 0x10, 0x2c,
+	0xc0, 0xc1, 0x0f, 0x61, 0xf9, 0x4c, 0x5a, 0x70, 0x08, 0xb6, 0xe0, 0xcb,
+	0x14, 0x04, 0xd8, 0x4f, 0x51, 0x02, 0x20, 0xc0, 0x02, 0x0c, 0x00, 0x02,
+	0x2c, 0xc0, 0x00, 0x08, 0xb0, 0x00, 0x03, 0x80, 0x00, 0x03, 0x80, 0x00,
+	0x0b, 0x30, 0x00, 0xb4, 0x0d, 0xb0, 0x31, 0xc6, 0x18, 0x63, 0x04, 0xd8,
+	0x18, 0x63, 0x8c, 0x11, 0x60, 0x63, 0x8c, 0x31, 0x46, 0x80, 0x8d, 0x31,
+	0xc6, 0x18, 0x23, 0xc0, 0xc6, 0x18, 0x63, 0x8c, 0x00, 0x1b, 0x63, 0x8c,
+	0x31, 0x46, 0x80, 0x8d, 0x31, 0xc6, 0x18, 0x01, 0x36, 0xc6, 0x18, 0x63,
+	0x8c, 0x00, 0x1b, 0x63, 0x8c, 0x31, 0x02, 0x6c, 0x8c, 0x31, 0xc6, 0x18,
+	0x01, 0x36, 0xc6, 0x18, 0x63, 0x04, 0xd8, 0x18, 0x63, 0x8c, 0x11, 0x60,
+	0x63, 0x8c, 0x31, 0xc6, 0x08, 0xb0, 0x31, 0xc6, 0x18, 0x23, 0xc0, 0xc6,
+	0x18, 0x63, 0x8c, 0x11, 0x60, 0x63, 0x8c, 0x31, 0x46, 0x80, 0x8d, 0x31,
+	0xc6, 0x18, 0x23, 0xc0, 0xc6, 0x18, 0x63, 0x8c, 0x00, 0x1b, 0x63, 0x8c,
+	0x31, 0x46, 0x80, 0x8d, 0x31, 0xc6, 0x98, 0x42, 0xf3, 0x17, 0x19, 0x61,
+	0xb1, 0xc4, 0x45, 0xec, 0xe8, 0xb7, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45,
+	0x4e, 0x44, 0xae, 0x42, 0x60, 0x82,
+};
+
+static const SInt32 kScreenshotWidth  = 640;
+static const SInt32 kScreenshotHeight = 400;
+
+// get the blue, green and red of a pixel of the screenshot
+static void
+drawScreenshot(SInt32 x, SInt32 y, UInt8* bgr)
+{
+	UInt8 gray = 0xff;
+	if (x < 32 || x >= 600 || y < 24 || y >= 380) {
+		// desktop
+		bgr[0] = 0xa5;
+		bgr[1] = 0x6e;
+		bgr[2] = 0x3a;
+		return;
+	}
+	if (y < 48) {
+		// title bar
+		gray = 0xdd;
+	}
+	else if (y >= 64 && (y - 64) % 20 < 10) {
+		// lines of text with gaps between words
+		SInt32 line = (y - 64) / 20;
+		SInt32 row  = (y - 64) % 20;
+		if (x >= 48 && x - 48 < 100 + (line * 137) % 420 &&
+			((x - 48) / 48) % 5 != 4 &&
+			(x * 7 + row * 13) % 11 < 4) {
+			gray = 0x20;
+		}
+	}
+	bgr[0] = bgr[1] = bgr[2] = gray;
+}
+
+// the screenshot as kBitmap data:  a 24 bit bottom-up DIB
+static String
+getScreenshotBitmap()
+{
+	const SInt32 w = kScreenshotWidth;
+	const SInt32 h = kScreenshotHeight;
+	const UInt32 rowBytes = (3 * w + 3) & ~3;
+	String dib(40 + rowBytes * h, '\0');
+	UInt8* header = reinterpret_cast<UInt8*>(&dib[0]);
+	header[0]  = 40;
+	header[4]  = static_cast<UInt8>(w & 0xff);
+	header[5]  = static_cast<UInt8>(w >> 8);
+	header[8]  = static_cast<UInt8>(h & 0xff);
+	header[9]  = static_cast<UInt8>(h >> 8);
+	header[12] = 1;
+	header[14] = 24;
+	for (SInt32 y = 0; y < h; ++y) {
+		UInt8* row = header + 40 + rowBytes * (h - 1 - y);
+		for (SInt32 x = 0; x < w; ++x) {
+			drawScreenshot(x, y, row + 3 * x);
+		}
+	}
+	return dib;
+}
+
+static String
+marshallFormat(IClipboard::EFormat format, const String& data)
+{
+	Clipboard clipboard;
+	clipboard.open(0);
+	clipboard.empty();
+	clipboard.add(format, data);
+	clipboard.close();
+	return clipboard.marshall();
+}
+
+TEST(ClipboardPNGTests, marshall_screenshot_pngMuchSmallerThanBitmap)
+{
+	String png(reinterpret_cast<const char*>(s_screenshotPNG),
+							sizeof(s_screenshotPNG));
+	String bitmap = getScreenshotBitmap();
+
+	size_t pngBytes    = marshallFormat(IClipboard::kPNG, png).size();
+	size_t bitmapBytes = marshallFormat(IClipboard::kBitmap, bitmap).size();
+
+	LOG((CLOG_INFO "%dx%d screenshot on the wire: png %d bytes, bitmap %d bytes", kScreenshotWidth, kScreenshotHeight, (int)pngBytes, (int)bitmapBytes));
+	EXPECT_LT(pngBytes * 10, bitmapBytes);
+}
+
+TEST(ClipboardPNGTests, unmarshall_png_bytesUntouched)
+{
+	String png(reinterpret_cast<const char*>(s_screenshotPNG),
+							sizeof(s_screenshotPNG));
+	Clipboard clipboard;
+
+	clipboard.unmarshall(marshallFormat(IClipboard::kPNG, png), 0);
+
+	clipboard.open(0);
+	EXPECT_TRUE(clipboard.has(IClipboard::kPNG));
+	EXPECT_FALSE(clipboard.has(IClipboard::kBitmap));
+	EXPECT_TRUE(png == clipboard.get(IClipboard::kPNG));
+	clipboard.close();
+}
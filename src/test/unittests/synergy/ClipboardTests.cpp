@@ -402,3 +402,43 @@ TEST(ClipboardTests, copy_withSingleText_clipboardsAreEqual)
 	String actual = clipboard2.get(Clipboard::kText);
 	EXPECT_EQ("synergy rocks!", actual);
 }
+
+TEST(ClipboardTests, swap_withSingleText_dataExchanged)
+{
+	Clipboard clipboard1;
+	clipboard1.open(0);
+	clipboard1.add(Clipboard::kText, "synergy rocks!");
+	clipboard1.close();
+	Clipboard clipboard2;
+
+	clipboard2.swap(clipboard1);
+
+	clipboard1.open(0);
+	EXPECT_FALSE(clipboard1.has(Clipboard::kText));
+	clipboard1.close();
+	clipboard2.open(0);
+	String actual = clipboard2.get(Clipboard::kText);
+	EXPECT_EQ("synergy rocks!", actual);
+}
+
+TEST(ClipboardTests, getDataHash_emptyData_returnsOffsetBasis)
+{
+	UInt32 actual = Clipboard::getDataHash("");
+
+	EXPECT_EQ(0x811c9dc5u, actual);
+}
+
+TEST(ClipboardTests, getDataHash_knownData_returnsFnv1aHash)
+{
+	UInt32 actual = Clipboard::getDataHash("a");
+
+	EXPECT_EQ(0xe40c292cu, actual);
+}
+
+TEST(ClipboardTests, getDataHash_differentData_hashesDiffer)
+{
+	UInt32 hash1 = Clipboard::getDataHash("synergy rocks!");
+	UInt32 hash2 = Clipboard::getDataHash("synergy rocks?");
+
+	EXPECT_NE(hash1, hash2);
+}
@@ -0,0 +1,163 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/MotionBatch.h"
+#include "synergy/ProtocolUtil.h"
+#include "synergy/protocol_types.h"
+#include "base/Log.h"
+
+#include "test/global/gtest.h"
+
+// each message also costs the 4 byte packet length
+#define PACKET_HEADER_SIZE 4
+
+// the old encoding, one kMsgDMouseMove or kMsgDMouseRelMove per sample
+#define OLD_MOTION_PACKET_SIZE (PACKET_HEADER_SIZE + 4 + 2 + 2)
+
+static UInt32
+batchedBytesPerSecond(UInt32 rate, UInt32 samplesPerBatch)
+{
+	MotionBatch batch;
+	String data;
+	UInt32 bytes = 0;
+	for (UInt32 i = 0; i < rate; ++i) {
+		// a one pixel move each millisecond
+		batch.add(true, 1, 0, i);
+		if ((i + 1) % samplesPerBatch == 0) {
+			batch.encode(data);
+			bytes += PACKET_HEADER_SIZE + static_cast<UInt32>(data.size());
+		}
+	}
+	if (!batch.isEmpty()) {
+		batch.encode(data);
+		bytes += PACKET_HEADER_SIZE + static_cast<UInt32>(data.size());
+	}
+	return bytes;
+}
+
+TEST(MotionBatchTests, encode_absoluteMoves_decodedInOrder)
+{
+	MotionBatch encoder;
+	encoder.setPosition(100, 200);
+	encoder.add(false, 101, 200, 5000);
+	encoder.add(false, 90, 350, 5001);
+	encoder.add(false, 1920, -1080, 5009);
+	String data;
+	encoder.encode(data);
+
+	EXPECT_EQ(0, data.compare(0, 4, kMsgDMouseMoveBatch, 4));
+	EXPECT_EQ(3, static_cast<UInt8>(data[4]));
+	EXPECT_TRUE(encoder.isEmpty());
+
+	MotionBatch decoder;
+	decoder.setPosition(100, 200);
+	bool relative = true;
+	MotionBatch::Samples samples;
+	EXPECT_TRUE(decoder.decode(data[4], data.substr(5), relative, samples));
+
+	EXPECT_FALSE(relative);
+	ASSERT_EQ(3u, samples.size());
+	EXPECT_EQ(101, samples[0].m_x);
+	EXPECT_EQ(200, samples[0].m_y);
+	EXPECT_EQ(5000u, samples[0].m_time);
+	EXPECT_EQ(90, samples[1].m_x);
+	EXPECT_EQ(350, samples[1].m_y);
+	EXPECT_EQ(5001u, samples[1].m_time);
+	EXPECT_EQ(1920, samples[2].m_x);
+	EXPECT_EQ(-1080, samples[2].m_y);
+	EXPECT_EQ(5009u, samples[2].m_time);
+}
+
+TEST(MotionBatchTests, encode_relativeMoves_decodedAcrossBatches)
+{
+	MotionBatch encoder;
+	MotionBatch decoder;
+	String data;
+	bool relative = false;
+	MotionBatch::Samples samples;
+
+	encoder.add(true, -1, 1, 10);
+	encoder.add(true, 0, -64, 11);
+	encoder.encode(data);
+	EXPECT_TRUE(decoder.decode(data[4], data.substr(5), relative, samples));
+	EXPECT_TRUE(relative);
+	ASSERT_EQ(2u, samples.size());
+	EXPECT_EQ(-1, samples[0].m_x);
+	EXPECT_EQ(1, samples[0].m_y);
+	EXPECT_EQ(0, samples[1].m_x);
+	EXPECT_EQ(-64, samples[1].m_y);
+
+	encoder.add(true, 32767, -32768, 0xffffffffu);
+	encoder.encode(data);
+	EXPECT_TRUE(decoder.decode(data[4], data.substr(5), relative, samples));
+	ASSERT_EQ(1u, samples.size());
+	EXPECT_EQ(32767, samples[0].m_x);
+	EXPECT_EQ(-32768, samples[0].m_y);
+	EXPECT_EQ(0xffffffffu, samples[0].m_time);
+}
+
+TEST(MotionBatchTests, add_otherKindOfMove_rejected)
+{
+	MotionBatch batch;
+	EXPECT_TRUE(batch.add(false, 1, 1, 0));
+	EXPECT_FALSE(batch.add(true, 1, 1, 0));
+}
+
+TEST(MotionBatchTests, add_fullBatch_rejected)
+{
+	MotionBatch batch;
+	for (int i = 0; i < MotionBatch::kMaxSamples; ++i) {
+		EXPECT_TRUE(batch.add(true, 1, 1, i));
+	}
+	EXPECT_FALSE(batch.add(true, 1, 1, 0));
+
+	String data;
+	batch.encode(data);
+	EXPECT_TRUE(batch.add(true, 1, 1, 0));
+}
+
+TEST(MotionBatchTests, decode_truncated_returnsFalse)
+{
+	MotionBatch encoder;
+	encoder.add(true, 1000, 1000, 1);
+	String data;
+	encoder.encode(data);
+
+	MotionBatch decoder;
+	bool relative;
+	MotionBatch::Samples samples;
+	EXPECT_FALSE(decoder.decode(data[4], data.substr(5, data.size() - 6),
+							relative, samples));
+}
+
+TEST(MotionBatchTests, encode_1000HzMotion_fewerBytesThanOldEncoding)
+{
+	const UInt32 rate = 1000;
+	UInt32 oldBytes = rate * OLD_MOTION_PACKET_SIZE;
+	UInt32 single   = batchedBytesPerSecond(rate, 1);
+	UInt32 batch4   = batchedBytesPerSecond(rate, 4);
+	UInt32 batch16  = batchedBytesPerSecond(rate, 16);
+
+	LOG((CLOG_INFO "1000Hz motion bytes/sec: old=%d batch1=%d batch4=%d batch16=%d",
+		oldBytes, single, batch4, batch16));
+
+	// the first sample carries the full timestamp, after that a lone
+	// sample is no bigger than the old message.
+	EXPECT_LE(single, oldBytes + 4);
+	EXPECT_LT(batch4, oldBytes / 2);
+	EXPECT_LT(batch16, oldBytes / 3);
+}
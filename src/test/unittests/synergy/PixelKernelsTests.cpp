@@ -0,0 +1,275 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/PixelKernels.h"
+#include "arch/Arch.h"
+#include "base/Log.h"
+#include "common/stdvector.h"
+
+#include "test/global/gtest.h"
+
+#include <algorithm>
+#include <cstring>
+
+// the vector kernels handle this many pixels per step at most, so
+// checking up to a few times as many covers every tail length
+#define MAX_PIXELS 100
+
+// bytes past the end of the output that must not be touched
+#define GUARD_BYTES 64
+#define GUARD 0xa5
+
+typedef std::vector<UInt8> Buffer;
+
+class PixelKernelsTests : public ::testing::Test {
+protected:
+	virtual void
+	SetUp()
+	{
+		m_set = PixelKernels::getInstructionSet();
+	}
+
+	virtual void
+	TearDown()
+	{
+		PixelKernels::setInstructionSet(m_set);
+	}
+
+	static void
+	fill(Buffer& buffer, UInt32 seed)
+	{
+		// a simple LCG so runs are repeatable
+		for (size_t i = 0; i < buffer.size(); ++i) {
+			seed      = seed * 1103515245u + 12345u;
+			buffer[i] = static_cast<UInt8>(seed >> 16);
+		}
+	}
+
+	static bool
+	guardIntact(const Buffer& buffer, size_t end)
+	{
+		for (size_t i = end; i < buffer.size(); ++i) {
+			if (buffer[i] != GUARD) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static Buffer
+	bgrToBGRA(PixelKernels::EInstructionSet set, UInt32 pixels, UInt32 offset)
+	{
+		Buffer src(offset + 3 * pixels);
+		Buffer dst(offset + 4 * pixels + GUARD_BYTES, GUARD);
+		fill(src, pixels);
+		PixelKernels::setInstructionSet(set);
+		PixelKernels::bgrToBGRA(&dst[0] + offset, &src[0] + offset,
+								pixels, 0x80);
+		EXPECT_TRUE(guardIntact(dst, offset + 4 * pixels));
+		return dst;
+	}
+
+	static Buffer
+	bgraToBGR(PixelKernels::EInstructionSet set, UInt32 pixels, UInt32 offset)
+	{
+		Buffer src(offset + 4 * pixels);
+		Buffer dst(offset + 3 * pixels + GUARD_BYTES, GUARD);
+		fill(src, pixels);
+		PixelKernels::setInstructionSet(set);
+		PixelKernels::bgraToBGR(&dst[0] + offset, &src[0] + offset, pixels);
+		EXPECT_TRUE(guardIntact(dst, offset + 3 * pixels));
+		return dst;
+	}
+
+	static Buffer
+	fillAlpha(PixelKernels::EInstructionSet set, UInt32 pixels, UInt32 offset)
+	{
+		Buffer data(offset + 4 * pixels + GUARD_BYTES, GUARD);
+		Buffer pixelData(4 * pixels);
+		fill(pixelData, pixels);
+		std::copy(pixelData.begin(), pixelData.end(), data.begin() + offset);
+		PixelKernels::setInstructionSet(set);
+		PixelKernels::fillAlpha(&data[0] + offset, pixels, 0xff);
+		EXPECT_TRUE(guardIntact(data, offset + 4 * pixels));
+		return data;
+	}
+
+	static Buffer
+	flipRows(PixelKernels::EInstructionSet set, UInt32 rowBytes, UInt32 rows)
+	{
+		Buffer data(rowBytes * rows + GUARD_BYTES, GUARD);
+		Buffer pixelData(rowBytes * rows);
+		fill(pixelData, rowBytes + rows);
+		std::copy(pixelData.begin(), pixelData.end(), data.begin());
+		PixelKernels::setInstructionSet(set);
+		PixelKernels::flipRows(data.empty() ? NULL : &data[0], rowBytes, rows);
+		EXPECT_TRUE(guardIntact(data, rowBytes * rows));
+		return data;
+	}
+
+	PixelKernels::EInstructionSet m_set;
+};
+
+TEST_F(PixelKernelsTests, bgrToBGRA_scalar_expandsAndSetsAlpha)
+{
+	const UInt8 src[] = { 1, 2, 3, 4, 5, 6 };
+	UInt8 dst[8];
+	PixelKernels::setInstructionSet(PixelKernels::kScalar);
+
+	PixelKernels::bgrToBGRA(dst, src, 2, 0xff);
+
+	const UInt8 expected[] = { 1, 2, 3, 0xff, 4, 5, 6, 0xff };
+	EXPECT_EQ(0, memcmp(expected, dst, sizeof(expected)));
+}
+
+TEST_F(PixelKernelsTests, bgraToBGR_scalar_dropsAlpha)
+{
+	const UInt8 src[] = { 1, 2, 3, 0xff, 4, 5, 6, 0 };
+	UInt8 dst[6];
+	PixelKernels::setInstructionSet(PixelKernels::kScalar);
+
+	PixelKernels::bgraToBGR(dst, src, 2);
+
+	const UInt8 expected[] = { 1, 2, 3, 4, 5, 6 };
+	EXPECT_EQ(0, memcmp(expected, dst, sizeof(expected)));
+}
+
+TEST_F(PixelKernelsTests, flipRows_scalar_reversesRows)
+{
+	UInt8 data[] = { 1, 2, 3, 4, 5, 6 };
+	PixelKernels::setInstructionSet(PixelKernels::kScalar);
+
+	PixelKernels::flipRows(data, 2, 3);
+
+	const UInt8 expected[] = { 5, 6, 3, 4, 1, 2 };
+	EXPECT_EQ(0, memcmp(expected, data, sizeof(expected)));
+}
+
+TEST_F(PixelKernelsTests, allKernels_everyLengthAndAlignment_matchScalar)
+{
+	for (int i = PixelKernels::kScalar + 1;
+							i < PixelKernels::kNumInstructionSets; ++i) {
+		PixelKernels::EInstructionSet set =
+							static_cast<PixelKernels::EInstructionSet>(i);
+		if (!PixelKernels::isSupported(set)) {
+			LOG((CLOG_INFO "%s kernels not supported, skipping", PixelKernels::getName(set)));
+			continue;
+		}
+
+		for (UInt32 pixels = 0; pixels <= MAX_PIXELS; ++pixels) {
+			for (UInt32 offset = 0; offset < 4; ++offset) {
+				SCOPED_TRACE(testing::Message() << PixelKernels::getName(set) << " pixels=" << pixels << " offset=" << offset);
+				EXPECT_TRUE(bgrToBGRA(PixelKernels::kScalar, pixels, offset) ==
+							bgrToBGRA(set, pixels, offset));
+				EXPECT_TRUE(bgraToBGR(PixelKernels::kScalar, pixels, offset) ==
+							bgraToBGR(set, pixels, offset));
+				EXPECT_TRUE(fillAlpha(PixelKernels::kScalar, pixels, offset) ==
+							fillAlpha(set, pixels, offset));
+			}
+		}
+
+		for (UInt32 rowBytes = 0; rowBytes <= MAX_PIXELS; ++rowBytes) {
+			for (UInt32 rows = 0; rows < 6; ++rows) {
+				SCOPED_TRACE(testing::Message() << PixelKernels::getName(set) << " rowBytes=" << rowBytes << " rows=" << rows);
+				EXPECT_TRUE(flipRows(PixelKernels::kScalar, rowBytes, rows) ==
+							flipRows(set, rowBytes, rows));
+			}
+		}
+	}
+}
+
+TEST_F(PixelKernelsTests, makeBottomUp_topDown_flipsAndNegatesHeight)
+{
+	// 2x2 24 bit, rows padded to 8 bytes
+	String dib(40, '\0');
+	dib[0]  = 40;
+	dib[4]  = 2;
+	dib[8]  = static_cast<char>(0xfe);	// -2
+	dib[9]  = static_cast<char>(0xff);
+	dib[10] = static_cast<char>(0xff);
+	dib[11] = static_cast<char>(0xff);
+	dib[14] = 24;
+	dib += String("\x01\x01\x01\x02\x02\x02\0\0", 8);
+	dib += String("\x03\x03\x03\x04\x04\x04\0\0", 8);
+
+	EXPECT_TRUE(PixelKernels::makeBottomUp(dib));
+
+	EXPECT_EQ(2, dib[8]);
+	EXPECT_EQ(0, dib[11]);
+	EXPECT_EQ(3, dib[40]);
+	EXPECT_EQ(1, dib[48]);
+}
+
+TEST_F(PixelKernelsTests, makeBottomUp_truncated_returnsFalse)
+{
+	String dib(40, '\0');
+	dib[0]  = 40;
+	dib[4]  = 2;
+	dib[8]  = static_cast<char>(0xfe);
+	dib[9]  = static_cast<char>(0xff);
+	dib[10] = static_cast<char>(0xff);
+	dib[11] = static_cast<char>(0xff);
+	dib[14] = 32;
+	dib += String(8, '\x01');
+
+	EXPECT_FALSE(PixelKernels::makeBottomUp(dib));
+	EXPECT_EQ(static_cast<char>(0xfe), dib[8]);
+}
+
+// not a correctness test:  logs the throughput of each kernel on a
+// 1080p and a 4K screenshot
+TEST_F(PixelKernelsTests, benchmark_screenshots_logsThroughput)
+{
+	const UInt32 sizes[][2] = { { 1920, 1080 }, { 3840, 2160 } };
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+		const UInt32 w      = sizes[s][0];
+		const UInt32 h      = sizes[s][1];
+		const UInt32 pixels = w * h;
+		Buffer bgr(3 * pixels);
+		Buffer bgra(4 * pixels);
+		fill(bgr, 1);
+		fill(bgra, 2);
+
+		for (int i = PixelKernels::kScalar;
+							i < PixelKernels::kNumInstructionSets; ++i) {
+			PixelKernels::EInstructionSet set =
+							static_cast<PixelKernels::EInstructionSet>(i);
+			if (!PixelKernels::isSupported(set)) {
+				continue;
+			}
+			PixelKernels::setInstructionSet(set);
+
+			double start = ARCH->monotonicTime();
+			PixelKernels::bgrToBGRA(&bgra[0], &bgr[0], pixels, 0xff);
+			const double expand = ARCH->monotonicTime() - start;
+
+			start = ARCH->monotonicTime();
+			PixelKernels::bgraToBGR(&bgr[0], &bgra[0], pixels);
+			const double pack = ARCH->monotonicTime() - start;
+
+			start = ARCH->monotonicTime();
+			PixelKernels::fillAlpha(&bgra[0], pixels, 0xff);
+			const double alpha = ARCH->monotonicTime() - start;
+
+			start = ARCH->monotonicTime();
+			PixelKernels::flipRows(&bgra[0], 4 * w, h);
+			const double flip = ARCH->monotonicTime() - start;
+
+			LOG((CLOG_INFO "%ux%u %s: bgr->bgra %.2fms, bgra->bgr %.2fms, alpha %.2fms, flip %.2fms", w, h, PixelKernels::getName(set), 1000.0 * expand, 1000.0 * pack, 1000.0 * alpha, 1000.0 * flip));
+		}
+	}
+}
@@ -0,0 +1,134 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2015 Synergy Si Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "synergy/ProtocolCapture.h"
+#include "synergy/ProtocolReplay.h"
+#include "base/EventQueue.h"
+
+#include "test/global/gtest.h"
+
+#include <stdio.h>
+
+static const char*		kCaptureFilename = "ProtocolCaptureTests.syncap";
+
+class ProtocolCaptureTests : public ::testing::Test {
+protected:
+	virtual void
+	TearDown()
+	{
+		remove(kCaptureFilename);
+	}
+
+	static ProtocolCapture::Record
+	makeRecord(UInt32 connection, ProtocolCapture::EDirection direction,
+				const String& data)
+	{
+		ProtocolCapture::Record record;
+		record.m_time       = 0.0;
+		record.m_connection = connection;
+		record.m_direction  = direction;
+		record.m_data       = data;
+		return record;
+	}
+};
+
+TEST_F(ProtocolCaptureTests, save_twoConnections_loadsSamePackets)
+{
+	{
+		ProtocolCapture capture(kCaptureFilename, 1024, ProtocolCapture::kServer);
+		EXPECT_TRUE(ProtocolCapture::isCapturing());
+		ProtocolCapture::record(1, ProtocolCapture::kInput, "CNOP", 4);
+		ProtocolCapture::record(2, ProtocolCapture::kOutput, "DMMV\0\1\0\2", 8);
+	}
+	EXPECT_FALSE(ProtocolCapture::isCapturing());
+
+	ProtocolCapture::ESide side;
+	ProtocolCapture::RecordList records;
+	ASSERT_TRUE(ProtocolCapture::load(kCaptureFilename, side, records));
+
+	EXPECT_EQ(ProtocolCapture::kServer, side);
+	ASSERT_EQ(2u, records.size());
+	EXPECT_EQ(1u, records[0].m_connection);
+	EXPECT_EQ(ProtocolCapture::kInput, records[0].m_direction);
+	EXPECT_EQ("CNOP", records[0].m_data);
+	EXPECT_EQ(2u, records[1].m_connection);
+	EXPECT_EQ(ProtocolCapture::kOutput, records[1].m_direction);
+	EXPECT_EQ(String("DMMV\0\1\0\2", 8), records[1].m_data);
+	EXPECT_LE(records[0].m_time, records[1].m_time);
+}
+
+TEST_F(ProtocolCaptureTests, record_overMaxBytes_dropsOldest)
+{
+	{
+		// room for two of the 17 byte headers and their payloads
+		ProtocolCapture capture(kCaptureFilename, 50, ProtocolCapture::kClient);
+		ProtocolCapture::record(1, ProtocolCapture::kInput, "CALV", 4);
+		ProtocolCapture::record(1, ProtocolCapture::kInput, "CNOP", 4);
+		ProtocolCapture::record(1, ProtocolCapture::kInput, "CBYE", 4);
+	}
+
+	ProtocolCapture::ESide side;
+	ProtocolCapture::RecordList records;
+	ASSERT_TRUE(ProtocolCapture::load(kCaptureFilename, side, records));
+
+	EXPECT_EQ(ProtocolCapture::kClient, side);
+	ASSERT_EQ(2u, records.size());
+	EXPECT_EQ("CNOP", records[0].m_data);
+	EXPECT_EQ("CBYE", records[1].m_data);
+}
+
+TEST_F(ProtocolCaptureTests, ctor_emptyPath_doesNotCapture)
+{
+	ProtocolCapture capture("", 1024, ProtocolCapture::kClient);
+
+	EXPECT_FALSE(ProtocolCapture::isCapturing());
+}
+
+TEST_F(ProtocolCaptureTests, load_notCapture_returnsFalse)
+{
+	FILE* file = fopen(kCaptureFilename, "wb");
+	ASSERT_TRUE(file != NULL);
+	fputs("not a capture", file);
+	fclose(file);
+
+	ProtocolCapture::ESide side;
+	ProtocolCapture::RecordList records;
+	EXPECT_FALSE(ProtocolCapture::load(kCaptureFilename, side, records));
+}
+
+TEST_F(ProtocolCaptureTests, replay_serverCapture_replaysEveryInput)
+{
+	// a client's hello back, as "Synergy", version 1.6 and its name,
+	// and its screen info
+	String hello("Synergy\0\1\0\6\0\0\0\6laptop", 21);
+	String info("DINF\0\0\0\0\7\200\4\70\0\0\3\300\2\34", 18);
+	ProtocolCapture::RecordList records;
+	records.push_back(makeRecord(1, ProtocolCapture::kOutput,
+						String("Synergy\0\1\0\6", 11)));
+	records.push_back(makeRecord(1, ProtocolCapture::kInput, hello));
+	records.push_back(makeRecord(1, ProtocolCapture::kInput, info));
+	records.push_back(makeRecord(1, ProtocolCapture::kInput, "CNOP"));
+
+	EventQueue events;
+	ProtocolReplay replay(&events);
+	replay.run(ProtocolCapture::kServer, records, false);
+
+	EXPECT_EQ(3u, replay.getPackets());
+	EXPECT_EQ(43.0, replay.getBytes());
+	EXPECT_EQ(3u, replay.getLatency().getCount());
+}
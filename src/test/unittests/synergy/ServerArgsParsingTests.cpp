@@ -64,3 +64,17 @@ TEST(ServerArgsParsingTests, parseServerArgs_configArg_setConfigFile)
 
 	EXPECT_EQ("mock_configFile", serverArgs.m_configFile);
 }
+
+TEST(ServerArgsParsingTests, parseServerArgs_protocolWorkersArg_setProtocolWorkers)
+{
+	NiceMock<MockArgParser> argParser;
+	ON_CALL(argParser, parseGenericArgs(_, _, _)).WillByDefault(Invoke(server_stubParseGenericArgs));
+	ON_CALL(argParser, checkUnexpectedArgs()).WillByDefault(Invoke(server_stubCheckUnexpectedArgs));
+	ServerArgs serverArgs;
+	const int argc = 2;
+	const char* kProtocolWorkersCmd[argc] = { "stub", "--protocol-workers" };
+
+	argParser.parseServerArgs(serverArgs, argc, kProtocolWorkersCmd);
+
+	EXPECT_TRUE(serverArgs.m_protocolWorkers);
+}